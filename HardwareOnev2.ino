@@ -1,7 +1,28 @@
 // Forward declarations to satisfy Arduino's auto-generated prototypes
 struct AuthContext;
+struct SessionEntry;
 struct CommandContext;
 struct Command;
+struct CommandEntry;
+struct AutoEntry;
+struct CondTerm;
+struct CondBranch;
+struct EspNowRxPacket;
+struct EspNowTxXfer;
+struct EspNowRxXfer;
+struct EspNowFrameHdr;
+struct EspNowTxDone;
+struct ChunkedMessage;
+struct EspNowTelemetry;
+struct EspNowSession;
+struct ExecReq;
+struct CliJob;
+struct WebGzPage;
+struct AutoStateRec;
+struct MemPerfSample;
+struct MemPerfTagStat;
+struct I2CPerfHist;
+struct I2CPerfSnap;
 static String originPrefix(const char* source, const String& user, const String& ip);
 static void runAutomationCommandUnified(const String& cmd);
 static void runUnifiedSystemCommand(const String& cmd);
@@ -14,7 +35,14 @@ static void runUnifiedSystemCommand(const String& cmd);
 #include <Preferences.h>
 #include <time.h>
 #include <esp_timer.h>
+#include <esp_idf_version.h>
 #include "mbedtls/base64.h"
+#include "mbedtls/md.h"
+#include "mbedtls/pkcs5.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/version.h"
+#include "rom/miniz.h"
+#include "esp_rom_crc.h"
 #include <lwip/sockets.h>
 #include "web_shared.h"
 #include "web_auth_required.h"
@@ -44,6 +72,7 @@ static void runUnifiedSystemCommand(const String& cmd);
 #include "vl53l4cx_class.h"
 #include <Adafruit_MLX90640.h>
 #include <vector>
+#include <atomic>
 #include "mem_util.h"
 
 
@@ -54,13 +83,29 @@ static bool executeUnifiedWebCommand(httpd_req_t* req, AuthContext& ctx, const S
 // Pre-allocation snapshots (used by mem_util.h capture helper)
 size_t gAllocHeapBefore = 0;
 size_t gAllocPsBefore = 0;
-// Global flag to indicate CLI dry-run validation mode (no side effects)
-static bool gCLIValidateOnly = false;
+// Command concurrency classes: each class has its own executor worker, so
+// commands of one class run one at a time and different classes run in parallel
+enum CmdClass : uint8_t {
+  CMD_CLASS_STATUS = 0,  // read-only status/diagnostics, quick
+  CMD_CLASS_SENSOR,      // sensor/LED/I2C control
+  CMD_CLASS_FS,          // filesystem and persisted settings mutation
+  CMD_CLASS_BLOCKING,    // long-running: waits, WiFi, ESP-NOW sends, LED effects, downloads
+  CMD_CLASS_COUNT
+};
+
+// Execution state of the running command; one per executor worker (see execState())
+struct ExecState {
+  bool validateOnly = false;  // CLI dry-run validation mode (no side effects)
+  bool fromWeb = false;       // CLI admin gating context (set for web CLI requests)
+  bool isAdmin = false;
+  String user;
+};
+static ExecState& execState();
 
 // Helper: early-return for validate-only mode inside command branches
 #define RETURN_VALID_IF_VALIDATE() \
   do { \
-    if (gCLIValidateOnly) return String("VALID"); \
+    if (execState().validateOnly) return String("VALID"); \
   } while (0)
 
 // Forward declaration for debug output sink used in macros
@@ -206,6 +251,7 @@ extern VL53L4CX* tofSensor;  // Declared later
 bool readToFObjects();
 void readIMUSensor();
 static bool readText(const char* path, String& out);
+bool writeText(const char* path, const String& in);
 static bool appendLineWithCap(const char* path, const String& line, size_t capBytes);
 static bool isAdminUser(const String& who);
 static String setSession(httpd_req_t* req, const String& u);
@@ -216,6 +262,7 @@ static bool initIMUSensor();
 // Forward declarations for functions defined later but used earlier
 static bool approvePendingUserInternal(const String& username, String& errorOut);
 static bool denyPendingUserInternal(const String& username, String& errorOut);
+static bool updateUserPasswordInternal(const String& username, const String& expectStored, const String& newStored, String& errorOut);
 static String jsonEscape(const String& in);
 void broadcastWithOrigin(const String& channel, const String& user, const String& origin, const String& message);
 
@@ -397,18 +444,17 @@ void timeSyncUpdateBootEpoch() {
 // ----- Output toggle and debug handlers (Batch 4 - Part C) -----
 // (moved per-sensor dedicated tasks below unifiedSensorPollingTask)
 
-// Forward declaration required by schedulerTickMinute
+// Forward declaration required by the automations scheduler
 static String processCommand(const String& cmd);
 
 // ----------------------------------------------------------------------------
-// Minute-based Automations Scheduler (v1: atTime only)
+// Automations Scheduler
 // ----------------------------------------------------------------------------
-// Runs once per minute. Reads automations.json and runs enabled atTime commands
-// that match current HH:MM and optional day filters. Prevents duplicate runs in
-// the same minute via a tiny memo table.
+// A dedicated task keeps enabled automations in a deadline min-heap and sleeps
+// until the earliest one is due, so atTime fires on the second and
+// interval/afterDelay honour their millisecond periods (see autoSchedulerTask).
 
 // Memo of last trigger per automation id: key = YYYYMMDDHHMM (int64 via String hash)
-static unsigned long gLastMinuteSeen = 0;  // millis()/60000 snapshot
 static const int kAutoMemoCap = 32;
 static long* gAutoMemoId = nullptr;
 static unsigned long* gAutoMemoKey = nullptr;
@@ -514,295 +560,776 @@ static bool appendAutoLogEntry(const String& type, const String& content) {
   return written > 0;
 }
 
-static void schedulerTickMinute() {
-  // Only valid if time is synced
-  time_t now = time(nullptr);
-  if (now <= 0) return;
+// -------- Pre-parsed automation table --------
+// automations.json is parsed once into compact POD entries. Names, conditions and
+// interned command strings live in a single arena referenced by offset, so the
+// scheduler never touches the filesystem or re-scans JSON. The table is
+// rebuilt only after the file is mutated (gAutoTableStale).
+enum AutoType : uint8_t {
+  AUTO_TYPE_UNKNOWN = 0,
+  AUTO_TYPE_ATTIME,
+  AUTO_TYPE_AFTERDELAY,
+  AUTO_TYPE_INTERVAL
+};
 
-  DEBUGF(DEBUG_DATETIME | DEBUG_AUTOMATIONS, "[automations] tick now=%lu", (unsigned long)now);
+enum AutoCondKind : uint8_t {
+  AUTO_COND_NONE = 0,
+  AUTO_COND_SIMPLE,  // single IF/THEN gate
+  AUTO_COND_CHAIN    // IF/ELSE IF/ELSE chain selecting an action
+};
 
-  // Load automations.json
-  String json;
-  if (!readText("/automations.json", json)) return;
-  DEBUGF(DEBUG_AUTOMATIONS, "[automations] json size=%d", json.length());
+struct AutoEntry {
+  long id;
+  time_t nextAt;      // 0 = not yet computed
+  int64_t dueMs;      // scheduler deadline (epoch ms); nextAt is its persisted, rounded-up form
+  time_t seedNextAt;  // nextAt as found in automations.json (runtime state applies while it matches)
+  uint32_t lastRun;   // epoch seconds of the last scheduled run
+  uint32_t runCount;
+  uint32_t periodMs;  // delayMs (afterDelay) or intervalMs (interval)
+  uint32_t nameOff;   // arena offsets; 0 = empty string
+  uint32_t condOff;
+  uint16_t condFirst;  // compiled condition: first index into gAutoCondBranches
+  uint8_t condBranchCount;
+  uint16_t cmdFirst;  // first index into gAutoCmdRefs
+  uint16_t cmdCount;
+  uint8_t type;
+  uint8_t condKind;
+  uint8_t dayMask;    // bit n set = runs on tm_wday n
+  int8_t hour;        // atTime only; -1 if invalid
+  int8_t minute;
+  bool enabled;
+};
 
-  int evaluated = 0, executed = 0;
-  bool queueSanitize = false;
-  long seenIds[128];
-  int seenCount = 0;
+static const int kAutoMaxCmdsPerEntry = 64;
+
+static AutoEntry* gAutoTable = nullptr;
+static int gAutoTableCount = 0;
+static int gAutoTableCap = 0;
+static char* gAutoArena = nullptr;  // NUL-separated strings; offset 0 is ""
+static uint32_t gAutoArenaLen = 0;
+static uint32_t gAutoArenaCap = 0;
+struct AutoCmdSlot {
+  uint32_t off;   // arena offset of the interned command text
+  uint32_t hash;  // FNV-1a of the text
+};
+static AutoCmdSlot* gAutoCmds = nullptr;
+static int gAutoCmdCount = 0;
+static int gAutoCmdCap = 0;
+static uint16_t* gAutoCmdRefs = nullptr;  // per-entry lists of unique command indices
+static int gAutoCmdRefCount = 0;
+static int gAutoCmdRefCap = 0;
+static volatile bool gAutoTableStale = true;  // set by any automations.json mutation
+
+static inline const char* autoStr(uint32_t off) {
+  return (gAutoArena && off < gAutoArenaLen) ? (gAutoArena + off) : "";
+}
+
+static bool autoGrow(void** buf, int& cap, int need, size_t elemSize, const char* tag) {
+  if (need <= cap) return true;
+  int newCap = cap ? cap : 16;
+  while (newCap < need) newCap *= 2;
+  void* p = ps_realloc(*buf, (size_t)newCap * elemSize, AllocPref::PreferPSRAM, tag);
+  if (!p) return false;
+  *buf = p;
+  cap = newCap;
+  return true;
+}
 
-  int pos = 0;
-  while (true) {
-    int idPos = json.indexOf("\"id\"", pos);
-    if (idPos < 0) break;
-    int colon = json.indexOf(':', idPos);
-    if (colon < 0) break;
-    int comma = json.indexOf(',', colon + 1);
-    int braceEnd = json.indexOf('}', colon + 1);
-    if (braceEnd < 0) break;
-    if (comma < 0 || comma > braceEnd) comma = braceEnd;
-    String idStr = json.substring(colon + 1, comma);
-    idStr.trim();
-    long id = idStr.toInt();
+static uint32_t autoArenaAppend(const char* s, size_t n) {
+  if (n == 0) return 0;
+  uint32_t base = gAutoArenaLen ? gAutoArenaLen : 1;  // offset 0 is reserved for ""
+  uint32_t need = base + (uint32_t)n + 1;
+  if (need > gAutoArenaCap) {
+    uint32_t newCap = gAutoArenaCap ? gAutoArenaCap : 1024;
+    while (newCap < need) newCap *= 2;
+    char* p = (char*)ps_realloc(gAutoArena, newCap, AllocPref::PreferPSRAM, "auto.arena");
+    if (!p) return 0;
+    gAutoArena = p;
+    gAutoArenaCap = newCap;
+  }
+  gAutoArena[0] = '\0';
+  memcpy(gAutoArena + base, s, n);
+  gAutoArena[base + n] = '\0';
+  gAutoArenaLen = need;
+  return base;
+}
+
+// Returns the unique-command index for cmd, adding it if new; -1 on OOM
+static int autoInternCommand(const String& cmd) {
+  uint32_t h = 2166136261UL;
+  for (size_t i = 0; i < cmd.length(); ++i) {
+    h ^= (uint8_t)cmd[i];
+    h *= 16777619UL;
+  }
+  for (int i = 0; i < gAutoCmdCount; ++i) {
+    if (gAutoCmds[i].hash == h && strcmp(autoStr(gAutoCmds[i].off), cmd.c_str()) == 0) return i;
+  }
+  if (!autoGrow((void**)&gAutoCmds, gAutoCmdCap, gAutoCmdCount + 1, sizeof(AutoCmdSlot), "auto.cmds")) return -1;
+  uint32_t off = autoArenaAppend(cmd.c_str(), cmd.length());
+  if (off == 0) return -1;
+  gAutoCmds[gAutoCmdCount].off = off;
+  gAutoCmds[gAutoCmdCount].hash = h;
+  return gAutoCmdCount++;
+}
+
+static bool autoPushCmdRef(int uniqueIdx) {
+  if (uniqueIdx < 0 || gAutoCmdRefCount >= 0xFFFF) return false;
+  if (!autoGrow((void**)&gAutoCmdRefs, gAutoCmdRefCap, gAutoCmdRefCount + 1, sizeof(uint16_t), "auto.cmd.refs")) return false;
+  gAutoCmdRefs[gAutoCmdRefCount++] = (uint16_t)uniqueIdx;
+  return true;
+}
 
-    // Extract the object substring
-    int objStart = json.lastIndexOf('{', idPos);
-    if (objStart < 0) {
-      pos = braceEnd + 1;
-      continue;
-    }
-    String obj = json.substring(objStart, braceEnd + 1);
+static inline const char* autoEntryCmd(const AutoEntry& e, int i) {
+  return autoStr(gAutoCmds[gAutoCmdRefs[e.cmdFirst + i]].off);
+}
 
-    // Duplicate-id guard
-    bool dupSeen = false;
-    for (int i = 0; i < seenCount; ++i) {
-      if (seenIds[i] == id) {
-        dupSeen = true;
-        break;
+static inline bool autoJsonIsWs(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Reads a JSON string literal at json[i]=='"' (unescaping), returns index past the closing quote or -1
+static int autoJsonReadString(const String& json, int i, int end, String& out) {
+  out = "";
+  if (i >= end || json[i] != '"') return -1;
+  for (++i; i < end; ++i) {
+    char c = json[i];
+    if (c == '"') return i + 1;
+    if (c == '\\' && i + 1 < end) {
+      char e = json[++i];
+      switch (e) {
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        default: out += e; break;  // \" \\ \/ and anything else verbatim
       }
+    } else {
+      out += c;
     }
-    if (dupSeen) {
-      DEBUGF(DEBUG_AUTOMATIONS, "[autos] duplicate id detected at runtime id=%ld; skipping and queuing sanitize", id);
-      queueSanitize = true;
-      pos = braceEnd + 1;
-      continue;
-    }
-    if (seenCount < (int)(sizeof(seenIds) / sizeof(seenIds[0]))) { seenIds[seenCount++] = id; }
-
-    evaluated++;
+  }
+  return -1;
+}
 
-    // Check if enabled
-    bool enabled = (obj.indexOf("\"enabled\": true") >= 0) || (obj.indexOf("\"enabled\":true") >= 0);
-    if (!enabled) {
-      DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld skip: disabled", id);
-      pos = braceEnd + 1;
-      continue;
+// Skips any JSON value starting at json[i], returns index just past it
+static int autoJsonSkipValue(const String& json, int i, int end) {
+  if (i >= end) return end;
+  char c = json[i];
+  if (c == '"') {
+    for (++i; i < end; ++i) {
+      if (json[i] == '\\') ++i;
+      else if (json[i] == '"') return i + 1;
     }
-
-    // Parse nextAt field
-    time_t nextAt = 0;
-    int nextAtPos = obj.indexOf("\"nextAt\"");
-    if (nextAtPos >= 0) {
-      int nextAtColon = obj.indexOf(':', nextAtPos);
-      int nextAtComma = obj.indexOf(',', nextAtColon);
-      int nextAtBrace = obj.indexOf('}', nextAtColon);
-      int nextAtEnd = (nextAtComma > 0 && (nextAtBrace < 0 || nextAtComma < nextAtBrace)) ? nextAtComma : nextAtBrace;
-      if (nextAtEnd > nextAtColon) {
-        String nextAtStr = obj.substring(nextAtColon + 1, nextAtEnd);
-        nextAtStr.trim();
-        if (nextAtStr != "null" && nextAtStr.length() > 0) {
-          nextAt = (time_t)nextAtStr.toInt();
-        }
+    return end;
+  }
+  if (c == '{' || c == '[') {
+    int depth = 0;
+    for (; i < end; ++i) {
+      char d = json[i];
+      if (d == '"') {
+        i = autoJsonSkipValue(json, i, end) - 1;
+      } else if (d == '{' || d == '[') {
+        depth++;
+      } else if (d == '}' || d == ']') {
+        if (--depth == 0) return i + 1;
       }
     }
+    return end;
+  }
+  while (i < end && json[i] != ',' && json[i] != '}' && json[i] != ']' && !autoJsonIsWs(json[i])) ++i;
+  return i;
+}
 
-    // If nextAt is missing or invalid, compute it now
-    if (nextAt <= 0) {
-      nextAt = computeNextRunTime(obj, now);
-      if (nextAt > 0) {
-        updateAutomationNextAt(id, nextAt);
-        DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld computed missing nextAt=%lu", id, (unsigned long)nextAt);
-      } else {
-        DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld skip: could not compute nextAt", id);
-        pos = braceEnd + 1;
-        continue;
-      }
+// Parses one automation object json[objStart..objEnd] into e. With storeStrings=false
+// only scheduling fields are filled (no arena/command-table writes).
+static bool autoParseObject(const String& json, int objStart, int objEnd, AutoEntry& e, bool storeStrings) {
+  memset(&e, 0, sizeof(e));
+  e.hour = -1;
+  e.minute = -1;
+  e.dayMask = 0x7F;
+  e.cmdFirst = (uint16_t)gAutoCmdRefCount;
+  bool haveId = false;
+  bool haveArray = false;
+  long delayMs = 0, intervalMs = 0;
+  String key, sval, single, days;
+  bool haveDays = false;
+
+  int end = objEnd;
+  int i = objStart + 1;
+  while (i < end) {
+    if (json[i] != '"') {
+      ++i;
+      continue;
     }
-
-    // Check if it's time to run
-    if (now >= nextAt) {
-      // Extract commands
-      String cmdsList[64];
-      int cmdsCount = 0;
-      int cmdsPos = obj.indexOf("\"commands\"");
-      bool haveArray = false;
-      int arrStart = -1, arrEnd = -1;
-
-      if (cmdsPos >= 0) {
-        int cmdsColon = obj.indexOf(':', cmdsPos);
-        if (cmdsColon > 0) {
-          arrStart = obj.indexOf('[', cmdsColon);
-          if (arrStart > 0) {
-            int depth = 0;
-            for (int i = arrStart; i < (int)obj.length(); ++i) {
-              char c = obj[i];
-              if (c == '[') depth++;
-              else if (c == ']') {
-                depth--;
-                if (depth == 0) {
-                  arrEnd = i;
-                  break;
-                }
-              }
-            }
-            haveArray = (arrStart > 0 && arrEnd > arrStart);
+    i = autoJsonReadString(json, i, end, key);
+    if (i < 0) break;
+    while (i < end && autoJsonIsWs(json[i])) ++i;
+    if (i >= end || json[i] != ':') continue;
+    ++i;
+    while (i < end && autoJsonIsWs(json[i])) ++i;
+    if (i >= end) break;
+    char v = json[i];
+
+    if (v == '"') {
+      i = autoJsonReadString(json, i, end, sval);
+      if (i < 0) break;
+      if (key == "type") {
+        sval.toLowerCase();
+        if (sval == "attime") e.type = AUTO_TYPE_ATTIME;
+        else if (sval == "afterdelay") e.type = AUTO_TYPE_AFTERDELAY;
+        else if (sval == "interval") e.type = AUTO_TYPE_INTERVAL;
+      } else if (key == "time") {
+        if (sval.length() == 5 && sval[2] == ':') {
+          int hh = sval.substring(0, 2).toInt();
+          int mm = sval.substring(3, 5).toInt();
+          if (hh >= 0 && hh <= 23 && mm >= 0 && mm <= 59) {
+            e.hour = (int8_t)hh;
+            e.minute = (int8_t)mm;
           }
         }
-      }
-
-      if (haveArray) {
-        String body = obj.substring(arrStart + 1, arrEnd);
-        int i = 0;
-        while (i < (int)body.length() && cmdsCount < 64) {
-          while (i < (int)body.length() && (body[i] == ' ' || body[i] == ',')) i++;
-          if (i >= (int)body.length()) break;
-          if (body[i] == '"') {
-            int q1 = i;
-            int q2 = body.indexOf('"', q1 + 1);
-            if (q2 < 0) break;
-            String one = body.substring(q1 + 1, q2);
-            one.trim();
-            if (one.length() && cmdsCount < 64) { cmdsList[cmdsCount++] = one; }
-            i = q2 + 1;
-          } else {
-            int next = body.indexOf(',', i);
-            if (next < 0) break;
-            i = next + 1;
-          }
+      } else if (key == "days") {
+        days = sval;
+        haveDays = true;
+      } else if (key == "delayMs") {
+        delayMs = sval.toInt();
+      } else if (key == "intervalMs") {
+        intervalMs = sval.toInt();
+      } else if (storeStrings && key == "name") {
+        e.nameOff = autoArenaAppend(sval.c_str(), sval.length());
+      } else if (storeStrings && key == "conditions") {
+        sval.trim();
+        if (sval.length()) {
+          e.condOff = autoArenaAppend(sval.c_str(), sval.length());
+          e.condKind = (sval.indexOf("ELSE") >= 0) ? AUTO_COND_CHAIN : AUTO_COND_SIMPLE;
         }
-      } else {
-        // Fallback to single command
-        int cpos = obj.indexOf("\"command\"");
-        if (cpos >= 0) {
-          int ccolon = obj.indexOf(':', cpos);
-          int cq1 = obj.indexOf('"', ccolon + 1);
-          int cq2 = obj.indexOf('"', cq1 + 1);
-          if (cq1 > 0 && cq2 > cq1) {
-            String cmd = obj.substring(cq1 + 1, cq2);
-            cmd.trim();
-            if (cmd.length() && cmdsCount < 64) { cmdsList[cmdsCount++] = cmd; }
-          }
+      } else if (storeStrings && key == "command") {
+        single = sval;
+        single.trim();
+      }
+    } else if (v == '[' && storeStrings && key == "commands") {
+      int arrEnd = autoJsonSkipValue(json, i, end);
+      haveArray = true;
+      for (int j = i + 1; j < arrEnd - 1;) {
+        if (json[j] != '"') {
+          ++j;
+          continue;
         }
+        j = autoJsonReadString(json, j, arrEnd, sval);
+        if (j < 0) break;
+        sval.trim();
+        if (sval.length() && e.cmdCount < kAutoMaxCmdsPerEntry && autoPushCmdRef(autoInternCommand(sval))) e.cmdCount++;
+      }
+      i = arrEnd;
+    } else if (v == '[' || v == '{') {
+      i = autoJsonSkipValue(json, i, end);
+    } else {
+      int tokEnd = autoJsonSkipValue(json, i, end);
+      String tok = json.substring(i, tokEnd);
+      i = tokEnd;
+      if (key == "id") {
+        e.id = tok.toInt();
+        haveId = true;
+      } else if (key == "enabled") {
+        e.enabled = (tok == "true");
+      } else if (key == "nextAt") {
+        e.nextAt = (tok == "null") ? 0 : (time_t)tok.toInt();
+      } else if (key == "delayMs") {
+        delayMs = tok.toInt();
+      } else if (key == "intervalMs") {
+        intervalMs = tok.toInt();
       }
+    }
+  }
 
-      if (cmdsCount > 0) {
-        // Extract automation name for logging
-        String autoName = "Unknown";
-        int namePos = obj.indexOf("\"name\"");
-        if (namePos >= 0) {
-          int colonPos = obj.indexOf(':', namePos);
-          if (colonPos >= 0) {
-            int q1 = obj.indexOf('"', colonPos + 1);
-            int q2 = obj.indexOf('"', q1 + 1);
-            if (q1 >= 0 && q2 >= 0) {
-              autoName = obj.substring(q1 + 1, q2);
-            }
-          }
-        }
+  if (storeStrings && !haveArray && single.length()) {
+    if (autoPushCmdRef(autoInternCommand(single))) e.cmdCount = 1;
+  }
+  if (haveDays && days.length()) {
+    uint8_t mask = 0;
+    for (int d = 0; d < 7; ++d) {
+      if (parseAtTimeMatchDays(days, d)) mask |= (uint8_t)(1 << d);
+    }
+    e.dayMask = mask;
+  }
+  if (e.type == AUTO_TYPE_AFTERDELAY) e.periodMs = delayMs > 0 ? (uint32_t)delayMs : 0;
+  else if (e.type == AUTO_TYPE_INTERVAL) e.periodMs = intervalMs > 0 ? (uint32_t)intervalMs : 0;
+  return haveId;
+}
 
-        // Check conditions if present
-        String conditions = "";
-        int condPos = obj.indexOf("\"conditions\"");
-        if (condPos >= 0) {
-          int condColon = obj.indexOf(':', condPos);
-          if (condColon >= 0) {
-            int condQ1 = obj.indexOf('"', condColon + 1);
-            int condQ2 = obj.indexOf('"', condQ1 + 1);
-            if (condQ1 >= 0 && condQ2 >= 0) {
-              conditions = obj.substring(condQ1 + 1, condQ2);
-              conditions.trim();
-            }
-          }
-        }
-        
-        // Evaluate conditions if present
-        if (conditions.length() > 0) {
-          // Check if this is a conditional chain (contains ELSE/ELSE IF)
-          if (conditions.indexOf("ELSE") >= 0) {
-            String actionToExecute = evaluateConditionalChain(conditions);
-            DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld conditional chain result: '%s'", 
-                   id, actionToExecute.c_str());
-            
-            if (actionToExecute.length() > 0) {
-              // Execute the specific action from the chain
-              String result = executeConditionalCommand(actionToExecute);
-              if (result.startsWith("Error:")) {
-                DEBUGF(DEBUG_AUTOMATIONS, "[autos] conditional chain error: %s", result.c_str());
-              }
-            }
-            continue; // Skip normal command execution
-          } else {
-            // Simple IF/THEN condition
-            bool conditionMet = evaluateCondition(conditions);
-            DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld condition='%s' result=%s", 
-                   id, conditions.c_str(), conditionMet ? "TRUE" : "FALSE");
-            
-            if (!conditionMet) {
-              if (gAutoLogActive) {
-                String skipMsg = "Scheduled automation skipped: ID=" + String(id) + " Name=" + autoName + " Condition not met: " + conditions;
-                appendAutoLogEntry("AUTO_SKIP", skipMsg);
-              }
-              DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld skipped - condition not met: %s", id, conditions.c_str());
-              continue; // Skip to next automation
-            }
-          }
-        }
+static time_t computeNextRunTimeEntry(const AutoEntry& e, time_t fromTime) {
+  if (e.type == AUTO_TYPE_ATTIME) {
+    if (e.hour < 0 || e.minute < 0 || e.dayMask == 0) return 0;
+    struct tm tmNow;
+    if (!localtime_r(&fromTime, &tmNow)) return 0;
+    // Today first, then up to 7 days ahead for the next allowed weekday
+    for (int dayOffset = 0; dayOffset <= 7; dayOffset++) {
+      struct tm tmTarget = tmNow;
+      tmTarget.tm_mday += dayOffset;
+      tmTarget.tm_hour = e.hour;
+      tmTarget.tm_min = e.minute;
+      tmTarget.tm_sec = 0;
+      tmTarget.tm_isdst = -1;  // Let system determine DST
+      time_t candidateTime = mktime(&tmTarget);
+      if (candidateTime <= fromTime) continue;
+      struct tm tmCheck;
+      if (localtime_r(&candidateTime, &tmCheck) && (e.dayMask & (1 << tmCheck.tm_wday))) {
+        return candidateTime;
+      }
+    }
+    return 0;
+  } else if (e.type == AUTO_TYPE_AFTERDELAY || e.type == AUTO_TYPE_INTERVAL) {
+    if (e.periodMs == 0) return 0;
+    return fromTime + (time_t)((e.periodMs + 999) / 1000);  // Convert ms to seconds, rounding up
+  }
+  return 0;  // Unknown type or error
+}
 
-        // Log scheduled automation start if logging is active
-        if (gAutoLogActive) {
-          gAutoLogAutomationName = autoName;
-          String startMsg = "Scheduled automation started: ID=" + String(id) + " Name=" + autoName + " User=system";
-          appendAutoLogEntry("AUTO_START", startMsg);
-        }
+// -------- Automation runtime state --------
+// Scheduler-owned fields (nextAt, last run, run count) are kept out of
+// automations.json and journalled to a small binary file, rewritten at most
+// once per scheduler pass. Each record remembers the JSON nextAt it was derived
+// from; if a user action rewrites nextAt in the JSON, the JSON value wins.
+static const char* AUTOMATIONS_STATE_FILE = "/automations.state";
+static const uint32_t kAutoStateMagic = 0x54534141;  // "AAST"
+static const uint16_t kAutoStateVersion = 1;
 
-        // Execute commands (with conditional logic support)
-        for (int ci = 0; ci < cmdsCount; ++ci) {
-          DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld run cmd[%d]='%s'", id, ci, cmdsList[ci].c_str());
-          
-          // Execute command with conditional logic support
-          String result = executeConditionalCommand(cmdsList[ci]);
-          if (result.startsWith("Error:")) {
-            DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld cmd[%d] error: %s", id, ci, result.c_str());
-          }
-        }
-        executed++;
+struct AutoStateHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+};
 
-        // Log scheduled automation end if logging is active
-        if (gAutoLogActive) {
-          String endMsg = "Scheduled automation completed: ID=" + String(id) + " Name=" + autoName + " Commands=" + String(cmdsCount);
-          appendAutoLogEntry("AUTO_END", endMsg);
-        }
+struct AutoStateRec {
+  int32_t id;
+  uint32_t seedNextAt;
+  uint32_t nextAt;
+  uint32_t lastRun;
+  uint32_t runCount;
+};
 
-        // Compute and update next run time
-        time_t newNextAt = computeNextRunTime(obj, now);
-        if (newNextAt > 0) {
-          updateAutomationNextAt(id, newNextAt);
-          DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld updated nextAt=%lu", id, (unsigned long)newNextAt);
-        } else {
-          DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld warning: could not compute next nextAt", id);
-        }
-      } else {
-        DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld skip: no commands found", id);
+static bool gAutoStateDirty = false;  // table runtime fields differ from the state file
+
+// Reads all state records into a ps_alloc'd array (caller frees); returns count or -1
+static int autoStateRead(AutoStateRec** out) {
+  *out = nullptr;
+  if (!filesystemReady) return -1;
+  File f = LittleFS.open(AUTOMATIONS_STATE_FILE, "r");
+  if (!f) return -1;
+  AutoStateHeader h;
+  if (f.read((uint8_t*)&h, sizeof(h)) != sizeof(h) || h.magic != kAutoStateMagic || h.version != kAutoStateVersion) {
+    f.close();
+    return -1;
+  }
+  if (h.count == 0) {
+    f.close();
+    return 0;
+  }
+  size_t bytes = (size_t)h.count * sizeof(AutoStateRec);
+  AutoStateRec* recs = (AutoStateRec*)ps_alloc(bytes, AllocPref::PreferPSRAM, "auto.state");
+  if (!recs) {
+    f.close();
+    return -1;
+  }
+  bool ok = f.read((uint8_t*)recs, bytes) == bytes;
+  f.close();
+  if (!ok) {
+    free(recs);
+    return -1;
+  }
+  *out = recs;
+  return h.count;
+}
+
+// Overlays the state file onto a freshly loaded table
+static void autoStateApply() {
+  AutoStateRec* recs = nullptr;
+  int n = autoStateRead(&recs);
+  if (n <= 0) {
+    if (recs) free(recs);
+    return;
+  }
+  int applied = 0, hint = 0;
+  for (int ai = 0; ai < gAutoTableCount; ++ai) {
+    AutoEntry& e = gAutoTable[ai];
+    // Records are written in table order, so start looking after the last match
+    for (int k = 0; k < n; ++k) {
+      const AutoStateRec& r = recs[(hint + k) % n];
+      if (r.id != (int32_t)e.id) continue;
+      hint = (hint + k + 1) % n;
+      e.lastRun = r.lastRun;
+      e.runCount = r.runCount;
+      if ((time_t)r.seedNextAt == e.seedNextAt) {
+        e.nextAt = (time_t)r.nextAt;
+        applied++;
       }
-    } else {
-      DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld wait: nextAt=%lu now=%lu", id, (unsigned long)nextAt, (unsigned long)now);
+      break;
     }
+  }
+  free(recs);
+  DEBUGF(DEBUG_AUTOMATIONS, "[autos] runtime state: records=%d applied=%d", n, applied);
+}
 
-    pos = braceEnd + 1;
+// Writes every entry's runtime fields in one pass (temp file + rename)
+static bool autoStateFlush() {
+  if (!gAutoStateDirty) return true;
+  if (!filesystemReady) return false;
+  const char* tmp = "/automations.state.tmp";
+  File f = LittleFS.open(tmp, "w");
+  if (!f) return false;
+  AutoStateHeader h = { kAutoStateMagic, kAutoStateVersion, (uint16_t)gAutoTableCount };
+  bool ok = f.write((const uint8_t*)&h, sizeof(h)) == sizeof(h);
+  for (int ai = 0; ok && ai < gAutoTableCount; ++ai) {
+    const AutoEntry& e = gAutoTable[ai];
+    AutoStateRec r = { (int32_t)e.id, (uint32_t)e.seedNextAt, (uint32_t)e.nextAt, e.lastRun, e.runCount };
+    ok = f.write((const uint8_t*)&r, sizeof(r)) == sizeof(r);
   }
+  f.close();
+  if (!ok) {
+    LittleFS.remove(tmp);
+    return false;
+  }
+  LittleFS.remove(AUTOMATIONS_STATE_FILE);
+  if (!LittleFS.rename(tmp, AUTOMATIONS_STATE_FILE)) return false;
+  gAutoStateDirty = false;
+  DEBUGF(DEBUG_AUTOMATIONS, "[autos] runtime state flushed: records=%d", gAutoTableCount);
+  return true;
+}
 
-  DEBUGF(DEBUG_AUTOMATIONS, "[autos] evaluated=%d executed=%d", evaluated, executed);
+// Drops all entries but keeps the buffers for the next load
+static void autoTableReset() {
+  gAutoTableCount = 0;
+  gAutoArenaLen = 0;
+  gAutoCmdCount = 0;
+  gAutoCmdRefCount = 0;
+}
+
+static bool autoTableLoad() {
+  // Clear the stale flag before reading so a concurrent write re-marks it
+  gAutoTableStale = false;
+  autoTableReset();
+  String json;
+  if (!readText("/automations.json", json)) return false;
+
+  int arrStart, arrEnd;
+  findAutomationsArrayBounds(json, arrStart, arrEnd);
+  if (arrStart < 0 || arrEnd <= arrStart) return true;  // empty table
+
+  // Count top-level objects to size the table once
+  int objs = 0;
+  for (int i = arrStart + 1; i < arrEnd;) {
+    if (json[i] == '{') {
+      objs++;
+      i = autoJsonSkipValue(json, i, arrEnd);
+    } else if (json[i] == '"') {
+      i = autoJsonSkipValue(json, i, arrEnd);
+    } else {
+      ++i;
+    }
+  }
+  if (!autoGrow((void**)&gAutoTable, gAutoTableCap, objs, sizeof(AutoEntry), "auto.table")) {
+    gAutoTableStale = true;
+    return false;
+  }
+
+  bool queueSanitize = false;
+  for (int i = arrStart + 1; i < arrEnd;) {
+    if (json[i] == '"') {
+      i = autoJsonSkipValue(json, i, arrEnd);
+      continue;
+    }
+    if (json[i] != '{') {
+      ++i;
+      continue;
+    }
+    int objStart = i;
+    i = autoJsonSkipValue(json, i, arrEnd);
+    AutoEntry& e = gAutoTable[gAutoTableCount];
+    if (!autoParseObject(json, objStart, i - 1, e, true)) continue;
+    e.seedNextAt = e.nextAt;
+    bool dup = false;
+    for (int k = 0; k < gAutoTableCount; ++k) {
+      if (gAutoTable[k].id == e.id) {
+        dup = true;
+        break;
+      }
+    }
+    if (dup) {
+      DEBUGF(DEBUG_AUTOMATIONS, "[autos] duplicate id detected at load id=%ld; skipping and queuing sanitize", e.id);
+      gAutoCmdRefCount = e.cmdFirst;  // drop its command refs
+      queueSanitize = true;
+      continue;
+    }
+    gAutoTableCount++;
+  }
+  DEBUGF(DEBUG_AUTOMATIONS, "[autos] table loaded: entries=%d uniqueCmds=%d arena=%lu json=%d",
+         gAutoTableCount, gAutoCmdCount, (unsigned long)gAutoArenaLen, json.length());
+  autoCompileConditions();
+  autoStateApply();
 
   // Handle duplicate sanitization
   static unsigned long s_lastAutoSanitizeMs = 0;
   if (queueSanitize) {
     unsigned long nowMs = millis();
     if (nowMs - s_lastAutoSanitizeMs > 5000UL) {
-      String fix;
-      if (readText("/automations.json", fix)) {
-        if (sanitizeAutomationsJson(fix)) {
-          writeAutomationsJsonAtomic(fix);
-          gAutosDirty = true;
-          DEBUGF(DEBUG_AUTOMATIONS, "[autos] Runtime sanitize applied after duplicate detection; scheduler refresh queued");
-        } else {
-          DEBUGF(DEBUG_AUTOMATIONS, "[autos] Runtime sanitize: no changes needed");
-        }
+      if (sanitizeAutomationsJson(json)) {
+        writeAutomationsJsonAtomic(json);
+        gAutosDirty = true;
+        DEBUGF(DEBUG_AUTOMATIONS, "[autos] Runtime sanitize applied after duplicate detection; scheduler refresh queued");
+      } else {
+        DEBUGF(DEBUG_AUTOMATIONS, "[autos] Runtime sanitize: no changes needed");
       }
       s_lastAutoSanitizeMs = nowMs;
     } else {
       DEBUGF(DEBUG_AUTOMATIONS, "[autos] Runtime sanitize skipped (debounced)");
     }
   }
+  return true;
+}
+
+// -------- Deadline heap scheduler --------
+// Enabled entries sit in a binary min-heap keyed on their epoch-ms deadline
+// (dueMs). The scheduler task peeks the root, runs whatever is due, re-inserts
+// it with its next deadline in O(log n) and then sleeps until the new root is
+// due. Mutations wake it early via autoSchedulerKick().
+static uint16_t* gAutoHeap = nullptr;  // indices into gAutoTable
+static int gAutoHeapCount = 0;
+static int gAutoHeapCap = 0;
+static TaskHandle_t gAutoSchedTaskHandle = nullptr;
+static const uint32_t kAutoSchedMaxSleepMs = 60000;   // re-check clock/file at least once a minute
+static const uint32_t kAutoCondRetryMs = 60000;       // condition not met: try again after this
+
+static inline int64_t autoNowEpochMs() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return (int64_t)tv.tv_sec * 1000LL + (int64_t)(tv.tv_usec / 1000);
+}
+
+static inline bool autoHeapLess(int a, int b) {
+  const AutoEntry& ea = gAutoTable[gAutoHeap[a]];
+  const AutoEntry& eb = gAutoTable[gAutoHeap[b]];
+  if (ea.dueMs != eb.dueMs) return ea.dueMs < eb.dueMs;
+  return ea.id < eb.id;
+}
+
+static inline void autoHeapSwap(int a, int b) {
+  uint16_t t = gAutoHeap[a];
+  gAutoHeap[a] = gAutoHeap[b];
+  gAutoHeap[b] = t;
+}
+
+static void autoHeapSiftUp(int pos) {
+  while (pos > 0) {
+    int parent = (pos - 1) / 2;
+    if (!autoHeapLess(pos, parent)) break;
+    autoHeapSwap(pos, parent);
+    pos = parent;
+  }
+}
+
+static void autoHeapSiftDown(int pos) {
+  for (;;) {
+    int l = pos * 2 + 1, r = l + 1, m = pos;
+    if (l < gAutoHeapCount && autoHeapLess(l, m)) m = l;
+    if (r < gAutoHeapCount && autoHeapLess(r, m)) m = r;
+    if (m == pos) return;
+    autoHeapSwap(pos, m);
+    pos = m;
+  }
+}
+
+static bool autoHeapPush(int tableIdx) {
+  if (!autoGrow((void**)&gAutoHeap, gAutoHeapCap, gAutoHeapCount + 1, sizeof(uint16_t), "auto.heap")) return false;
+  gAutoHeap[gAutoHeapCount] = (uint16_t)tableIdx;
+  autoHeapSiftUp(gAutoHeapCount++);
+  return true;
+}
+
+static int autoHeapPop() {
+  if (gAutoHeapCount == 0) return -1;
+  int top = gAutoHeap[0];
+  gAutoHeap[0] = gAutoHeap[--gAutoHeapCount];
+  if (gAutoHeapCount > 0) autoHeapSiftDown(0);
+  return top;
+}
+
+// Next deadline in epoch ms after fromMs; 0 if the entry cannot be scheduled
+static int64_t autoNextDueMs(const AutoEntry& e, int64_t fromMs) {
+  if (e.type == AUTO_TYPE_AFTERDELAY || e.type == AUTO_TYPE_INTERVAL) {
+    return e.periodMs ? fromMs + (int64_t)e.periodMs : 0;
+  }
+  time_t t = computeNextRunTimeEntry(e, (time_t)(fromMs / 1000));
+  return t > 0 ? (int64_t)t * 1000LL : 0;
+}
+
+// Persisted nextAt is whole seconds, rounded up so a reload never fires early
+static inline time_t autoDueToNextAt(int64_t dueMs) {
+  return (time_t)((dueMs + 999) / 1000);
+}
+
+static void autoHeapRebuild(int64_t nowMs) {
+  gAutoHeapCount = 0;
+  for (int ai = 0; ai < gAutoTableCount; ++ai) {
+    AutoEntry& e = gAutoTable[ai];
+    if (!e.enabled) {
+      DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld skip: disabled", e.id);
+      continue;
+    }
+    if (e.cmdCount == 0) {
+      DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld skip: no commands found", e.id);
+      continue;
+    }
+    if (e.nextAt > 0) {
+      e.dueMs = (int64_t)e.nextAt * 1000LL;
+    } else {
+      // If nextAt is missing or invalid, compute it now
+      e.dueMs = autoNextDueMs(e, nowMs);
+      if (e.dueMs <= 0) {
+        DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld skip: could not compute nextAt", e.id);
+        continue;
+      }
+      e.nextAt = autoDueToNextAt(e.dueMs);
+      gAutoStateDirty = true;
+      DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld computed missing nextAt=%lu", e.id, (unsigned long)e.nextAt);
+    }
+    if (!autoHeapPush(ai)) {
+      DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld skip: heap alloc failed", e.id);
+    }
+  }
+  DEBUGF(DEBUG_AUTOMATIONS, "[autos] heap rebuilt: scheduled=%d of %d", gAutoHeapCount, gAutoTableCount);
+}
+
+// Runs one due entry. Returns false if its simple condition gated it off.
+static bool autoRunEntry(const AutoEntry& e) {
+  long id = e.id;
+  String autoName = e.nameOff ? String(autoStr(e.nameOff)) : String("Unknown");
+
+  // Evaluate conditions if present
+  if (e.condKind == AUTO_COND_CHAIN) {
+    int branch = autoCondSelect(e);
+    String actionToExecute = branch >= 0 ? String(autoCondAction(e, branch)) : String("");
+    DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld conditional chain result: '%s'", id, actionToExecute.c_str());
+    if (actionToExecute.length() > 0) {
+      // Execute the specific action from the chain
+      String result = executeConditionalCommand(actionToExecute);
+      if (result.startsWith("Error:")) {
+        DEBUGF(DEBUG_AUTOMATIONS, "[autos] conditional chain error: %s", result.c_str());
+      }
+    }
+    return true;
+  }
+
+  if (e.condKind == AUTO_COND_SIMPLE) {
+    bool conditionMet = autoCondSelect(e) >= 0;
+    DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld condition='%s' result=%s", id, autoStr(e.condOff), conditionMet ? "TRUE" : "FALSE");
+    if (!conditionMet) {
+      if (gAutoLogActive) {
+        String skipMsg = "Scheduled automation skipped: ID=" + String(id) + " Name=" + autoName + " Condition not met: " + autoStr(e.condOff);
+        appendAutoLogEntry("AUTO_SKIP", skipMsg);
+      }
+      DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld skipped - condition not met: %s", id, autoStr(e.condOff));
+      return false;
+    }
+  }
+
+  // Log scheduled automation start if logging is active
+  if (gAutoLogActive) {
+    gAutoLogAutomationName = autoName;
+    String startMsg = "Scheduled automation started: ID=" + String(id) + " Name=" + autoName + " User=system";
+    appendAutoLogEntry("AUTO_START", startMsg);
+  }
+
+  // Execute commands (with conditional logic support)
+  for (int ci = 0; ci < e.cmdCount; ++ci) {
+    String cmd = autoEntryCmd(e, ci);
+    DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld run cmd[%d]='%s'", id, ci, cmd.c_str());
+    String result = executeConditionalCommand(cmd);
+    if (result.startsWith("Error:")) {
+      DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld cmd[%d] error: %s", id, ci, result.c_str());
+    }
+  }
+
+  // Log scheduled automation end if logging is active
+  if (gAutoLogActive) {
+    String endMsg = "Scheduled automation completed: ID=" + String(id) + " Name=" + autoName + " Commands=" + String(e.cmdCount);
+    appendAutoLogEntry("AUTO_END", endMsg);
+  }
+  return true;
+}
+
+// Runs every entry whose deadline has passed; returns ms until the next one
+static uint32_t autoSchedulerRunDue() {
+  // Only valid if time is synced
+  if (time(nullptr) <= 0) return kAutoSchedMaxSleepMs;
+
+  if (gAutoTableStale) {
+    autoStateFlush();  // keep progress made against the outgoing table
+    if (!autoTableLoad()) return kAutoSchedMaxSleepMs;
+    autoHeapRebuild(autoNowEpochMs());
+  }
+
+  int executed = 0;
+  int64_t nowMs = autoNowEpochMs();
+  while (gAutoHeapCount > 0) {
+    AutoEntry& e = gAutoTable[gAutoHeap[0]];
+    if (e.dueMs > nowMs) break;
+    autoHeapPop();
+    DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld due: late=%ldms", e.id, (long)(nowMs - e.dueMs));
+
+    bool ran = autoRunEntry(e);
+    int64_t afterMs = autoNowEpochMs();
+
+    if (!ran) {
+      // Re-evaluate later without moving the persisted nextAt
+      uint32_t retryMs = kAutoCondRetryMs;
+      if (e.type != AUTO_TYPE_ATTIME && e.periodMs && e.periodMs < retryMs) retryMs = e.periodMs;
+      e.dueMs = afterMs + retryMs;
+    } else {
+      executed++;
+      e.lastRun = (uint32_t)(afterMs / 1000);
+      e.runCount++;
+      gAutoStateDirty = true;
+      int64_t next;
+      if (e.type == AUTO_TYPE_ATTIME) {
+        next = autoNextDueMs(e, afterMs);
+      } else {
+        // Keep a fixed cadence; if we overran a whole period, restart from now
+        next = autoNextDueMs(e, e.dueMs);
+        if (next > 0 && next <= afterMs) next = autoNextDueMs(e, afterMs);
+      }
+      if (next <= 0) {
+        DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld warning: could not compute next nextAt", e.id);
+        continue;  // drops out of the heap until the next reload
+      }
+      e.dueMs = next;
+      e.nextAt = autoDueToNextAt(next);
+      DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld updated nextAt=%lu", e.id, (unsigned long)e.nextAt);
+    }
+
+    autoHeapPush((int)(&e - gAutoTable));
+    // A command edited automations.json: reload before touching the table again
+    if (gAutoTableStale) return 0;
+    nowMs = afterMs;
+  }
+
+  if (executed) DEBUGF(DEBUG_AUTOMATIONS, "[autos] executed=%d scheduled=%d", executed, gAutoHeapCount);
+  autoStateFlush();  // one write for everything that fired this pass
+  if (gAutoHeapCount == 0) return kAutoSchedMaxSleepMs;
+  int64_t waitMs = gAutoTable[gAutoHeap[0]].dueMs - autoNowEpochMs();
+  if (waitMs < 0) return 0;
+  return waitMs > (int64_t)kAutoSchedMaxSleepMs ? kAutoSchedMaxSleepMs : (uint32_t)waitMs;
+}
+
+static void autoSchedulerTask(void* arg) {
+  (void)arg;
+  for (;;) {
+    // Manual "automation run" in progress elsewhere: stay out of its way
+    uint32_t waitMs = gInAutomationContext ? 50 : autoSchedulerRunDue();
+    if (waitMs == 0) continue;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+  }
+}
+
+// Wakes the scheduler so it reloads/re-evaluates immediately (e.g. after mutations)
+static void autoSchedulerKick() {
+  if (gAutoSchedTaskHandle) xTaskNotifyGive(gAutoSchedTaskHandle);
 }
 
 // Forward declaration - implementation after LOG_* constants are defined
@@ -881,8 +1408,8 @@ static bool gInAutomationContext = false;
 // -------- Command Executor Task (decl) --------
 // Forward declaration of request struct (full definition after CommandContext)
 struct ExecReq;
-// Queue holding pointers to ExecReq
-static QueueHandle_t gCmdExecQ = nullptr;
+// Concurrency class of a command line (looked up in kCommands)
+static CmdClass commandClassOf(const String& line);
 // Forward declaration of task
 static void commandExecTask(void* pv);
 static bool executeCommand(AuthContext& ctx, const String& cmd, String& out);
@@ -916,22 +1443,206 @@ static String gSerialUser = String();
 static bool gEspNowInitialized = false;
 static uint8_t gEspNowChannel = 1;
 
-// ESP-NOW chunked message support
+// ESP-NOW chunked text results (RESULT_START/CHUNK/END from older firmware),
+// reassembled per (peer MAC, message hash) so concurrent peers don't collide
 #define MAX_CHUNKS 10
 #define CHUNK_SIZE 200
 
 struct ChunkedMessage {
-  String hash;
-  String status;
-  String deviceName;
-  int totalChunks;
-  int receivedChunks;
-  String chunks[MAX_CHUNKS];
+  uint8_t mac[6];
+  char hash[12];
+  char status[8];
+  uint8_t totalChunks;
+  uint8_t receivedChunks;
+  uint16_t chunkMask;              // bit i: chunk i+1 received
+  uint8_t chunkLen[MAX_CHUNKS];
+  uint8_t* data;                   // MAX_CHUNKS * CHUNK_SIZE bytes of gChunkedArena
   unsigned long startTime;
   bool active;
 };
 
-static ChunkedMessage gActiveMessage;
+static const uint8_t kChunkedSlots = 16;             // one per paired device
+static ChunkedMessage gChunked[kChunkedSlots];       // espnow_rx only
+static uint8_t* gChunkedArena = nullptr;             // allocated by initEspNow()
+static uint8_t gChunkedActive[kChunkedSlots];        // indices of active entries
+static uint8_t gChunkedActiveCount = 0;
+
+// ESP-NOW receive ring: the recv callback (WiFi driver task) only copies packets
+// in; the espnow_rx worker parses, authenticates, dispatches and logs them.
+// Single producer / single consumer, so head and tail need no lock.
+struct EspNowRxPacket {
+  uint8_t mac[6];
+  uint8_t len;
+  uint32_t rxMs;
+  uint8_t data[ESP_NOW_MAX_DATA_LEN];
+};
+static const uint32_t kEspNowRxSlots = 16;        // power of two
+static EspNowRxPacket* gEspNowRxRing = nullptr;   // allocated by initEspNow()
+static std::atomic<uint32_t> gEspNowRxHead{ 0 };  // advanced by the callback only
+static std::atomic<uint32_t> gEspNowRxTail{ 0 };  // advanced by the worker only
+static std::atomic<uint32_t> gEspNowRxDropped{ 0 };
+static uint32_t gEspNowRxProcessed = 0;
+static TaskHandle_t gEspNowRxTask = nullptr;
+
+// ESP-NOW framed transfers: binary frames carrying message id, sequence number and
+// CRC32, moved by a selective-ACK sliding window. The espnow_rx worker runs both
+// ends; sends are paced by send-callback credits instead of fixed delays. Frames
+// start with a non-ASCII magic byte so they never collide with text messages.
+#define ESPNOW_FRAME_MAGIC 0xA7
+enum EspNowFrameType : uint8_t { ESPNOW_FRAME_DATA = 1,
+                                 ESPNOW_FRAME_ACK = 2,
+                                 ESPNOW_FRAME_RST = 3,        // receiver refuses the message
+                                 ESPNOW_FRAME_TELEMETRY = 4 };  // unacknowledged sensor summary
+enum EspNowMsgKind : uint8_t { ESPNOW_MSG_RESULT = 1,
+                               ESPNOW_MSG_AUTH_HELLO = 2,      // session login: user + client nonce
+                               ESPNOW_MSG_AUTH_CHALLENGE = 3,  // server nonce + KDF parameters
+                               ESPNOW_MSG_AUTH_PROOF = 4,      // HMAC proof of the derived key
+                               ESPNOW_MSG_AUTH_OK = 5,         // session id, lifetime and server proof
+                               ESPNOW_MSG_COMMAND = 6 };       // session-tagged remote command
+static const uint8_t kEspNowFrameAckReq = 0x01;  // DATA: acknowledge now (last frame of a burst)
+static const uint8_t kEspNowFrameOk = 0x02;      // DATA: RESULT status is SUCCESS
+
+struct __attribute__((packed)) EspNowFrameHdr {
+  uint8_t magic;
+  uint8_t type;
+  uint8_t kind;
+  uint8_t flags;
+  uint16_t msgId;
+  uint16_t seq;    // DATA: frame index; ACK: cumulative base (every frame below it arrived)
+  uint16_t count;  // DATA: frames in the message; ACK: unused
+  uint32_t crc;    // CRC32 over header (crc = 0) and payload
+};
+static const size_t kEspNowFramePayload = ESP_NOW_MAX_DATA_LEN - sizeof(EspNowFrameHdr);
+static const uint32_t kEspNowMaxMessageBytes = 64 * 1024;
+static const uint16_t kEspNowTxWindow = 16;        // frames in flight per transfer (<= 32)
+static const uint8_t kEspNowTxCredits = 2;         // data frames queued in the driver at once
+static const uint32_t kEspNowTxRtoMs = 80;         // retransmit timeout, doubled per retry
+static const uint32_t kEspNowTxRtoMaxMs = 1280;
+static const uint8_t kEspNowTxMaxRetries = 6;
+static const uint32_t kEspNowRxXferTimeoutMs = 5000;
+static const uint32_t kEspNowRxXferLingerMs = 3000;  // delivered messages keep re-ACKing duplicates
+
+struct EspNowTxXfer {
+  bool active;
+  uint8_t mac[6];
+  uint16_t msgId;
+  uint8_t kind;
+  uint8_t flags;
+  uint8_t* buf;
+  uint32_t len;
+  uint16_t count;
+  uint16_t base;      // first unacknowledged frame
+  uint32_t ackMask;   // bit i: frame base+i acknowledged (selectively)
+  uint32_t sentMask;  // bit i: frame base+i sent and not presumed lost
+  uint16_t fastMark;  // holes below this were already fast-retransmitted
+  uint8_t retries;
+  uint8_t macFails;   // consecutive send callbacks reporting failure
+  uint32_t rtoMs;
+  uint32_t rtoAtMs;   // 0 = no timer
+  uint32_t startMs;
+};
+
+struct EspNowRxXfer {
+  bool active;
+  uint8_t mac[6];
+  uint16_t msgId;
+  uint8_t kind;
+  uint8_t flags;
+  uint16_t count;
+  uint16_t base;      // first missing frame
+  uint16_t got;
+  uint8_t sinceAck;
+  uint32_t* have;     // received-frame bitmap, one bit per frame
+  uint8_t* buf;
+  uint32_t len;
+  uint32_t lastMs;
+};
+
+// Recently delivered messages, so late duplicates are re-ACKed instead of
+// starting a second copy
+struct EspNowRxDoneRec {
+  uint8_t mac[6];
+  uint16_t msgId;
+  uint16_t count;
+  uint32_t ms;
+};
+
+// Frames handed to esp_now_send(), oldest first; matched against send callbacks
+struct EspNowTxInflight {
+  uint8_t mac[6];
+  uint8_t slot;  // tx transfer slot, kEspNowInflightCtl for ACK/RST, kEspNowInflightPlain for text sends
+  uint16_t msgId;
+  uint16_t seq;
+  uint32_t sentMs;
+};
+
+// Send-callback completions (WiFi driver task -> espnow_rx), single producer / single consumer
+struct EspNowTxDone {
+  uint8_t mac[6];
+  uint8_t ok;
+};
+
+static const uint8_t kEspNowTxXfers = 8;
+static const uint8_t kEspNowRxXfers = 16;
+static const uint8_t kEspNowRxDoneRecs = 32;
+static const uint8_t kEspNowTxInflightSlots = 16;
+static const uint8_t kEspNowInflightCtl = 0xFF;
+static const uint8_t kEspNowInflightPlain = 0xFE;
+static const uint32_t kEspNowTxDoneSlots = 32;  // power of two
+static EspNowTxXfer gEspNowTx[kEspNowTxXfers];  // guarded by gEspNowTxMutex
+static EspNowRxXfer gEspNowRxX[kEspNowRxXfers]; // espnow_rx only
+static EspNowRxDoneRec gEspNowRxDoneRecs[kEspNowRxDoneRecs];  // espnow_rx only, ring
+static uint8_t gEspNowRxDoneNext = 0;
+static SemaphoreHandle_t gEspNowTxMutex = nullptr;
+static SemaphoreHandle_t gEspNowSendMutex = nullptr;  // esp_now_send + its in-flight record, so records keep callback order
+static uint16_t gEspNowNextMsgId = 0;
+static uint8_t gEspNowTxRr = 0;
+static EspNowTxInflight gEspNowTxInflight[kEspNowTxInflightSlots];  // guarded by gEspNowSendMutex
+static uint8_t gEspNowTxInflightN = 0;
+static uint8_t gEspNowTxCreditsUsed = 0;
+static EspNowTxDone gEspNowTxDone[kEspNowTxDoneSlots];
+static std::atomic<uint32_t> gEspNowTxDoneHead{ 0 };
+static std::atomic<uint32_t> gEspNowTxDoneTail{ 0 };
+struct EspNowFrameStats {
+  uint32_t txFrames, txRetx, txDone, txFailed;
+  uint32_t rxFrames, rxBad, rxDup, rxDone;
+};
+static EspNowFrameStats gEspNowFrameStats = {};
+
+// Sensor telemetry: nodes stream a compact summary to a collector (setting
+// espnowTelemetryPeer) as single unacknowledged frames. The collector keeps the
+// latest summary per peer under the sensor cache mutex for /api/sensors and
+// automation conditions ("IF peer:<name>.TEMP > 30"). Frames carry only a CRC,
+// so they are accepted only from peers paired with "espnow pairsecure", whose
+// link the radio encrypts; anything else could spoof a paired MAC.
+static const uint8_t kTelemThermal = 0x01;
+static const uint8_t kTelemToF = 0x02;
+static const uint8_t kTelemImu = 0x04;
+struct __attribute__((packed)) EspNowTelemetry {
+  uint8_t valid;                        // kTelem* bits
+  int16_t thermMin, thermMax, thermAvg; // 0.01 C
+  uint8_t hotX, hotY;                   // hottest pixel of the 32x24 frame, 0xFF = none
+  uint8_t tofCount;
+  uint16_t tofMm[4];
+  int16_t yaw, pitch, roll;             // 0.01 degree
+};
+struct EspNowPeerTelemetry {
+  bool used;
+  uint8_t mac[6];
+  uint32_t nameHash;  // cmdHashName() of the paired device name, 0 = unnamed
+  uint16_t seq;
+  uint32_t rxMs;
+  uint32_t received;
+  uint32_t lost;      // gaps in the sender's sequence numbers
+  EspNowTelemetry t;
+};
+static const uint8_t kEspNowTelemPeers = 16;
+static const uint32_t kEspNowTelemStaleMs = 10000;  // older summaries don't satisfy conditions
+static EspNowPeerTelemetry gEspNowPeerTelem[kEspNowTelemPeers];
+static uint32_t gEspNowTelemRejected = 0;  // frames from unpaired or unencrypted peers (espnow_rx only)
+static uint16_t gEspNowTelemSeq = 0;
+static uint32_t gEspNowTelemNextMs = 0;
+static uint32_t gEspNowTelemSent = 0;
 
 // ESP-NOW encryption support
 static String gEspNowPassphrase = "";
@@ -948,6 +1659,109 @@ struct EspNowDevice {
 static EspNowDevice gEspNowDevices[16]; // Support up to 16 paired devices
 static int gEspNowDeviceCount = 0;
 
+// espnow exec-all: one fan-out at a time. Replies carry no request id, so rows
+// are matched by sender MAC; the first RESULT from a peer completes its row.
+enum EspNowFanoutState : uint8_t { FANOUT_PENDING = 0,
+                                   FANOUT_OK,
+                                   FANOUT_FAILED,
+                                   FANOUT_SEND_ERROR };
+struct EspNowFanoutRow {
+  uint8_t mac[6];
+  uint8_t state;     // EspNowFanoutState
+  uint32_t ms;       // reply latency from the start of the fan-out
+  uint32_t lines;    // lines in the full reply
+  String name;
+  String firstLine;  // the table shows one (truncated) line per peer
+};
+struct EspNowFanout {
+  bool active;
+  uint8_t rows;
+  uint8_t pending;
+  uint32_t startMs;
+  EspNowFanoutRow row[16];
+};
+static EspNowFanout gEspNowFanout;                     // guarded by gEspNowFanoutMutex
+static SemaphoreHandle_t gEspNowFanoutMutex = nullptr;
+static SemaphoreHandle_t gEspNowFanoutDone = nullptr;  // given when pending reaches 0
+static const uint32_t kEspNowFanoutDefaultMs = 3000;
+
+// ESP-NOW command sessions: "espnow login" answers a challenge with a SCRAM-style
+// proof, ClientKey xor HMAC(StoredKey, nonces + user), so the password never
+// leaves the node and the receiver checks it against the stored SCRAM$ key
+// without running the KDF. ClientKey is not stored, so a copy of users.json is
+// not enough to log in. Both ends then derive a session key from ClientKey;
+// commands carry a counter and a truncated HMAC-SHA256 tag over it, checked in
+// O(1) on the receiving side.
+static const uint8_t kEspNowNonceBytes = 16;
+static const uint8_t kEspNowTagBytes = 16;
+static const uint8_t kEspNowSessionSlots = 16;
+static const uint8_t kEspNowPendingSlots = 4;  // logins between HELLO and proof
+static const uint32_t kEspNowSessionTtlMs = 15UL * 60UL * 1000UL;
+static const uint32_t kEspNowHandshakeMs = 5000;  // per step of the login exchange
+static const uint32_t kEspNowDecoyIterations = 10000;  // challenge for unknown users; the settings default
+struct __attribute__((packed)) EspNowAuthHello {
+  uint8_t nonceA[kEspNowNonceBytes];
+  char user[32];  // NUL padded
+};
+struct __attribute__((packed)) EspNowAuthChallenge {
+  uint8_t nonceA[kEspNowNonceBytes];
+  uint8_t nonceB[kEspNowNonceBytes];
+  uint32_t iterations;
+  uint8_t salt[16];
+};
+struct __attribute__((packed)) EspNowAuthProof {
+  uint8_t nonceB[kEspNowNonceBytes];
+  uint8_t proof[32];
+};
+struct __attribute__((packed)) EspNowAuthOk {
+  uint8_t nonceB[kEspNowNonceBytes];
+  uint32_t sessionId;  // 0 = login rejected
+  uint32_t ttlMs;
+  uint8_t tag[kEspNowTagBytes];
+};
+struct __attribute__((packed)) EspNowCmdHdr {
+  uint32_t sessionId;
+  uint32_t ctr;  // increasing per session; each value is accepted once
+  uint8_t tag[kEspNowTagBytes];
+};  // command text follows
+enum EspNowSessionState : uint8_t { SESSION_FREE = 0,
+                                    SESSION_CHALLENGED,  // inbound, gEspNowSessPending only: waiting for the proof
+                                    SESSION_ESTABLISHED };
+struct EspNowSession {
+  uint8_t state;  // EspNowSessionState
+  uint8_t mac[6];
+  char user[32];
+  uint8_t nonceA[kEspNowNonceBytes];
+  uint8_t nonceB[kEspNowNonceBytes];
+  uint8_t key[32];  // StoredKey while challenged, then the session key
+  uint32_t sessionId;
+  uint32_t ctr;     // outbound: last sent; inbound: highest accepted
+  uint32_t seen;    // inbound: bit i set = ctr - i accepted (transfers may finish out of order)
+  uint32_t expiresMs;
+};
+static EspNowSession gEspNowSessIn[kEspNowSessionSlots];   // peers that may command us; espnow_rx only
+// Challenges awaiting a proof, kept apart so an unauthenticated HELLO never
+// replaces an established session; espnow_rx only
+static EspNowSession gEspNowSessPending[kEspNowPendingSlots];
+static EspNowSession gEspNowSessOut[kEspNowSessionSlots];  // peers we may command; guarded by gEspNowSessMutex
+static SemaphoreHandle_t gEspNowSessMutex = nullptr;
+// Per-device secret (NVS "espnow"/"decoy") that salts challenges for unknown
+// users, so repeated HELLOs can't tell them from real accounts
+static uint8_t gEspNowDecoySecret[32];
+static bool gEspNowDecoyReady = false;
+// The one login in progress; replies are copied in by espnow_rx
+struct EspNowLogin {
+  bool active;
+  bool got;
+  uint8_t stage;  // ESPNOW_MSG_AUTH_CHALLENGE or ESPNOW_MSG_AUTH_OK awaited
+  uint8_t mac[6];
+  uint8_t nonceA[kEspNowNonceBytes];
+  EspNowAuthChallenge challenge;
+  EspNowAuthOk ok;
+};
+static EspNowLogin gEspNowLogin;                        // guarded by gEspNowSessMutex
+static SemaphoreHandle_t gEspNowLoginSignal = nullptr;  // given when the awaited reply lands
+
 // ---------------------------------------------------------------------------
 // Transport-agnostic auth context and guards (HTTP + Serial today; TFT later)
 // ---------------------------------------------------------------------------
@@ -1122,6 +1936,225 @@ static const char* USERS_JSON_FILE = "/users.json";              // preferred: {
 static const char* AUTOMATIONS_JSON_FILE = "/automations.json";  // {"version":1,"automations":[]}
 static const char* ESPNOW_DEVICES_FILE = "/espnow_devices.json"; // ESP-NOW paired devices
 
+// -------- In-RAM user directory --------
+// users.json (or legacy users.txt) is parsed once into compact entries with an
+// open-addressing index keyed by username, so login and admin checks never
+// re-read or re-scan the file. Names and stored credentials live in one arena
+// referenced by offset. Every users file mutation sets gUserDirStale and the
+// next lookup reloads under gUserDirMutex.
+enum UserRoleBits : uint8_t {
+  USER_ROLE_ADMIN = 0x01  // role "admin", or the legacy first-user fallback
+};
+
+struct UserDirEntry {
+  uint32_t nameHash;  // FNV-1a of the username
+  uint32_t nameOff;   // arena offsets; 0 = empty string
+  uint32_t credOff;   // stored password field ("HASH:..." or legacy plaintext)
+  uint8_t roles;      // UserRoleBits
+};
+
+static UserDirEntry* gUserDir = nullptr;
+static int gUserDirCount = 0;
+static int gUserDirCap = 0;
+static char* gUserDirArena = nullptr;  // NUL-separated strings; offset 0 is ""
+static uint32_t gUserDirArenaLen = 0;
+static uint32_t gUserDirArenaCap = 0;
+static int16_t* gUserDirIndex = nullptr;  // slots into gUserDir; -1 = empty
+static int gUserDirIndexCap = 0;          // power of two, at least twice the entry count
+static volatile bool gUserDirStale = true;  // set by any users file mutation
+static SemaphoreHandle_t gUserDirMutex = nullptr;
+
+static inline const char* userDirStr(uint32_t off) {
+  return (gUserDirArena && off < gUserDirArenaLen) ? (gUserDirArena + off) : "";
+}
+
+static uint32_t userDirHash(const char* s, size_t n) {
+  uint32_t h = 2166136261UL;
+  for (size_t i = 0; i < n; ++i) {
+    h ^= (uint8_t)s[i];
+    h *= 16777619UL;
+  }
+  return h;
+}
+
+// The arena is sized from the source file up front (every string is a
+// substring of it), so appends never reallocate during a load
+static uint32_t userDirArenaAppend(const String& s) {
+  size_t n = s.length();
+  if (n == 0) return 0;
+  uint32_t base = gUserDirArenaLen ? gUserDirArenaLen : 1;  // offset 0 is reserved for ""
+  if (base + n + 1 > gUserDirArenaCap) return 0;
+  gUserDirArena[0] = '\0';
+  memcpy(gUserDirArena + base, s.c_str(), n);
+  gUserDirArena[base + n] = '\0';
+  gUserDirArenaLen = base + (uint32_t)n + 1;
+  return base;
+}
+
+static int userDirFind(const char* name, size_t n) {
+  if (!gUserDirIndex || gUserDirCount == 0) return -1;
+  uint32_t h = userDirHash(name, n);
+  uint32_t mask = (uint32_t)gUserDirIndexCap - 1;
+  for (uint32_t i = h & mask, probes = 0; probes < (uint32_t)gUserDirIndexCap; i = (i + 1) & mask, ++probes) {
+    int16_t slot = gUserDirIndex[i];
+    if (slot < 0) return -1;
+    const UserDirEntry& e = gUserDir[slot];
+    if (e.nameHash == h && strcmp(userDirStr(e.nameOff), name) == 0) return slot;
+  }
+  return -1;
+}
+
+// Adds a user; a repeated username keeps its first credential and merges roles
+static bool userDirAdd(const String& name, const String& cred, uint8_t roles) {
+  if (name.length() == 0) return true;
+  int dup = userDirFind(name.c_str(), name.length());
+  if (dup >= 0) {
+    gUserDir[dup].roles |= roles;
+    return true;
+  }
+  if (!autoGrow((void**)&gUserDir, gUserDirCap, gUserDirCount + 1, sizeof(UserDirEntry), "users.dir")) return false;
+  int need = 16;
+  while (need < (gUserDirCount + 1) * 2) need *= 2;
+  if (need > gUserDirIndexCap) {
+    int16_t* p = (int16_t*)ps_realloc(gUserDirIndex, (size_t)need * sizeof(int16_t), AllocPref::PreferPSRAM, "users.idx");
+    if (!p) return false;
+    gUserDirIndex = p;
+    gUserDirIndexCap = need;
+    // Re-seat existing entries in the larger table
+    memset(gUserDirIndex, 0xFF, (size_t)need * sizeof(int16_t));
+    for (int k = 0; k < gUserDirCount; ++k) {
+      uint32_t i = gUserDir[k].nameHash & (uint32_t)(need - 1);
+      while (gUserDirIndex[i] >= 0) i = (i + 1) & (uint32_t)(need - 1);
+      gUserDirIndex[i] = (int16_t)k;
+    }
+  }
+  UserDirEntry& e = gUserDir[gUserDirCount];
+  e.nameHash = userDirHash(name.c_str(), name.length());
+  e.nameOff = userDirArenaAppend(name);
+  e.credOff = userDirArenaAppend(cred);
+  e.roles = roles;
+  uint32_t mask = (uint32_t)gUserDirIndexCap - 1;
+  uint32_t i = e.nameHash & mask;
+  while (gUserDirIndex[i] >= 0) i = (i + 1) & mask;
+  gUserDirIndex[i] = (int16_t)gUserDirCount;
+  gUserDirCount++;
+  return true;
+}
+
+// Parses the users file into the directory. Caller holds gUserDirMutex.
+static bool userDirLoad() {
+  // Clear the stale flag before reading so a concurrent write re-marks it
+  gUserDirStale = false;
+  gUserDirCount = 0;
+  gUserDirArenaLen = 0;
+  if (gUserDirIndex) memset(gUserDirIndex, 0xFF, (size_t)gUserDirIndexCap * sizeof(int16_t));
+
+  bool isJson = LittleFS.exists(USERS_JSON_FILE);
+  if (!isJson && !LittleFS.exists(USERS_FILE)) return true;  // no users yet
+  String txt;
+  if (!readText(isJson ? USERS_JSON_FILE : USERS_FILE, txt)) {
+    gUserDirStale = true;
+    return false;
+  }
+  uint32_t arenaNeed = (uint32_t)txt.length() + 2;
+  if (arenaNeed > gUserDirArenaCap) {
+    char* p = (char*)ps_realloc(gUserDirArena, arenaNeed, AllocPref::PreferPSRAM, "users.arena");
+    if (!p) {
+      gUserDirStale = true;
+      return false;
+    }
+    gUserDirArena = p;
+    gUserDirArenaCap = arenaNeed;
+  }
+
+  bool ok = true;
+  if (isJson) {
+    int pos = txt.indexOf("\"users\"");
+    bool first = true;
+    while (ok && pos >= 0) {
+      int uKey = txt.indexOf("\"username\"", pos);
+      if (uKey < 0) break;
+      int uq1 = txt.indexOf('"', txt.indexOf(':', uKey) + 1);
+      int uq2 = txt.indexOf('"', uq1 + 1);
+      if (uq1 < 0 || uq2 <= uq1) break;
+      int nextU = txt.indexOf("\"username\"", uKey + 1);
+      String pass, role;
+      int pKey = txt.indexOf("\"password\"", uKey);
+      if (pKey > 0 && (nextU < 0 || pKey < nextU)) {
+        int pq1 = txt.indexOf('"', txt.indexOf(':', pKey) + 1);
+        int pq2 = txt.indexOf('"', pq1 + 1);
+        if (pq1 > 0 && pq2 > pq1) pass = txt.substring(pq1 + 1, pq2);
+      }
+      int rKey = txt.indexOf("\"role\"", uKey);
+      if (rKey > 0 && (nextU < 0 || rKey < nextU)) {
+        int rq1 = txt.indexOf('"', txt.indexOf(':', rKey) + 1);
+        int rq2 = txt.indexOf('"', rq1 + 1);
+        if (rq1 > 0 && rq2 > rq1) role = txt.substring(rq1 + 1, rq2);
+      }
+      // Fallback kept from the file-scanning checks: the first user is admin
+      uint8_t roles = (role == "admin" || first) ? USER_ROLE_ADMIN : 0;
+      ok = userDirAdd(txt.substring(uq1 + 1, uq2), pass, roles);
+      first = false;
+      pos = uq2 + 1;
+    }
+  } else {
+    // Legacy users.txt: username:password[:role]; a role-less first user is admin
+    int pos = 0;
+    bool first = true;
+    while (ok && pos < (int)txt.length()) {
+      int eol = txt.indexOf('\n', pos);
+      if (eol < 0) eol = txt.length();
+      String line = txt.substring(pos, eol);
+      pos = eol + 1;
+      line.trim();
+      if (line.length() == 0 || line[0] == '#') continue;
+      int c1 = line.indexOf(':');
+      if (c1 <= 0) continue;
+      int c2 = line.indexOf(':', c1 + 1);
+      String lu = line.substring(0, c1);
+      lu.trim();
+      String lp = (c2 >= 0) ? line.substring(c1 + 1, c2) : line.substring(c1 + 1);
+      lp.trim();
+      String role = (c2 >= 0) ? line.substring(c2 + 1) : String("");
+      role.trim();
+      uint8_t roles = (role == "admin" || (first && role.length() == 0)) ? USER_ROLE_ADMIN : 0;
+      ok = userDirAdd(lu, lp, roles);
+      first = false;
+    }
+  }
+  if (!ok) {
+    gUserDirCount = 0;
+    gUserDirStale = true;
+    return false;
+  }
+  DEBUG_USERSF("[users] directory loaded: users=%d arena=%lu file=%d",
+                gUserDirCount, (unsigned long)gUserDirArenaLen, txt.length());
+  return true;
+}
+
+// Takes gUserDirMutex and reloads the directory if the users file changed
+static bool userDirAcquire() {
+  if (!gUserDirMutex || xSemaphoreTake(gUserDirMutex, portMAX_DELAY) != pdTRUE) return false;
+  if (gUserDirStale && !userDirLoad()) {
+    xSemaphoreGive(gUserDirMutex);
+    return false;
+  }
+  return true;
+}
+
+static void userDirRelease() {
+  xSemaphoreGive(gUserDirMutex);
+}
+
+// All users.json writes go through here so a lookup never caches a half-written file
+static bool writeUsersJson(const String& json) {
+  bool locked = gUserDirMutex && xSemaphoreTake(gUserDirMutex, portMAX_DELAY) == pdTRUE;
+  bool ok = writeText(USERS_JSON_FILE, json);
+  gUserDirStale = true;
+  if (locked) xSemaphoreGive(gUserDirMutex);
+  return ok;
+}
+
 // SSE helpers
 // ==========================
 
@@ -1175,10 +2208,13 @@ bool thermalEnabled = false;
 // Centralize Wire1 clock policy: 100kHz default, temporarily override for specific operations
 static uint32_t gWire1DefaultHz = 100000;  // safe default for mixed sensors
 static uint32_t gWire1CurrentHz = 0;
+static volatile uint8_t gI2CBusHolder = 0xFF;  // I2CBusDevice holding a bus lease, 0xFF = none
+static void i2cPerfNoteClockSwitch();           // bus-time accounting, with the bus owner below
 static inline void i2cSetWire1Clock(uint32_t hz) {
   if (gWire1CurrentHz != hz) {
     Wire1.setClock(hz);
     gWire1CurrentHz = hz;
+    i2cPerfNoteClockSwitch();
     DEBUG_CLIF("[I2C] Wire1 clock -> %lu Hz", (unsigned long)hz);
   }
 }
@@ -1234,6 +2270,8 @@ struct Wire1ClockScope {
   }
   ~Wire1ClockScope() {
     i2cClockStackPop();
+    // Under a bus lease the i2c_bus owner decides the clock between transactions
+    if (gI2CClockStackDepth == 0 && gI2CBusHolder != 0xFF) return;
     uint32_t restore = i2cClockStackTopOrDefault();
     // Only log when actually changing clock speed
     if (restore != gWire1CurrentHz) {
@@ -1367,6 +2405,321 @@ TaskHandle_t imuTaskHandle = nullptr;
 TaskHandle_t thermalTaskHandle = nullptr;
 SemaphoreHandle_t i2cMutex = nullptr;
 
+// ---- I2C bus owner (Wire1) ----
+// The sensor tasks don't race for i2cMutex with timeouts (carrying on when the
+// take failed); each asks the i2c_bus task for a lease with a priority, the
+// clock it needs and a deadline. The owner holds i2cMutex for the lease, so CLI
+// paths that take the gate directly still serialize with it, and picks the next
+// holder: overdue leases first, then priority, running a lease that needs the
+// current clock ahead of a higher-priority one when it fits before that one's
+// deadline. The transaction itself runs on the sensor task's stack (the
+// MLX90640 frame path needs the thermal task's 32 KB).
+enum I2CBusDevice : uint8_t { I2C_DEV_THERMAL = 0,
+                              I2C_DEV_TOF,
+                              I2C_DEV_IMU,
+                              I2C_DEV_COUNT,
+                              I2C_DEV_NONE = 0xFF };
+static const char* const kI2CBusDevNames[I2C_DEV_COUNT] = { "thermal", "tof", "imu" };
+static const uint8_t kI2CPrioInit = 0;
+static const uint8_t kI2CPrioToF = 1;
+static const uint8_t kI2CPrioImu = 2;
+static const uint8_t kI2CPrioThermal = 3;
+struct I2CBusReq {
+  bool pending;
+  uint8_t priority;
+  uint32_t clockHz;         // 0 = whatever the bus runs at
+  uint32_t deadlineMs;
+  uint32_t requestUs;
+  SemaphoreHandle_t grant;  // given by i2c_bus when this device holds the bus
+};
+struct I2CBusDevStats {
+  uint32_t leases;
+  uint32_t late;        // released after the deadline
+  uint64_t busyUs;
+  uint64_t waitUs;
+  uint32_t maxWaitUs;
+  uint32_t avgBusyUs;   // EWMA; decides whether a same-clock lease fits first
+};
+static I2CBusReq gI2CBusReq[I2C_DEV_COUNT];
+static I2CBusDevStats gI2CBusStats[I2C_DEV_COUNT];  // guarded by gI2CBusMux
+static uint32_t gI2CBusSwitches = 0;
+static uint32_t gI2CBusStatsSinceMs = 0;
+static uint32_t gI2CBusGrantUs = 0;
+static TaskHandle_t gI2CBusTask = nullptr;
+static portMUX_TYPE gI2CBusMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ---- I2C bus-time accounting ----
+// Per device: wait for the bus, hold time, transactions, errors and the clock
+// switches made while it had the bus, recorded at the lease and gate sites.
+// Relaxed atomics only, so recording never blocks the transactions it times;
+// readers copy the counters without stopping the bus.
+// Four linear sub-buckets per power of two (<= 25% error): [0] [1] [2] [3] [4] [5] [6] [7]
+// [8-9] [10-11] ... up to ~2 s, the last bucket collecting the rest
+static const int kI2CPerfBuckets = 80;
+struct I2CPerfHist {
+  std::atomic<uint32_t> bucket[kI2CPerfBuckets];
+  std::atomic<uint32_t> maxUs;
+};
+struct I2CPerfDev {
+  std::atomic<uint32_t> tx;
+  std::atomic<uint32_t> errors;
+  std::atomic<uint32_t> switches;
+  I2CPerfHist wait;
+  I2CPerfHist hold;
+};
+struct I2CPerfSnap {
+  uint32_t tx, errors, switches;
+  uint32_t waitN, waitMaxUs, wait[kI2CPerfBuckets];
+  uint32_t holdN, holdMaxUs, hold[kI2CPerfBuckets];
+};
+static I2CPerfDev gI2CPerf[I2C_DEV_COUNT];
+static uint8_t gI2CPerfAddr[I2C_DEV_COUNT] = { MLX90640_I2CADDR_DEFAULT, VL53L4CX_DEFAULT_DEVICE_ADDRESS, BNO055_ADDRESS_A };
+static uint32_t gI2CPerfHoldSinceUs[I2C_DEV_COUNT];
+static volatile uint8_t gI2CPerfActive = I2C_DEV_NONE;  // charged for clock switches
+static uint32_t gI2CPerfSinceMs = 0;
+
+static int i2cPerfBucket(uint32_t us) {
+  if (us < 4) return (int)us;
+  int octave = 31 - __builtin_clz(us);
+  int b = 4 + (octave - 2) * 4 + (int)((us >> (octave - 2)) & 3);
+  return (b < kI2CPerfBuckets) ? b : kI2CPerfBuckets - 1;
+}
+
+static uint32_t i2cPerfBucketMaxUs(int b) {
+  if (b < 4) return (uint32_t)b;
+  int octave = (b - 4) / 4 + 2;
+  return ((uint32_t)(5 + (b - 4) % 4) << (octave - 2)) - 1;
+}
+
+static void i2cPerfHistAdd(I2CPerfHist& h, uint32_t us) {
+  h.bucket[i2cPerfBucket(us)].fetch_add(1, std::memory_order_relaxed);
+  uint32_t prev = h.maxUs.load(std::memory_order_relaxed);
+  while (us > prev && !h.maxUs.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {}
+}
+
+// dev now has the bus after waiting waitUs
+static void i2cPerfBegin(uint8_t dev, uint32_t waitUs) {
+  i2cPerfHistAdd(gI2CPerf[dev].wait, waitUs);
+  gI2CPerfHoldSinceUs[dev] = micros();
+  gI2CPerfActive = dev;
+}
+
+static void i2cPerfEnd(uint8_t dev, bool ok) {
+  I2CPerfDev& p = gI2CPerf[dev];
+  i2cPerfHistAdd(p.hold, micros() - gI2CPerfHoldSinceUs[dev]);
+  p.tx.fetch_add(1, std::memory_order_relaxed);
+  if (!ok) p.errors.fetch_add(1, std::memory_order_relaxed);
+  gI2CPerfActive = I2C_DEV_NONE;
+}
+
+static void i2cPerfNoteClockSwitch() {
+  uint8_t dev = gI2CPerfActive;
+  if (dev < I2C_DEV_COUNT) gI2CPerf[dev].switches.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void i2cPerfSnapshot(uint8_t dev, I2CPerfSnap& s) {
+  const I2CPerfDev& p = gI2CPerf[dev];
+  s.tx = p.tx.load(std::memory_order_relaxed);
+  s.errors = p.errors.load(std::memory_order_relaxed);
+  s.switches = p.switches.load(std::memory_order_relaxed);
+  s.waitN = s.holdN = 0;
+  for (int b = 0; b < kI2CPerfBuckets; ++b) {
+    s.wait[b] = p.wait.bucket[b].load(std::memory_order_relaxed);
+    s.hold[b] = p.hold.bucket[b].load(std::memory_order_relaxed);
+    s.waitN += s.wait[b];
+    s.holdN += s.hold[b];
+  }
+  s.waitMaxUs = p.wait.maxUs.load(std::memory_order_relaxed);
+  s.holdMaxUs = p.hold.maxUs.load(std::memory_order_relaxed);
+}
+
+// Upper bound (us) of the bucket holding the requested percentile, capped at the max seen
+static uint32_t i2cPerfPercentile(const uint32_t* hist, uint32_t total, uint32_t maxUs, uint32_t pct) {
+  if (total == 0) return 0;
+  uint32_t want = (uint32_t)(((uint64_t)total * pct + 99) / 100);
+  uint32_t seen = 0;
+  for (int b = 0; b < kI2CPerfBuckets - 1; ++b) {
+    seen += hist[b];
+    if (seen >= want) return min(i2cPerfBucketMaxUs(b), maxUs);
+  }
+  return maxUs;
+}
+
+static void i2cPerfReset() {
+  for (uint8_t d = 0; d < I2C_DEV_COUNT; ++d) {
+    I2CPerfDev& p = gI2CPerf[d];
+    p.tx.store(0, std::memory_order_relaxed);
+    p.errors.store(0, std::memory_order_relaxed);
+    p.switches.store(0, std::memory_order_relaxed);
+    for (int b = 0; b < kI2CPerfBuckets; ++b) {
+      p.wait.bucket[b].store(0, std::memory_order_relaxed);
+      p.hold.bucket[b].store(0, std::memory_order_relaxed);
+    }
+    p.wait.maxUs.store(0, std::memory_order_relaxed);
+    p.hold.maxUs.store(0, std::memory_order_relaxed);
+  }
+  gI2CPerfSinceMs = millis();
+}
+
+// Next device to get the bus; caller holds gI2CBusMux
+static uint8_t i2cBusPick(uint32_t nowMs) {
+  uint8_t best = I2C_DEV_NONE;
+  for (uint8_t d = 0; d < I2C_DEV_COUNT; ++d) {
+    const I2CBusReq& r = gI2CBusReq[d];
+    if (!r.pending || (int32_t)(nowMs - r.deadlineMs) < 0) continue;
+    if (best == I2C_DEV_NONE || (int32_t)(r.deadlineMs - gI2CBusReq[best].deadlineMs) < 0) best = d;
+  }
+  if (best != I2C_DEV_NONE) return best;  // overdue: earliest deadline first
+
+  for (uint8_t d = 0; d < I2C_DEV_COUNT; ++d) {
+    const I2CBusReq& r = gI2CBusReq[d];
+    if (!r.pending) continue;
+    if (best == I2C_DEV_NONE || r.priority > gI2CBusReq[best].priority
+        || (r.priority == gI2CBusReq[best].priority && (int32_t)(r.deadlineMs - gI2CBusReq[best].deadlineMs) < 0)) best = d;
+  }
+  if (best == I2C_DEV_NONE) return best;
+  const I2CBusReq& b = gI2CBusReq[best];
+  if (b.clockHz == 0 || b.clockHz == gWire1CurrentHz) return best;
+
+  // Batch: a lease at the current clock goes first if it ends before best's deadline
+  uint32_t slackUs = (uint32_t)(b.deadlineMs - nowMs) * 1000UL;
+  uint8_t alt = I2C_DEV_NONE;
+  for (uint8_t d = 0; d < I2C_DEV_COUNT; ++d) {
+    const I2CBusReq& r = gI2CBusReq[d];
+    if (!r.pending || d == best || (r.clockHz != 0 && r.clockHz != gWire1CurrentHz)) continue;
+    if (gI2CBusStats[d].avgBusyUs >= slackUs) continue;
+    if (alt == I2C_DEV_NONE || r.priority > gI2CBusReq[alt].priority) alt = d;
+  }
+  return (alt != I2C_DEV_NONE) ? alt : best;
+}
+
+// Bus owner: hands out one lease at a time, woken by requests and releases
+static void i2cBusTask(void* parameter) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while (gI2CBusHolder == I2C_DEV_NONE) {
+      portENTER_CRITICAL(&gI2CBusMux);
+      uint8_t d = i2cBusPick(millis());
+      portEXIT_CRITICAL(&gI2CBusMux);
+      if (d == I2C_DEV_NONE) {
+        // Idle: put the default back for code that uses Wire1 without a scope
+        if (gWire1CurrentHz != gWire1DefaultHz && xSemaphoreTake(i2cMutex, 0) == pdTRUE) {
+          i2cSetDefaultWire1Clock();
+          gI2CBusSwitches++;
+          xSemaphoreGive(i2cMutex);
+        }
+        break;
+      }
+      xSemaphoreTake(i2cMutex, portMAX_DELAY);  // CLI paths take the gate directly
+      I2CBusReq& r = gI2CBusReq[d];
+      if (r.pending && r.clockHz && r.clockHz != gWire1CurrentHz) {
+        gI2CPerfActive = d;  // switching on d's behalf
+        i2cSetWire1Clock(r.clockHz);
+        gI2CBusSwitches++;
+      }
+      uint32_t nowUs = micros();
+      portENTER_CRITICAL(&gI2CBusMux);
+      bool granted = r.pending;  // i2cBusCancel() may have withdrawn it meanwhile
+      if (granted) {
+        r.pending = false;
+        uint32_t waitUs = nowUs - r.requestUs;
+        I2CBusDevStats& st = gI2CBusStats[d];
+        st.leases++;
+        st.waitUs += waitUs;
+        if (waitUs > st.maxWaitUs) st.maxWaitUs = waitUs;
+        gI2CBusGrantUs = nowUs;
+        gI2CBusHolder = d;
+      }
+      portEXIT_CRITICAL(&gI2CBusMux);
+      if (granted) {
+        xSemaphoreGive(r.grant);
+        break;  // i2cBusRelease() wakes us again
+      }
+      xSemaphoreGive(i2cMutex);
+    }
+  }
+}
+
+// Blocks the calling sensor task until it holds the bus
+static void i2cBusAcquire(uint8_t dev, uint8_t priority, uint32_t clockHz, uint32_t budgetMs) {
+  I2CBusReq& r = gI2CBusReq[dev];
+  uint32_t startUs = micros();
+  portENTER_CRITICAL(&gI2CBusMux);
+  r.priority = priority;
+  r.clockHz = clockHz;
+  r.requestUs = startUs;
+  r.deadlineMs = millis() + budgetMs;
+  r.pending = true;
+  portEXIT_CRITICAL(&gI2CBusMux);
+  xTaskNotifyGive(gI2CBusTask);
+  // A grant given after i2cBusCancel() freed the lease is stale; skip it
+  do {
+    xSemaphoreTake(r.grant, portMAX_DELAY);
+  } while (gI2CBusHolder != dev);
+  i2cPerfBegin(dev, micros() - startUs);
+}
+
+static void i2cBusRelease(uint8_t dev, bool ok) {
+  i2cPerfEnd(dev, ok);
+  uint32_t busyUs = micros() - gI2CBusGrantUs;
+  bool late = (int32_t)(millis() - gI2CBusReq[dev].deadlineMs) > 0;
+  portENTER_CRITICAL(&gI2CBusMux);
+  I2CBusDevStats& st = gI2CBusStats[dev];
+  st.busyUs += busyUs;
+  if (late) st.late++;
+  st.avgBusyUs = st.avgBusyUs ? (st.avgBusyUs * 7 + busyUs) / 8 : busyUs;
+  gI2CBusHolder = I2C_DEV_NONE;
+  portEXIT_CRITICAL(&gI2CBusMux);
+  xSemaphoreGive(i2cMutex);
+  xTaskNotifyGive(gI2CBusTask);
+}
+
+// Withdraws a deleted sensor task's request or lease so the bus can't wedge on it
+static void i2cBusCancel(uint8_t dev) {
+  if (!gI2CBusTask) return;
+  portENTER_CRITICAL(&gI2CBusMux);
+  gI2CBusReq[dev].pending = false;
+  bool held = (gI2CBusHolder == dev);
+  if (held) gI2CBusHolder = I2C_DEV_NONE;
+  portEXIT_CRITICAL(&gI2CBusMux);
+  xSemaphoreTake(gI2CBusReq[dev].grant, 0);  // drop a grant the task never took
+  if (held) {
+    i2cPerfEnd(dev, false);  // cut off mid-transaction
+    xSemaphoreGive(i2cMutex);
+  }
+  xTaskNotifyGive(gI2CBusTask);
+}
+
+// Scope guard for one bus lease on a sensor task; set failed to count an error
+struct I2CBusLease {
+  uint8_t dev;
+  bool failed;
+  I2CBusLease(uint8_t device, uint8_t priority, uint32_t clockHz, uint32_t budgetMs)
+    : dev(device), failed(false) {
+    i2cBusAcquire(dev, priority, clockHz, budgetMs);
+  }
+  ~I2CBusLease() {
+    i2cBusRelease(dev, !failed);
+  }
+};
+
+// CLI paths that stop a sensor take the gate directly; accounted like a lease.
+// A timed-out take still proceeds (as before) but counts as an error and
+// doesn't give back a gate it never held.
+static bool i2cGateTake(uint8_t dev, uint32_t timeoutMs) {
+  if (!i2cMutex) return false;
+  uint32_t startUs = micros();
+  bool took = xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+  i2cPerfBegin(dev, micros() - startUs);
+  return took;
+}
+
+static void i2cGateGive(uint8_t dev, bool took) {
+  if (!i2cMutex) return;
+  i2cPerfEnd(dev, took);
+  if (took) xSemaphoreGive(i2cMutex);
+}
+
 // Helper: set cause then bump (to preserve existing call-sites)
 static inline void sensorStatusBumpWith(const char* cause) {
   gLastStatusCause = cause ? String(cause) : String("");
@@ -1577,6 +2930,8 @@ static String DEFAULT_AUTH_PASS = "admin";
 
 // Globals
 httpd_handle_t server = NULL;
+static const int kHttpMaxSocketsLimit = CONFIG_LWIP_MAX_SOCKETS - 3;  // httpd keeps 3 for itself
+static const int kHttpMaxWorkers = 4;
 Preferences prefs;
 bool filesystemReady = false;
 
@@ -1670,10 +3025,6 @@ static size_t gWebMirrorCap = 8192;               // adjustable capacity
 static volatile unsigned long gWebMirrorSeq = 0;  // increments on each append
 static String gLastTFTLine;                       // last rendered line for TFT
 
-// Execution context for CLI admin gating (set for web CLI requests)
-static bool gExecFromWeb = false;
-static String gExecUser = "";
-static bool gExecIsAdmin = false;
 // Feature capability flags from unified pipeline (default true; can be refined later)
 static bool gCapAdminControls = true;
 static bool gCapSensorConfig = true;
@@ -1692,6 +3043,11 @@ struct Settings {
   int cliHistorySize;
   String ntpServer;
   int tzOffsetMinutes;
+  int passwordKdfIterations;  // PBKDF2 rounds for newly hashed user passwords
+  // HTTP server (applied when the server starts)
+  int httpMaxSockets;  // concurrent client sockets
+  bool httpLruPurge;   // close the least recently used socket when full
+  int httpWorkers;     // async workers for long requests (/api/cli, /api/events); 0 = inline
   bool outSerial;  // persist output lanes
   bool outWeb;
   bool outTft;
@@ -1718,6 +3074,7 @@ struct Settings {
   int thermalDevicePollMs;
   int tofDevicePollMs;
   int imuDevicePollMs;
+  int sensorIdlePollMs;  // poll period with no consumer; 0 = sleep until one appears
   // Debug settings
   bool debugAuthCookies;
   bool debugHttp;
@@ -1734,6 +3091,8 @@ struct Settings {
   bool debugUsers;
   // ESP-NOW settings
   bool espnowenabled;
+  String espnowTelemetryPeer;  // collector device name; empty = telemetry off
+  int espnowTelemetryMs;
 };
 Settings gSettings;
 
@@ -1743,15 +3102,176 @@ static void thermalTask(void* parameter);
 
 // Unified sensor polling task removed; per-sensor tasks are defined below.
 
+// ---- Sensor polling governor ----
+// The sensor tasks poll at their configured rate only while something consumes
+// the data: a web client fetching it from /api/sensors, an enabled automation
+// whose condition reads it, or ESP-NOW telemetry to a collector. Background
+// consumers get the rate they need (doubled again while the bus is busy); with
+// none the task polls every sensorIdlePollMs, or sleeps until a viewer wakes it
+// when that is 0. Between reads the tasks block until the next deadline; anything
+// that changes what they should do (start/stop, init requests, poll-period edits,
+// a new viewer) notifies them awake.
+enum SensorGovReason : uint8_t { SENSOR_GOV_IDLE = 0,
+                                 SENSOR_GOV_VIEWER,
+                                 SENSOR_GOV_AUTOMATION,
+                                 SENSOR_GOV_TELEMETRY };
+static const char* const kSensorGovReasonNames[] = { "idle", "viewer", "automation", "telemetry" };
+static const uint32_t kSensorGovViewerMs = 5000;      // a web fetch counts as a viewer this long
+static const uint32_t kSensorGovAutomationMs = 1000;  // fresh enough for condition checks
+static const uint32_t kSensorGovRecheckMs = 1000;     // longest sleep before demand is re-read
+static const uint8_t kSensorGovMaxViewers = 4;
+struct SensorGovViewer {
+  uint32_t ip;
+  uint32_t lastMs;  // 0 = unused
+};
+static SensorGovViewer gSensorGovViewers[I2C_DEV_COUNT][kSensorGovMaxViewers];
+static portMUX_TYPE gSensorGovMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint8_t gSensorGovAutoMask = 0;  // bit per I2CBusDevice, rebuilt with the automation table
+static volatile bool gSensorGovBusBusy = false;  // bus leased >80% of the last window
+static uint32_t gSensorGovBusCheckMs = 0;
+static uint64_t gSensorGovBusBusyUs = 0;
+
+static TaskHandle_t sensorGovTask(uint8_t dev) {
+  switch (dev) {
+    case I2C_DEV_THERMAL: return thermalTaskHandle;
+    case I2C_DEV_TOF: return tofTaskHandle;
+    case I2C_DEV_IMU: return imuTaskHandle;
+    default: return nullptr;
+  }
+}
+
+// Wakes dev's task so it re-reads its state instead of sleeping out its deadline
+static void sensorTaskNotify(uint8_t dev) {
+  TaskHandle_t t = sensorGovTask(dev);
+  if (t) xTaskNotifyGive(t);
+}
+
+static void sensorTaskNotifyAll() {
+  for (uint8_t d = 0; d < I2C_DEV_COUNT; ++d) sensorTaskNotify(d);
+}
+
+// A web client fetched dev's data; wakes the task if nobody was watching
+static void sensorGovNoteViewer(uint8_t dev, const String& ip) {
+  IPAddress addr;
+  uint32_t key = addr.fromString(ip) ? (uint32_t)addr : 0;
+  uint32_t now = millis();
+  bool watched = false;
+  int match = -1, oldest = 0;
+  portENTER_CRITICAL(&gSensorGovMux);
+  SensorGovViewer* views = gSensorGovViewers[dev];
+  for (int i = 0; i < kSensorGovMaxViewers; ++i) {
+    if (views[i].lastMs && now - views[i].lastMs < kSensorGovViewerMs) watched = true;
+    if (views[i].lastMs && views[i].ip == key) match = i;
+    if (!views[i].lastMs || (views[oldest].lastMs && now - views[i].lastMs > now - views[oldest].lastMs)) oldest = i;
+  }
+  SensorGovViewer& v = views[(match >= 0) ? match : oldest];
+  v.ip = key;
+  v.lastMs = now ? now : 1;
+  portEXIT_CRITICAL(&gSensorGovMux);
+  if (!watched) sensorTaskNotify(dev);
+}
+
+static uint8_t sensorGovViewerCount(uint8_t dev, uint32_t now) {
+  uint8_t n = 0;
+  portENTER_CRITICAL(&gSensorGovMux);
+  for (int i = 0; i < kSensorGovMaxViewers; ++i) {
+    const SensorGovViewer& v = gSensorGovViewers[dev][i];
+    if (v.lastMs && now - v.lastMs < kSensorGovViewerMs) n++;
+  }
+  portEXIT_CRITICAL(&gSensorGovMux);
+  return n;
+}
+
+// Refreshes gSensorGovBusBusy from the bus owner's lease time, at most once a second
+static void sensorGovCheckBus(uint32_t now) {
+  if (now - gSensorGovBusCheckMs < 1000) return;
+  uint64_t busyUs = 0;
+  portENTER_CRITICAL(&gI2CBusMux);
+  for (uint8_t d = 0; d < I2C_DEV_COUNT; ++d) busyUs += gI2CBusStats[d].busyUs;
+  portEXIT_CRITICAL(&gI2CBusMux);
+  portENTER_CRITICAL(&gSensorGovMux);
+  uint32_t windowMs = now - gSensorGovBusCheckMs;
+  if (windowMs >= 1000) {
+    gSensorGovBusBusy = gSensorGovBusCheckMs && (busyUs - gSensorGovBusBusyUs) > (uint64_t)windowMs * 800;
+    gSensorGovBusBusyUs = busyUs;
+    gSensorGovBusCheckMs = now;
+  }
+  portEXIT_CRITICAL(&gSensorGovMux);
+}
+
+// Poll period for dev given its configured one; 0 = sleep until a consumer appears
+static uint32_t sensorGovPollMs(uint8_t dev, uint32_t configuredMs, uint8_t* reason = nullptr) {
+  uint32_t now = millis();
+  sensorGovCheckBus(now);
+  uint8_t why = SENSOR_GOV_IDLE;
+  uint32_t ms = 0;
+  if (sensorGovViewerCount(dev, now)) {
+    why = SENSOR_GOV_VIEWER;
+    ms = configuredMs;
+  } else {
+    if (gEspNowInitialized && gSettings.espnowTelemetryPeer.length()) {
+      why = SENSOR_GOV_TELEMETRY;
+      ms = max(configuredMs, (uint32_t)gSettings.espnowTelemetryMs);
+    }
+    if (gSensorGovAutoMask & (1 << dev)) {
+      uint32_t autoMs = max(configuredMs, kSensorGovAutomationMs);
+      if (!ms || autoMs < ms) {
+        why = SENSOR_GOV_AUTOMATION;
+        ms = autoMs;
+      }
+    }
+    if (ms && gSensorGovBusBusy) ms *= 2;
+    if (!ms && gSettings.sensorIdlePollMs > 0) ms = max(configuredMs, (uint32_t)gSettings.sensorIdlePollMs);
+  }
+  if (reason) *reason = why;
+  return ms;
+}
+
+// True when a task last read at lastReadMs should read again
+static bool sensorGovDue(uint32_t govMs, unsigned long lastReadMs) {
+  if (lastReadMs == 0) return true;  // first read after start confirms the sensor works
+  return govMs && millis() - lastReadMs >= govMs;
+}
+
+// Deadline of the read after one taken at nowMs: one period after the previous
+// deadline, so the rate does not drift by the wakeup latency, unless a whole
+// period was missed (first read, rate change, long bus wait)
+static unsigned long sensorGovNextRead(uint32_t govMs, unsigned long lastReadMs, unsigned long nowMs) {
+  if (lastReadMs && govMs && nowMs - lastReadMs < 2 * govMs) return lastReadMs + govMs;
+  return nowMs;
+}
+
+// Blocks until the next read is due or a notification arrives; at most
+// kSensorGovRecheckMs so demand changes are picked up
+static void sensorGovWait(uint32_t govMs, unsigned long lastReadMs) {
+  uint32_t waitMs = kSensorGovRecheckMs;
+  if (govMs) {
+    uint32_t since = millis() - lastReadMs;
+    waitMs = (since < govMs) ? min(govMs - since, kSensorGovRecheckMs) : 0;
+  }
+  if (waitMs) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+}
+
 // ------------------------------
 // Per-sensor dedicated tasks (defined after Settings)
 // ------------------------------
 
+// VL53L4CX data-ready flag. readToFObjects() spins on the same flag for up to a
+// timing budget; checking it first keeps that wait off the bus. Errors report
+// ready so readToFObjects() surfaces them.
+static bool tofDataReady() {
+  if (!tofConnected || tofSensor == nullptr) return true;
+  uint8_t ready = 0;
+  if (tofSensor->VL53L4CX_GetMeasurementDataReady(&ready) != VL53L4CX_ERROR_NONE) return true;
+  return ready != 0;
+}
+
 static void tofTask(void* parameter) {
   if (gDebugFlags & DEBUG_SENSORS_FRAME) {
     Serial.println("[DEBUG_SENSORS_FRAME] ToF task started");
   }
   unsigned long lastToFRead = 0;
+  unsigned long tofWaitSinceMs = 0;  // first data-ready probe of the pending read
   unsigned long lastStackLog = 0;
   while (true) {
     // Update watermark diagnostics
@@ -1765,22 +3285,42 @@ static void tofTask(void* parameter) {
     }
     if (tofEnabled && tofConnected && tofSensor != nullptr) {
       unsigned long tofPollMs = (gSettings.tofDevicePollMs > 0) ? (unsigned long)gSettings.tofDevicePollMs : 100;
+      uint32_t govMs = sensorGovPollMs(I2C_DEV_TOF, tofPollMs);
       unsigned long nowMs = millis();
-      if (nowMs - lastToFRead >= tofPollMs) {
-        if (gDebugFlags & DEBUG_SENSORS_FRAME) {
-          Serial.println("[DEBUG_SENSORS_FRAME] [ToF task] Calling readToFObjects()");
+      if (sensorGovDue(govMs, lastToFRead)) {
+        // Wait for the measurement in short leases so thermal/IMU get the bus meanwhile;
+        // the read lease then only spans the result transfer
+        if (!tofWaitSinceMs) tofWaitSinceMs = nowMs ? nowMs : 1;
+        bool timedOut = nowMs - tofWaitSinceMs > 250;  // 200ms timing budget + margin, as in readToFObjects()
+        bool dataReady;
+        {
+          I2CBusLease lease(I2C_DEV_TOF, kI2CPrioToF, 0, 5);
+          dataReady = tofDataReady();
+          lease.failed = !dataReady && timedOut;
+        }
+        if (!dataReady && !timedOut) {
+          vTaskDelay(pdMS_TO_TICKS(5));
+          continue;
+        }
+        tofWaitSinceMs = 0;
+        bool ok = false;  // timed out: sensor may be stuck, skip this period
+        if (dataReady) {
+          if (gDebugFlags & DEBUG_SENSORS_FRAME) {
+            Serial.println("[DEBUG_SENSORS_FRAME] [ToF task] Calling readToFObjects()");
+          }
+          // ToF runs at whatever clock the bus is at (no per-read toggling)
+          I2CBusLease lease(I2C_DEV_TOF, kI2CPrioToF, 0, tofPollMs);
+          ok = readToFObjects();
+          lease.failed = !ok;
         }
-        if (i2cMutex) xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(300));
-        bool ok = readToFObjects();
-        if (i2cMutex) xSemaphoreGive(i2cMutex);
-        lastToFRead = nowMs;
+        lastToFRead = sensorGovNextRead(govMs, lastToFRead, nowMs);
         if (gDebugFlags & DEBUG_SENSORS_FRAME) {
           Serial.printf("[DEBUG_SENSORS_FRAME] [ToF task] readToFObjects() %s\n", ok ? "ok" : "fail");
         }
       }
-      vTaskDelay(pdMS_TO_TICKS(1));
+      sensorGovWait(govMs, lastToFRead);
     } else {
-      vTaskDelay(pdMS_TO_TICKS(50));
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(kSensorGovRecheckMs));  // tofstart notifies
     }
   }
 }
@@ -1804,9 +3344,12 @@ static void imuTask(void* parameter) {
     // Handle deferred IMU initialization on task stack
     if (imuEnabled && (!imuConnected || bno == nullptr)) {
       if (imuInitRequested) {
-        if (i2cMutex) xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(500));
-        bool ok = initIMUSensor();
-        if (i2cMutex) xSemaphoreGive(i2cMutex);
+        bool ok;
+        {
+          I2CBusLease lease(I2C_DEV_IMU, kI2CPrioInit, 0, 500);
+          ok = initIMUSensor();
+          lease.failed = !ok;
+        }
         imuInitResult = ok;
         imuInitDone = true;
         imuInitRequested = false;
@@ -1819,20 +3362,35 @@ static void imuTask(void* parameter) {
 
     if (imuEnabled && imuConnected && bno != nullptr) {
       unsigned long imuPollMs = (gSettings.imuDevicePollMs > 0) ? (unsigned long)gSettings.imuDevicePollMs : 200;
+      uint32_t govMs = sensorGovPollMs(I2C_DEV_IMU, imuPollMs);
       unsigned long nowMs = millis();
-      if (nowMs - lastIMURead >= imuPollMs) {
-        if (i2cMutex) xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(200));
-        readIMUSensor();
-        if (i2cMutex) xSemaphoreGive(i2cMutex);
-        lastIMURead = nowMs;
+      if (sensorGovDue(govMs, lastIMURead)) {
+        {
+          I2CBusLease lease(I2C_DEV_IMU, kI2CPrioImu, 100000, imuPollMs);  // BNO055 safe speed, as in readIMUSensor()
+          readIMUSensor();
+        }
+        lastIMURead = sensorGovNextRead(govMs, lastIMURead, nowMs);
       }
-      vTaskDelay(pdMS_TO_TICKS(1));
+      sensorGovWait(govMs, lastIMURead);
     } else {
-      vTaskDelay(pdMS_TO_TICKS(50));
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(kSensorGovRecheckMs));  // imustart notifies
     }
   }
 }
 
+// MLX90640 status register: bit 3 set once a new subpage is in RAM. getFrame() spins on
+// the same bit; checking it first keeps that wait off the bus. Errors report ready so
+// getFrame() surfaces them.
+static bool mlx90640SubpageReady() {
+  Wire1.beginTransmission(MLX90640_I2CADDR_DEFAULT);
+  Wire1.write(0x80);
+  Wire1.write(0x00);
+  if (Wire1.endTransmission(false) != 0) return true;
+  if (Wire1.requestFrom((uint8_t)MLX90640_I2CADDR_DEFAULT, (uint8_t)2) != 2) return true;
+  uint16_t status = ((uint16_t)Wire1.read() << 8) | (uint16_t)Wire1.read();
+  return (status & 0x0008) != 0;
+}
+
 // Thermal dedicated task: mirrors ToF/IMU pattern
 static void thermalTask(void* parameter) {
   if (gDebugFlags & DEBUG_SENSORS_FRAME) {
@@ -1853,9 +3411,12 @@ static void thermalTask(void* parameter) {
     // Handle deferred initialization request on the task's large stack
     if (thermalEnabled && (!thermalConnected || thermalSensor == nullptr)) {
       if (thermalInitRequested) {
-        if (i2cMutex) xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(1000));
-        bool ok = initThermalSensor();
-        if (i2cMutex) xSemaphoreGive(i2cMutex);
+        bool ok;
+        {
+          I2CBusLease lease(I2C_DEV_THERMAL, kI2CPrioInit, 0, 1000);
+          ok = initThermalSensor();
+          lease.failed = !ok;
+        }
         thermalInitResult = ok;
         thermalInitDone = true;
         thermalInitRequested = false;
@@ -1869,24 +3430,47 @@ static void thermalTask(void* parameter) {
     if (thermalEnabled && thermalConnected && thermalSensor != nullptr) {
       unsigned long nowMs = millis();
       unsigned long pollMs = (gSettings.thermalDevicePollMs > 0) ? (unsigned long)gSettings.thermalDevicePollMs : 100;
+      // A restart needs its first frame regardless of demand
+      uint32_t govMs = thermalPendingFirstFrame ? pollMs : sensorGovPollMs(I2C_DEV_THERMAL, pollMs);
       bool ready = true;
       if (thermalArmAtMs) {
         int32_t dt = (int32_t)(nowMs - thermalArmAtMs);
         if (dt < 0) ready = false;
       }
-      if (ready && (nowMs - lastThermalRead) >= pollMs) {
-        if (i2cMutex) xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(500));
-        bool ok = readThermalPixels();
-        if (i2cMutex) xSemaphoreGive(i2cMutex);
+      if (ready && sensorGovDue(govMs, lastThermalRead)) {
+        uint32_t thermalHz = (gSettings.i2cClockThermalHz > 0) ? (uint32_t)gSettings.i2cClockThermalHz : 800000;
+        // Wait for the first subpage in short leases so ToF/IMU get the bus meanwhile;
+        // the frame lease then only spans the second subpage (one refresh period)
+        bool subpageReady;
+        {
+          I2CBusLease lease(I2C_DEV_THERMAL, kI2CPrioThermal, thermalHz, 5);
+          subpageReady = mlx90640SubpageReady();
+        }
+        if (!subpageReady) {
+          vTaskDelay(pdMS_TO_TICKS(4));
+          continue;
+        }
+        int fps = constrain(gSettings.thermalTargetFps, 1, 8);
+        bool ok;
+        {
+          I2CBusLease lease(I2C_DEV_THERMAL, kI2CPrioThermal, thermalHz, 2000UL / fps);
+          ok = readThermalPixels();
+          lease.failed = !ok;
+        }
         lastThermalRead = millis();
         if (thermalPendingFirstFrame && ok) {
           thermalPendingFirstFrame = false;
           sensorStatusBumpWith("thermalstart@firstframe");
         }
       }
-      vTaskDelay(pdMS_TO_TICKS(1));
+      if (!ready) {
+        int32_t armMs = (int32_t)(thermalArmAtMs - millis());
+        if (armMs > 0) vTaskDelay(pdMS_TO_TICKS(armMs));
+      } else {
+        sensorGovWait(govMs, lastThermalRead);
+      }
     } else {
-      vTaskDelay(pdMS_TO_TICKS(20));
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(kSensorGovRecheckMs));  // thermalstart notifies
     }
   }
 }
@@ -1972,79 +3556,39 @@ String generateNavigation(const String& activePage, const String& username) {
   return nav;
 }
 
-// Universal page streaming function
-void streamPageWithContent(httpd_req_t* req, const String& activePage, const String& username, void (*contentStreamer)(httpd_req_t*)) {
-  httpd_resp_set_type(req, "text/html");
-
-  // Streaming debug: reset per-request counters
-  extern void streamDebugReset(const char* tag);
-  streamDebugReset(activePage.c_str());
-
-  // Stream page-specific content only - no navigation wrapper
-  if (contentStreamer) {
-    contentStreamer(req);
-  }
-
-  // End chunked response
-  httpd_resp_send_chunk(req, NULL, 0);
-
-  // Streaming debug: print summary for this response
-  extern void streamDebugFlush();
-  streamDebugFlush();
-}
-
-// Global reusable buffer for chunked streaming to avoid fragmentation
-static char* gStreamBuffer = nullptr;  // 5KB buffer - allocated with ps_alloc
-
 // ==========================
 // Streaming debug instrumentation
 // ==========================
-static bool gStreamHitMaxChunk = false;
 static size_t gStreamMaxChunk = 0;
 static size_t gStreamTotalBytes = 0;
-static String gStreamTag = "";
+static size_t gStreamChunks = 0;
+static size_t gStreamHeapBase = 0;  // free heap when the response started
+static size_t gStreamHeapPeak = 0;  // most heap held above the base while sending
+static const char* gStreamTag = "";
 
 void streamDebugReset(const char* tag) {
-  gStreamHitMaxChunk = false;
   gStreamMaxChunk = 0;
   gStreamTotalBytes = 0;
-  gStreamTag = tag ? String(tag) : String("");
+  gStreamChunks = 0;
+  gStreamHeapBase = ESP.getFreeHeap();
+  gStreamHeapPeak = 0;
+  gStreamTag = tag ? tag : "";
 }
 
-inline void streamDebugRecord(size_t sz, size_t chunkLimit) {
+inline void streamDebugRecord(size_t sz) {
   if (sz > gStreamMaxChunk) gStreamMaxChunk = sz;
   gStreamTotalBytes += sz;
-  if (sz >= chunkLimit) gStreamHitMaxChunk = true;
+  gStreamChunks++;
+  size_t freeNow = ESP.getFreeHeap();
+  if (freeNow < gStreamHeapBase && gStreamHeapBase - freeNow > gStreamHeapPeak) gStreamHeapPeak = gStreamHeapBase - freeNow;
 }
 
 void streamDebugFlush() {
   // One-line summary per response
-  DEBUG_HTTPF("page=%s total=%uB maxChunk=%uB hitMax=%s buf=5119B", 
-              gStreamTag.c_str(), gStreamTotalBytes, gStreamMaxChunk, gStreamHitMaxChunk ? "yes" : "no");
-}
-
-void streamContentGeneric(httpd_req_t* req, const String& content) {
-  const char* contentStr = content.c_str();
-  size_t contentLen = content.length();
-  size_t chunkSize = 5119;  // 5KB buffer size - 1 for null terminator
-  
-  httpd_resp_set_type(req, "text/html; charset=utf-8");
-  
-  for (size_t i = 0; i < contentLen; i += chunkSize) {
-    size_t remainingBytes = contentLen - i;
-    size_t currentChunkSize = (remainingBytes > chunkSize) ? chunkSize : remainingBytes;
-    httpd_resp_send_chunk(req, contentStr + i, currentChunkSize);
-  }
-  
-  // End chunked response
-  httpd_resp_send_chunk(req, NULL, 0);
-
-  // Streaming debug: print summary for this response
-  extern void streamDebugFlush();
-  streamDebugFlush();
+  DEBUG_HTTPF("page=%s total=%uB chunks=%u maxChunk=%uB heapPeak=%uB",
+              gStreamTag, gStreamTotalBytes, gStreamChunks, gStreamMaxChunk, gStreamHeapPeak);
 }
 
-
 // Helper to stream regular strings (for dynamic content)
 void streamChunk(httpd_req_t* req, const String& str) {
   httpd_resp_send_chunk(req, str.c_str(), str.length());
@@ -2055,18 +3599,321 @@ void streamChunk(httpd_req_t* req, const char* str) {
   httpd_resp_send_chunk(req, str, strlen(str));
 }
 
-void streamSensorsContent(httpd_req_t* req) {
-  String u;
-  isAuthed(req, u);
-  String content = getSensorsPage(u);
-  streamContentGeneric(req, content);
+// ==========================
+// UI pages from flash spans + precompiled gzip page cache
+// ==========================
+// A UI page is a list of flash-resident spans: the shell pieces from web_shared.h
+// around the page content from web_*.h. WEB_SLOT_* markers inside the spans stand
+// for the few per-request values. Without gzip the spans are sent straight from
+// flash with httpd_resp_send_chunk and only the slot values are built per request.
+//
+// For gzip, each page is rendered once with WEB_SLOT_* markers in place of its
+// per-request values. It is split at the markers, and each static segment is
+// deflated on its own into a PSRAM blob. A request sends the cached segments
+// and writes the slot values between them as stored deflate blocks. The gzip
+// trailer CRC is combined from the per-segment CRCs, so the page is never
+// re-rendered or recompressed. ETag = template hash + slot CRC, so If-None-Match
+// hits get a 304 without a body.
+
+struct WebGzSegment {
+  uint32_t off;     // deflate bytes in the page blob
+  uint32_t len;
+  uint32_t rawLen;  // uncompressed length
+  uint32_t crc;     // CRC-32 of the uncompressed bytes
+  uint32_t shift[32];  // CRC operator for appending rawLen bytes (webCrc32Shift)
+  char slotAfter;   // WEB_SLOT_* id sent after this segment; 0 on the last one
+};
+
+struct WebGzPage {
+  const char* name;     // activePage id used by streamPage
+  const char* content;  // page content span (web_*.h)
+  uint8_t* blob;
+  uint32_t blobLen;
+  WebGzSegment* segs;
+  int segCount;
+  uint32_t rawLen;
+  uint32_t tplHash;  // FNV-1a of the rendered template
+  bool failed;       // compressor unavailable; always serve uncompressed
+};
+
+static WebGzPage gWebGzPages[] = {
+  { "dashboard", kDashboardContent },
+  { "cli", kCLIContent },
+  { "sensors", kSensorsContent },
+  { "espnow", kEspNowContent },
+  { "files", kFilesContent },
+  { "automations", kAutomationsContent },
+  { "settings", kSettingsContent },
+};
+static const int kWebGzPageCount = sizeof(gWebGzPages) / sizeof(gWebGzPages[0]);
+static const int kWebGzMaxSegments = 16;
+static const int kWebPageSpanCount = 5;
+
+static void webPageSpans(const WebGzPage& p, const char** spans) {
+  spans[0] = kWebShellHead;
+  spans[1] = kWebCommonCss;
+  spans[2] = kWebShellBody;  // carries WEB_SLOT_NAV
+  spans[3] = p.content;
+  spans[4] = kWebShellTail;
 }
 
-void streamEspNowContent(httpd_req_t* req) {
-  String u;
-  isAuthed(req, u);
-  String content = getEspNowPage(u);
-  streamContentGeneric(req, content);
+static WebGzPage* webFindPage(const char* name) {
+  for (int i = 0; i < kWebGzPageCount; ++i) {
+    if (strcmp(name, gWebGzPages[i].name) == 0) return &gWebGzPages[i];
+  }
+  return nullptr;
+}
+
+static String webSlotValue(char slot, const String& username) {
+  switch (slot) {
+    case 'U': return username;
+    case 'I': return WiFi.localIP().toString();
+    default: return String();
+  }
+}
+
+// Page text for the gzip build. The nav is fixed per page apart from the
+// username, so it is expanded here and its username stays a slot.
+static String webPageTemplate(const WebGzPage& p) {
+  const char* spans[kWebPageSpanCount];
+  webPageSpans(p, spans);
+  size_t n = 0;
+  for (int i = 0; i < kWebPageSpanCount; ++i) n += strlen(spans[i]);
+  String tpl;
+  tpl.reserve(n + 1024);
+  for (int i = 0; i < kWebPageSpanCount; ++i) tpl += spans[i];
+  tpl.replace(WEB_SLOT_NAV, generateNavigation(p.name, WEB_SLOT_USER));
+  return tpl;
+}
+
+// CRC-32 of concatenated data without the data (GF(2) matrix method, as in zlib's
+// crc32_combine). webCrc32Shift() builds the operator for appending len bytes once
+// per segment, so a request combines each segment with a single matrix product.
+static uint32_t webGf2Times(const uint32_t* mat, uint32_t vec) {
+  uint32_t sum = 0;
+  while (vec) {
+    if (vec & 1) sum ^= *mat;
+    vec >>= 1;
+    mat++;
+  }
+  return sum;
+}
+
+static void webGf2Square(uint32_t* square, const uint32_t* mat) {
+  for (int n = 0; n < 32; n++) square[n] = webGf2Times(mat, mat[n]);
+}
+
+static void webCrc32Shift(uint32_t len, uint32_t* out) {
+  uint32_t op[32], sq[32];
+  for (int n = 0; n < 32; n++) out[n] = 1UL << n;  // identity
+  op[0] = 0xEDB88320UL;  // one zero bit: reflected CRC-32 polynomial
+  for (int n = 1; n < 32; n++) op[n] = 1UL << (n - 1);
+  webGf2Square(sq, op);  // two zero bits
+  webGf2Square(op, sq);  // four zero bits
+  webGf2Square(sq, op);  // one zero byte
+  while (len) {
+    if (len & 1) {
+      uint32_t prod[32];
+      for (int n = 0; n < 32; n++) prod[n] = webGf2Times(sq, out[n]);
+      memcpy(out, prod, sizeof(prod));
+    }
+    len >>= 1;
+    if (!len) break;
+    memcpy(op, sq, sizeof(op));
+    webGf2Square(sq, op);
+  }
+}
+
+struct WebGzSink {
+  uint8_t* buf;
+  uint32_t len;
+  uint32_t cap;
+};
+
+static mz_bool webGzPut(const void* data, int len, void* user) {
+  WebGzSink* s = (WebGzSink*)user;
+  if (s->len + (uint32_t)len > s->cap) {
+    uint32_t newCap = s->cap ? s->cap : 4096;
+    while (newCap < s->len + (uint32_t)len) newCap *= 2;
+    uint8_t* p = (uint8_t*)ps_realloc(s->buf, newCap, AllocPref::PreferPSRAM, "web.gz.blob");
+    if (!p) return MZ_FALSE;
+    s->buf = p;
+    s->cap = newCap;
+  }
+  memcpy(s->buf + s->len, data, len);
+  s->len += len;
+  return MZ_TRUE;
+}
+
+static bool webGzBuild(WebGzPage& p) {
+  String tpl = webPageTemplate(p);
+  const char* src = tpl.c_str();
+  uint32_t n = tpl.length();
+
+  WebGzSegment* segs = (WebGzSegment*)ps_alloc(kWebGzMaxSegments * sizeof(WebGzSegment), AllocPref::PreferPSRAM, "web.gz.segs");
+  tdefl_compressor* d = (tdefl_compressor*)ps_alloc(sizeof(tdefl_compressor), AllocPref::PreferPSRAM, "web.gz.deflate");
+  WebGzSink sink = { nullptr, 0, 0 };
+  int segCount = 0;
+  bool ok = segs && d;
+  uint32_t start = 0;
+  uint32_t hash = 2166136261UL;
+  while (ok) {
+    // Next marker, or the end of the template
+    uint32_t end = start;
+    while (end < n && src[end] != '\x1e') end++;
+    if (segCount == kWebGzMaxSegments || (end < n && end + 1 >= n)) {
+      ok = false;
+      break;
+    }
+    WebGzSegment& s = segs[segCount++];
+    s.off = sink.len;
+    s.rawLen = end - start;
+    s.crc = esp_rom_crc32_le(0, (const uint8_t*)src + start, s.rawLen);
+    webCrc32Shift(s.rawLen, s.shift);
+    s.slotAfter = (end < n) ? src[end + 1] : 0;
+    for (uint32_t i = start; i < end + (end < n ? 2 : 0); ++i) {
+      hash ^= (uint8_t)src[i];
+      hash *= 16777619UL;
+    }
+    if (s.rawLen > 0) {
+      // Fresh compressor per segment: back-references must not span a slot.
+      // SYNC_FLUSH leaves the stream byte-aligned and open for the next block.
+      ok = tdefl_init(d, webGzPut, &sink, TDEFL_DEFAULT_MAX_PROBES) == TDEFL_STATUS_OKAY
+           && tdefl_compress_buffer(d, src + start, s.rawLen, TDEFL_SYNC_FLUSH) == TDEFL_STATUS_OKAY;
+    }
+    s.len = sink.len - s.off;
+    if (end >= n) break;
+    start = end + 2;
+  }
+  if (d) free(d);
+  if (!ok) {
+    if (segs) free(segs);
+    if (sink.buf) free(sink.buf);
+    DEBUG_HTTPF("gzip cache: page=%s build failed", p.name);
+    return false;
+  }
+  p.blob = sink.buf;
+  p.blobLen = sink.len;
+  p.segs = segs;
+  p.segCount = segCount;
+  p.rawLen = n;
+  p.tplHash = hash;
+  DEBUG_HTTPF("gzip cache: page=%s raw=%uB gz=%uB segments=%d", p.name, (unsigned)n, (unsigned)sink.len, segCount);
+  return true;
+}
+
+static bool webSendChunk(httpd_req_t* req, const void* data, size_t len) {
+  if (len == 0) return true;
+  streamDebugRecord(len);
+  return httpd_resp_send_chunk(req, (const char*)data, len) == ESP_OK;
+}
+
+// Serves a page from the gzip cache. Returns false (nothing sent) when the page
+// cannot be cached or the client does not accept gzip.
+static bool webGzServePage(httpd_req_t* req, WebGzPage* p, const String& username) {
+  if (p->failed) return false;
+
+  char hdr[128];
+  if (httpd_req_get_hdr_value_str(req, "Accept-Encoding", hdr, sizeof(hdr)) != ESP_OK || !strstr(hdr, "gzip")) {
+    return false;
+  }
+  // Render and compress on first use (handlers run on the single httpd task)
+  if (!p->blob && !webGzBuild(*p)) {
+    p->failed = true;
+    return false;
+  }
+
+  // Slot values for this request; their CRC also keys the ETag
+  String values[kWebGzMaxSegments];
+  uint32_t slotCrc = 0;
+  for (int i = 0; i < p->segCount; ++i) {
+    if (!p->segs[i].slotAfter) continue;
+    values[i] = webSlotValue(p->segs[i].slotAfter, username);
+    if (values[i].length() > 0xFFFF) values[i] = values[i].substring(0, 0xFFFF);  // one stored block
+    slotCrc = esp_rom_crc32_le(slotCrc, (const uint8_t*)values[i].c_str(), values[i].length());
+  }
+  char etag[24];
+  snprintf(etag, sizeof(etag), "\"%08lx-%08lx\"", (unsigned long)p->tplHash, (unsigned long)slotCrc);
+
+  // Pages sit behind auth, so browsers may keep them but must revalidate each time
+  httpd_resp_set_hdr(req, "ETag", etag);
+  httpd_resp_set_hdr(req, "Cache-Control", "private, no-cache");
+  httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+  if (httpd_req_get_hdr_value_str(req, "If-None-Match", hdr, sizeof(hdr)) == ESP_OK && strstr(hdr, etag)) {
+    httpd_resp_set_status(req, "304 Not Modified");
+    httpd_resp_send(req, NULL, 0);
+    return true;
+  }
+
+  httpd_resp_set_type(req, "text/html; charset=utf-8");
+  httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+  static const uint8_t kGzipHeader[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+  bool ok = webSendChunk(req, kGzipHeader, sizeof(kGzipHeader));
+  uint32_t crc = 0;
+  uint32_t total = 0;
+  for (int i = 0; ok && i < p->segCount; ++i) {
+    const WebGzSegment& s = p->segs[i];
+    ok = webSendChunk(req, p->blob + s.off, s.len);
+    crc = webGf2Times(s.shift, crc) ^ s.crc;
+    total += s.rawLen;
+    if (!ok || !s.slotAfter) continue;
+    // Stored (uncompressed) block: BFINAL=0/BTYPE=00, LEN, NLEN, bytes
+    uint16_t vlen = values[i].length();
+    uint16_t nlen = ~vlen;
+    uint8_t stored[5] = { 0, (uint8_t)vlen, (uint8_t)(vlen >> 8), (uint8_t)nlen, (uint8_t)(nlen >> 8) };
+    ok = webSendChunk(req, stored, sizeof(stored)) && webSendChunk(req, values[i].c_str(), vlen);
+    crc = esp_rom_crc32_le(crc, (const uint8_t*)values[i].c_str(), vlen);
+    total += vlen;
+  }
+  if (ok) {
+    // Empty final stored block, then CRC-32 and ISIZE (little-endian)
+    uint8_t tail[13] = { 1, 0, 0, 0xff, 0xff,
+                         (uint8_t)crc, (uint8_t)(crc >> 8), (uint8_t)(crc >> 16), (uint8_t)(crc >> 24),
+                         (uint8_t)total, (uint8_t)(total >> 8), (uint8_t)(total >> 16), (uint8_t)(total >> 24) };
+    ok = webSendChunk(req, tail, sizeof(tail));
+  }
+  httpd_resp_send_chunk(req, NULL, 0);
+  return true;
+}
+
+// Uncompressed path: sends the page spans as they sit in flash, a run at a time
+// up to each slot marker, so the page is never assembled in RAM.
+static void webStreamPage(httpd_req_t* req, const WebGzPage& p, const String& username) {
+  httpd_resp_set_type(req, "text/html; charset=utf-8");
+  const char* spans[kWebPageSpanCount];
+  webPageSpans(p, spans);
+  bool ok = true;
+  for (int i = 0; ok && i < kWebPageSpanCount; ++i) {
+    const char* run = spans[i];
+    while (ok && *run) {
+      const char* mark = strchr(run, '\x1e');
+      if (!mark) {
+        ok = webSendChunk(req, run, strlen(run));
+        break;
+      }
+      ok = webSendChunk(req, run, mark - run);
+      if (!mark[1]) break;
+      String value = (mark[1] == 'N') ? generateNavigation(p.name, username) : webSlotValue(mark[1], username);
+      ok = ok && webSendChunk(req, value.c_str(), value.length());
+      run = mark + 2;
+    }
+  }
+  httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Universal page streaming function
+void streamPage(httpd_req_t* req, const char* activePage, const String& username) {
+  WebGzPage* p = webFindPage(activePage);
+  if (!p) {
+    httpd_resp_send_404(req);
+    return;
+  }
+  streamDebugReset(activePage);
+  // Precompiled gzip copy when the browser accepts it, else spans from flash
+  if (!webGzServePage(req, p, username)) {
+    webStreamPage(req, *p, username);
+  }
+  streamDebugFlush();
 }
 
 esp_err_t handleSensorsPage(httpd_req_t* req) {
@@ -2078,7 +3925,7 @@ esp_err_t handleSensorsPage(httpd_req_t* req) {
   if (!tgRequireAuth(ctx)) return ESP_OK;  // 401 already sent
   logAuthAttempt(true, req->uri, ctx.user, ctx.ip, "");
 
-  streamPageWithContent(req, "sensors", ctx.user, streamSensorsContent);
+  streamPage(req, "sensors", ctx.user);
   return ESP_OK;
 }
 
@@ -2091,7 +3938,7 @@ esp_err_t handleEspNowPage(httpd_req_t* req) {
   if (!tgRequireAuth(ctx)) return ESP_OK;  // 401 already sent
   logAuthAttempt(true, req->uri, ctx.user, ctx.ip, "");
 
-  streamPageWithContent(req, "espnow", ctx.user, streamEspNowContent);
+  streamPage(req, "espnow", ctx.user);
   return ESP_OK;
 }
 
@@ -2242,7 +4089,10 @@ esp_err_t handleFileWrite(httpd_req_t* req) {
   f.close();
 
   // Post-save hooks for specific files
+  if (name == USERS_FILE) gUserDirStale = true;
   if (name == "/automations.json") {
+    gAutoTableStale = true;
+    gAutosDirty = true;
     // Read back and sanitize duplicate IDs; persist atomically if changed
     String json;
     if (readText(AUTOMATIONS_JSON_FILE, json)) {
@@ -2496,6 +4346,7 @@ bool writeText(const char* path, const String& in) {
 
 // Atomic writer for automations.json: write temp then rename; fallback to direct write
 static bool writeAutomationsJsonAtomic(const String& json) {
+  gAutoTableStale = true;
   const char* tmp = "/automations.tmp";
   if (!writeText(tmp, json)) return false;
   LittleFS.remove(AUTOMATIONS_JSON_FILE);
@@ -2687,6 +4538,10 @@ void settingsDefaults() {
   gSettings.cliHistorySize = 10;
   gSettings.ntpServer = "pool.ntp.org";
   gSettings.tzOffsetMinutes = -240;  // EST (UTC-5)
+  gSettings.passwordKdfIterations = 10000;
+  gSettings.httpMaxSockets = 7;
+  gSettings.httpLruPurge = true;
+  gSettings.httpWorkers = 2;
   gSettings.outSerial = true;        // default serial on
   gSettings.outWeb = false;
   gSettings.outTft = false;
@@ -2715,6 +4570,7 @@ void settingsDefaults() {
   // ToF timing budget is 200ms; default poll a bit slower to avoid stale/invalid frames
   gSettings.tofDevicePollMs = 220;
   gSettings.imuDevicePollMs = 200;
+  gSettings.sensorIdlePollMs = 5000;
   // Debug defaults - enable all for development/troubleshooting
   gSettings.debugAuthCookies = false;
   gSettings.debugHttp = false;
@@ -2731,6 +4587,8 @@ void settingsDefaults() {
   gSettings.debugUsers = false;
   // ESP-NOW defaults
   gSettings.espnowenabled = false;  // default disabled for backward compatibility
+  gSettings.espnowTelemetryPeer = "";
+  gSettings.espnowTelemetryMs = 1000;
 }
 
 // Minimal JSON encode (no external deps)
@@ -2741,6 +4599,10 @@ String settingsToJson() {
   j += ",\"cliHistorySize\":" + String(gSettings.cliHistorySize);
   j += ",\"ntpServer\":\"" + gSettings.ntpServer + "\"";
   j += ",\"tzOffsetMinutes\":" + String(gSettings.tzOffsetMinutes);
+  j += ",\"passwordKdfIterations\":" + String(gSettings.passwordKdfIterations);
+  j += ",\"httpMaxSockets\":" + String(gSettings.httpMaxSockets);
+  j += ",\"httpLruPurge\":" + String(gSettings.httpLruPurge ? 1 : 0);
+  j += ",\"httpWorkers\":" + String(gSettings.httpWorkers);
   // Grouped sections only (no duplicate top-level keys)
   j += ",\"output\":{"
        "\"outSerial\":"
@@ -2819,8 +4681,11 @@ String settingsToJson() {
        + String(gSettings.i2cClockToFHz) + "}}";
   // Un-grouped device-side key(s) that remain top-level
   j += ",\"imuDevicePollMs\":" + String(gSettings.imuDevicePollMs);
+  j += ",\"sensorIdlePollMs\":" + String(gSettings.sensorIdlePollMs);
   // ESP-NOW settings
   j += ",\"espnowenabled\":" + String(gSettings.espnowenabled ? 1 : 0);
+  j += ",\"espnowTelemetryPeer\":\"" + gSettings.espnowTelemetryPeer + "\"";
+  j += ",\"espnowTelemetryMs\":" + String(gSettings.espnowTelemetryMs);
   // Embed multi-SSID list (authoritative store). Includes passwords.
   j += ",\"wifiNetworks\":[";
   for (int i = 0; i < gWifiNetworkCount; ++i) {
@@ -3066,8 +4931,13 @@ static bool loadUnifiedSettings() {
   parseJsonInt(txt, "cliHistorySize", gSettings.cliHistorySize);
   parseJsonString(txt, "ntpServer", gSettings.ntpServer);
   parseJsonInt(txt, "tzOffsetMinutes", gSettings.tzOffsetMinutes);
+  parseJsonInt(txt, "passwordKdfIterations", gSettings.passwordKdfIterations);
+  parseJsonInt(txt, "httpMaxSockets", gSettings.httpMaxSockets);
+  parseJsonBool(txt, "httpLruPurge", gSettings.httpLruPurge);
+  parseJsonInt(txt, "httpWorkers", gSettings.httpWorkers);
   // Legacy flat keys removed: rely on grouped objects only
   parseJsonInt(txt, "imuDevicePollMs", gSettings.imuDevicePollMs);
+  parseJsonInt(txt, "sensorIdlePollMs", gSettings.sensorIdlePollMs);
   // Debug settings
   parseJsonBool(txt, "debugAuthCookies", gSettings.debugAuthCookies);
   parseJsonBool(txt, "debugHttp", gSettings.debugHttp);
@@ -3084,6 +4954,8 @@ static bool loadUnifiedSettings() {
   parseJsonBool(txt, "debugUsers", gSettings.debugUsers);
   // ESP-NOW settings
   parseJsonBool(txt, "espnowenabled", gSettings.espnowenabled);
+  parseJsonString(txt, "espnowTelemetryPeer", gSettings.espnowTelemetryPeer);
+  parseJsonInt(txt, "espnowTelemetryMs", gSettings.espnowTelemetryMs);
   // Load grouped objects (authoritative structure)
   parseOutputFromJson(txt);
   parseThermalFromJson(txt);
@@ -3335,121 +5207,33 @@ static bool connectWiFiSSID(const String& ssid, unsigned long timeoutMs) {
 // Determine if the given username is admin (any user with role == admin)
 bool isAdminUser(const String& who) {
   if (!filesystemReady) return false;
-  // Prefer JSON
-  if (LittleFS.exists(USERS_JSON_FILE)) {
-    String json;
-    if (!readText(USERS_JSON_FILE, json)) return false;
-    int usersIdx = json.indexOf("\"users\"");
-    if (usersIdx < 0) return false;
-    // Find first user to allow legacy-first-admin fallback
-    int firstUKey = json.indexOf("\"username\"", usersIdx);
-    String firstUser = "";
-    if (firstUKey >= 0) {
-      int uq1 = json.indexOf('"', json.indexOf(':', firstUKey) + 1);
-      int uq2 = json.indexOf('"', uq1 + 1);
-      if (uq1 > 0 && uq2 > uq1) firstUser = json.substring(uq1 + 1, uq2);
-    }
-    // Search for target user and role
-    int pos = usersIdx;
-    while (true) {
-      int uKey = json.indexOf("\"username\"", pos);
-      if (uKey < 0) break;
-      int uq1 = json.indexOf('"', json.indexOf(':', uKey) + 1);
-      int uq2 = json.indexOf('"', uq1 + 1);
-      if (uq1 < 0 || uq2 <= uq1) break;
-      String uname = json.substring(uq1 + 1, uq2);
-      int rKey = json.indexOf("\"role\"", uKey);
-      int nextU = json.indexOf("\"username\"", uKey + 1);
-      if (rKey > 0 && (nextU < 0 || rKey < nextU)) {
-        int rq1 = json.indexOf('"', json.indexOf(':', rKey) + 1);
-        int rq2 = json.indexOf('"', rq1 + 1);
-        String role = (rq1 > 0 && rq2 > rq1) ? json.substring(rq1 + 1, rq2) : String("");
-        if (uname == who && role == "admin") return true;
-      }
-      pos = uq2 + 1;
-    }
-    // Fallback: first user without role is admin
-    return (who == firstUser);
-  }
-  // Legacy users.txt
-  if (!LittleFS.exists(USERS_FILE)) return false;
-  String txt;
-  if (!readText(USERS_FILE, txt)) return false;
-  int pos = 0;
-  bool firstUserChecked = false;
-  while (pos < (int)txt.length()) {
-    int nl = txt.indexOf('\n', pos);
-    if (nl < 0) nl = txt.length();
-    String line = txt.substring(pos, nl);
-    pos = nl + 1;
-    line.trim();
-    if (line.length() == 0 || line.startsWith("#")) continue;
-    int c1 = line.indexOf(':');
-    if (c1 <= 0) continue;
-    int c2 = line.indexOf(':', c1 + 1);
-    String username = line.substring(0, c1);
-    username.trim();
-    String role = (c2 >= 0) ? line.substring(c2 + 1) : String("");
-    role.trim();
-    if (username == who && role == "admin") return true;
-    if (!firstUserChecked) {
-      if (role.length() == 0 && username == who) return true;
-      firstUserChecked = true;
-    }
-  }
-  return false;
+  if (!userDirAcquire()) return false;
+  int idx = userDirFind(who.c_str(), who.length());
+  bool admin = idx >= 0 && (gUserDir[idx].roles & USER_ROLE_ADMIN);
+  userDirRelease();
+  return admin;
 }
 
-// Validate provided credentials against any entry in users file (username:password[:role])
+// Validate provided credentials against the user directory (users.json or legacy users.txt)
 bool isValidUser(const String& u, const String& p) {
   if (!filesystemReady) return false;
-  // JSON first
-  if (LittleFS.exists(USERS_JSON_FILE)) {
-    String json;
-    if (!readText(USERS_JSON_FILE, json)) return false;
-    int pos = json.indexOf("\"users\"");
-    if (pos < 0) return false;
-    while (true) {
-      int uKey = json.indexOf("\"username\"", pos);
-      if (uKey < 0) break;
-      int uq1 = json.indexOf('"', json.indexOf(':', uKey) + 1);
-      int uq2 = json.indexOf('"', uq1 + 1);
-      if (uq1 < 0 || uq2 <= uq1) break;
-      String uname = json.substring(uq1 + 1, uq2);
-      int pKey = json.indexOf("\"password\"", uKey);
-      int nextU = json.indexOf("\"username\"", uKey + 1);
-      if (pKey > 0 && (nextU < 0 || pKey < nextU)) {
-        int pq1 = json.indexOf('"', json.indexOf(':', pKey) + 1);
-        int pq2 = json.indexOf('"', pq1 + 1);
-        String pass = (pq1 > 0 && pq2 > pq1) ? json.substring(pq1 + 1, pq2) : String("");
-        if (u == uname && verifyUserPassword(p, pass)) return true;
-      }
-      pos = uq2 + 1;
+  if (!userDirAcquire()) return false;
+  int idx = userDirFind(u.c_str(), u.length());
+  // Copy the stored credential so the hash check runs outside the lock
+  String stored = (idx >= 0) ? String(userDirStr(gUserDir[idx].credOff)) : String("");
+  userDirRelease();
+  if (idx < 0 || !verifyUserPassword(p, stored)) return false;
+  // Upgrade legacy/plaintext entries (or a changed iteration count) while the password is at hand
+  if (passwordNeedsRehash(stored) && LittleFS.exists(USERS_JSON_FILE)) {
+    String err;
+    String rehashed = hashUserPassword(p);
+    if (rehashed.length() > 0 && updateUserPasswordInternal(u, stored, rehashed, err)) {
+      DEBUG_USERSF("[users] password for %s migrated to SCRAM$ (%d iterations)", u.c_str(), passwordKdfIterations());
+    } else {
+      DEBUG_USERSF("[users] password migration for %s skipped: %s", u.c_str(), err.c_str());
     }
-    return false;
-  }
-  // Legacy users.txt
-  if (!LittleFS.exists(USERS_FILE)) return false;
-  String txt;
-  if (!readText(USERS_FILE, txt)) return false;
-  int pos = 0;
-  while (pos < (int)txt.length()) {
-    int eol = txt.indexOf('\n', pos);
-    if (eol < 0) eol = txt.length();
-    String line = txt.substring(pos, eol);
-    pos = eol + 1;
-    line.trim();
-    if (line.length() == 0 || line[0] == '#') continue;
-    int c1 = line.indexOf(':');
-    if (c1 <= 0) continue;
-    int c2 = line.indexOf(':', c1 + 1);
-    String lu = line.substring(0, c1);
-    lu.trim();
-    String lp = (c2 >= 0) ? line.substring(c1 + 1, c2) : line.substring(c1 + 1);
-    lp.trim();
-    if (u == lu && verifyUserPassword(p, lp)) return true;
   }
-  return false;
+  return true;
 }
 
 String waitForSerialInput(unsigned long timeoutMs) {
@@ -3509,7 +5293,7 @@ void firstTimeSetupIfNeeded() {
   // Create users.json with admin (ID 1) and nextId field - hash the password
   String hashedPassword = hashUserPassword(p);
   String j = "{\n  \"version\": 1,\n  \"nextId\": 2,\n  \"users\": [\n    {\n      \"id\": 1,\n      \"username\": \"" + u + "\",\n      \"password\": \"" + hashedPassword + "\",\n      \"role\": \"admin\"\n    }\n  ]\n}\n";
-  if (!writeText(USERS_JSON_FILE, j)) {
+  if (!writeUsersJson(j)) {
     broadcastOutput("ERROR: Failed to write users.json");
   } else {
     broadcastOutput("Saved /users.json");
@@ -3615,43 +5399,240 @@ static String decryptWifiPassword(const String& encryptedPassword) {
 }
 
 // ==========================
-// User Password Hashing (SHA-256 with device-specific salt)
+// User Password Hashing (PBKDF2-HMAC-SHA256 with per-user salt)
 // ==========================
+// Stored form: SCRAM$<iterations>$<salt hex>$<stored key hex>, where the stored
+// key is SHA-256(HMAC(PBKDF2 key, "Client Key")) as in SCRAM (RFC 5802). It
+// verifies a password but, unlike the PBKDF2 key itself, cannot answer an
+// "espnow login" challenge. Entries written by older firmware (PBKDF2$ with the
+// raw derived key, "HASH:" 32-bit hash, or plaintext) still verify and are
+// re-hashed on the next successful login (see isValidUser).
+
+static const char* kPasswordScramPrefix = "SCRAM$";
+static const char* kPasswordKdfPrefix = "PBKDF2$";  // legacy: raw derived key
+static const int kPasswordSaltBytes = 16;
+static const int kPasswordKeyBytes = 32;
+static const int kPasswordKdfMinIterations = 1000;
+static const int kPasswordKdfMaxIterations = 200000;
+
+static int passwordKdfIterations() {
+  int it = gSettings.passwordKdfIterations;
+  if (it < kPasswordKdfMinIterations) it = kPasswordKdfMinIterations;
+  if (it > kPasswordKdfMaxIterations) it = kPasswordKdfMaxIterations;
+  return it;
+}
+
+static bool passwordKdf(const String& password, const uint8_t* salt, size_t saltLen, uint32_t iterations, uint8_t* out) {
+#if MBEDTLS_VERSION_NUMBER >= 0x03030000
+  return mbedtls_pkcs5_pbkdf2_hmac_ext(MBEDTLS_MD_SHA256, (const uint8_t*)password.c_str(), password.length(),
+                                       salt, saltLen, iterations, kPasswordKeyBytes, out) == 0;
+#else
+  const mbedtls_md_info_t* info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+  if (!info) return false;
+  mbedtls_md_context_t md;
+  mbedtls_md_init(&md);
+  int rc = mbedtls_md_setup(&md, info, 1);
+  if (rc == 0) {
+    rc = mbedtls_pkcs5_pbkdf2_hmac(&md, (const uint8_t*)password.c_str(), password.length(),
+                                   salt, saltLen, iterations, kPasswordKeyBytes, out);
+  }
+  mbedtls_md_free(&md);
+  return rc == 0;
+#endif
+}
 
-static String hashUserPassword(const String& password) {
-  if (password.length() == 0) return "";
-  
-  String salt = getDeviceEncryptionKey(); // Use same device-specific key as salt
+static void passwordHexEncode(const uint8_t* in, size_t n, char* out) {
+  static const char* kHex = "0123456789abcdef";
+  for (size_t i = 0; i < n; ++i) {
+    out[i * 2] = kHex[in[i] >> 4];
+    out[i * 2 + 1] = kHex[in[i] & 0x0F];
+  }
+  out[n * 2] = '\0';
+}
+
+static bool passwordHexDecode(const char* in, size_t hexLen, uint8_t* out, size_t n) {
+  if (hexLen != n * 2) return false;
+  for (size_t i = 0; i < hexLen; ++i) {
+    char c = in[i];
+    uint8_t v;
+    if (c >= '0' && c <= '9') v = c - '0';
+    else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+    else return false;
+    if (i & 1) out[i / 2] |= v;
+    else out[i / 2] = v << 4;
+  }
+  return true;
+}
+
+// ClientKey = HMAC(PBKDF2 key, "Client Key"); StoredKey = SHA-256(ClientKey)
+static bool passwordScramKeys(const uint8_t* kdfKey, uint8_t* clientKey, uint8_t* storedKey) {
+  const mbedtls_md_info_t* info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+  return info
+         && mbedtls_md_hmac(info, kdfKey, kPasswordKeyBytes, (const uint8_t*)"Client Key", 10, clientKey) == 0
+         && mbedtls_md(info, clientKey, kPasswordKeyBytes, storedKey) == 0;
+}
+
+// Splits a stored SCRAM$ or PBKDF2$ credential (per prefix) into its parts
+static bool parsePasswordKdf(const String& stored, const char* prefix, uint32_t& iterations, uint8_t* salt, uint8_t* key) {
+  if (!stored.startsWith(prefix)) return false;
+  int p1 = strlen(prefix);
+  int p2 = stored.indexOf('$', p1);
+  int p3 = (p2 > p1) ? stored.indexOf('$', p2 + 1) : -1;
+  if (p2 <= p1 || p3 < 0) return false;
+  long it = stored.substring(p1, p2).toInt();
+  if (it < 1 || it > kPasswordKdfMaxIterations) return false;
+  iterations = (uint32_t)it;
+  const char* s = stored.c_str();
+  return passwordHexDecode(s + p2 + 1, p3 - p2 - 1, salt, kPasswordSaltBytes)
+         && passwordHexDecode(s + p3 + 1, stored.length() - p3 - 1, key, kPasswordKeyBytes);
+}
+
+// Pre-PBKDF2 format: 32-bit multiply/xor hash salted with the chip ID
+static String legacyHashUserPassword(const String& password) {
+  String salt = getDeviceEncryptionKey();
   String saltedPassword = password + salt;
-  
-  // Simple hash implementation using built-in hash function
-  // Note: For production, consider using a more robust hash like SHA-256
   uint32_t hash = 0;
   for (int i = 0; i < saltedPassword.length(); i++) {
     hash = hash * 31 + (uint8_t)saltedPassword[i];
     hash ^= (hash >> 16);
   }
-  
-  // Convert to hex string for storage
   String hashStr = String(hash, HEX);
-  while (hashStr.length() < 8) hashStr = "0" + hashStr; // Pad to 8 chars
-  
-  return "HASH:" + hashStr; // Prefix to identify hashed passwords
+  while (hashStr.length() < 8) hashStr = "0" + hashStr;
+  return "HASH:" + hashStr;
+}
+
+static String hashUserPassword(const String& password) {
+  if (password.length() == 0) return "";
+  uint8_t salt[kPasswordSaltBytes];
+  uint8_t kdfKey[kPasswordKeyBytes];
+  uint8_t clientKey[kPasswordKeyBytes];
+  uint8_t key[kPasswordKeyBytes];
+  esp_fill_random(salt, sizeof(salt));
+  int iterations = passwordKdfIterations();
+  bool ok = passwordKdf(password, salt, sizeof(salt), iterations, kdfKey)
+            && passwordScramKeys(kdfKey, clientKey, key);
+  memset(kdfKey, 0, sizeof(kdfKey));
+  memset(clientKey, 0, sizeof(clientKey));
+  if (!ok) return "";
+  char saltHex[kPasswordSaltBytes * 2 + 1];
+  char keyHex[kPasswordKeyBytes * 2 + 1];
+  passwordHexEncode(salt, sizeof(salt), saltHex);
+  passwordHexEncode(key, sizeof(key), keyHex);
+  return String(kPasswordScramPrefix) + String(iterations) + "$" + saltHex + "$" + keyHex;
+}
+
+// True when a stored credential should be re-hashed with the current KDF settings
+static bool passwordNeedsRehash(const String& stored) {
+  uint32_t iterations;
+  uint8_t salt[kPasswordSaltBytes];
+  uint8_t key[kPasswordKeyBytes];
+  if (!parsePasswordKdf(stored, kPasswordScramPrefix, iterations, salt, key)) return true;
+  return iterations != (uint32_t)passwordKdfIterations();
+}
+
+// -------- Password verification cache --------
+// Successful verifications are remembered for a while so repeated logins and
+// REMOTE: commands skip the KDF. Entries are keyed by SHA-256 over the stored
+// credential and the candidate password, so a changed or migrated credential
+// never matches an old entry. Failures are never cached.
+struct PasswordCacheEntry {
+  uint8_t key[32];
+  unsigned long validUntil;
+  unsigned long lastUsed;
+  bool used;
+};
+static const int kPasswordCacheSlots = 8;
+static const unsigned long kPasswordCacheTtlMs = 10UL * 60UL * 1000UL;
+static PasswordCacheEntry gPasswordCache[kPasswordCacheSlots];
+static portMUX_TYPE gPasswordCacheMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void passwordCacheKey(const String& input, const String& stored, uint8_t* out) {
+  mbedtls_sha256_context sha;
+  mbedtls_sha256_init(&sha);
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+  mbedtls_sha256_starts(&sha, 0);
+  mbedtls_sha256_update(&sha, (const uint8_t*)stored.c_str(), stored.length() + 1);  // include NUL as separator
+  mbedtls_sha256_update(&sha, (const uint8_t*)input.c_str(), input.length());
+  mbedtls_sha256_finish(&sha, out);
+#else
+  mbedtls_sha256_starts_ret(&sha, 0);
+  mbedtls_sha256_update_ret(&sha, (const uint8_t*)stored.c_str(), stored.length() + 1);
+  mbedtls_sha256_update_ret(&sha, (const uint8_t*)input.c_str(), input.length());
+  mbedtls_sha256_finish_ret(&sha, out);
+#endif
+  mbedtls_sha256_free(&sha);
+}
+
+static bool passwordCacheLookup(const uint8_t* key) {
+  unsigned long now = millis();
+  bool hit = false;
+  portENTER_CRITICAL(&gPasswordCacheMux);
+  for (int i = 0; i < kPasswordCacheSlots; ++i) {
+    PasswordCacheEntry& e = gPasswordCache[i];
+    if (!e.used || memcmp(e.key, key, sizeof(e.key)) != 0) continue;
+    if ((long)(e.validUntil - now) <= 0) {
+      e.used = false;
+      break;
+    }
+    e.lastUsed = now;
+    hit = true;
+    break;
+  }
+  portEXIT_CRITICAL(&gPasswordCacheMux);
+  return hit;
+}
+
+static void passwordCacheStore(const uint8_t* key) {
+  unsigned long now = millis();
+  portENTER_CRITICAL(&gPasswordCacheMux);
+  int victim = 0;
+  for (int i = 0; i < kPasswordCacheSlots; ++i) {
+    if (!gPasswordCache[i].used) {
+      victim = i;
+      break;
+    }
+    if (gPasswordCache[i].lastUsed < gPasswordCache[victim].lastUsed) victim = i;
+  }
+  PasswordCacheEntry& e = gPasswordCache[victim];
+  memcpy(e.key, key, sizeof(e.key));
+  e.validUntil = now + kPasswordCacheTtlMs;
+  e.lastUsed = now;
+  e.used = true;
+  portEXIT_CRITICAL(&gPasswordCacheMux);
 }
 
 static bool verifyUserPassword(const String& inputPassword, const String& storedHash) {
   if (inputPassword.length() == 0 || storedHash.length() == 0) return false;
-  
-  // If stored password doesn't start with HASH:, it's plaintext (backward compatibility)
-  if (!storedHash.startsWith("HASH:")) {
-    // For migration period, allow plaintext comparison
-    // TODO: Remove this after all passwords are migrated
-    return (inputPassword == storedHash);
+
+  uint8_t cacheKey[32];
+  passwordCacheKey(inputPassword, storedHash, cacheKey);
+  if (passwordCacheLookup(cacheKey)) return true;
+
+  bool ok = false;
+  uint32_t iterations;
+  uint8_t salt[kPasswordSaltBytes];
+  uint8_t expect[kPasswordKeyBytes];
+  bool scram = storedHash.startsWith(kPasswordScramPrefix);
+  if (scram || storedHash.startsWith(kPasswordKdfPrefix)) {
+    uint8_t got[kPasswordKeyBytes];
+    uint8_t clientKey[kPasswordKeyBytes];
+    if (parsePasswordKdf(storedHash, scram ? kPasswordScramPrefix : kPasswordKdfPrefix, iterations, salt, expect)
+        && passwordKdf(inputPassword, salt, sizeof(salt), iterations, got)
+        && (!scram || passwordScramKeys(got, clientKey, got))) {
+      uint8_t diff = 0;  // constant-time compare
+      for (int i = 0; i < kPasswordKeyBytes; ++i) diff |= got[i] ^ expect[i];
+      ok = (diff == 0);
+    }
+    memset(clientKey, 0, sizeof(clientKey));
+  } else if (storedHash.startsWith("HASH:")) {
+    ok = (legacyHashUserPassword(inputPassword) == storedHash);
+  } else {
+    // Plaintext from before hashing existed; migrated on the next login
+    ok = (inputPassword == storedHash);
   }
-  
-  // Hash the input password and compare
-  String inputHash = hashUserPassword(inputPassword);
-  return (inputHash == storedHash);
+  if (ok) passwordCacheStore(cacheKey);
+  return ok;
 }
 
 // Test command for encryption (temporary - for verification)
@@ -3934,23 +5915,181 @@ struct SessionEntry {
   bool needsStatusUpdate = false;  // flag to trigger status refresh on next request
   int sockfd = -1;                 // socket file descriptor for force disconnect
   bool revoked = false;            // session has been revoked but kept alive for notice delivery
+  uint8_t token[16] = { 0 };       // binary form of sid (32 hex chars), key of gSessIndex
 };
 
 // Forward declarations for SSE notice helpers (avoid Arduino autoproto issues)
 static inline void sseEnqueueNotice(SessionEntry& s, const String& msg);
 static inline bool sseDequeueNotice(SessionEntry& s, String& out);
+static bool sseSessionIs(int idx, const uint8_t* tok);
+static bool sseTakeNotice(int idx, const uint8_t* tok, String& out);
+
+static const int MAX_SESSIONS = 12;
+static SessionEntry* gSessions = nullptr;
+
+// Open-addressing SID index: lookups probe on the binary 128-bit token instead of
+// comparing String SIDs across every slot. Each slot holds a session index, or
+// empty/deleted markers; deleted markers are swept whenever sessions are pruned.
+static const int kSessIndexCap = 32;  // power of two, at least 2 * MAX_SESSIONS
+static const int16_t kSessSlotEmpty = -1;
+static const int16_t kSessSlotDeleted = -2;
+static int16_t gSessIndex[kSessIndexCap];
+
+// Auth cache for high-frequency endpoints: a few (token, ip) -> session entries
+// with LRU replacement, so several tabs/clients don't evict each other
+struct AuthCacheEntry {
+  uint8_t token[16];
+  int16_t sessIdx;  // -1 = unused
+  unsigned long validUntil;
+  unsigned long lastUsed;
+  char ip[48];
+};
+static const int kAuthCacheSlots = 8;
+static const unsigned long kAuthCacheTtlMs = 30000;
+static AuthCacheEntry gAuthCache[kAuthCacheSlots];
+
+// Session table lock. HTTP workers (handleHttpAsync) authenticate and bind SSE
+// sessions off the server task, so the auth/session entry points take this.
+// Recursive because those paths call one another.
+static SemaphoreHandle_t gSessionMutex = nullptr;
+struct SessionLock {
+  SessionLock() { if (gSessionMutex) xSemaphoreTakeRecursive(gSessionMutex, portMAX_DELAY); }
+  ~SessionLock() { if (gSessionMutex) xSemaphoreGiveRecursive(gSessionMutex); }
+};
+
+// Parses a 32-hex-char SID into its 16-byte token
+static bool sessParseToken(const char* sid, size_t len, uint8_t* out) {
+  if (len != 32) return false;
+  for (int i = 0; i < 16; ++i) {
+    uint8_t b = 0;
+    for (int k = 0; k < 2; ++k) {
+      char c = sid[i * 2 + k];
+      uint8_t v;
+      if (c >= '0' && c <= '9') v = c - '0';
+      else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+      else return false;
+      b = (uint8_t)((b << 4) | v);
+    }
+    out[i] = b;
+  }
+  return true;
+}
+
+static inline uint32_t sessTokenHash(const uint8_t* tok) {
+  // Leading 96 bits of the token come from esp_random(), so any word hashes well
+  uint32_t h;
+  memcpy(&h, tok, sizeof(h));
+  return h;
+}
+
+static int sessIndexFind(const uint8_t* tok) {
+  uint32_t h = sessTokenHash(tok);
+  for (int n = 0; n < kSessIndexCap; ++n) {
+    int16_t v = gSessIndex[(h + n) & (kSessIndexCap - 1)];
+    if (v == kSessSlotEmpty) return -1;
+    if (v >= 0 && gSessions[v].sid.length() && memcmp(gSessions[v].token, tok, 16) == 0) return v;
+  }
+  return -1;
+}
+
+static void sessIndexInsert(int idx) {
+  uint32_t h = sessTokenHash(gSessions[idx].token);
+  for (int n = 0; n < kSessIndexCap; ++n) {
+    int16_t& slot = gSessIndex[(h + n) & (kSessIndexCap - 1)];
+    if (slot < 0) {
+      slot = (int16_t)idx;
+      return;
+    }
+  }
+}
+
+static void sessIndexRemove(int idx) {
+  uint32_t h = sessTokenHash(gSessions[idx].token);
+  for (int n = 0; n < kSessIndexCap; ++n) {
+    int16_t& slot = gSessIndex[(h + n) & (kSessIndexCap - 1)];
+    if (slot == kSessSlotEmpty) return;
+    if (slot == idx) {
+      slot = kSessSlotDeleted;
+      return;
+    }
+  }
+}
+
+static void sessIndexRebuild() {
+  for (int i = 0; i < kSessIndexCap; ++i) gSessIndex[i] = kSessSlotEmpty;
+  for (int i = 0; i < MAX_SESSIONS; ++i) {
+    if (gSessions[i].sid.length()) sessIndexInsert(i);
+  }
+}
+
+static void authCacheClear() {
+  for (int i = 0; i < kAuthCacheSlots; ++i) gAuthCache[i].sessIdx = -1;
+}
+
+static void authCacheDropSession(int idx) {
+  for (int i = 0; i < kAuthCacheSlots; ++i) {
+    if (gAuthCache[i].sessIdx == idx) gAuthCache[i].sessIdx = -1;
+  }
+}
+
+// Returns the cached session index for (token, ip), or -1. Hits are re-checked
+// against the live session so revocation/expiry take effect immediately.
+static int authCacheLookup(const uint8_t* tok, const String& ip, unsigned long now) {
+  for (int i = 0; i < kAuthCacheSlots; ++i) {
+    AuthCacheEntry& c = gAuthCache[i];
+    if (c.sessIdx < 0 || memcmp(c.token, tok, 16) != 0) continue;
+    if ((long)(now - c.validUntil) >= 0 || strcmp(c.ip, ip.c_str()) != 0) return -1;
+    const SessionEntry& s = gSessions[c.sessIdx];
+    if (!s.sid.length() || s.revoked || memcmp(s.token, tok, 16) != 0) return -1;
+    if (s.expiresAt > 0 && (long)(now - s.expiresAt) >= 0) return -1;
+    c.lastUsed = now;
+    return c.sessIdx;
+  }
+  return -1;
+}
 
-static const int MAX_SESSIONS = 12;
-static SessionEntry* gSessions = nullptr;
+static void authCacheStore(const uint8_t* tok, const String& ip, int sessIdx, unsigned long now) {
+  if (sessIdx < 0 || ip.length() >= sizeof(gAuthCache[0].ip)) return;
+  int victim = 0;
+  for (int i = 0; i < kAuthCacheSlots; ++i) {
+    AuthCacheEntry& c = gAuthCache[i];
+    if (c.sessIdx >= 0 && memcmp(c.token, tok, 16) == 0) {
+      victim = i;  // refresh in place
+      break;
+    }
+    if (c.sessIdx < 0) {
+      victim = i;
+    } else if (gAuthCache[victim].sessIdx >= 0 && (long)(c.lastUsed - gAuthCache[victim].lastUsed) < 0) {
+      victim = i;
+    }
+  }
+  AuthCacheEntry& c = gAuthCache[victim];
+  memcpy(c.token, tok, 16);
+  c.sessIdx = (int16_t)sessIdx;
+  c.validUntil = now + kAuthCacheTtlMs;
+  c.lastUsed = now;
+  strncpy(c.ip, ip.c_str(), sizeof(c.ip) - 1);
+  c.ip[sizeof(c.ip) - 1] = '\0';
+}
 
-// Auth cache for high-frequency endpoints
-struct AuthCache {
-  String sessionId;
-  String user;
-  unsigned long validUntil;
-  String ip;
-};
-static AuthCache gAuthCache = { "", "", 0, "" };
+// Clears a session slot, keeping the SID index and auth cache consistent
+static void sessionClearSlot(int idx) {
+  if (idx < 0 || idx >= MAX_SESSIONS) return;
+  if (gSessions[idx].sid.length()) sessIndexRemove(idx);
+  authCacheDropSession(idx);
+  gSessions[idx] = SessionEntry();
+}
+
+// Stores a new session in slot idx and indexes it by token
+static void sessionInstall(int idx, const SessionEntry& s) {
+  sessionClearSlot(idx);
+  gSessions[idx] = s;
+  if (!sessParseToken(s.sid.c_str(), s.sid.length(), gSessions[idx].token)) {
+    memset(gSessions[idx].token, 0, sizeof(gSessions[idx].token));
+  }
+  sessIndexInsert(idx);
+}
 
 // Temporary logout reason storage (IP-based, expires after 60 seconds)
 struct LogoutReason {
@@ -4136,11 +6275,10 @@ esp_err_t handleSystemStatus(httpd_req_t* req) {
 }
 
 static int findSessionIndexBySID(const String& sid) {
-  if (sid.length() == 0) return -1;
-  for (int i = 0; i < MAX_SESSIONS; ++i) {
-    if (gSessions[i].sid == sid) return i;
-  }
-  return -1;
+  SessionLock lock;
+  uint8_t tok[16];
+  if (!sessParseToken(sid.c_str(), sid.length(), tok)) return -1;
+  return sessIndexFind(tok);
 }
 
 static int findFreeSessionIndex() {
@@ -4160,6 +6298,7 @@ static int findFreeSessionIndex() {
 }
 
 static void pruneExpiredSessions() {
+  SessionLock lock;
   static unsigned long lastPrune = 0;
   unsigned long now = millis();
 
@@ -4169,72 +6308,53 @@ static void pruneExpiredSessions() {
 
   for (int i = 0; i < MAX_SESSIONS; ++i) {
     if (gSessions[i].sid.length() && gSessions[i].expiresAt > 0 && (long)(now - gSessions[i].expiresAt) >= 0) {
-      gSessions[i] = SessionEntry();
+      sessionClearSlot(i);
     }
   }
+  sessIndexRebuild();  // sweep deleted markers so probe chains stay short
 }
 
-static String getCookieSID(httpd_req_t* req) {
-  size_t hdr_len = httpd_req_get_hdr_value_len(req, "Cookie");
-  if (hdr_len == 0) {
-    DEBUG_AUTHF("No Cookie header for URI: %s", req->uri);
-    return "";
-  }
-  if (hdr_len > 2048) {
-    DEBUG_AUTHF("Cookie header unusually large (%d bytes) – capping read to 2048", hdr_len);
-    hdr_len = 2048;
-  }
-  // Read into a PSRAM buffer to avoid heap allocations and also avoid large stack usage
-  static char* cookieBuf = nullptr;
-  if (!cookieBuf) {
-    cookieBuf = (char*)ps_alloc(2049, AllocPref::PreferPSRAM, "cookie.buf");
-    if (!cookieBuf) return "";
-  }
-  if (httpd_req_get_hdr_value_str(req, "Cookie", cookieBuf, 2049) != ESP_OK) {
-    DEBUG_AUTHF("Failed to get Cookie header for URI: %s", req->uri);
-    return "";
-  }
-  // Trim leading spaces
-  char* p = cookieBuf;
-  while (*p == ' ' || *p == '\t') ++p;
-  // Find "session=" token
-  const char key[] = "session=";
-  const size_t klen = sizeof(key) - 1;
-  char* s = p;
-  char* sidStart = nullptr;
-  while (*s) {
-    if (strncmp(s, key, klen) == 0) {
-      sidStart = s + klen;
-      break;
-    }
-    // advance to next token (semicolon-separated), but also check every position for robustness
-    ++s;
+// Reads the "session" cookie value into buf (stack sized for a 32-hex SID)
+static bool readSessionCookie(httpd_req_t* req, char* buf, size_t bufSize) {
+  size_t len = bufSize;
+  esp_err_t rc = httpd_req_get_cookie_val(req, "session", buf, &len);
+  if (rc == ESP_ERR_NOT_FOUND) {
+    DEBUG_AUTHF("No session cookie for URI: %s", req->uri);
+    return false;
   }
-  if (!sidStart) {
-    DEBUG_AUTHF("No session cookie found");
-    return "";
+  if (rc != ESP_OK) {
+    DEBUG_AUTHF("Unusable session cookie (rc=%d) for URI: %s", (int)rc, req->uri);
+    return false;
   }
-  // Find end of value (semicolon or end)
-  char* sidEnd = sidStart;
-  while (*sidEnd && *sidEnd != ';') ++sidEnd;
-  // Create String from the exact slice by temporarily NUL-terminating
-  char saved = *sidEnd;
-  *sidEnd = '\0';
-  String sid = String(sidStart);
-  *sidEnd = saved;
-  return sid;
+  return true;
+}
+
+static String getCookieSID(httpd_req_t* req) {
+  char buf[48];
+  if (!readSessionCookie(req, buf, sizeof(buf))) return "";
+  return String(buf);
+}
+
+// Allocation-free variant for the auth hot path. present=true if a session
+// cookie was sent at all; returns true only if it parsed as a token.
+static bool getCookieSessionToken(httpd_req_t* req, uint8_t* tok, bool& present) {
+  char buf[48];
+  present = readSessionCookie(req, buf, sizeof(buf));
+  return present && sessParseToken(buf, strlen(buf), tok);
 }
 
 // Helper: enqueue a targeted revoke notice for a specific session index.
 // Marks session for revocation and sends notice to client for popup/redirect.
 // Session will be cleared on next auth check or after notice delivery.
 static void enqueueTargetedRevokeForSessionIdx(int idx, const String& reasonMsg) {
+  SessionLock lock;
   if (idx < 0 || idx >= MAX_SESSIONS) return;
   if (gSessions[idx].sid.length() == 0) return;
   String msg = String("[revoke] ") + (reasonMsg.length() ? reasonMsg : String("Your session has been signed out by an administrator."));
   
   // Mark session as revoked but keep it alive for notice delivery
   gSessions[idx].revoked = true;
+  authCacheDropSession(idx);
   gSessions[idx].notice = msg;
   // Set grace period for SSE delivery (30 seconds from now)
   gSessions[idx].expiresAt = millis() + 30000UL;
@@ -4245,27 +6365,27 @@ static void enqueueTargetedRevokeForSessionIdx(int idx, const String& reasonMsg)
 
 // Cached auth check for high-frequency endpoints (sensors)
 static bool isAuthedCached(httpd_req_t* req, String& outUser) {
+  SessionLock lock;
   String ip;
   getClientIP(req, ip);
-  String sid = getCookieSID(req);
+  uint8_t tok[16];
+  bool present = false;
+  bool haveTok = getCookieSessionToken(req, tok, present);
   unsigned long now = millis();
 
   // Check cache first (valid for 30 seconds)
-  if (gAuthCache.sessionId == sid && gAuthCache.ip == ip && now < gAuthCache.validUntil && gAuthCache.sessionId.length() > 0) {
-    outUser = gAuthCache.user;
-    return true;
+  if (haveTok) {
+    int idx = authCacheLookup(tok, ip, now);
+    if (idx >= 0) {
+      outUser = gSessions[idx].user;
+      return true;
+    }
   }
 
   // Full auth check on cache miss
   bool result = isAuthed(req, outUser);
-  if (result) {
-    gAuthCache.sessionId = sid;
-    gAuthCache.user = outUser;
-    gAuthCache.validUntil = now + 30000;  // Cache for 30 seconds
-    gAuthCache.ip = ip;
-  } else {
-    // Clear cache on auth failure
-    gAuthCache = { "", "", 0, "" };
+  if (result && haveTok) {
+    authCacheStore(tok, ip, sessIndexFind(tok), now);
   }
   return result;
 }
@@ -4308,10 +6428,11 @@ static String makeSessToken() {
 }
 
 static String setSession(httpd_req_t* req, const String& u) {
+  SessionLock lock;
   pruneExpiredSessions();
 
   // Clear auth cache to prevent stale authentication
-  gAuthCache = { "", "", 0, "" };
+  authCacheClear();
 
   // Get current client IP to avoid storing logout reason for same IP
   String currentIP;
@@ -4350,7 +6471,7 @@ static String setSession(httpd_req_t* req, const String& u) {
       if (gSessions[i].sockfd >= 0) {
         httpd_sess_trigger_close(server, gSessions[i].sockfd);
       }
-      gSessions[i] = SessionEntry();  // Clear immediately
+      sessionClearSlot(i);  // Clear immediately
     }
   }
 
@@ -4371,7 +6492,7 @@ static String setSession(httpd_req_t* req, const String& u) {
   getClientIP(req, ip);
   s.ip = ip;
   s.sockfd = httpd_req_to_sockfd(req);  // Store socket descriptor for force disconnect
-  gSessions[idx] = s;
+  sessionInstall(idx, s);
   // New session should reconcile UI immediately on next SSE ping
   gSessions[idx].needsStatusUpdate = true;
   gSessions[idx].lastSensorSeqSent = 0;
@@ -4389,28 +6510,32 @@ static String setSession(httpd_req_t* req, const String& u) {
 }
 
 static void clearSession(httpd_req_t* req) {
+  SessionLock lock;
   // Revoke current session by cookie value
   String sid = getCookieSID(req);
   int idx = findSessionIndexBySID(sid);
-  if (idx >= 0) { gSessions[idx] = SessionEntry(); }
+  if (idx >= 0) { sessionClearSlot(idx); }
   // Clear session cookie client-side
   httpd_resp_set_hdr(req, "Set-Cookie", "session=; Path=/; Max-Age=0; HttpOnly; SameSite=Strict");
   broadcastOutput("[auth] clearSession (revoked current if present)");
 }
 
 static bool isAuthed(httpd_req_t* req, String& outUser) {
+  SessionLock lock;
   const char* uri = req && req->uri ? req->uri : "(null)";
   pruneExpiredSessions();
-  String sid = getCookieSID(req);
+  uint8_t tok[16];
+  bool present = false;
+  bool haveTok = getCookieSessionToken(req, tok, present);
   String ip;
   getClientIP(req, ip);
 
-  if (sid.length() == 0) {
+  if (!present) {
     broadcastOutput(String("[auth] no session cookie for uri=") + uri);
     return false;
   }
 
-  int idx = findSessionIndexBySID(sid);
+  int idx = haveTok ? sessIndexFind(tok) : -1;
   if (idx < 0) {
     broadcastOutput(String("[auth] unknown SID for uri=") + uri);
     
@@ -4423,7 +6548,7 @@ static bool isAuthed(httpd_req_t* req, String& outUser) {
       DEBUG_AUTHF("No session found for SID, current boot ID: %s", gBootId.c_str());
       
       // If someone has a session cookie but we have no sessions, it's likely due to a reboot
-      if (sid.length() > 0) {
+      if (present) {
         DEBUG_AUTHF("Client has session cookie but no sessions exist - likely system restart");
         storeLogoutReason(ip, "Your session expired due to a system restart. Please log in again.");
       }
@@ -4432,7 +6557,7 @@ static bool isAuthed(httpd_req_t* req, String& outUser) {
       lastDebugTime = now;
     } else {
       // Still store logout reason but don't spam debug logs
-      if (sid.length() > 0) {
+      if (present) {
         storeLogoutReason(ip, "Your session expired due to a system restart. Please log in again.");
       }
     }
@@ -4466,7 +6591,7 @@ static bool isAuthed(httpd_req_t* req, String& outUser) {
     broadcastOutput(String("[auth] session from previous boot for uri=") + uri);
     storeLogoutReason(ip, "Your session expired due to a system restart. Please log in again.");
     // Clear the stale session
-    gSessions[idx] = SessionEntry();
+    sessionClearSlot(idx);
     return false;
   } else {
     if (ip == lastBootDebugIP && (bootNow - lastBootDebugTime) < 1000) {
@@ -4483,7 +6608,7 @@ static bool isAuthed(httpd_req_t* req, String& outUser) {
   unsigned long now = millis();
   if (gSessions[idx].expiresAt > 0 && (long)(now - gSessions[idx].expiresAt) >= 0) {
     // expired
-    gSessions[idx] = SessionEntry();
+    sessionClearSlot(idx);
     broadcastOutput(String("[auth] expired SID for uri=") + uri);
     return false;
   }
@@ -4522,6 +6647,7 @@ static bool sseWrite(httpd_req_t* req, const char* chunk) {
 }
 
 static int sseBindSession(httpd_req_t* req, String& outSid) {
+  SessionLock lock;
   outSid = getCookieSID(req);
   int idx = findSessionIndexBySID(outSid);
   String ip;
@@ -4548,6 +6674,7 @@ static int sseBindSession(httpd_req_t* req, String& outSid) {
 }
 
 static bool sseSessionAliveAndRefresh(int sessIdx, const String& sid) {
+  SessionLock lock;
   if (sessIdx < 0 || sessIdx >= MAX_SESSIONS) {
     DEBUG_SSEF("Invalid session index: %d", sessIdx);
     return false;
@@ -4704,6 +6831,8 @@ esp_err_t handleEvents(httpd_req_t* req) {
     sseWrite(req, NULL);
     return ESP_OK;
   }
+  uint8_t sessTok[16];
+  if (!sessParseToken(sid.c_str(), sid.length(), sessTok)) memset(sessTok, 0, sizeof(sessTok));
   sseDebug(String("handleEvents: bound session idx=") + String(sessIdx) + ", sid=" + (sid.length() ? sid : "<none>"));
   DEBUG_SSEF("handleEvents: bound session details | idx=%d sid=%s needsStatusUpdate=%d lastSensorSeqSent=%d",
              sessIdx, (sid.length() ? (sid.substring(0, 8) + "...").c_str() : "<none>"),
@@ -4778,16 +6907,19 @@ esp_err_t handleEvents(httpd_req_t* req) {
 
   // Conditional short-hold: only keep connection briefly if there are pending notifications.
   // Otherwise close immediately to minimize interference with sensor loops.
-  bool wantHold = gSessions[sessIdx].needsNotificationTick ||
-                  (gSessions[sessIdx].nqCount > 0) ||
-                  (gSessions[sessIdx].notice.length() > 0);
+  bool wantHold;
+  {
+    SessionLock lock;
+    wantHold = sseSessionIs(sessIdx, sessTok)
+               && (gSessions[sessIdx].needsNotificationTick || (gSessions[sessIdx].nqCount > 0) || (gSessions[sessIdx].notice.length() > 0));
+  }
   if (wantHold) {
     unsigned long holdStart = millis();
     const unsigned long holdMs = 600UL; // shorter hold still catches near-term broadcasts
     while ((long)(millis() - holdStart) < (long)holdMs) {
       String n;
       int sent = 0;
-      while (sseDequeueNotice(gSessions[sessIdx], n)) {
+      while (sseTakeNotice(sessIdx, sessTok, n)) {
         DEBUG_SSEF("SSE notice tick send: %s", n.c_str());
         if (!sseSendNotice(req, n)) {
           DEBUG_SSEF("SSE write failed while sending notice; closing");
@@ -4802,8 +6934,11 @@ esp_err_t handleEvents(httpd_req_t* req) {
   }
 
   // If no more notices queued, clear the flag to allow slower retry
-  if (gSessions[sessIdx].nqCount == 0 && gSessions[sessIdx].notice.length() == 0) {
-    gSessions[sessIdx].needsNotificationTick = false;
+  {
+    SessionLock lock;
+    if (sseSessionIs(sessIdx, sessTok) && gSessions[sessIdx].nqCount == 0 && gSessions[sessIdx].notice.length() == 0) {
+      gSessions[sessIdx].needsNotificationTick = false;
+    }
   }
 
   sseWrite(req, NULL);
@@ -4840,6 +6975,7 @@ void broadcastSensorStatusToAllSessions() {
 }
 
 // ---- Notice queue helpers ----
+// The queue Strings are shared with the HTTP workers: callers hold SessionLock.
 static inline void sseEnqueueNotice(SessionEntry& s, const String& msg) {
   // Prefer queue; fallback to legacy single notice if queue full
   if (s.nqCount < (int)(sizeof(s.noticeQueue) / sizeof(s.noticeQueue[0]))) {
@@ -4868,9 +7004,21 @@ static inline bool sseDequeueNotice(SessionEntry& s, String& out) {
   return false;
 }
 
+// True while slot idx still holds the session with token tok (caller holds SessionLock)
+static bool sseSessionIs(int idx, const uint8_t* tok) {
+  return idx >= 0 && idx < MAX_SESSIONS && gSessions[idx].sid.length() && memcmp(gSessions[idx].token, tok, 16) == 0;
+}
+
+// Pops the next notice for an SSE stream; false once the slot was cleared or reused
+static bool sseTakeNotice(int idx, const uint8_t* tok, String& out) {
+  SessionLock lock;
+  return sseSessionIs(idx, tok) && sseDequeueNotice(gSessions[idx], out);
+}
+
 // Send broadcast notice to all active sessions for popup alerts
 void broadcastNoticeToAllSessions(const String& message) {
   DEBUG_SSEF("Broadcasting notice to all sessions: %s", message.c_str());
+  SessionLock lock;
   for (int i = 0; i < MAX_SESSIONS; i++) {
     if (gSessions[i].sid.length() > 0) {
       sseEnqueueNotice(gSessions[i], message);
@@ -5626,6 +7774,7 @@ static String cmd_session_list(const String& originalCmd) {
 //   session revoke user <username> [reason]
 //   session revoke all [reason]
 static String cmd_session_revoke(const String& originalCmd) {
+  SessionLock lock;
   RETURN_VALID_IF_VALIDATE();
   // Admin check now handled by executeCommand pipeline
 
@@ -5656,7 +7805,7 @@ static String cmd_session_revoke(const String& originalCmd) {
       revoked++;
     }
     // Admin audit broadcast
-    broadcastWithOrigin("admin", gExecIsAdmin ? String("admin") : String(), String(), String("Admin audit: revoked ALL sessions (count=") + String(revoked) + ") reason='" + reason + "'.");
+    broadcastWithOrigin("admin", execState().isAdmin ? String("admin") : String(), String(), String("Admin audit: revoked ALL sessions (count=") + String(revoked) + ") reason='" + reason + "'.");
     return String("Revoked ") + String(revoked) + String(" session(s).");
   }
 
@@ -5678,7 +7827,7 @@ static String cmd_session_revoke(const String& originalCmd) {
     // Admin audit broadcast
     {
       String who = gSessions[idx].user.length() ? gSessions[idx].user : String("(unknown)");
-      broadcastWithOrigin("admin", gExecIsAdmin ? String("admin") : String(), String(), String("Admin audit: revoked session by SID for user '") + who + "' reason='" + reason + "'.");
+      broadcastWithOrigin("admin", execState().isAdmin ? String("admin") : String(), String(), String("Admin audit: revoked session by SID for user '") + who + "' reason='" + reason + "'.");
     }
     return String("Revoked 1 session (sid=") + sid + ")";
   }
@@ -5703,7 +7852,7 @@ static String cmd_session_revoke(const String& originalCmd) {
     }
     if (revoked > 0) {
       // Admin audit broadcast
-      broadcastWithOrigin("admin", gExecIsAdmin ? String("admin") : String(), String(), String("Admin audit: revoked ") + String(revoked) + String(" session(s) for user '") + username + "' reason='" + reason + "'.");
+      broadcastWithOrigin("admin", execState().isAdmin ? String("admin") : String(), String(), String("Admin audit: revoked ") + String(revoked) + String(" session(s) for user '") + username + "' reason='" + reason + "'.");
     }
     if (revoked == 0) return String("No active sessions found for user '") + username + "'.";
     return String("Revoked ") + String(revoked) + String(" session(s) for user '") + username + "'.";
@@ -5927,147 +8076,389 @@ static inline void printToWeb(const String& s) {
 // - afterDelay: Stays enabled after firing, nextAt = now + delayMs
 // - interval: Preserves cadence by adding intervalMs to current nextAt, not current time
 static time_t computeNextRunTime(const String& automationJson, time_t fromTime) {
-  // Parse automation type
-  String type;
-  int typePos = automationJson.indexOf("\"type\"");
-  if (typePos >= 0) {
-    int colon = automationJson.indexOf(':', typePos);
-    int q1 = automationJson.indexOf('"', colon + 1);
-    int q2 = automationJson.indexOf('"', q1 + 1);
-    if (q1 > 0 && q2 > q1) {
-      type = automationJson.substring(q1 + 1, q2);
-      type.toLowerCase();
-    }
-  }
-
-  if (type == "attime") {
-    // Parse time field (HH:MM)
-    String timeStr;
-    int timePos = automationJson.indexOf("\"time\"");
-    if (timePos >= 0) {
-      int colon = automationJson.indexOf(':', timePos);
-      int q1 = automationJson.indexOf('"', colon + 1);
-      int q2 = automationJson.indexOf('"', q1 + 1);
-      if (q1 > 0 && q2 > q1) {
-        timeStr = automationJson.substring(q1 + 1, q2);
-      }
+  // Schedule fields only; shares parsing/scheduling with the pre-parsed table
+  AutoEntry e;
+  autoParseObject(automationJson, 0, automationJson.length(), e, false);
+  return computeNextRunTimeEntry(e, fromTime);
+}
+
+// ----- Automations handlers (relocated after dependencies) -----
+static String cmd_automation_list() {
+  RETURN_VALID_IF_VALIDATE();
+  String json;
+  if (!readText(AUTOMATIONS_JSON_FILE, json)) return "Error: failed to read automations.json";
+  return json;
+}
+
+// -------- Compiled conditions --------
+// Condition text is compiled once into flat terms (sensor, op, constant) grouped
+// into branches, so evaluation is a walk over PODs with no String work. Terms
+// combine with AND/OR (AND binds tighter). A simple "IF <expr> THEN ..." is one
+// branch; an IF/ELSE IF/ELSE chain is one branch per clause plus its action.
+enum CondSensor : uint8_t {
+  COND_SENSOR_UNKNOWN = 0,
+  COND_SENSOR_TEMP,
+  COND_SENSOR_HUMIDITY,  // no humidity source; always false
+  COND_SENSOR_DISTANCE,  // true if ANY valid ToF object matches
+  COND_SENSOR_LIGHT,
+  COND_SENSOR_MOTION,
+  COND_SENSOR_TIME
+};
+
+enum CondOp : uint8_t {
+  COND_OP_NONE = 0,
+  COND_OP_GE,
+  COND_OP_LE,
+  COND_OP_NE,
+  COND_OP_GT,
+  COND_OP_LT,
+  COND_OP_EQ
+};
+
+struct CondTerm {
+  uint32_t peer;    // "PEER:<name>." prefix: cmdHashName(name); 0 = local sensors
+  float value;      // numeric constant
+  int8_t strCode;   // MOTION: 0=NONE 1=DETECTED; TIME: 0..3=MORNING..NIGHT; -1 otherwise
+  uint8_t sensor;   // CondSensor
+  uint8_t op;       // CondOp
+  bool orWithPrev;  // false = AND with the previous term
+};
+
+struct CondBranch {
+  uint32_t actionOff;    // arena offset of the action (automation table only)
+  uint16_t actionStart;  // action span in the compiled (upper-cased) source
+  uint16_t actionEnd;
+  uint16_t termFirst;
+  uint8_t termCount;
+  bool isElse;           // unconditional ELSE clause
+};
+
+static const int kCondMaxTerms = 32;
+static const int kCondMaxBranches = 16;
+
+static const char* const kCondOpText[] = { "", ">=", "<=", "!=", ">", "<", "=" };
+
+// Compiled conditions for the automation table (rebuilt with it)
+static CondTerm* gAutoCondTerms = nullptr;
+static int gAutoCondTermCount = 0;
+static int gAutoCondTermCap = 0;
+static CondBranch* gAutoCondBranches = nullptr;
+static int gAutoCondBranchCount = 0;
+static int gAutoCondBranchCap = 0;
+
+static inline bool condStartsAt(const char* s, int len, int pos, const char* kw) {
+  int n = (int)strlen(kw);
+  return pos >= 0 && pos + n <= len && memcmp(s + pos, kw, n) == 0;
+}
+
+static int condFind(const char* s, int from, int to, const char* kw) {
+  int n = (int)strlen(kw);
+  for (int i = from; i + n <= to; ++i) {
+    if (memcmp(s + i, kw, n) == 0) return i;
+  }
+  return -1;
+}
+
+static inline void condTrim(const char* s, int& a, int& b) {
+  while (a < b && isspace((unsigned char)s[a])) ++a;
+  while (b > a && isspace((unsigned char)s[b - 1])) --b;
+}
+
+static inline bool condSpanIs(const char* s, int a, int b, const char* word) {
+  int n = (int)strlen(word);
+  return b - a == n && memcmp(s + a, word, n) == 0;
+}
+
+// One "SENSOR op VALUE" term from s[a..b); op is the first of >=,<=,!=,>,<,= found past position 0
+static void condCompileTerm(const char* s, int a, int b, CondTerm& t) {
+  t.peer = 0;
+  t.value = 0;
+  t.strCode = -1;
+  t.sensor = COND_SENSOR_UNKNOWN;
+  t.op = COND_OP_NONE;
+  condTrim(s, a, b);
+  int opPos = -1;
+  for (int k = COND_OP_GE; k <= COND_OP_EQ; ++k) {
+    int p = condFind(s, a, b, kCondOpText[k]);
+    if (p > a) {
+      opPos = p;
+      t.op = (uint8_t)k;
+      break;
     }
+  }
+  if (opPos < 0) return;
+
+  int sa = a, sb = opPos;
+  condTrim(s, sa, sb);
+  if (condStartsAt(s, sb, sa, "PEER:")) {
+    // PEER:<name>.<SENSOR> reads that peer's streamed telemetry (encrypted peers only)
+    int dot = sb - 1;
+    while (dot > sa + 5 && s[dot] != '.') --dot;
+    if (dot <= sa + 5) return;
+    t.peer = cmdHashName(s + sa + 5, dot - (sa + 5));
+    if (t.peer == 0) t.peer = 1;
+    sa = dot + 1;
+  }
+  if (condSpanIs(s, sa, sb, "TEMP")) t.sensor = COND_SENSOR_TEMP;
+  else if (condSpanIs(s, sa, sb, "HUMIDITY")) t.sensor = COND_SENSOR_HUMIDITY;
+  else if (condSpanIs(s, sa, sb, "DISTANCE")) t.sensor = COND_SENSOR_DISTANCE;
+  else if (condSpanIs(s, sa, sb, "LIGHT")) t.sensor = COND_SENSOR_LIGHT;
+  else if (condSpanIs(s, sa, sb, "MOTION")) t.sensor = COND_SENSOR_MOTION;
+  else if (condSpanIs(s, sa, sb, "TIME")) t.sensor = COND_SENSOR_TIME;
+
+  int va = opPos + (int)strlen(kCondOpText[t.op]), vb = b;
+  condTrim(s, va, vb);
+  char num[24];
+  int n = vb - va < (int)sizeof(num) - 1 ? vb - va : (int)sizeof(num) - 1;
+  memcpy(num, s + va, n);
+  num[n] = '\0';
+  t.value = (float)atof(num);
+  if (t.sensor == COND_SENSOR_MOTION) {
+    if (condSpanIs(s, va, vb, "NONE")) t.strCode = 0;
+    else if (condSpanIs(s, va, vb, "DETECTED")) t.strCode = 1;
+  } else if (t.sensor == COND_SENSOR_TIME) {
+    if (condSpanIs(s, va, vb, "MORNING")) t.strCode = 0;
+    else if (condSpanIs(s, va, vb, "AFTERNOON")) t.strCode = 1;
+    else if (condSpanIs(s, va, vb, "EVENING")) t.strCode = 2;
+    else if (condSpanIs(s, va, vb, "NIGHT")) t.strCode = 3;
+  }
+}
+
+// Splits s[a..b) on " AND " / " OR " into terms; returns false if out of room
+static bool condCompileExpr(const char* s, int a, int b, CondTerm* terms, int termCap, int& termCount, CondBranch& br) {
+  br.termFirst = (uint16_t)termCount;
+  br.termCount = 0;
+  bool orNext = false;
+  int start = a;
+  for (int i = a; i <= b; ++i) {
+    int kwLen = 0;
+    bool isOr = false;
+    if (i == b) kwLen = -1;
+    else if (condStartsAt(s, b, i, " AND ")) kwLen = 5;
+    else if (condStartsAt(s, b, i, " OR ")) kwLen = 4, isOr = true;
+    if (kwLen == 0) continue;
+    if (termCount >= termCap) return false;
+    CondTerm& t = terms[termCount++];
+    condCompileTerm(s, start, i, t);
+    t.orWithPrev = orNext;
+    br.termCount++;
+    if (kwLen < 0) break;
+    orNext = isOr;
+    start = i + kwLen;
+    i = start - 1;
+  }
+  return true;
+}
+
+// Compiles upper-cased, trimmed condition text. chain=false parses "IF <expr> THEN ..."
+// exactly like the old evaluateCondition; chain=true walks IF/ELSE IF/ELSE clauses
+// like evaluateConditionalChain. Returns the branch count (0 = never true).
+static int condCompile(const char* s, int len, bool chain, CondTerm* terms, int termCap, int& termCount, CondBranch* branches, int branchCap) {
+  termCount = 0;
+  int nb = 0;
+  if (!chain) {
+    int thenPos = condFind(s, 0, len, " THEN ");
+    if (thenPos < 0 || branchCap < 1) return 0;
+    CondBranch& br = branches[0];
+    memset(&br, 0, sizeof(br));
+    if (!condCompileExpr(s, 3 < thenPos ? 3 : thenPos, thenPos, terms, termCap, termCount, br)) return 0;
+    return 1;
+  }
 
-    // Parse optional days field
-    String daysStr;
-    int daysPos = automationJson.indexOf("\"days\"");
-    if (daysPos >= 0) {
-      int colon = automationJson.indexOf(':', daysPos);
-      int q1 = automationJson.indexOf('"', colon + 1);
-      int q2 = automationJson.indexOf('"', q1 + 1);
-      if (q1 > 0 && q2 > q1) {
-        daysStr = automationJson.substring(q1 + 1, q2);
+  int pos = 0;
+  while (pos < len && nb < branchCap) {
+    while (pos < len && s[pos] == ' ') pos++;
+    if (pos >= len) break;
+    bool isIF = condStartsAt(s, len, pos, "IF ");
+    bool isELSEIF = condStartsAt(s, len, pos, "ELSE IF ");
+    bool isELSE = condStartsAt(s, len, pos, "ELSE ");
+    if (isIF || isELSEIF) {
+      int condStart = pos + (isELSEIF ? 8 : 3);
+      int thenPos = condFind(s, condStart, len, " THEN ");
+      if (thenPos < 0) break;  // invalid syntax: nothing past here can run
+      int actionStart = thenPos + 6;
+      int actionEnd = len;
+      for (int i = actionStart; i + 7 < len; i++) {
+        if (condStartsAt(s, len, i, " ELSE IF ") || condStartsAt(s, len, i, " ELSE ")) {
+          actionEnd = i;
+          break;
+        }
       }
+      CondBranch& br = branches[nb];
+      memset(&br, 0, sizeof(br));
+      if (!condCompileExpr(s, condStart, thenPos, terms, termCap, termCount, br)) break;
+      int aa = actionStart, ab = actionEnd;
+      condTrim(s, aa, ab);
+      br.actionStart = (uint16_t)aa;
+      br.actionEnd = (uint16_t)ab;
+      nb++;
+      pos = actionEnd;
+    } else if (isELSE) {
+      CondBranch& br = branches[nb];
+      memset(&br, 0, sizeof(br));
+      br.isElse = true;
+      int aa = pos + 5, ab = len;
+      condTrim(s, aa, ab);
+      br.actionStart = (uint16_t)aa;
+      br.actionEnd = (uint16_t)ab;
+      nb++;
+      break;
+    } else {
+      pos++;
     }
+  }
+  return nb;
+}
 
-    // Validate time format (HH:MM)
-    if (timeStr.length() != 5 || timeStr[2] != ':') return 0;
-    int hour = timeStr.substring(0, 2).toInt();
-    int minute = timeStr.substring(3, 5).toInt();
-    if (hour < 0 || hour > 23 || minute < 0 || minute > 59) return 0;
+static inline bool condCompare(float cur, uint8_t op, float target) {
+  switch (op) {
+    case COND_OP_GT: return cur > target;
+    case COND_OP_LT: return cur < target;
+    case COND_OP_EQ: return fabsf(cur - target) < 0.1f;  // Float equality
+    case COND_OP_GE: return cur >= target;
+    case COND_OP_LE: return cur <= target;
+    case COND_OP_NE: return fabsf(cur - target) >= 0.1f;
+  }
+  return false;
+}
 
-    // Convert fromTime to local time
-    struct tm tmNow;
-    if (!localtime_r(&fromTime, &tmNow)) return 0;
+static inline bool condCompareCode(int cur, uint8_t op, int target) {
+  // Only equality makes sense for string-valued sensors
+  if (op == COND_OP_EQ) return cur == target;
+  if (op == COND_OP_NE) return cur != target;
+  return false;
+}
 
-    // Try today first
-    struct tm tmTarget = tmNow;
-    tmTarget.tm_hour = hour;
-    tmTarget.tm_min = minute;
-    tmTarget.tm_sec = 0;
-    tmTarget.tm_isdst = -1;  // Let system determine DST
-
-    time_t candidateTime = mktime(&tmTarget);
-
-    // If time has passed today, or if we have day restrictions, find next valid day
-    bool needNextDay = (candidateTime <= fromTime);
-
-    // Check day restrictions
-    bool dayMatches = true;
-    if (daysStr.length() > 0) {
-      dayMatches = parseAtTimeMatchDays(daysStr, tmTarget.tm_wday);
-      if (!dayMatches) needNextDay = true;
-    }
-
-    if (needNextDay) {
-      // Search up to 7 days ahead for next valid day
-      for (int dayOffset = 1; dayOffset <= 7; dayOffset++) {
-        tmTarget = tmNow;
-        tmTarget.tm_mday += dayOffset;
-        tmTarget.tm_hour = hour;
-        tmTarget.tm_min = minute;
-        tmTarget.tm_sec = 0;
-        tmTarget.tm_isdst = -1;
-
-        candidateTime = mktime(&tmTarget);
-        if (candidateTime <= fromTime) continue;  // Still in past somehow
-
-        // Check if this day matches our restrictions
-        struct tm tmCheck;
-        if (localtime_r(&candidateTime, &tmCheck)) {
-          if (daysStr.length() == 0 || parseAtTimeMatchDays(daysStr, tmCheck.tm_wday)) {
-            return candidateTime;
-          }
-        }
-      }
-      return 0;  // Couldn't find valid day
-    }
-
-    return candidateTime;
-
-  } else if (type == "afterdelay") {
-    // Parse delayMs field
-    int delayMs = 0;
-    int delayPos = automationJson.indexOf("\"delayMs\"");
-    if (delayPos >= 0) {
-      int colon = automationJson.indexOf(':', delayPos);
-      int comma = automationJson.indexOf(',', colon);
-      int brace = automationJson.indexOf('}', colon);
-      int end = (comma > 0 && (brace < 0 || comma < brace)) ? comma : brace;
-      if (end > colon) {
-        String delayStr = automationJson.substring(colon + 1, end);
-        delayStr.trim();
-        delayMs = delayStr.toInt();
-      }
+// Term against a peer's latest telemetry; missing or stale data is false
+static bool condEvalPeerTerm(const CondTerm& t) {
+  if (!lockSensorCache(pdMS_TO_TICKS(20))) return false;
+  bool met = false;
+  for (uint8_t i = 0; i < kEspNowTelemPeers; ++i) {
+    const EspNowPeerTelemetry& e = gEspNowPeerTelem[i];
+    if (!e.used || e.nameHash != t.peer || millis() - e.rxMs > kEspNowTelemStaleMs) continue;
+    if (t.sensor == COND_SENSOR_TEMP && (e.t.valid & kTelemThermal)) {
+      met = condCompare(e.t.thermAvg / 100.0f, t.op, t.value);
+    } else if (t.sensor == COND_SENSOR_DISTANCE && (e.t.valid & kTelemToF)) {
+      for (int j = 0; j < e.t.tofCount && j < 4 && !met; j++) met = condCompare(e.t.tofMm[j] / 10.0f, t.op, t.value);
     }
+    break;
+  }
+  unlockSensorCache();
+  return met;
+}
 
-    if (delayMs <= 0) return 0;
-    return fromTime + (delayMs / 1000);  // Convert ms to seconds
-
-  } else if (type == "interval") {
-    // Parse intervalMs field
-    int intervalMs = 0;
-    int intervalPos = automationJson.indexOf("\"intervalMs\"");
-    if (intervalPos >= 0) {
-      int colon = automationJson.indexOf(':', intervalPos);
-      int comma = automationJson.indexOf(',', colon);
-      int brace = automationJson.indexOf('}', colon);
-      int end = (comma > 0 && (brace < 0 || comma < brace)) ? comma : brace;
-      if (end > colon) {
-        String intervalStr = automationJson.substring(colon + 1, end);
-        intervalStr.trim();
-        intervalMs = intervalStr.toInt();
+static bool condEvalTerm(const CondTerm& t) {
+  if (t.peer) return condEvalPeerTerm(t);
+  switch (t.sensor) {
+    case COND_SENSOR_TEMP:
+      return condCompare(gSensorCache.thermalAvgTemp, t.op, t.value);
+    case COND_SENSOR_LIGHT:
+      return condCompare((float)gSensorCache.apdsClear, t.op, t.value);
+    case COND_SENSOR_DISTANCE:
+      for (int j = 0; j < gSensorCache.tofTotalObjects && j < 4; j++) {
+        if (gSensorCache.tofObjects[j].valid && condCompare(gSensorCache.tofObjects[j].distance_cm, t.op, t.value)) return true;
       }
+      return false;
+    case COND_SENSOR_MOTION:
+      // Proximity sensor doubles as motion detection
+      return condCompareCode(gSensorCache.apdsProximity > 50 ? 1 : 0, t.op, t.strCode);
+    case COND_SENSOR_TIME: {
+      time_t now = time(nullptr);
+      struct tm tmNow;
+      localtime_r(&now, &tmNow);
+      int hour = tmNow.tm_hour;
+      int code = (hour >= 6 && hour < 12) ? 0 : (hour >= 12 && hour < 18) ? 1 : (hour >= 18) ? 2 : 3;
+      return condCompareCode(code, t.op, t.strCode);
     }
+    default:
+      return false;  // humidity (no sensor) or unknown
+  }
+}
 
-    if (intervalMs <= 0) return 0;
-    return fromTime + (intervalMs / 1000);  // Convert ms to seconds
+// OR of AND-groups, short-circuiting within each group
+static bool condEvalBranch(const CondBranch& br, const CondTerm* terms) {
+  if (br.isElse) return true;
+  if (br.termCount == 0) return false;
+  bool group = true;
+  for (int i = 0; i < br.termCount; ++i) {
+    const CondTerm& t = terms[br.termFirst + i];
+    if (i > 0 && t.orWithPrev) {
+      if (group) return true;
+      group = true;
+    }
+    if (group) group = condEvalTerm(t);
   }
+  return group;
+}
 
-  return 0;  // Unknown type or error
+// Index of the first branch that fires, or -1
+static int condSelectBranch(const CondBranch* branches, int branchCount, const CondTerm* terms) {
+  for (int b = 0; b < branchCount; ++b) {
+    if (condEvalBranch(branches[b], terms)) return b;
+  }
+  return -1;
 }
 
-// ----- Automations handlers (relocated after dependencies) -----
-static String cmd_automation_list() {
-  RETURN_VALID_IF_VALIDATE();
-  String json;
-  if (!readText(AUTOMATIONS_JSON_FILE, json)) return "Error: failed to read automations.json";
-  return json;
+// Compiles every automation's conditions into the shared pools (called on table load)
+static void autoCompileConditions() {
+  gAutoCondTermCount = 0;
+  gAutoCondBranchCount = 0;
+  CondTerm terms[kCondMaxTerms];
+  CondBranch branches[kCondMaxBranches];
+  for (int ai = 0; ai < gAutoTableCount; ++ai) {
+    AutoEntry& e = gAutoTable[ai];
+    e.condFirst = 0;
+    e.condBranchCount = 0;
+    if (e.condKind == AUTO_COND_NONE) continue;
+    String src = autoStr(e.condOff);
+    src.trim();
+    src.toUpperCase();
+    int termCount = 0;
+    int nb = condCompile(src.c_str(), src.length(), e.condKind == AUTO_COND_CHAIN, terms, kCondMaxTerms, termCount, branches, kCondMaxBranches);
+    if (!autoGrow((void**)&gAutoCondTerms, gAutoCondTermCap, gAutoCondTermCount + termCount, sizeof(CondTerm), "auto.cond.terms")
+        || !autoGrow((void**)&gAutoCondBranches, gAutoCondBranchCap, gAutoCondBranchCount + nb, sizeof(CondBranch), "auto.cond.br")) {
+      DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld condition compile: out of memory", e.id);
+      continue;  // no branches -> condition never true
+    }
+    e.condFirst = (uint16_t)gAutoCondBranchCount;
+    e.condBranchCount = (uint8_t)nb;
+    for (int b = 0; b < nb; ++b) {
+      CondBranch br = branches[b];
+      br.termFirst = (uint16_t)(br.termFirst + gAutoCondTermCount);
+      br.actionOff = (e.condKind == AUTO_COND_CHAIN) ? autoArenaAppend(src.c_str() + br.actionStart, br.actionEnd - br.actionStart) : 0;
+      gAutoCondBranches[gAutoCondBranchCount++] = br;
+    }
+    memcpy(gAutoCondTerms + gAutoCondTermCount, terms, termCount * sizeof(CondTerm));
+    gAutoCondTermCount += termCount;
+    DEBUGF(DEBUG_AUTOMATIONS, "[autos] id=%ld condition compiled: branches=%d terms=%d", e.id, nb, termCount);
+  }
+  // Local sensors enabled automations read, so the polling governor keeps them fresh
+  uint8_t mask = 0;
+  for (int ai = 0; ai < gAutoTableCount; ++ai) {
+    const AutoEntry& e = gAutoTable[ai];
+    if (!e.enabled) continue;
+    for (int b = 0; b < e.condBranchCount; ++b) {
+      const CondBranch& br = gAutoCondBranches[e.condFirst + b];
+      for (int i = 0; i < br.termCount; ++i) {
+        const CondTerm& t = gAutoCondTerms[br.termFirst + i];
+        if (t.peer) continue;
+        if (t.sensor == COND_SENSOR_TEMP) mask |= 1 << I2C_DEV_THERMAL;
+        else if (t.sensor == COND_SENSOR_DISTANCE) mask |= 1 << I2C_DEV_TOF;
+      }
+    }
+  }
+  gSensorGovAutoMask = mask;
+}
+
+// Branch index selected by an automation's compiled condition, or -1
+static int autoCondSelect(const AutoEntry& e) {
+  if (e.condBranchCount == 0) return -1;
+  return condSelectBranch(gAutoCondBranches + e.condFirst, e.condBranchCount, gAutoCondTerms);
+}
+
+// Action text of a chain branch picked by autoCondSelect
+static const char* autoCondAction(const AutoEntry& e, int branch) {
+  return autoStr(gAutoCondBranches[e.condFirst + branch].actionOff);
 }
 
 // Validate condition syntax for Phase 1: Simple IF/THEN
@@ -6103,19 +8494,19 @@ static String validateConditionSyntax(const String& condition) {
     return "Missing command after 'THEN'";
   }
   
-  // Validate condition syntax: sensor operator value
+  // Validate condition syntax: sensor operator value, optionally joined with AND / OR
   // Supported: temp>75, temp<65, temp=70, humidity>80, motion=detected, time=morning
-  bool hasOperator = false;
-  String operators[] = {">=", "<=", "!=", ">", "<", "="};
-  for (int i = 0; i < 6; i++) {
-    if (conditionPart.indexOf(operators[i]) > 0) {
-      hasOperator = true;
-      break;
-    }
+  CondTerm terms[kCondMaxTerms];
+  CondBranch br;
+  memset(&br, 0, sizeof(br));
+  int termCount = 0;
+  if (!condCompileExpr(conditionPart.c_str(), 0, conditionPart.length(), terms, kCondMaxTerms, termCount, br)) {
+    return "Condition has too many AND/OR terms";
   }
-  
-  if (!hasOperator) {
-    return "Condition must contain an operator (>, <, =, >=, <=, !=)";
+  for (int i = 0; i < termCount; i++) {
+    if (terms[i].op == COND_OP_NONE) {
+      return "Condition must contain an operator (>, <, =, >=, <=, !=)";
+    }
   }
   
   // Basic validation passed
@@ -6201,7 +8592,8 @@ static String validateConditionalHierarchy(const String& conditions) {
   return "VALID";
 }
 
-// Enhanced conditional chain evaluator
+// Enhanced conditional chain evaluator (compiles per call; the scheduler uses the
+// table's pre-compiled branches instead)
 static String evaluateConditionalChain(const String& chainStr) {
   if (chainStr.length() == 0) return "";
   
@@ -6209,179 +8601,28 @@ static String evaluateConditionalChain(const String& chainStr) {
   input.trim();
   input.toUpperCase();
   
-  int position = 0;
-  
-  while (position < input.length()) {
-    // Skip whitespace
-    while (position < input.length() && input[position] == ' ') position++;
-    if (position >= input.length()) break;
-    
-    // Check for keywords
-    bool isIF = input.substring(position).startsWith("IF ");
-    bool isELSEIF = input.substring(position).startsWith("ELSE IF ");
-    bool isELSE = input.substring(position).startsWith("ELSE ");
-    
-    if (isIF || isELSEIF) {
-      // Extract condition and action
-      int condStart = position + (isELSEIF ? 8 : 3); // Skip "IF " or "ELSE IF "
-      int thenPos = input.indexOf(" THEN ", condStart);
-      if (thenPos < 0) return ""; // Invalid syntax
-      
-      String conditionPart = input.substring(condStart, thenPos);
-      conditionPart.trim();
-      
-      // Find end of action (next IF/ELSE IF/ELSE or end of string)
-      int actionStart = thenPos + 6; // Skip " THEN "
-      int actionEnd = input.length();
-      
-      // Look for next conditional keyword
-      for (int i = actionStart; i < input.length() - 7; i++) {
-        if (input.substring(i).startsWith(" ELSE IF ") || 
-            input.substring(i).startsWith(" ELSE ")) {
-          actionEnd = i;
-          break;
-        }
-      }
-      
-      String action = input.substring(actionStart, actionEnd);
-      action.trim();
-      
-      // Evaluate this condition
-      String fullCondition = "IF " + conditionPart + " THEN dummy";
-      bool conditionMet = evaluateCondition(fullCondition);
-      
-      if (conditionMet) {
-        return action; // Execute this action and stop
-      }
-      
-      position = actionEnd;
-    } else if (isELSE) {
-      // ELSE - always execute
-      int actionStart = position + 5; // Skip "ELSE "
-      String action = input.substring(actionStart);
-      action.trim();
-      return action;
-    } else {
-      position++; // Move forward
-    }
-  }
-  
-  return ""; // No action to execute
+  CondTerm terms[kCondMaxTerms];
+  CondBranch branches[kCondMaxBranches];
+  int termCount = 0;
+  int nb = condCompile(input.c_str(), input.length(), true, terms, kCondMaxTerms, termCount, branches, kCondMaxBranches);
+  int b = condSelectBranch(branches, nb, terms);
+  if (b < 0) return ""; // No action to execute
+  return input.substring(branches[b].actionStart, branches[b].actionEnd);
 }
 
-// Evaluate condition for Phase 1: Simple IF/THEN
+// Evaluate condition for Phase 1: Simple IF/THEN (terms may be joined with AND / OR)
 static bool evaluateCondition(const String& condition) {
   String cond = condition;
   cond.trim();
   cond.toUpperCase();
   
-  // Extract condition part (between IF and THEN)
-  int thenPos = cond.indexOf(" THEN ");
-  if (thenPos < 0) return false; // Invalid syntax
-  
-  String conditionPart = cond.substring(3, thenPos); // Skip "IF "
-  conditionPart.trim();
-  
-  // Parse: sensor operator value
-  String sensor, op, value;
-  int opPos = -1;
-  String operators[] = {">=", "<=", "!=", ">", "<", "="};
-  
-  // Find operator
-  for (int i = 0; i < 6; i++) {
-    opPos = conditionPart.indexOf(operators[i]);
-    if (opPos > 0) {
-      sensor = conditionPart.substring(0, opPos);
-      op = operators[i];
-      value = conditionPart.substring(opPos + op.length());
-      sensor.trim();
-      value.trim();
-      break;
-    }
-  }
-  
-  if (opPos < 0) return false; // No operator found
-  
-  // Get current sensor value
-  float currentValue = 0;
-  bool isNumeric = true;
-  String currentStringValue = "";
-  
-  if (sensor == "TEMP") {
-    currentValue = gSensorCache.thermalAvgTemp;
-  } else if (sensor == "HUMIDITY") {
-    // No humidity sensor in this cache, return error
-    DEBUGF(DEBUG_CLI | DEBUG_AUTOMATIONS, "[condition] Humidity sensor not available");
-    return false;
-  } else if (sensor == "DISTANCE") {
-    // Special handling for distance - check if ANY valid object meets the condition
-    float targetValue = value.toFloat();
-    bool anyObjectMeetsCondition = false;
-    
-    DEBUGF(DEBUG_CLI | DEBUG_AUTOMATIONS, "[condition] distance: checking %d objects against %s%.1f", 
-           gSensorCache.tofTotalObjects, op.c_str(), targetValue);
-    
-    for (int j = 0; j < gSensorCache.tofTotalObjects && j < 4; j++) {
-      if (gSensorCache.tofObjects[j].valid) {
-        float objDistance = gSensorCache.tofObjects[j].distance_cm;
-        bool objMeetsCondition = false;
-        
-        if (op == ">") objMeetsCondition = objDistance > targetValue;
-        else if (op == "<") objMeetsCondition = objDistance < targetValue;
-        else if (op == "=") objMeetsCondition = abs(objDistance - targetValue) < 0.1;
-        else if (op == ">=") objMeetsCondition = objDistance >= targetValue;
-        else if (op == "<=") objMeetsCondition = objDistance <= targetValue;
-        else if (op == "!=") objMeetsCondition = abs(objDistance - targetValue) >= 0.1;
-        
-        DEBUGF(DEBUG_CLI | DEBUG_AUTOMATIONS, "[condition] obj[%d]: %.1fcm %s %.1f = %s", 
-               j, objDistance, op.c_str(), targetValue, objMeetsCondition ? "TRUE" : "FALSE");
-        
-        if (objMeetsCondition) {
-          anyObjectMeetsCondition = true;
-        }
-      }
-    }
-    
-    DEBUGF(DEBUG_CLI | DEBUG_AUTOMATIONS, "[condition] distance result: %s", 
-           anyObjectMeetsCondition ? "TRUE" : "FALSE");
-    return anyObjectMeetsCondition;
-  } else if (sensor == "LIGHT") {
-    currentValue = gSensorCache.apdsClear; // Use clear light sensor
-  } else if (sensor == "MOTION") {
-    isNumeric = false;
-    // Use proximity sensor as motion detection
-    currentStringValue = (gSensorCache.apdsProximity > 50) ? "DETECTED" : "NONE";
-  } else if (sensor == "TIME") {
-    isNumeric = false;
-    time_t now = time(nullptr);
-    struct tm* timeinfo = localtime(&now);
-    int hour = timeinfo->tm_hour;
-    if (hour >= 6 && hour < 12) currentStringValue = "MORNING";
-    else if (hour >= 12 && hour < 18) currentStringValue = "AFTERNOON";
-    else if (hour >= 18 && hour < 24) currentStringValue = "EVENING";
-    else currentStringValue = "NIGHT";
-  } else {
-    DEBUGF(DEBUG_CLI | DEBUG_AUTOMATIONS, "[condition] Unknown sensor: %s", sensor.c_str());
-    return false; // Unknown sensor
-  }
-  
-  // Evaluate condition
-  if (isNumeric) {
-    float targetValue = value.toFloat();
-    if (op == ">") return currentValue > targetValue;
-    else if (op == "<") return currentValue < targetValue;
-    else if (op == "=") return abs(currentValue - targetValue) < 0.1; // Float equality
-    else if (op == ">=") return currentValue >= targetValue;
-    else if (op == "<=") return currentValue <= targetValue;
-    else if (op == "!=") return abs(currentValue - targetValue) >= 0.1;
-  } else {
-    value.toUpperCase();
-    if (op == "=") return currentStringValue == value;
-    else if (op == "!=") return currentStringValue != value;
-    // Other operators don't make sense for strings
-  }
-  
-  return false;
+  CondTerm terms[kCondMaxTerms];
+  CondBranch br;
+  int termCount = 0;
+  int nb = condCompile(cond.c_str(), cond.length(), false, terms, kCondMaxTerms, termCount, &br, 1);
+  bool met = nb > 0 && condEvalBranch(br, terms);
+  DEBUGF(DEBUG_CLI | DEBUG_AUTOMATIONS, "[condition] '%s' terms=%d result=%s", cond.c_str(), termCount, met ? "TRUE" : "FALSE");
+  return met;
 }
 
 // Validate conditional command syntax
@@ -6426,10 +8667,10 @@ static String validateConditionalCommand(const String& command) {
   }
   
   // Validate THEN command (recursively handle nested conditionals)
-  bool prevValidate = gCLIValidateOnly;
-  gCLIValidateOnly = true;
+  bool prevValidate = execState().validateOnly;
+  execState().validateOnly = true;
   String thenResult = executeConditionalCommand(thenCommand);
-  gCLIValidateOnly = prevValidate;
+  execState().validateOnly = prevValidate;
   
   if (thenResult.startsWith("Error:") && thenResult != "Error: Unknown command") {
     return "Error: Invalid THEN command - " + thenResult;
@@ -6441,10 +8682,10 @@ static String validateConditionalCommand(const String& command) {
     elseCommand.trim();
     
     if (elseCommand.length() > 0) {
-      bool prevValidate2 = gCLIValidateOnly;
-      gCLIValidateOnly = true;
+      bool prevValidate2 = execState().validateOnly;
+      execState().validateOnly = true;
       String elseResult = executeConditionalCommand(elseCommand);
-      gCLIValidateOnly = prevValidate2;
+      execState().validateOnly = prevValidate2;
       
       if (elseResult.startsWith("Error:") && elseResult != "Error: Unknown command") {
         return "Error: Invalid ELSE command - " + elseResult;
@@ -6521,7 +8762,7 @@ static String executeConditionalCommand(const String& command) {
 
 static String cmd_automation_add(const String& originalCmd) {
   // Do not early-return on validate; we want to perform full argument checks
-  bool validateOnly = gCLIValidateOnly;
+  bool validateOnly = execState().validateOnly;
   String args = originalCmd.substring(String("automation add ").length());
   args.trim();
   auto getVal = [&](const String& key) {
@@ -6615,10 +8856,10 @@ static String cmd_automation_add(const String& originalCmd) {
       part.trim();
       if (part.length()) {
         // Validate this individual command by calling processCommand in validation mode
-        bool prevValidate = gCLIValidateOnly;
-        gCLIValidateOnly = true;
+        bool prevValidate = execState().validateOnly;
+        execState().validateOnly = true;
         String validationResult = processCommand(part);
-        gCLIValidateOnly = prevValidate;
+        execState().validateOnly = prevValidate;
         
         if (validationResult != "VALID") {
           return "Error: Invalid command '" + part + "' - " + validationResult;
@@ -6951,7 +9192,7 @@ static String cmd_automation_run(const String& originalCmd) {
   // Log automation start if logging is active
   if (gAutoLogActive) {
     gAutoLogAutomationName = autoName;
-    String startMsg = "Automation started: ID=" + idStr + " Name=" + autoName + " User=" + gExecUser;
+    String startMsg = "Automation started: ID=" + idStr + " Name=" + autoName + " User=" + execState().user;
     appendAutoLogEntry("AUTO_START", startMsg);
   }
 
@@ -7090,6 +9331,7 @@ static String cmd_automation_run(const String& originalCmd) {
     if (nextAt > 0) {
       long id = idStr.toInt();
       if (updateAutomationNextAt(id, nextAt)) {
+        gAutosDirty = true;
         DEBUGF(DEBUG_CLI | DEBUG_AUTOMATIONS, "[autos run] advanced nextAt=%lu for id=%s", (unsigned long)nextAt, idStr.c_str());
       } else {
         DEBUGF(DEBUG_CLI | DEBUG_AUTOMATIONS, "[autos run] warning: failed to update nextAt for id=%s", idStr.c_str());
@@ -7137,11 +9379,11 @@ static String cmd_broadcast(const String& originalCmd) {
   
   if (targetUser.length() > 0) {
     // Send to specific user - clean format: [sender@recipient]
-    broadcastWithOrigin("", gExecIsAdmin ? gExecUser : String(), targetUser, msg);
+    broadcastWithOrigin("", execState().isAdmin ? execState().user : String(), targetUser, msg);
     return String("Broadcast sent to user '") + targetUser + "': " + msg;
   } else {
     // Send to all users - clean format: [sender]
-    broadcastWithOrigin("", gExecIsAdmin ? gExecUser : String(), String(), msg);
+    broadcastWithOrigin("", execState().isAdmin ? execState().user : String(), String(), msg);
     
     // Send broadcast notifications to all active sessions for popup alerts
     // Now safe to call from automation context due to dedicated executor task
@@ -7936,6 +10178,30 @@ static String cmd_set(const String& originalCmd) {
     saveUnifiedSettings();
     setupNTP();
     return "Timezone offset set to " + String(offset) + " minutes";
+  } else if (setting == "passwordkdfiterations") {
+    int iterations = value.toInt();
+    if (iterations < kPasswordKdfMinIterations || iterations > kPasswordKdfMaxIterations) {
+      return "Error: passwordKdfIterations must be between " + String(kPasswordKdfMinIterations) + " and " + String(kPasswordKdfMaxIterations);
+    }
+    gSettings.passwordKdfIterations = iterations;
+    saveUnifiedSettings();
+    return "Password KDF iterations set to " + String(iterations) + " (existing passwords are re-hashed at next login)";
+  } else if (setting == "httpmaxsockets") {
+    int v = value.toInt();
+    if (v < 2 || v > kHttpMaxSocketsLimit) return "Error: httpMaxSockets must be 2.." + String(kHttpMaxSocketsLimit);
+    gSettings.httpMaxSockets = v;
+    saveUnifiedSettings();
+    return String("httpMaxSockets set to ") + v + " (applies when the HTTP server restarts)";
+  } else if (setting == "httplrupurge") {
+    gSettings.httpLruPurge = (value == "1" || value.equalsIgnoreCase("true") || value.equalsIgnoreCase("on"));
+    saveUnifiedSettings();
+    return String("httpLruPurge set to ") + (gSettings.httpLruPurge ? "1" : "0") + " (applies when the HTTP server restarts)";
+  } else if (setting == "httpworkers") {
+    int v = value.toInt();
+    if (v < 0 || v > kHttpMaxWorkers) return "Error: httpWorkers must be 0.." + String(kHttpMaxWorkers);
+    gSettings.httpWorkers = v;
+    saveUnifiedSettings();
+    return String("httpWorkers set to ") + v + " (applies after reboot)";
   } else if (setting == "ntpserver") {
     if (value.length() == 0) return "Error: NTP server cannot be empty";
     WiFiUDP udp;
@@ -8064,6 +10330,27 @@ static String cmd_set(const String& originalCmd) {
     gSettings.espnowenabled = (v == 1);
     saveUnifiedSettings();
     return String("espnowenabled set to ") + (gSettings.espnowenabled ? "1" : "0") + " (takes effect after reboot)";
+  } else if (setting == "espnowtelemetrypeer") {
+    String v = value;
+    v.trim();
+    if (v.equalsIgnoreCase("off") || v == "0") v = "";
+    if (v.length() > 32 || v.indexOf('"') >= 0 || v.indexOf(' ') >= 0) return "Error: espnowTelemetryPeer must be a paired device name or 'off'";
+    gSettings.espnowTelemetryPeer = v;
+    saveUnifiedSettings();
+    return v.length() ? String("espnowTelemetryPeer set to ") + v : String("ESP-NOW telemetry disabled");
+  } else if (setting == "espnowtelemetryms") {
+    int v = value.toInt();
+    if (v < 100 || v > 60000) return "Error: espnowTelemetryMs must be 100..60000";
+    gSettings.espnowTelemetryMs = v;
+    saveUnifiedSettings();
+    return String("espnowTelemetryMs set to ") + v;
+  } else if (setting == "sensoridlepollms") {
+    int v = value.toInt();
+    if (v != 0 && (v < 1000 || v > 600000)) return "Error: sensorIdlePollMs must be 0 (sleep) or 1000..600000";
+    gSettings.sensorIdlePollMs = v;
+    saveUnifiedSettings();
+    sensorTaskNotifyAll();
+    return String("sensorIdlePollMs set to ") + v + (v ? "" : " (idle sensors sleep)");
   } else {
     return "Error: unknown setting '" + setting + "'";
   }
@@ -8140,6 +10427,7 @@ static inline void broadcastWithOrigin(const char* source, const String& user, c
   if (isTargetedMessage) {
     // Find the target user's session
     bool userFound = false;
+    SessionLock lock;
     for (int i = 0; i < MAX_SESSIONS; i++) {
       if (gSessions[i].user.length() > 0 && gSessions[i].user == targetUser) {
         Serial.println("[DEBUG-BROADCAST] Found target user session [" + String(i) + "] - sending targeted message");
@@ -8238,6 +10526,9 @@ static void applySettings() {
 
     thermalSensor->setRefreshRate(rate);
   }
+
+  // Sensor tasks pick up poll-period changes now rather than at their next deadline
+  sensorTaskNotifyAll();
 }
 
 // ==========================
@@ -8387,17 +10678,20 @@ esp_err_t handleNotice(httpd_req_t* req) {
   }
 
   String sid = getCookieSID(req);
-  int idx = findSessionIndexBySID(sid);
   String note = "";
-  if (idx >= 0) {
-    note = gSessions[idx].notice;
-    gSessions[idx].notice = "";  // clear on read
-    // If this is a revoke notice, immediately clear the session and expire cookie
-    if (note.startsWith("[revoke]")) {
-      gSessions[idx] = SessionEntry();
-      httpd_resp_set_hdr(req, "Set-Cookie", "session=; Path=/; Max-Age=0; HttpOnly; SameSite=Strict");
+  bool revoked = false;
+  {
+    SessionLock lock;
+    int idx = findSessionIndexBySID(sid);
+    if (idx >= 0) {
+      note = gSessions[idx].notice;
+      gSessions[idx].notice = "";  // clear on read
+      // If this is a revoke notice, immediately clear the session and expire cookie
+      revoked = note.startsWith("[revoke]");
+      if (revoked) sessionClearSlot(idx);
     }
   }
+  if (revoked) httpd_resp_set_hdr(req, "Set-Cookie", "session=; Path=/; Max-Age=0; HttpOnly; SameSite=Strict");
   String json = String("{\"success\":true,\"notice\":\"") + jsonEscape(note) + "\"}";
   httpd_resp_send(req, json.c_str(), HTTPD_RESP_USE_STRLEN);
   return ESP_OK;
@@ -8491,7 +10785,7 @@ esp_err_t handleLogin(httpd_req_t* req) {
   logAuthAttempt(true, req->uri, u, ip, "Login successful");
 
   // Clear auth cache immediately
-  gAuthCache = { "", "", 0, "" };
+  authCacheClear();
 
   // Clear any existing logout reason for this IP to prevent false "signed out" messages
   String clientIP;
@@ -8573,13 +10867,6 @@ esp_err_t handleLogout(httpd_req_t* req) {
 }
 
 // Protected dashboard
-void streamDashboardContent(httpd_req_t* req) {
-  String u;
-  isAuthed(req, u);
-  String content = getDashboardPage(u);
-  streamContentGeneric(req, content);
-}
-
 esp_err_t handleDashboard(httpd_req_t* req) {
   AuthContext ctx;
   ctx.transport = AUTH_HTTP;
@@ -8589,17 +10876,10 @@ esp_err_t handleDashboard(httpd_req_t* req) {
   if (!tgRequireAuth(ctx)) return ESP_OK;
   logAuthAttempt(true, req->uri, ctx.user, ctx.ip, "");
 
-  streamPageWithContent(req, "dashboard", ctx.user, streamDashboardContent);
+  streamPage(req, "dashboard", ctx.user);
   return ESP_OK;
 }
 
-void streamSettingsContent(httpd_req_t* req) {
-  String u;
-  isAuthed(req, u);
-  String content = getSettingsPage(u);
-  streamContentGeneric(req, content);
-}
-
 esp_err_t handleSettingsPage(httpd_req_t* req) {
   AuthContext ctx;
   ctx.transport = AUTH_HTTP;
@@ -8609,7 +10889,7 @@ esp_err_t handleSettingsPage(httpd_req_t* req) {
   if (!tgRequireAuth(ctx)) return ESP_OK;
   logAuthAttempt(true, req->uri, ctx.user, ctx.ip, "");
 
-  streamPageWithContent(req, "settings", ctx.user, streamSettingsContent);
+  streamPage(req, "settings", ctx.user);
   return ESP_OK;
 }
 
@@ -8636,6 +10916,7 @@ esp_err_t handleSensorData(httpd_req_t* req) {
       String sensorType = String(sensor);
 
       if (sensorType == "thermal") {
+        sensorGovNoteViewer(I2C_DEV_THERMAL, ctx.ip);
         // Always return thermal data, even if cache is stale - with mutex protection
         String json = "";
         if (lockSensorCache(pdMS_TO_TICKS(100))) {  // 100ms timeout for HTTP response
@@ -8657,6 +10938,7 @@ esp_err_t handleSensorData(httpd_req_t* req) {
         httpd_resp_send(req, json.c_str(), json.length());
         return ESP_OK;
       } else if (sensorType == "tof") {
+        sensorGovNoteViewer(I2C_DEV_TOF, ctx.ip);
         // Always return ToF data, even if cache is stale
         if (gDebugFlags & DEBUG_SENSORS_FRAME) {
           Serial.println("[DEBUG_SENSORS_FRAME] handleSensorData: ToF data requested via /api/sensors?sensor=tof");
@@ -8668,7 +10950,14 @@ esp_err_t handleSensorData(httpd_req_t* req) {
         httpd_resp_set_type(req, "application/json");
         httpd_resp_send(req, json.c_str(), json.length());
         return ESP_OK;
+      } else if (sensorType == "peers") {
+        // Telemetry streamed by other nodes over ESP-NOW
+        String json = espNowPeerTelemetryJson();
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_send(req, json.c_str(), json.length());
+        return ESP_OK;
       } else if (sensorType == "imu") {
+        sensorGovNoteViewer(I2C_DEV_IMU, ctx.ip);
         // Return cached IMU data with mutex protection
         String json = "";
         if (lockSensorCache(pdMS_TO_TICKS(100))) {  // 100ms timeout for HTTP response
@@ -8735,8 +11024,11 @@ esp_err_t handleSettingsGet(httpd_req_t* req) {
   json += "\"tof\":{\"ui\":{\"tofPollingMs\":" + String(gSettings.tofPollingMs) + ",\"tofStabilityThreshold\":" + String(gSettings.tofStabilityThreshold) + ",\"tofTransitionMs\":" + String(gSettings.tofTransitionMs) + ",\"tofUiMaxDistanceMm\":" + String(gSettings.tofUiMaxDistanceMm) + "},\"device\":{\"tofDevicePollMs\":" + String(gSettings.tofDevicePollMs) + ",\"i2cClockToFHz\":" + String(gSettings.i2cClockToFHz) + "}},";
   // Un-grouped device-side key(s) that remain top-level
   json += "\"imuDevicePollMs\":" + String(gSettings.imuDevicePollMs) + ",";
+  json += "\"sensorIdlePollMs\":" + String(gSettings.sensorIdlePollMs) + ",";
   // ESP-NOW settings
   json += "\"espnowenabled\":" + String(gSettings.espnowenabled ? 1 : 0) + ",";
+  json += "\"espnowTelemetryPeer\":\"" + gSettings.espnowTelemetryPeer + "\",";
+  json += "\"espnowTelemetryMs\":" + String(gSettings.espnowTelemetryMs) + ",";
   // Current WiFi connection info
   String currentSSID = WiFi.isConnected() ? WiFi.SSID() : String("");
   currentSSID.replace("\\", "\\\\");
@@ -8878,6 +11170,7 @@ esp_err_t handleSessionsRevoke(httpd_req_t* req) {
     httpd_resp_send(req, "{\"success\":false,\"error\":\"sid required\"}", HTTPD_RESP_USE_STRLEN);
     return ESP_OK;
   }
+  SessionLock lock;  // held until the slot is updated so a worker can't reuse it under us
   int idx = findSessionIndexBySID(sid);
   if (idx < 0) {
     httpd_resp_set_type(req, "application/json");
@@ -8913,6 +11206,7 @@ static bool requireAdmin(httpd_req_t* req, String& uOut) {
 
 // Build JSON for all sessions (admin view)
 static void buildAllSessionsJson(const String& currentSid, String& outJsonArr) {
+  SessionLock lock;
   bool first = true;
   for (int i = 0; i < MAX_SESSIONS; ++i) {
     const SessionEntry& s = gSessions[i];
@@ -8992,34 +11286,38 @@ esp_err_t handleAdminSessionsRevoke(httpd_req_t* req) {
     httpd_resp_send(req, "{\"success\":false,\"error\":\"sid required\"}", HTTPD_RESP_USE_STRLEN);
     return ESP_OK;
   }
-  int idx = findSessionIndexBySID(sid);
-  if (idx < 0) {
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, "{\"success\":false,\"error\":\"not found\"}", HTTPD_RESP_USE_STRLEN);
-    return ESP_OK;
-  }
-  // Preserve target username and IP for logging
-  String targetUser = gSessions[idx].user;
-  String targetIP = gSessions[idx].ip;
-  int targetSockfd = gSessions[idx].sockfd;
+  String targetUser;
+  {
+    SessionLock lock;  // held until the slot is cleared so a worker can't reuse it under us
+    int idx = findSessionIndexBySID(sid);
+    if (idx < 0) {
+      httpd_resp_set_type(req, "application/json");
+      httpd_resp_send(req, "{\"success\":false,\"error\":\"not found\"}", HTTPD_RESP_USE_STRLEN);
+      return ESP_OK;
+    }
+    // Preserve target username and IP for logging
+    targetUser = gSessions[idx].user;
+    String targetIP = gSessions[idx].ip;
+    int targetSockfd = gSessions[idx].sockfd;
 
-  // Store logout reason for the target IP before force closing
-  if (targetIP.length() > 0) {
-    Serial.printf("[ADMIN_DEBUG] Admin revocation: storing admin revoke message for IP '%s'\n", targetIP.c_str());
-    storeLogoutReason(targetIP, "Your session was revoked by an administrator.");
-  }
+    // Store logout reason for the target IP before force closing
+    if (targetIP.length() > 0) {
+      Serial.printf("[ADMIN_DEBUG] Admin revocation: storing admin revoke message for IP '%s'\n", targetIP.c_str());
+      storeLogoutReason(targetIP, "Your session was revoked by an administrator.");
+    }
 
-  // Force close the connection immediately using native ESP32 HTTP server function
-  if (targetSockfd >= 0) {
-    esp_err_t closeResult = httpd_sess_trigger_close(server, targetSockfd);
-    DEBUG_AUTHF("Force closing socket %d for user %s - %s", targetSockfd, targetUser.c_str(), closeResult == ESP_OK ? "SUCCESS" : "FAILED");
-    broadcastOutput(String("[admin] Force closing socket ") + String(targetSockfd) + " for user " + targetUser + (closeResult == ESP_OK ? " - SUCCESS" : " - FAILED"));
-  } else {
-    DEBUG_AUTHF("No socket to close for user %s (sockfd=%d)", targetUser.c_str(), targetSockfd);
-  }
+    // Force close the connection immediately using native ESP32 HTTP server function
+    if (targetSockfd >= 0) {
+      esp_err_t closeResult = httpd_sess_trigger_close(server, targetSockfd);
+      DEBUG_AUTHF("Force closing socket %d for user %s - %s", targetSockfd, targetUser.c_str(), closeResult == ESP_OK ? "SUCCESS" : "FAILED");
+      broadcastOutput(String("[admin] Force closing socket ") + String(targetSockfd) + " for user " + targetUser + (closeResult == ESP_OK ? " - SUCCESS" : " - FAILED"));
+    } else {
+      DEBUG_AUTHF("No socket to close for user %s (sockfd=%d)", targetUser.c_str(), targetSockfd);
+    }
 
-  // Clear the session immediately
-  gSessions[idx] = SessionEntry();
+    // Clear the session immediately
+    sessionClearSlot(idx);
+  }
 
   // Broadcast general admin feed message (use legacy helper here; CommandContext not available yet in this scope)
   broadcastWithOrigin("admin", ctx.user, String(), String("Admin notice: session forcibly disconnected") + (targetUser.length() ? String(" for user '") + targetUser + "'" : String("")) + ".");
@@ -9097,7 +11395,14 @@ static bool isAdminOnlyCommand(const String& cmd) {
          // Download commands
          c.startsWith("downloadautomation") ||
          // CPU frequency (safety critical)
-         c.startsWith("cpufreq ");
+         c.startsWith("cpufreq ") ||
+         // Password hashing cost
+         c.startsWith("set passwordkdfiterations") ||
+         // HTTP server tuning
+         c.startsWith("set httpmaxsockets") || c.startsWith("set httplrupurge") ||
+         c.startsWith("set httpworkers") ||
+         // Telemetry mutations
+         c.startsWith("memperf reset") || c.startsWith("memperf interval") || c.startsWith("i2cperf reset");
 }
 
 static String redactCmdForAudit(const String& cmd) {
@@ -9121,6 +11426,31 @@ static String redactCmdForAudit(const String& cmd) {
       }
     }
   }
+  // Redact espnow exec-all password: "espnow exec-all [--timeout <ms>] <username> <password> <command>"
+  if (cl.startsWith("espnow exec-all ")) {
+    int userStart = 16;
+    if (cl.startsWith("--timeout ", userStart)) {
+      int sp = c.indexOf(' ', userStart + 10);
+      userStart = (sp > 0) ? sp + 1 : c.length();
+    }
+    if (cl.startsWith("--session ", userStart)) return c;  // no credentials on the line
+    int sp1 = c.indexOf(' ', userStart);  // after <username>
+    if (sp1 > 0) {
+      int sp2 = c.indexOf(' ', sp1 + 1);  // after <password>
+      String tail = (sp2 > 0) ? c.substring(sp2) : String();
+      c = c.substring(0, sp1 + 1) + "***" + tail;
+      return c;
+    }
+  }
+  // Redact espnow login password: "espnow login <target> <username> <password>"
+  if (cl.startsWith("espnow login ")) {
+    int sp1 = c.indexOf(' ', 13);  // after <target>
+    int sp2 = (sp1 > 0) ? c.indexOf(' ', sp1 + 1) : -1;  // after <username>
+    if (sp2 > 0) {
+      c = c.substring(0, sp2 + 1) + "***";
+      return c;
+    }
+  }
   // Redact user request secrets: mask everything after <username>
   // Syntax: "user request <username> <password> [confirm]"
   if (cl.startsWith("user request ")) {
@@ -9142,9 +11472,10 @@ static String redactCmdForAudit(const String& cmd) {
 
 static bool executeCommand(AuthContext& ctx, const String& cmd, String& out) {
   // Set execution context for downstream checks (used by handlers)
-  gExecFromWeb = (ctx.transport == AUTH_HTTP);
-  gExecUser = ctx.user;
-  gExecIsAdmin = isAdminUser(ctx.user);
+  ExecState& es = execState();
+  es.fromWeb = (ctx.transport == AUTH_HTTP);
+  es.user = ctx.user;
+  es.isAdmin = isAdminUser(ctx.user);
   DEBUG_CMD_FLOWF("[execCmd] user=%s ip=%s path=%s cmd=%s", ctx.user.c_str(), ctx.ip.c_str(), ctx.path.c_str(), redactCmdForAudit(cmd).c_str());
 
   // Admin-only protection for user-origin calls; allow system-origin through
@@ -9285,7 +11616,7 @@ struct CommandContext {
   uint32_t timestampMs;
   uint32_t outputMask;
   bool validateOnly;
-  void* replyHandle;     // placeholder for future sync replies
+  void* replyHandle;     // async submitter's reply target (ESP-NOW remote commands)
   httpd_req_t* httpReq;  // used by web origin if needed
 };
 struct Command {
@@ -9294,38 +11625,149 @@ struct Command {
 };
 
 // -------- Command Executor Task (definition) --------
+// Completion is signalled with a direct-to-task notification on the submitter.
+// Use a spare notification slot when the FreeRTOS config has one, so a task's
+// own wakeups on index 0 (e.g. the automations scheduler) are not consumed.
+#if defined(configTASK_NOTIFICATION_ARRAY_ENTRIES) && (configTASK_NOTIFICATION_ARRAY_ENTRIES > 1)
+#define EXEC_NOTIFY_INDEX 1
+#else
+#define EXEC_NOTIFY_INDEX 0
+#endif
+
 struct ExecReq {
   String line;               // Command string
   CommandContext ctx;        // Full execution context
   String out;                // Result from executeCommand()
-  SemaphoreHandle_t done;    // Signals completion
-  bool ok;                   // Success flag from executeCommand()
+  TaskHandle_t waiter = nullptr;       // notified on completion (nullptr for async jobs)
+  std::atomic<bool> finished{ false };  // set by the worker as its last access to the request
+  bool ok = false;           // Success flag from executeCommand()
+  bool pooled = true;        // false for heap overflow requests
+  void (*onDone)(ExecReq* r) = nullptr;  // async jobs: runs on the executor before finished is set
+  bool detached = false;     // no owner: the executor releases it after onDone
+};
+
+// Preallocated requests, handed out through a free queue. Their line/ctx Strings
+// keep their buffers between commands, so steady-state submits don't allocate.
+// When the pool runs dry a one-off heap request is used instead.
+static const int kExecReqPoolSize = 16;
+static ExecReq gExecReqPool[kExecReqPoolSize];
+static QueueHandle_t gExecReqFree = nullptr;
+
+static ExecReq* execReqAcquire() {
+  ExecReq* r = nullptr;
+  if (!gExecReqFree || xQueueReceive(gExecReqFree, &r, 0) != pdTRUE) {
+    r = new ExecReq();
+    r->pooled = false;
+  }
+  r->waiter = nullptr;
+  r->finished.store(false, std::memory_order_relaxed);
+  r->ok = false;
+  r->onDone = nullptr;
+  r->detached = false;
+  return r;
+}
+
+static void execReqRelease(ExecReq* r) {
+  if (!r->pooled) {
+    delete r;
+    return;
+  }
+  r->out = String();  // unread async output; everything else is overwritten on reuse
+  xQueueSend(gExecReqFree, &r, 0);
+}
+
+// One worker task + queue per CmdClass. A 'wait', 'wificonnect' or LED effect
+// only holds up its own class; 'status' and friends keep answering meanwhile.
+struct CmdWorker {
+  const char* name;
+  QueueHandle_t q;
+  TaskHandle_t task;
+  ExecState state;
 };
+static CmdWorker gCmdWorkers[CMD_CLASS_COUNT] = {
+  { "cmd_status" }, { "cmd_sensor" }, { "cmd_fs" }, { "cmd_block" }
+};
+static const int kCmdWorkerQueueDepth = 4;
+// Callers outside the workers: the automations scheduler runs its commands inline
+// (ORIGIN_AUTOMATION) and has its own state, so a scheduled run never sees the
+// user of a web or serial command; early boot uses the shared one
+static ExecState gExecStateAuto;
+static ExecState gExecStateShared;
+
+static int cmdWorkerIndexSelf() {
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  for (int i = 0; i < CMD_CLASS_COUNT; ++i) {
+    if (gCmdWorkers[i].task && gCmdWorkers[i].task == self) return i;
+  }
+  return -1;
+}
+
+static ExecState& execState() {
+  int i = cmdWorkerIndexSelf();
+  if (i >= 0) return gCmdWorkers[i].state;
+  if (gAutoSchedTaskHandle && xTaskGetCurrentTaskHandle() == gAutoSchedTaskHandle) return gExecStateAuto;
+  return gExecStateShared;
+}
+
+// Queue of the worker that runs this command line; nullptr until the executor is started
+static QueueHandle_t cmdExecQueueFor(const String& line) {
+  return gCmdWorkers[commandClassOf(line)].q;
+}
 
 // Now that ExecReq is fully defined we can implement the task
 static void commandExecTask(void* pv) {
-  DEBUG_CMD_FLOWF("[cmd_exec] task started");
+  CmdWorker* w = (CmdWorker*)pv;
+  DEBUG_CMD_FLOWF("[%s] task started", w->name);
   for (;;) {
     ExecReq* r;
-    DEBUG_CMD_FLOWF("[cmd_exec] waiting for command...");
-    if (xQueueReceive(gCmdExecQ, &r, portMAX_DELAY) == pdTRUE) {
-      DEBUG_CMD_FLOWF("[cmd_exec] received cmd='%s'", r->line.c_str());
+    DEBUG_CMD_FLOWF("[%s] waiting for command...", w->name);
+    if (xQueueReceive(w->q, &r, portMAX_DELAY) == pdTRUE) {
+      DEBUG_CMD_FLOWF("[%s] received cmd='%s'", w->name, r->line.c_str());
       setCurrentCommandContext(r->ctx);
-      bool prevValidate = gCLIValidateOnly;
-      gCLIValidateOnly = r->ctx.validateOnly;
+      w->state.validateOnly = r->ctx.validateOnly;
       r->ok = executeCommand((AuthContext&)r->ctx.auth, r->line, r->out);
-      DEBUG_CMD_FLOWF("[cmd_exec] executed ok=%d out_len=%d", r->ok ? 1 : 0, r->out.length());
-      gCLIValidateOnly = prevValidate;
-      xSemaphoreGive(r->done);
+      DEBUG_CMD_FLOWF("[%s] executed ok=%d out_len=%d", w->name, r->ok ? 1 : 0, r->out.length());
+      w->state.validateOnly = false;
+      if (r->onDone) r->onDone(r);
+      if (r->detached) {
+        execReqRelease(r);
+        continue;
+      }
+      TaskHandle_t waiter = r->waiter;
+      r->finished.store(true, std::memory_order_release);  // r may be released by its owner from here on
+      if (waiter) xTaskNotifyGiveIndexed(waiter, EXEC_NOTIFY_INDEX);
     } else {
-      DEBUG_CMD_FLOWF("[cmd_exec] queue receive failed");
+      DEBUG_CMD_FLOWF("[%s] queue receive failed", w->name);
+    }
+  }
+}
+
+// Creates the request pool, per-class queues and worker tasks; false on allocation failure
+static bool cmdExecStart() {
+  if (!gExecReqFree) {
+    gExecReqFree = xQueueCreate(kExecReqPoolSize, sizeof(ExecReq*));
+    if (!gExecReqFree) return false;
+    for (int i = 0; i < kExecReqPoolSize; ++i) {
+      ExecReq* r = &gExecReqPool[i];
+      xQueueSend(gExecReqFree, &r, 0);
     }
   }
+  const uint32_t cmdExecStackWords = 4096;  // words (≈16 KB) per worker
+  for (int i = 0; i < CMD_CLASS_COUNT; ++i) {
+    CmdWorker& w = gCmdWorkers[i];
+    if (w.q) continue;
+    w.q = xQueueCreate(kCmdWorkerQueueDepth, sizeof(ExecReq*));
+    if (!w.q) return false;
+    if (xTaskCreate(commandExecTask, w.name, cmdExecStackWords, &w, 1, &w.task) != pdPASS) return false;
+  }
+  return true;
 }
+
 static void setCurrentCommandContext(const CommandContext& ctx) {
   // Temporary bridge to legacy globals; will be removed once handlers read from ctx
-  gExecFromWeb = (ctx.auth.transport == AUTH_HTTP);
-  gExecUser = ctx.auth.user;
+  ExecState& es = execState();
+  es.fromWeb = (ctx.auth.transport == AUTH_HTTP);
+  es.user = ctx.auth.user;
 }
 static void routeOutput(const String& s, const CommandContext& ctx) {
   // Minimal router: preserve current behavior using existing helpers
@@ -9358,50 +11800,197 @@ static void routeOutput(const String& s, const CommandContext& ctx) {
 }
 static bool submitAndExecuteSync(const Command& cmd, String& out) {
   // If executor queue isn't ready (very early boot) fallback to direct call
-  if (gCmdExecQ == nullptr) {
+  QueueHandle_t q = cmdExecQueueFor(cmd.line);
+  if (q == nullptr) {
     setCurrentCommandContext(cmd.ctx);
     return executeCommand((AuthContext&)cmd.ctx.auth, cmd.line, out);
   }
 
-  // AVOID DEADLOCK: If we're already running in the executor task context,
-  // execute directly instead of queuing (which would cause deadlock)
-  if (cmd.ctx.origin == ORIGIN_AUTOMATION) {
-    DEBUG_CMD_FLOWF("[submit] AUTOMATION - executing directly to avoid deadlock");
+  // AVOID DEADLOCK: If we're already running in an executor worker,
+  // execute directly instead of queuing (which could wait on ourselves)
+  if (cmd.ctx.origin == ORIGIN_AUTOMATION || cmdWorkerIndexSelf() >= 0) {
+    DEBUG_CMD_FLOWF("[submit] AUTOMATION/nested - executing directly to avoid deadlock");
+    ExecState& es = execState();
+    ExecState saved = es;  // the outer command keeps its user/validate state
     setCurrentCommandContext(cmd.ctx);
-    bool prevValidate = gCLIValidateOnly;
-    gCLIValidateOnly = cmd.ctx.validateOnly;
+    es.validateOnly = cmd.ctx.validateOnly;
     bool ok = executeCommand((AuthContext&)cmd.ctx.auth, cmd.line, out);
-    gCLIValidateOnly = prevValidate;
+    es = saved;
     DEBUG_CMD_FLOWF("[submit] done ok=%d len=%d", ok ? 1 : 0, out.length());
     return ok;
   }
 
   // Package request
-  ExecReq* r = new ExecReq();
+  ExecReq* r = execReqAcquire();
   r->line = cmd.line;
   r->ctx = cmd.ctx;
-  r->done = xSemaphoreCreateBinary();
-  r->ok = false;
+  r->waiter = xTaskGetCurrentTaskHandle();
 
   DEBUG_CMD_FLOWF("[submit] origin=%d user=%s path=%s cmd=%s", (int)cmd.ctx.origin, cmd.ctx.auth.user.c_str(), cmd.ctx.auth.path.c_str(), cmd.line.c_str());
 
   // Enqueue and wait
   DEBUG_CMD_FLOWF("[submit] sending to queue...");
-  BaseType_t queueResult = xQueueSend(gCmdExecQ, &r, portMAX_DELAY);
+  BaseType_t queueResult = xQueueSend(q, &r, portMAX_DELAY);
   DEBUG_CMD_FLOWF("[submit] queue send result=%d, waiting for completion...", queueResult);
-  xSemaphoreTake(r->done, portMAX_DELAY);
+  // Loop: a notification left over from an earlier command may wake us early
+  while (!r->finished.load(std::memory_order_acquire)) {
+    ulTaskNotifyTakeIndexed(EXEC_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+  }
   DEBUG_CMD_FLOWF("[submit] command completed");
 
   out = std::move(r->out);
   bool ok = r->ok;
-
-  vSemaphoreDelete(r->done);
-  delete r;
+  execReqRelease(r);
 
   DEBUG_CMD_FLOWF("[submit] done ok=%d len=%d", ok ? 1 : 0, out.length());
   return ok;
 }
 
+// -------- Async CLI jobs (/api/cli?async=1) --------
+// Slow commands (wificonnect, wifiscan, wait, downloads, LED effects) would hold
+// the HTTP request for their whole run. An async submit queues the ExecReq and
+// returns a job id; the client polls /api/cli/job/<id> for the output. The
+// bounded table owns each ExecReq until its output is fetched. Running jobs are
+// never evicted; finished ones are, oldest first, when a slot is needed.
+struct CliJob {
+  uint32_t id;        // 0 = free slot
+  ExecReq* req;
+  String user;        // owner; only they or an admin may read the job
+  int originIdx;      // submitting session, skipped by the output broadcast
+  uint32_t submittedMs;
+  uint32_t finishedMs;
+};
+static const int kCliJobSlots = 8;
+static CliJob gCliJobs[kCliJobSlots];
+static uint32_t gCliJobNextId = 1;
+static SemaphoreHandle_t gCliJobMutex = nullptr;
+
+static bool cliJobFinished(const CliJob& j) {
+  return j.req && j.req->finished.load(std::memory_order_acquire);
+}
+
+static void cliJobFree(CliJob& j) {
+  if (j.req) execReqRelease(j.req);
+  j = CliJob();
+}
+
+// Executor-side completion: route output like the synchronous web path does
+static void cliJobDone(ExecReq* r) {
+  int skip = -1;
+  if (xSemaphoreTake(gCliJobMutex, portMAX_DELAY) == pdTRUE) {
+    for (int i = 0; i < kCliJobSlots; ++i) {
+      if (gCliJobs[i].req == r) {
+        skip = gCliJobs[i].originIdx;
+        gCliJobs[i].finishedMs = millis();
+        break;
+      }
+    }
+    xSemaphoreGive(gCliJobMutex);
+  }
+  int prevSkip = gBroadcastSkipSessionIdx;
+  gBroadcastSkipSessionIdx = skip;
+  routeOutput(r->out, r->ctx);
+  gBroadcastSkipSessionIdx = prevSkip;
+}
+
+// Queues cmd as a job; returns its id, or 0 when the table or executor queue is full
+static uint32_t cliJobSubmit(const Command& cmd, int originIdx) {
+  QueueHandle_t q = cmdExecQueueFor(cmd.line);
+  if (!q || !gCliJobMutex) return 0;
+  if (xSemaphoreTake(gCliJobMutex, portMAX_DELAY) != pdTRUE) return 0;
+  int slot = -1;
+  for (int i = 0; i < kCliJobSlots && slot < 0; ++i) {
+    if (gCliJobs[i].id == 0) slot = i;
+  }
+  if (slot < 0) {
+    // Reclaim the oldest finished job (its output was never fetched)
+    for (int i = 0; i < kCliJobSlots; ++i) {
+      CliJob& j = gCliJobs[i];
+      if (cliJobFinished(j) && (slot < 0 || (long)(j.finishedMs - gCliJobs[slot].finishedMs) < 0)) slot = i;
+    }
+    if (slot >= 0) cliJobFree(gCliJobs[slot]);
+  }
+  uint32_t id = 0;
+  if (slot >= 0) {
+    ExecReq* r = execReqAcquire();
+    r->line = cmd.line;
+    r->ctx = cmd.ctx;
+    r->ctx.httpReq = nullptr;  // the request is answered before the command runs
+    r->onDone = cliJobDone;
+    // The executor's cliJobDone waits on the mutex we hold, so the slot is
+    // filled in before it can look the request up
+    if (xQueueSend(q, &r, 0) == pdTRUE) {
+      CliJob& j = gCliJobs[slot];
+      j.id = gCliJobNextId++;
+      if (gCliJobNextId == 0) gCliJobNextId = 1;
+      j.req = r;
+      j.user = cmd.ctx.auth.user;
+      j.originIdx = originIdx;
+      j.submittedMs = millis();
+      id = j.id;
+      DEBUG_CMD_FLOWF("[cli.job] submitted id=%lu cmd=%s", (unsigned long)id, r->line.c_str());
+    } else {
+      execReqRelease(r);
+    }
+  }
+  xSemaphoreGive(gCliJobMutex);
+  return id;
+}
+
+// GET /api/cli/job/<id>: 202 + JSON while running, 200 + output once finished
+// (the job is released on that read), 404 for unknown ids or other users' jobs
+esp_err_t handleCLIJob(httpd_req_t* req) {
+  AuthContext ctx;
+  ctx.transport = AUTH_HTTP;
+  ctx.opaque = req;
+  ctx.path = "/api/cli/job";
+  getClientIP(req, ctx.ip);
+  if (!tgRequireAuth(ctx)) return ESP_OK;
+
+  const char* uri = req->uri ? req->uri : "";
+  const char* idStr = strrchr(uri, '/');
+  uint32_t id = idStr ? (uint32_t)strtoul(idStr + 1, nullptr, 10) : 0;
+  bool admin = isAdminUser(ctx.user);
+
+  httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+  if (!gCliJobMutex || xSemaphoreTake(gCliJobMutex, portMAX_DELAY) != pdTRUE) {
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, "{\"error\":\"busy\"}", HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+  }
+  CliJob* j = nullptr;
+  for (int i = 0; id && i < kCliJobSlots; ++i) {
+    if (gCliJobs[i].id == id && (admin || gCliJobs[i].user == ctx.user)) {
+      j = &gCliJobs[i];
+      break;
+    }
+  }
+  if (!j) {
+    xSemaphoreGive(gCliJobMutex);
+    httpd_resp_set_status(req, "404 Not Found");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, "{\"error\":\"unknown job\"}", HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+  }
+  if (!cliJobFinished(*j)) {
+    char body[80];
+    snprintf(body, sizeof(body), "{\"job\":%lu,\"state\":\"running\",\"elapsedMs\":%lu}",
+             (unsigned long)j->id, (unsigned long)(millis() - j->submittedMs));
+    xSemaphoreGive(gCliJobMutex);
+    httpd_resp_set_status(req, "202 Accepted");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, body, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+  }
+  String out = std::move(j->req->out);
+  cliJobFree(*j);
+  xSemaphoreGive(gCliJobMutex);
+  httpd_resp_set_type(req, "text/plain");
+  httpd_resp_send(req, out.c_str(), HTTPD_RESP_USE_STRLEN);
+  return ESP_OK;
+}
+
 // Convenience wrapper: execute a command with an existing context and return output
 static String execCommandUnified(const CommandContext& baseCtx, const String& line) {
   DEBUG_CMD_FLOWF("[exec] enter origin=%d user=%s path=%s cmd=%s", (int)baseCtx.origin, baseCtx.auth.user.c_str(), baseCtx.auth.path.c_str(), line.c_str());
@@ -9414,7 +12003,7 @@ static String execCommandUnified(const CommandContext& baseCtx, const String& li
   return out;
 }
 
-// Helper used by schedulerTickMinute to avoid using incomplete types before definitions
+// Helper used by the automations scheduler to avoid using incomplete types before definitions
 static void runAutomationCommandUnified(const String& cmd) {
   // Set automation context flag to prevent SSE recursion
   gInAutomationContext = true;
@@ -9435,13 +12024,14 @@ static void runAutomationCommandUnified(const String& cmd) {
   DEBUGF(DEBUG_CLI | DEBUG_AUTOMATIONS, "[auto] ENTER cmd='%s' stack=%u heap=%u", cmd.c_str(), stackBefore, heapBefore);
   
   AuthContext actx;
+  const ExecState& es = execState();
   // SECURITY: Automations should run with the privileges of the user who triggered them,
   // NOT with system privileges. This prevents privilege escalation attacks.
-  if (gExecUser.length() > 0) {
+  if (es.user.length() > 0) {
     // Manual run: use the actual user's privileges
-    actx.transport = gExecFromWeb ? AUTH_HTTP : AUTH_SERIAL;
-    actx.user = gExecUser;
-    actx.ip = gExecFromWeb ? String("automation-web") : String("automation-serial");
+    actx.transport = es.fromWeb ? AUTH_HTTP : AUTH_SERIAL;
+    actx.user = es.user;
+    actx.ip = es.fromWeb ? String("automation-web") : String("automation-serial");
   } else {
     // Scheduled run: use system privileges only for scheduler-triggered automations
     actx.transport = AUTH_SYSTEM;
@@ -9567,7 +12157,9 @@ esp_err_t handleCLICommand(httpd_req_t* req) {
   String cmd = urlDecode(extractFormField(body, "cmd"));
   String validateStr = extractFormField(body, "validate");
   bool doValidate = (validateStr == "1" || validateStr == "true");
-  DEBUG_CMD_FLOWF("[web.cli] authed user=%s cmd='%s' validate=%d", ctx.user.c_str(), cmd.c_str(), doValidate ? 1 : 0);
+  String asyncStr;
+  bool wantAsync = !doValidate && getQueryParam(req, "async", asyncStr) && (asyncStr == "1" || asyncStr == "true");
+  DEBUG_CMD_FLOWF("[web.cli] authed user=%s cmd='%s' validate=%d async=%d", ctx.user.c_str(), cmd.c_str(), doValidate ? 1 : 0, wantAsync ? 1 : 0);
 
   // Record the command in the unified feed (skip if validation-only), then execute centrally
   if (!doValidate) {
@@ -9594,6 +12186,22 @@ esp_err_t handleCLICommand(httpd_req_t* req) {
   uc.ctx.replyHandle = nullptr;
   uc.ctx.httpReq = req;
 
+  // ?async=1: queue the command and return a job id; output is read from /api/cli/job/<id>
+  if (wantAsync) {
+    uint32_t jobId = cliJobSubmit(uc, originIdx);
+    if (jobId) {
+      gBroadcastSkipSessionIdx = prevSkip;
+      char body[32];
+      snprintf(body, sizeof(body), "{\"job\":%lu}", (unsigned long)jobId);
+      httpd_resp_set_status(req, "202 Accepted");
+      httpd_resp_set_type(req, "application/json");
+      httpd_resp_send(req, body, HTTPD_RESP_USE_STRLEN);
+      DEBUG_CMD_FLOWF("[web.cli] exit async job=%lu", (unsigned long)jobId);
+      return ESP_OK;
+    }
+    DEBUG_CMD_FLOWF("[web.cli] job table full, running inline");
+  }
+
   String out;
   bool ok = submitAndExecuteSync(uc, out);
   DEBUG_CMD_FLOWF("[web.cli] executed ok=%d out_len=%d", ok ? 1 : 0, out.length());
@@ -9615,13 +12223,6 @@ esp_err_t handleCLICommand(httpd_req_t* req) {
   return ESP_OK;
 }
 
-void streamCLIContent(httpd_req_t* req) {
-  String u;
-  isAuthed(req, u);
-  String content = getCLIPage(u);
-  streamContentGeneric(req, content);
-}
-
 esp_err_t handleCLIPage(httpd_req_t* req) {
   AuthContext ctx;
   ctx.transport = AUTH_HTTP;
@@ -9632,25 +12233,10 @@ esp_err_t handleCLIPage(httpd_req_t* req) {
 
   logAuthAttempt(true, req->uri, ctx.user, ctx.ip, "");
 
-  streamPageWithContent(req, "cli", ctx.user, streamCLIContent);
+  streamPage(req, "cli", ctx.user);
   return ESP_OK;
 }
 
-void streamFilesContent(httpd_req_t* req) {
-  String u;
-  isAuthed(req, u);
-  String content = getFilesPage(u);
-  streamContentGeneric(req, content);
-}
-
-// Automations page streamer
-void streamAutomationsContent(httpd_req_t* req) {
-  String u;
-  isAuthed(req, u);
-  String content = getAutomationsPage(u);
-  streamContentGeneric(req, content);
-}
-
 // Automations page handler (authenticated for all users)
 esp_err_t handleAutomationsPage(httpd_req_t* req) {
   AuthContext ctx;
@@ -9661,11 +12247,11 @@ esp_err_t handleAutomationsPage(httpd_req_t* req) {
   if (!tgRequireAuth(ctx)) return ESP_OK;
   logAuthAttempt(true, req->uri, ctx.user, ctx.ip, "");
 
-  streamPageWithContent(req, "automations", ctx.user, streamAutomationsContent);
+  streamPage(req, "automations", ctx.user);
   return ESP_OK;
 }
 
-// GET /api/automations: return raw automations.json
+// GET /api/automations: return automations.json plus a "runtime" map from the scheduler state file
 esp_err_t handleAutomationsGet(httpd_req_t* req) {
   AuthContext ctx;
   ctx.transport = AUTH_HTTP;
@@ -9684,6 +12270,25 @@ esp_err_t handleAutomationsGet(httpd_req_t* req) {
   if (sanitizeAutomationsJson(json)) {
     writeAutomationsJsonAtomic(json);  // best-effort writeback
   }
+  // "runtime": {"<id>":{"seed":..,"nextAt":..,"lastRun":..,"runs":..}}; seed is the JSON nextAt it supersedes
+  AutoStateRec* recs = nullptr;
+  int n = autoStateRead(&recs);
+  int close = json.lastIndexOf('}');
+  if (n > 0 && close > 0) {
+    String rt;
+    rt.reserve(24 + n * 72);
+    rt += ",\"runtime\":{";
+    for (int i = 0; i < n; ++i) {
+      if (i) rt += ",";
+      rt += "\"" + String((long)recs[i].id) + "\":{\"seed\":" + String((unsigned long)recs[i].seedNextAt);
+      rt += ",\"nextAt\":" + String((unsigned long)recs[i].nextAt);
+      rt += ",\"lastRun\":" + String((unsigned long)recs[i].lastRun);
+      rt += ",\"runs\":" + String((unsigned long)recs[i].runCount) + "}";
+    }
+    rt += "}";
+    json = json.substring(0, close) + rt + json.substring(close);
+  }
+  if (recs) free(recs);
   httpd_resp_send(req, json.c_str(), HTTPD_RESP_USE_STRLEN);
   return ESP_OK;
 }
@@ -9834,8 +12439,6 @@ esp_err_t handleAutomationsExport(httpd_req_t* req) {
   return ESP_OK;
 }
 
-// Removed duplicate - using the existing streamFilesContent above
-
 // Persistent buffers for file viewing (prefer PSRAM, fallback to heap)
 static char* gFileReadBuf = nullptr;
 static char* gFileOutBuf = nullptr;
@@ -9863,7 +12466,7 @@ esp_err_t handleFilesPage(httpd_req_t* req) {
   if (!tgRequireAuth(ctx)) return ESP_OK;
   logAuthAttempt(true, req->uri, ctx.user, ctx.ip, "");
 
-  streamPageWithContent(req, "files", ctx.user, streamFilesContent);
+  streamPage(req, "files", ctx.user);
   return ESP_OK;
 }
 
@@ -10078,7 +12681,7 @@ esp_err_t handleFilesCreate(httpd_req_t* req) {
     // Use CLI command for consistent validation and error handling
     String cmd = "mkdir " + path;
     String result;
-    bool success = executeCommand(ctx, cmd, result);
+    bool success = executeUnifiedWebCommand(req, ctx, cmd, result);
     
     httpd_resp_set_type(req, "application/json");
     if (success && result.startsWith("Created folder:")) {
@@ -10391,6 +12994,7 @@ esp_err_t handleFileDelete(httpd_req_t* req) {
   }
 
   if (success) {
+    if (path == USERS_FILE) gUserDirStale = true;
     httpd_resp_set_type(req, "application/json");
     httpd_resp_send(req, "{\"success\":true}", HTTPD_RESP_USE_STRLEN);
   } else {
@@ -10525,7 +13129,7 @@ static bool approvePendingUserInternal(const String& username, String& errorOut)
   if (!LittleFS.exists(USERS_JSON_FILE)) {
     // Create users.json with the first user (ID 1)
     usersJson = String("{\n  \"version\": 1,\n  \"nextId\": 2,\n  \"users\": [\n    {\n      \"id\": 1,\n      \"username\": \"") + username + "\",\n      \"password\": \"" + userPassword + "\",\n      \"role\": \"admin\"\n    }\n  ]\n}\n";
-    if (!writeText(USERS_JSON_FILE, usersJson)) {
+    if (!writeUsersJson(usersJson)) {
       errorOut = "Failed to create users.json";
       return false;
     }
@@ -10579,7 +13183,7 @@ static bool approvePendingUserInternal(const String& username, String& errorOut)
     String afterNextId = usersJson.substring(nextIdEnd);
     usersJson = beforeNextId + String(nextId + 1) + afterNextId;
     
-    if (!writeText(USERS_JSON_FILE, usersJson)) {
+    if (!writeUsersJson(usersJson)) {
       errorOut = "Failed to write users.json";
       return false;
     }
@@ -10731,7 +13335,7 @@ static bool promoteUserToAdminInternal(const String& username, String& errorOut)
     searchPos = objEnd + 1;
   }
   if (!updated) { errorOut = "User not found"; return false; }
-  if (!writeText(USERS_JSON_FILE, json)) { errorOut = "Failed to write users.json"; return false; }
+  if (!writeUsersJson(json)) { errorOut = "Failed to write users.json"; return false; }
   broadcastOutput(String("[admin] Promoted user to admin: ") + username);
   
   // Serial admin status now checked in real-time via isAdminUser()
@@ -10815,7 +13419,7 @@ static bool demoteUserFromAdminInternal(const String& username, String& errorOut
     searchPos = objEnd + 1;
   }
   if (!updated) { errorOut = "User not found"; return false; }
-  if (!writeText(USERS_JSON_FILE, json)) { errorOut = "Failed to write users.json"; return false; }
+  if (!writeUsersJson(json)) { errorOut = "Failed to write users.json"; return false; }
   broadcastOutput(String("[admin] Demoted user from admin: ") + username);
   
   // Serial admin status now checked in real-time via isAdminUser()
@@ -10826,6 +13430,44 @@ static bool demoteUserFromAdminInternal(const String& username, String& errorOut
   return true;
 }
 
+// Replace a user's stored password in users.json if it still equals expectStored (JSON-only).
+// Holds gUserDirMutex across the read-modify-write so it cannot clobber another write.
+static bool updateUserPasswordInternal(const String& username, const String& expectStored, const String& newStored, String& errorOut) {
+  if (username.length() == 0) { errorOut = "Username required"; return false; }
+  if (!gUserDirMutex || xSemaphoreTake(gUserDirMutex, portMAX_DELAY) != pdTRUE) { errorOut = "Directory busy"; return false; }
+  String json;
+  bool ok = false;
+  errorOut = "User not found";
+  if (!readText(USERS_JSON_FILE, json)) errorOut = "Failed to read users.json";
+  int pos = json.indexOf("\"users\"");
+  while (pos >= 0) {
+    int uKey = json.indexOf("\"username\"", pos);
+    if (uKey < 0) break;
+    int uq1 = json.indexOf('"', json.indexOf(':', uKey) + 1);
+    int uq2 = json.indexOf('"', uq1 + 1);
+    if (uq1 < 0 || uq2 <= uq1) break;
+    pos = uq2 + 1;
+    if (json.substring(uq1 + 1, uq2) != username) continue;
+    int nextU = json.indexOf("\"username\"", uKey + 1);
+    int pKey = json.indexOf("\"password\"", uKey);
+    if (pKey < 0 || (nextU >= 0 && pKey > nextU)) break;
+    int pq1 = json.indexOf('"', json.indexOf(':', pKey) + 1);
+    int pq2 = json.indexOf('"', pq1 + 1);
+    if (pq1 < 0 || pq2 <= pq1) break;
+    if (json.substring(pq1 + 1, pq2) != expectStored) {
+      errorOut = "Password changed concurrently";
+      break;
+    }
+    json = json.substring(0, pq1 + 1) + newStored + json.substring(pq2);
+    ok = writeText(USERS_JSON_FILE, json);
+    if (!ok) errorOut = "Failed to write users.json";
+    gUserDirStale = true;
+    break;
+  }
+  xSemaphoreGive(gUserDirMutex);
+  return ok;
+}
+
 // Delete an existing user from users.json (JSON-only)
 static bool deleteUserInternal(const String& username, String& errorOut) {
   DEBUG_USERSF("[users] delete internal username=%s", username.c_str());
@@ -10913,21 +13555,24 @@ static bool deleteUserInternal(const String& username, String& errorOut) {
     searchPos = objEnd + 1;
   }
   if (!deleted) { errorOut = "User not found"; return false; }
-  if (!writeText(USERS_JSON_FILE, json)) { errorOut = "Failed to write users.json"; return false; }
+  if (!writeUsersJson(json)) { errorOut = "Failed to write users.json"; return false; }
   
   // Force logout all sessions for the deleted user
   int revokedSessions = 0;
   String reason = "Account deleted by administrator";
   
   // Revoke web sessions
-  for (int i = 0; i < MAX_SESSIONS; ++i) {
-    if (!gSessions[i].sid.length()) continue;
-    if (!gSessions[i].user.equalsIgnoreCase(username)) continue;
-    if (gSessions[i].ip.length() > 0) {
-      storeLogoutReason(gSessions[i].ip, reason);
+  {
+    SessionLock lock;
+    for (int i = 0; i < MAX_SESSIONS; ++i) {
+      if (!gSessions[i].sid.length()) continue;
+      if (!gSessions[i].user.equalsIgnoreCase(username)) continue;
+      if (gSessions[i].ip.length() > 0) {
+        storeLogoutReason(gSessions[i].ip, reason);
+      }
+      enqueueTargetedRevokeForSessionIdx(i, reason);
+      revokedSessions++;
     }
-    enqueueTargetedRevokeForSessionIdx(i, reason);
-    revokedSessions++;
   }
   
   // Force logout serial session if this user is logged in
@@ -11068,29 +13713,21 @@ void setup() {
   broadcastOutput("[build] Firmware: reg-json-debug-1");
   Serial.printf("[BOOT_DEBUG] Setup continuing after banner...\n");
 
-  // --- Command Executor Task init ---
-  if (!gCmdExecQ) {
-    gCmdExecQ = xQueueCreate(6, sizeof(ExecReq*));
-    if (!gCmdExecQ) {
-      Serial.println("FATAL: Failed to create command exec queue");
-      while (1) delay(1000);
-    }
-    const uint32_t cmdExecStackWords = 4096; // words (≈16 KB)
-    if (xTaskCreate(commandExecTask, "cmd_exec", cmdExecStackWords, nullptr, 1, nullptr) != pdPASS) {
-      Serial.println("FATAL: Failed to create command exec task");
-      while (1) delay(1000);
-    }
+  // --- Command Executor workers init ---
+  if (!cmdExecStart()) {
+    Serial.println("FATAL: Failed to create command exec workers");
+    while (1) delay(1000);
   }
 
-  // Initialize large buffers with PSRAM preference
-  if (!gStreamBuffer) {
-    gStreamBuffer = (char*)ps_alloc(5120, AllocPref::PreferPSRAM, "stream.buf");
-    if (!gStreamBuffer) {
-      Serial.println("FATAL: Failed to allocate stream buffer");
+  // --- Automations scheduler task (submits through the cmd workers, so created after them) ---
+  if (!gAutoSchedTaskHandle) {
+    if (xTaskCreate(autoSchedulerTask, "auto_sched", 6144, nullptr, 1, &gAutoSchedTaskHandle) != pdPASS) {
+      Serial.println("FATAL: Failed to create automations scheduler task");
       while (1) delay(1000);
     }
   }
 
+  // Initialize large buffers with PSRAM preference
   if (!gDebugBuffer) {
     gDebugBuffer = (char*)ps_alloc(1024, AllocPref::PreferPSRAM, "debug.buf");
     if (!gDebugBuffer) {
@@ -11109,6 +13746,27 @@ void setup() {
     memset(gAutoMemoId, 0, kAutoMemoCap * sizeof(long));
   }
 
+  // Initialize user directory mutex
+  gUserDirMutex = xSemaphoreCreateMutex();
+  if (!gUserDirMutex) {
+    Serial.println("FATAL: Failed to create user directory mutex");
+    while (1) delay(1000);
+  }
+
+  // Initialize session table mutex (HTTP workers authenticate off the server task)
+  gSessionMutex = xSemaphoreCreateRecursiveMutex();
+  if (!gSessionMutex) {
+    Serial.println("FATAL: Failed to create session mutex");
+    while (1) delay(1000);
+  }
+
+  // Initialize async CLI job table mutex
+  gCliJobMutex = xSemaphoreCreateMutex();
+  if (!gCliJobMutex) {
+    Serial.println("FATAL: Failed to create CLI job mutex");
+    while (1) delay(1000);
+  }
+
   // Initialize sensor cache mutex
   gSensorCache.mutex = xSemaphoreCreateMutex();
   if (!gSensorCache.mutex) {
@@ -11125,6 +13783,21 @@ void setup() {
   }
   // Start in 'available' state
   xSemaphoreGive(i2cMutex);
+  // Bus owner for the sensor tasks' Wire1 transactions
+  for (uint8_t d = 0; d < I2C_DEV_COUNT; ++d) {
+    gI2CBusReq[d].grant = xSemaphoreCreateBinary();
+    if (!gI2CBusReq[d].grant) {
+      Serial.println("FATAL: Failed to create I2C bus grant semaphore");
+      while (1) delay(1000);
+    }
+  }
+  gI2CBusStatsSinceMs = millis();
+  gI2CPerfSinceMs = gI2CBusStatsSinceMs;
+  // Clock switches log through DEBUG_CLIF (snprintf + Serial.printf) on this stack
+  if (xTaskCreate(i2cBusTask, "i2c_bus", 3072, nullptr, 2, &gI2CBusTask) != pdPASS) {
+    Serial.println("FATAL: Failed to create I2C bus task");
+    while (1) delay(1000);
+  }
 
   // Per-sensor tasks will be created lazily on first start to conserve RAM
 
@@ -11171,6 +13844,8 @@ void setup() {
     for (int i = 0; i < MAX_SESSIONS; i++) {
       new (&gSessions[i]) SessionEntry();
     }
+    sessIndexRebuild();
+    authCacheClear();
   }
 
   // Initialize logout reasons array
@@ -11189,6 +13864,11 @@ void setup() {
   // Filesystem FIRST to enable early allocation logging
   fsInit();
 
+  // Background heap/PSRAM telemetry (ring + per-tag allocation stats)
+  if (!memPerfInit()) {
+    Serial.println("WARNING: Memory telemetry unavailable");
+  }
+
   // Now safe to emit output (may allocate and will be logged)
   broadcastOutput("");
   broadcastOutput("Booting ESP32 Minimal Auth");
@@ -11293,8 +13973,6 @@ void loop() {
     performanceCounter();
   }
   
-  // ESP-NOW chunked message timeout cleanup
-  cleanupExpiredChunkedMessage();
   // Debounced SSE sensor-status broadcast
   if (gSensorStatusDirty) {
     unsigned long nowMs = millis();
@@ -11394,21 +14072,10 @@ void loop() {
     }
   }
 
-  // Automations scheduler: run immediately if a mutation recently occurred
-  // Skip if already in automation context to prevent recursion
-  if (gAutosDirty && !gInAutomationContext) {
+  // Automations scheduler: wake it immediately if a mutation recently occurred
+  if (gAutosDirty) {
     gAutosDirty = false;
-    schedulerTickMinute();
-  }
-
-  // Minute-based automations scheduler (runs once per minute)
-  // Skip if already in automation context to prevent recursion
-  if (!gInAutomationContext) {
-    unsigned long minuteNow = millis() / 60000UL;
-    if (minuteNow != gLastMinuteSeen) {
-      gLastMinuteSeen = minuteNow;
-      schedulerTickMinute();
-    }
+    autoSchedulerKick();
   }
 
   // All sensor polling now handled by unified sensor polling task - no loop processing needed
@@ -11494,6 +14161,13 @@ static String renderHelpSettings() {
                                    "System Time:\n"
                                    "  set tzOffsetMinutes <-720..720>   - Minutes offset from UTC (e.g., -240 for UTC-4)\n"
                                    "  set ntpServer <host>              - Validate and save NTP server host\n\n"
+                                   "Security:\n"
+                                   "  set passwordKdfIterations <1000..200000> - PBKDF2 rounds for stored passwords\n\n"
+                                   "HTTP Server (applied when the server restarts):\n"
+                                   "  set httpMaxSockets <2.." + String(kHttpMaxSocketsLimit) + ">" + (kHttpMaxSocketsLimit < 10 ? "         " : "        ")
+                                   + "- Concurrent client sockets\n"
+                                   "  set httpLruPurge <0|1>            - Close least recently used socket when full\n"
+                                   "  set httpWorkers <0..4>            - Workers for /api/cli and /api/events (0 = inline)\n\n"
                                    "Output Channels:\n"
                                    "  outserial [persist|temp] <0|1>    - Serial output (persisted or runtime)\n"
                                    "  outweb    [persist|temp] <0|1>    - Web output (persisted or runtime)\n"
@@ -11520,6 +14194,7 @@ static String renderHelpSettings() {
                                    "  thermaldevicepollms <50..5000>\n"
                                    "  tofdevicepollms <50..5000>\n"
                                    "  imudevicepollms <5..1000>\n"
+                                   "  sensoridlepollms <0|1000..600000>  - Poll period with no consumer (0 = sleep)\n"
                                    "  i2cclockthermalhz <100000..1000000>\n"
                                    "  i2cclocktofhz <50000..400000>\n\n"
                                    "Debug Controls (toggles):\n"
@@ -11528,6 +14203,9 @@ static String renderHelpSettings() {
                                    "  debugPerformance|debugDateTime|debugCommandFlow|debugUsers   <0|1>\n\n"
                                    "User Admin:\n"
                                    "  user promote <username>\n\n"
+                                   "ESP-NOW Telemetry:\n"
+                                   "  set espnowTelemetryPeer <name|off>  - Stream sensor summaries to a paired collector (both sides must use espnow pairsecure)\n"
+                                   "  set espnowTelemetryMs <100..60000>  - Telemetry interval (ms)\n\n"
                                    "Other Settings:\n"
                                    "  wifiautoreconnect <0|1>\n\n"
                                    "Type 'back' to return to help menu or 'exit' to return to CLI.";
@@ -11629,9 +14307,10 @@ static String exitHelpAndExecute(const String& originalCmd) {
   // Exit help, show banner, and then execute the original command in normal mode
   String banner = exitToNormalBanner() + "\n";
   AuthContext ctx;
-  ctx.transport = gExecFromWeb ? AUTH_HTTP : AUTH_SERIAL;
-  ctx.user = gExecUser;
-  ctx.ip = gExecFromWeb ? String() : String("local");
+  const ExecState& es = execState();
+  ctx.transport = es.fromWeb ? AUTH_HTTP : AUTH_SERIAL;
+  ctx.user = es.user;
+  ctx.ip = es.fromWeb ? String() : String("local");
   ctx.path = "/help/exit";
   String out;
   (void)executeCommand(ctx, originalCmd, out);
@@ -11865,11 +14544,45 @@ static String cmd_espnow_status_core() {
     }
     result += "\n";
     result += "  Paired Devices: " + String(gEspNowDeviceCount) + "\n";
+    uint32_t queued = gEspNowRxHead.load(std::memory_order_relaxed) - gEspNowRxTail.load(std::memory_order_relaxed);
+    result += "  RX: processed=" + String(gEspNowRxProcessed) + " queued=" + String(queued) + "/" + String(kEspNowRxSlots) + " dropped=" + String(gEspNowRxDropped.load(std::memory_order_relaxed)) + "\n";
+    const EspNowFrameStats& fs = gEspNowFrameStats;
+    result += "  Frames TX: sent=" + String(fs.txFrames) + " retransmitted=" + String(fs.txRetx) + " delivered=" + String(fs.txDone) + " failed=" + String(fs.txFailed) + "\n";
+    result += "  Sessions: " + String(espNowSessionCount(gEspNowSessOut)) + " outbound, " + String(espNowSessionCount(gEspNowSessIn)) + " inbound\n";
+    result += "  Telemetry: " + (gSettings.espnowTelemetryPeer.length() ? "to " + gSettings.espnowTelemetryPeer + " every " + String(gSettings.espnowTelemetryMs) + " ms, sent=" + String(gEspNowTelemSent) : String("off")) + "\n";
+    result += "  Frames RX: ok=" + String(fs.rxFrames) + " duplicate=" + String(fs.rxDup) + " bad=" + String(fs.rxBad) + " messages=" + String(fs.rxDone) + "\n";
   }
   
   return result;
 }
 
+static String cmd_espnow_telemetry_modern(const String& cmd) {
+  RETURN_VALID_IF_VALIDATE();
+  if (!lockSensorCache(pdMS_TO_TICKS(100))) return "Error: sensor cache busy";
+  String result = "ESP-NOW peer telemetry:\n";
+  uint32_t now = millis();
+  int shown = 0;
+  for (uint8_t i = 0; i < kEspNowTelemPeers; ++i) {
+    const EspNowPeerTelemetry& e = gEspNowPeerTelem[i];
+    if (!e.used) continue;
+    String name = getEspNowDeviceName(e.mac);
+    result += "  " + (name.length() ? name : formatMacAddress(e.mac)) + " (" + String((now - e.rxMs) / 1000) + "s ago, lost " + String(e.lost) + "/" + String(e.received + e.lost) + ")";
+    if (e.t.valid & kTelemThermal) result += " temp avg=" + String(e.t.thermAvg / 100.0f, 1) + " min=" + String(e.t.thermMin / 100.0f, 1) + " max=" + String(e.t.thermMax / 100.0f, 1);
+    if (e.t.valid & kTelemToF) {
+      result += " tof=";
+      for (int j = 0; j < e.t.tofCount && j < 4; j++) result += (j ? "," : "") + String(e.t.tofMm[j]);
+      result += e.t.tofCount ? "mm" : "none";
+    }
+    if (e.t.valid & kTelemImu) result += " yaw=" + String(e.t.yaw / 100.0f, 1) + " pitch=" + String(e.t.pitch / 100.0f, 1) + " roll=" + String(e.t.roll / 100.0f, 1);
+    result += "\n";
+    shown++;
+  }
+  unlockSensorCache();
+  if (!shown) result += "  (none received)\n";
+  if (gEspNowTelemRejected) result += "  Rejected: " + String(gEspNowTelemRejected) + " frames from peers not paired with 'espnow pairsecure'\n";
+  return result;
+}
+
 static String cmd_espnow_status_modern(const String& cmd) {
   RETURN_VALID_IF_VALIDATE();
   return cmd_espnow_status_core();
@@ -11963,156 +14676,1057 @@ static bool addEspNowPeerWithEncryption(const uint8_t* mac, bool useEncryption,
     broadcastOutput("[ESP-NOW] Failed to add peer: " + String(result));
     return false;
   }
-  
-  return true;
+  
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ESP-NOW framed transfers (see EspNowFrameHdr). Submitters queue messages under
+// gEspNowTxMutex; everything else runs on the espnow_rx worker. Every
+// esp_now_send() goes through espNowSendRecorded() so send callbacks, which
+// carry only the peer MAC, can be matched in order.
+// ---------------------------------------------------------------------------
+
+// CRC32 of a frame with its crc field taken as zero
+static uint32_t espNowFrameCrc(const uint8_t* frame, size_t len) {
+  EspNowFrameHdr h;
+  memcpy(&h, frame, sizeof(h));
+  h.crc = 0;
+  uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)&h, sizeof(h));
+  return esp_rom_crc32_le(crc, frame + sizeof(h), len - sizeof(h));
+}
+
+// Sends and records the send so its callback can be matched (any task)
+static esp_err_t espNowSendRecorded(const uint8_t* mac, const uint8_t* data, size_t len, uint8_t slot, uint16_t msgId, uint16_t seq) {
+  if (!gEspNowSendMutex) return esp_now_send(mac, data, len);
+  xSemaphoreTake(gEspNowSendMutex, portMAX_DELAY);
+  esp_err_t err = esp_now_send(mac, data, len);
+  if (err == ESP_OK && gEspNowTxInflightN < kEspNowTxInflightSlots) {
+    EspNowTxInflight& f = gEspNowTxInflight[gEspNowTxInflightN++];
+    memcpy(f.mac, mac, 6);
+    f.slot = slot;
+    f.msgId = msgId;
+    f.seq = seq;
+    f.sentMs = millis();
+    if (slot < kEspNowTxXfers) ++gEspNowTxCreditsUsed;
+  }
+  xSemaphoreGive(gEspNowSendMutex);
+  return err;
+}
+
+// Unframed send (text messages, legacy REMOTE: commands)
+static esp_err_t espNowSendPlain(const uint8_t* mac, const uint8_t* data, size_t len) {
+  return espNowSendRecorded(mac, data, len, kEspNowInflightPlain, 0, 0);
+}
+
+// Stamps and sends one frame
+static esp_err_t espNowFrameSend(const uint8_t* mac, uint8_t* frame, size_t len, uint8_t slot, uint16_t msgId, uint16_t seq) {
+  EspNowFrameHdr* h = (EspNowFrameHdr*)frame;
+  h->magic = ESPNOW_FRAME_MAGIC;
+  h->crc = espNowFrameCrc(frame, len);
+  return espNowSendRecorded(mac, frame, len, slot, msgId, seq);
+}
+
+static void espNowSendAck(const uint8_t* mac, uint8_t type, uint16_t msgId, uint16_t base, uint32_t sack) {
+  uint8_t frame[sizeof(EspNowFrameHdr) + sizeof(uint32_t)];
+  EspNowFrameHdr* h = (EspNowFrameHdr*)frame;
+  memset(h, 0, sizeof(*h));
+  h->type = type;
+  h->msgId = msgId;
+  h->seq = base;
+  memcpy(frame + sizeof(*h), &sack, sizeof(sack));
+  espNowFrameSend(mac, frame, sizeof(frame), kEspNowInflightCtl, msgId, base);
+}
+
+// Queues a message for reliable delivery to a peer (any task). False when the
+// message is too large, memory is short or all transfer slots are busy.
+static bool espNowSendMessage(const uint8_t* mac, uint8_t kind, uint8_t flags, const uint8_t* data, size_t len) {
+  if (!gEspNowTxMutex || len > kEspNowMaxMessageBytes) return false;
+  uint8_t* buf = nullptr;
+  if (len) {
+    buf = (uint8_t*)ps_alloc(len, AllocPref::PreferPSRAM, "espnow.txmsg");
+    if (!buf) return false;
+    memcpy(buf, data, len);
+  }
+  bool queued = false;
+  xSemaphoreTake(gEspNowTxMutex, portMAX_DELAY);
+  for (uint8_t i = 0; i < kEspNowTxXfers; ++i) {
+    EspNowTxXfer& x = gEspNowTx[i];
+    if (x.active) continue;
+    memset(&x, 0, sizeof(x));
+    memcpy(x.mac, mac, 6);
+    x.msgId = gEspNowNextMsgId++;
+    x.kind = kind;
+    x.flags = flags & kEspNowFrameOk;
+    x.buf = buf;
+    x.len = len;
+    x.count = len ? (len + kEspNowFramePayload - 1) / kEspNowFramePayload : 1;
+    x.rtoMs = kEspNowTxRtoMs;
+    x.startMs = millis();
+    x.active = true;
+    queued = true;
+    break;
+  }
+  xSemaphoreGive(gEspNowTxMutex);
+  if (!queued) {
+    free(buf);
+    return false;
+  }
+  if (gEspNowRxTask) xTaskNotifyGive(gEspNowRxTask);
+  return true;
+}
+
+// Caller holds gEspNowTxMutex; appends the result line to log, which the caller
+// broadcasts with espNowTxLogFlush() after releasing the mutex
+static void espNowTxFinish(EspNowTxXfer& x, bool ok, const char* why, String& log) {
+  String peer = getEspNowDeviceName(x.mac);
+  if (peer.length() == 0) peer = formatMacAddress(x.mac);
+  uint32_t ms = millis() - x.startMs;
+  if (log.length()) log += '\n';
+  if (ok) {
+    ++gEspNowFrameStats.txDone;
+    log += "[ESP-NOW] Delivered " + String(x.len) + " bytes to " + peer + " (" + String(x.count) + " frames, " + String(ms) + " ms)";
+  } else {
+    ++gEspNowFrameStats.txFailed;
+    log += "[ESP-NOW] Transfer to " + peer + " failed after " + String(ms) + " ms: " + why;
+  }
+  free(x.buf);
+  x.buf = nullptr;
+  x.active = false;
+}
+
+static void espNowTxLogFlush(const String& log) {
+  int start = 0;
+  while (start < (int)log.length()) {
+    int nl = log.indexOf('\n', start);
+    if (nl < 0) nl = log.length();
+    broadcastOutput(log.substring(start, nl));
+    start = nl + 1;
+  }
+}
+
+// Caller holds gEspNowTxMutex
+static EspNowTxXfer* espNowTxFind(const uint8_t* mac, uint16_t msgId) {
+  for (uint8_t i = 0; i < kEspNowTxXfers; ++i) {
+    EspNowTxXfer& x = gEspNowTx[i];
+    if (x.active && x.msgId == msgId && memcmp(x.mac, mac, 6) == 0) return &x;
+  }
+  return nullptr;
+}
+
+// ACK/RST from the receiver: slide the window, record selective ACKs and
+// fast-retransmit holes below the highest one (the link preserves order)
+static void espNowTxOnAck(const uint8_t* mac, const EspNowFrameHdr& h, uint32_t sack) {
+  String log;
+  xSemaphoreTake(gEspNowTxMutex, portMAX_DELAY);
+  EspNowTxXfer* x = espNowTxFind(mac, h.msgId);
+  if (x && h.type == ESPNOW_FRAME_RST) {
+    espNowTxFinish(*x, false, "rejected by receiver", log);
+  } else if (x) {
+    bool progress = false;
+    uint16_t rbase = h.seq > x->count ? x->count : h.seq;
+    if (rbase > x->base) {
+      uint16_t shift = rbase - x->base;
+      x->ackMask = shift >= 32 ? 0 : x->ackMask >> shift;
+      x->sentMask = shift >= 32 ? 0 : x->sentMask >> shift;
+      x->base = rbase;
+      progress = true;
+    }
+    uint32_t sel = sack << 1;  // relative to base; base itself is missing by definition
+    if (x->count - x->base < 32) sel &= (1u << (x->count - x->base)) - 1;
+    if (sel & ~x->ackMask) progress = true;
+    x->ackMask |= sel;
+    x->sentMask |= sel;
+    if (x->base >= x->count) {
+      espNowTxFinish(*x, true, nullptr, log);
+    } else {
+      if (sel) {
+        int hi = 31 - __builtin_clz(sel);
+        for (int i = 0; i < hi; ++i) {
+          uint32_t b = 1u << i;
+          if (x->base + i < x->fastMark || (x->ackMask & b) || !(x->sentMask & b)) continue;
+          x->sentMask &= ~b;
+          ++gEspNowFrameStats.txRetx;
+        }
+        if (x->base + hi + 1 > x->fastMark) x->fastMark = x->base + hi + 1;
+      }
+      if (progress) {
+        x->retries = 0;
+        x->rtoMs = kEspNowTxRtoMs;
+        x->rtoAtMs = (x->sentMask & ~x->ackMask) ? millis() + x->rtoMs : 0;
+      }
+    }
+  }
+  xSemaphoreGive(gEspNowTxMutex);
+  espNowTxLogFlush(log);
+  if (gEspNowRxTask) xTaskNotifyGive(gEspNowRxTask);
+}
+
+// Sends the lowest unsent frame in the window; false when there is none.
+// Caller holds gEspNowTxMutex.
+static bool espNowTxSendNext(EspNowTxXfer& x, uint8_t slot, esp_err_t& err) {
+  uint16_t lim = x.count - x.base < kEspNowTxWindow ? x.count - x.base : kEspNowTxWindow;
+  uint32_t win = lim >= 32 ? 0xFFFFFFFFu : (1u << lim) - 1;
+  uint32_t todo = win & ~(x.ackMask | x.sentMask);
+  if (!todo) return false;
+  int i = __builtin_ctz(todo);
+  uint16_t seq = x.base + i;
+  size_t off = (size_t)seq * kEspNowFramePayload;
+  size_t plen = x.len - off < kEspNowFramePayload ? x.len - off : kEspNowFramePayload;
+  uint8_t frame[ESP_NOW_MAX_DATA_LEN];
+  EspNowFrameHdr* h = (EspNowFrameHdr*)frame;
+  memset(h, 0, sizeof(*h));
+  h->type = ESPNOW_FRAME_DATA;
+  h->kind = x.kind;
+  h->msgId = x.msgId;
+  h->seq = seq;
+  h->count = x.count;
+  x.sentMask |= 1u << i;
+  h->flags = x.flags | (((x.sentMask | x.ackMask) & win) == win ? kEspNowFrameAckReq : 0);
+  if (plen) memcpy(frame + sizeof(*h), x.buf + off, plen);
+  err = espNowFrameSend(x.mac, frame, sizeof(*h) + plen, slot, x.msgId, seq);
+  if (err != ESP_OK) {
+    x.sentMask &= ~(1u << i);
+    return true;
+  }
+  ++gEspNowFrameStats.txFrames;
+  if (!x.rtoAtMs) x.rtoAtMs = millis() + x.rtoMs;
+  return true;
+}
+
+// Matches a send-callback completion to the oldest in-flight send for that
+// peer; plain sends (and any the table had no room for) just report the result
+static void espNowTxOnDone(const EspNowTxDone& d, uint32_t now) {
+  int idx = -1;
+  EspNowTxInflight f;
+  xSemaphoreTake(gEspNowSendMutex, portMAX_DELAY);
+  for (uint8_t i = 0; i < gEspNowTxInflightN; ++i) {
+    if (memcmp(gEspNowTxInflight[i].mac, d.mac, 6) == 0) {
+      idx = i;
+      break;
+    }
+  }
+  if (idx >= 0) {
+    f = gEspNowTxInflight[idx];
+    // Completions arrive in send order, so older records lost theirs
+    for (int i = 0; i <= idx; ++i) {
+      if (gEspNowTxInflight[i].slot < kEspNowTxXfers && gEspNowTxCreditsUsed) --gEspNowTxCreditsUsed;
+    }
+    gEspNowTxInflightN -= idx + 1;
+    memmove(gEspNowTxInflight, gEspNowTxInflight + idx + 1, gEspNowTxInflightN * sizeof(EspNowTxInflight));
+  }
+  xSemaphoreGive(gEspNowSendMutex);
+  if (idx < 0 || f.slot == kEspNowInflightPlain) {
+    String deviceName = getEspNowDeviceName(d.mac);
+    if (deviceName.length() == 0) deviceName = formatMacAddress(d.mac);
+    broadcastOutput("[ESP-NOW] Send to " + deviceName + ": " + (d.ok ? "Success" : "Failed"));
+    return;
+  }
+  if (f.slot == kEspNowInflightCtl) return;
+  xSemaphoreTake(gEspNowTxMutex, portMAX_DELAY);
+  EspNowTxXfer& x = gEspNowTx[f.slot];
+  if (x.active && x.msgId == f.msgId) {
+    if (d.ok) {
+      x.macFails = 0;
+    } else {
+      // The peer's radio did not acknowledge: resend that frame now, and back
+      // off through the timeout path if it keeps happening
+      uint16_t i = f.seq - x.base;
+      if (f.seq >= x.base && i < 32 && !(x.ackMask & (1u << i)) && (x.sentMask & (1u << i))) {
+        x.sentMask &= ~(1u << i);
+        ++gEspNowFrameStats.txRetx;
+      }
+      if (++x.macFails >= 3) x.rtoAtMs = now;
+    }
+  }
+  xSemaphoreGive(gEspNowTxMutex);
+}
+
+// Completes the exec-all row of a replying peer (espnow_rx worker)
+static void espNowFanoutRecord(const uint8_t* mac, bool ok, const String& text) {
+  if (!gEspNowFanoutMutex) return;
+  xSemaphoreTake(gEspNowFanoutMutex, portMAX_DELAY);
+  for (uint8_t i = 0; gEspNowFanout.active && i < gEspNowFanout.rows; ++i) {
+    EspNowFanoutRow& row = gEspNowFanout.row[i];
+    if (row.state != FANOUT_PENDING || memcmp(row.mac, mac, 6) != 0) continue;
+    row.state = ok ? FANOUT_OK : FANOUT_FAILED;
+    row.ms = millis() - gEspNowFanout.startMs;
+    int nl = text.indexOf('\n');
+    row.firstLine = (nl < 0) ? text : text.substring(0, nl);
+    row.firstLine.trim();
+    if (row.firstLine.length() > 60) row.firstLine = row.firstLine.substring(0, 57) + "...";
+    row.lines = 1;
+    for (const char* p = text.c_str(); (p = strchr(p, '\n')) != nullptr; ++p) {
+      if (p[1]) row.lines++;
+    }
+    if (--gEspNowFanout.pending == 0) xSemaphoreGive(gEspNowFanoutDone);
+    break;
+  }
+  xSemaphoreGive(gEspNowFanoutMutex);
+}
+
+// Completed (or timed out) message for the local side
+static void espNowDeliverMessage(const EspNowRxXfer& r) {
+  String peer = getEspNowDeviceName(r.mac);
+  if (peer.length() == 0) peer = formatMacAddress(r.mac);
+  if (r.kind == ESPNOW_MSG_RESULT) {
+    String text;
+    text.reserve(r.len);
+    text.concat((const char*)r.buf, r.len);
+    broadcastOutput("[ESP-NOW] Remote result from " + peer + " (" + ((r.flags & kEspNowFrameOk) ? "SUCCESS" : "FAILED") + "):");
+    broadcastOutput(text);
+    espNowFanoutRecord(r.mac, (r.flags & kEspNowFrameOk) != 0, text);
+  } else if (r.kind == ESPNOW_MSG_AUTH_HELLO) {
+    espNowAuthOnHello(r.mac, r.buf, r.len);
+  } else if (r.kind == ESPNOW_MSG_AUTH_PROOF) {
+    espNowAuthOnProof(r.mac, r.buf, r.len);
+  } else if (r.kind == ESPNOW_MSG_AUTH_CHALLENGE || r.kind == ESPNOW_MSG_AUTH_OK) {
+    espNowAuthOnReply(r.mac, r.kind, r.buf, r.len);
+  } else if (r.kind == ESPNOW_MSG_COMMAND) {
+    espNowAuthOnCommand(r.mac, r.buf, r.len);
+  } else {
+    DEBUG_WIFIF("[ESP-NOW] Ignoring message kind %u from %s (%u bytes)", (unsigned)r.kind, peer.c_str(), (unsigned)r.len);
+  }
+}
+
+// Claims a free reassembly slot for a new message
+static EspNowRxXfer* espNowRxXferOpen(const uint8_t* mac, const EspNowFrameHdr& h) {
+  EspNowRxXfer* r = nullptr;
+  for (uint8_t i = 0; i < kEspNowRxXfers && !r; ++i) {
+    if (!gEspNowRxX[i].active) r = &gEspNowRxX[i];
+  }
+  if (!r) return nullptr;
+  size_t words = (h.count + 31) / 32;
+  uint32_t* have = (uint32_t*)ps_alloc(words * sizeof(uint32_t) + (size_t)h.count * kEspNowFramePayload, AllocPref::PreferPSRAM, "espnow.rxmsg");
+  if (!have) return nullptr;
+  memset(have, 0, words * sizeof(uint32_t));
+  memset(r, 0, sizeof(*r));
+  memcpy(r->mac, mac, 6);
+  r->msgId = h.msgId;
+  r->kind = h.kind;
+  r->flags = h.flags & kEspNowFrameOk;
+  r->count = h.count;
+  r->have = have;
+  r->buf = (uint8_t*)(have + words);
+  r->active = true;
+  return r;
+}
+
+// Collector side: cache the latest summary from a peer (espnow_rx worker)
+static void espNowTelemetryStore(const uint8_t* mac, uint16_t seq, const uint8_t* payload) {
+  bool encrypted = false;
+  for (int i = 0; i < gEspNowDeviceCount; i++) {
+    if (memcmp(gEspNowDevices[i].mac, mac, 6) == 0) {
+      encrypted = gEspNowDevices[i].encrypted;
+      break;
+    }
+  }
+  if (!encrypted) {
+    if (gEspNowTelemRejected++ == 0) broadcastOutput("[ESP-NOW] Ignoring telemetry from " + formatMacAddress(mac) + ": peer not paired with 'espnow pairsecure'");
+    return;
+  }
+  String name = getEspNowDeviceName(mac);
+  uint32_t nameHash = name.length() ? cmdHashName(name.c_str(), name.length()) : 0;
+  if (nameHash == 0 && name.length()) nameHash = 1;  // matches condCompileTerm
+  if (!lockSensorCache(pdMS_TO_TICKS(20))) return;
+  EspNowPeerTelemetry* e = nullptr;
+  EspNowPeerTelemetry* spare = nullptr;  // a free entry, else the least recently heard peer
+  for (uint8_t i = 0; i < kEspNowTelemPeers && !e; ++i) {
+    EspNowPeerTelemetry& c = gEspNowPeerTelem[i];
+    if (c.used && memcmp(c.mac, mac, 6) == 0) {
+      e = &c;
+    } else if (!spare || (spare->used && (!c.used || (int32_t)(c.rxMs - spare->rxMs) < 0))) {
+      spare = &c;
+    }
+  }
+  if (!e) {
+    e = spare;
+    memset(e, 0, sizeof(*e));
+    memcpy(e->mac, mac, 6);
+    e->used = true;
+  } else if ((uint16_t)(seq - e->seq) > 1 && (uint16_t)(seq - e->seq) < 1000) {
+    e->lost += (uint16_t)(seq - e->seq) - 1;
+  }
+  e->seq = seq;
+  e->nameHash = nameHash;
+  e->rxMs = millis();
+  e->received++;
+  memcpy(&e->t, payload, sizeof(e->t));
+  unlockSensorCache();
+}
+
+// One framed packet (espnow_rx worker)
+static void espNowHandleFrame(const EspNowRxPacket& pkt) {
+  EspNowFrameHdr h;
+  memcpy(&h, pkt.data, sizeof(h));
+  if (espNowFrameCrc(pkt.data, pkt.len) != h.crc) {
+    ++gEspNowFrameStats.rxBad;
+    DEBUG_WIFIF("[ESP-NOW] Dropping frame with bad CRC (len=%u)", (unsigned)pkt.len);
+    return;
+  }
+  const uint8_t* payload = pkt.data + sizeof(h);
+  size_t plen = pkt.len - sizeof(h);
+  if (h.type == ESPNOW_FRAME_TELEMETRY) {
+    if (plen >= sizeof(EspNowTelemetry)) espNowTelemetryStore(pkt.mac, h.seq, payload);
+    return;
+  }
+  if (h.type == ESPNOW_FRAME_ACK || h.type == ESPNOW_FRAME_RST) {
+    uint32_t sack = 0;
+    if (plen >= sizeof(sack)) memcpy(&sack, payload, sizeof(sack));
+    espNowTxOnAck(pkt.mac, h, sack);
+    return;
+  }
+  bool lastFrame = h.count && h.seq + 1 == h.count;
+  if (h.type != ESPNOW_FRAME_DATA || h.seq >= h.count || (!lastFrame && plen != kEspNowFramePayload)) {
+    ++gEspNowFrameStats.rxBad;
+    return;
+  }
+  ++gEspNowFrameStats.rxFrames;
+
+  EspNowRxXfer* r = nullptr;
+  for (uint8_t i = 0; i < kEspNowRxXfers && !r; ++i) {
+    EspNowRxXfer& e = gEspNowRxX[i];
+    if (e.active && e.msgId == h.msgId && memcmp(e.mac, pkt.mac, 6) == 0) r = &e;
+  }
+  if (!r) {
+    for (uint8_t i = 0; i < kEspNowRxDoneRecs; ++i) {
+      const EspNowRxDoneRec& d = gEspNowRxDoneRecs[i];
+      if (d.count && d.msgId == h.msgId && memcmp(d.mac, pkt.mac, 6) == 0 && millis() - d.ms < kEspNowRxXferLingerMs) {
+        ++gEspNowFrameStats.rxDup;  // our final ACK was lost
+        espNowSendAck(pkt.mac, ESPNOW_FRAME_ACK, h.msgId, d.count, 0);
+        return;
+      }
+    }
+    if (h.count <= (kEspNowMaxMessageBytes + kEspNowFramePayload - 1) / kEspNowFramePayload) r = espNowRxXferOpen(pkt.mac, h);
+    if (!r) {
+      DEBUG_WIFIF("[ESP-NOW] Refusing message %u (%u frames): no reassembly slot", (unsigned)h.msgId, (unsigned)h.count);
+      espNowSendAck(pkt.mac, ESPNOW_FRAME_RST, h.msgId, 0, 0);
+      return;
+    }
+  }
+
+  bool ackNow = (h.flags & kEspNowFrameAckReq) != 0;
+  if (r->have[h.seq >> 5] & (1u << (h.seq & 31))) {
+    ++gEspNowFrameStats.rxDup;
+    ackNow = true;  // our ACK was lost
+  } else {
+    r->have[h.seq >> 5] |= 1u << (h.seq & 31);
+    memcpy(r->buf + (size_t)h.seq * kEspNowFramePayload, payload, plen);
+    if (lastFrame) r->len = (uint32_t)h.seq * kEspNowFramePayload + plen;
+    if (h.seq != r->base) ackNow = true;  // a hole below: report it early
+    while (r->base < r->count && (r->have[r->base >> 5] & (1u << (r->base & 31)))) ++r->base;
+    if (++r->sinceAck >= 4) ackNow = true;
+    if (++r->got == r->count) {
+      espNowDeliverMessage(*r);
+      ++gEspNowFrameStats.rxDone;
+      EspNowRxDoneRec& d = gEspNowRxDoneRecs[gEspNowRxDoneNext];
+      gEspNowRxDoneNext = (gEspNowRxDoneNext + 1) % kEspNowRxDoneRecs;
+      memcpy(d.mac, r->mac, 6);
+      d.msgId = r->msgId;
+      d.count = r->count;
+      d.ms = millis();
+      free(r->have);
+      r->have = nullptr;
+      r->buf = nullptr;
+      r->active = false;
+      espNowSendAck(pkt.mac, ESPNOW_FRAME_ACK, h.msgId, h.count, 0);
+      return;
+    }
+  }
+  r->lastMs = millis();
+  if (!ackNow) return;
+  uint32_t sack = 0;
+  for (uint16_t i = 0; i < 32 && r->base + 1 + i < r->count; ++i) {
+    uint16_t s = r->base + 1 + i;
+    if (r->have[s >> 5] & (1u << (s & 31))) sack |= 1u << i;
+  }
+  espNowSendAck(pkt.mac, ESPNOW_FRAME_ACK, r->msgId, r->base, sack);
+  r->sinceAck = 0;
+}
+
+// Drives framed transfers: send completions, retransmit timeouts, new frames
+// while driver credits last, and stale reassembly slots. Returns ms until the
+// next deadline, UINT32_MAX when idle.
+static uint32_t espNowFramesService() {
+  uint32_t now = millis();
+  uint32_t tail = gEspNowTxDoneTail.load(std::memory_order_relaxed);
+  while (tail != gEspNowTxDoneHead.load(std::memory_order_acquire)) {
+    EspNowTxDone d = gEspNowTxDone[tail & (kEspNowTxDoneSlots - 1)];
+    gEspNowTxDoneTail.store(++tail, std::memory_order_release);
+    espNowTxOnDone(d, now);
+  }
+  // A completion that never came (callback ring overflow) must not pin a credit
+  xSemaphoreTake(gEspNowSendMutex, portMAX_DELAY);
+  while (gEspNowTxInflightN && now - gEspNowTxInflight[0].sentMs > 500) {
+    if (gEspNowTxInflight[0].slot < kEspNowTxXfers && gEspNowTxCreditsUsed) --gEspNowTxCreditsUsed;
+    memmove(gEspNowTxInflight, gEspNowTxInflight + 1, --gEspNowTxInflightN * sizeof(EspNowTxInflight));
+  }
+  bool inflight = gEspNowTxInflightN != 0;
+  xSemaphoreGive(gEspNowSendMutex);
+
+  uint32_t wait = UINT32_MAX;
+  String log;
+  xSemaphoreTake(gEspNowTxMutex, portMAX_DELAY);
+  for (uint8_t i = 0; i < kEspNowTxXfers; ++i) {
+    EspNowTxXfer& x = gEspNowTx[i];
+    if (!x.active || !x.rtoAtMs || (int32_t)(now - x.rtoAtMs) < 0) continue;
+    uint32_t outstanding = x.sentMask & ~x.ackMask;
+    x.rtoAtMs = 0;
+    if (!outstanding) continue;
+    if (++x.retries > kEspNowTxMaxRetries) {
+      espNowTxFinish(x, false, "no acknowledgement", log);
+      continue;
+    }
+    gEspNowFrameStats.txRetx += __builtin_popcount(outstanding);
+    x.sentMask &= x.ackMask;
+    x.rtoMs = x.rtoMs * 2 > kEspNowTxRtoMaxMs ? kEspNowTxRtoMaxMs : x.rtoMs * 2;
+  }
+  while (gEspNowTxCreditsUsed < kEspNowTxCredits) {
+    bool sent = false;
+    for (uint8_t k = 0; k < kEspNowTxXfers && !sent; ++k) {
+      uint8_t slot = (gEspNowTxRr + k) % kEspNowTxXfers;
+      EspNowTxXfer& x = gEspNowTx[slot];
+      esp_err_t err = ESP_OK;
+      if (!x.active || !espNowTxSendNext(x, slot, err)) continue;
+      if (err == ESP_ERR_ESPNOW_NO_MEM) {
+        wait = 10;  // driver queue full: retry shortly
+        break;
+      }
+      if (err != ESP_OK) {
+        espNowTxFinish(x, false, esp_err_to_name(err), log);
+        continue;
+      }
+      gEspNowTxRr = slot + 1;
+      sent = true;
+    }
+    if (!sent) break;
+  }
+  for (uint8_t i = 0; i < kEspNowTxXfers; ++i) {
+    const EspNowTxXfer& x = gEspNowTx[i];
+    if (!x.active || !x.rtoAtMs) continue;
+    uint32_t left = (int32_t)(x.rtoAtMs - now) > 0 ? x.rtoAtMs - now : 1;
+    if (left < wait) wait = left;
+  }
+  xSemaphoreGive(gEspNowTxMutex);
+  espNowTxLogFlush(log);
+
+  for (uint8_t i = 0; i < kEspNowRxXfers; ++i) {
+    EspNowRxXfer& r = gEspNowRxX[i];
+    if (r.active && now - r.lastMs > kEspNowRxXferTimeoutMs) {
+      String peer = getEspNowDeviceName(r.mac);
+      if (peer.length() == 0) peer = formatMacAddress(r.mac);
+      broadcastOutput("[ESP-NOW] Transfer from " + peer + " timed out (" + String(r.got) + "/" + String(r.count) + " frames)");
+      free(r.have);
+      r.have = nullptr;
+      r.buf = nullptr;
+      r.active = false;
+    }
+    if (r.active && wait > 250) wait = 250;
+  }
+  if (inflight && wait > 100) wait = 100;
+  return wait;
+}
+
+// Node side: summarize the local sensor cache for the collector
+static void espNowTelemetrySample(EspNowTelemetry& t) {
+  memset(&t, 0, sizeof(t));
+  t.hotX = t.hotY = 0xFF;
+  if (!lockSensorCache(pdMS_TO_TICKS(20))) return;
+  if (gSensorCache.thermalDataValid) {
+    t.valid |= kTelemThermal;
+    t.thermMin = (int16_t)lroundf(gSensorCache.thermalMinTemp * 100.0f);
+    t.thermMax = (int16_t)lroundf(gSensorCache.thermalMaxTemp * 100.0f);
+    t.thermAvg = (int16_t)lroundf(gSensorCache.thermalAvgTemp * 100.0f);
+    if (gSensorCache.thermalFrame) {
+      int hot = 0;
+      for (int i = 1; i < 768; i++) {
+        if (gSensorCache.thermalFrame[i] > gSensorCache.thermalFrame[hot]) hot = i;
+      }
+      t.hotX = hot % 32;
+      t.hotY = hot / 32;
+    }
+  }
+  if (gSensorCache.tofDataValid) {
+    t.valid |= kTelemToF;
+    for (int j = 0; j < gSensorCache.tofTotalObjects && j < 4; j++) {
+      if (gSensorCache.tofObjects[j].valid) t.tofMm[t.tofCount++] = (uint16_t)gSensorCache.tofObjects[j].distance_mm;
+    }
+  }
+  if (gSensorCache.imuDataValid) {
+    t.valid |= kTelemImu;
+    t.yaw = (int16_t)lroundf(gSensorCache.oriYaw * 100.0f);
+    t.pitch = (int16_t)lroundf(gSensorCache.oriPitch * 100.0f);
+    t.roll = (int16_t)lroundf(gSensorCache.oriRoll * 100.0f);
+  }
+  unlockSensorCache();
+}
+
+// Sends a summary to the configured collector when due (espnow_rx worker).
+// Returns ms until the next one, UINT32_MAX when telemetry is off.
+static uint32_t espNowTelemetryService() {
+  if (gSettings.espnowTelemetryPeer.length() == 0) return UINT32_MAX;
+  uint32_t now = millis();
+  if ((int32_t)(gEspNowTelemNextMs - now) > 0) return gEspNowTelemNextMs - now;
+  gEspNowTelemNextMs = now + gSettings.espnowTelemetryMs;
+  for (int i = 0; i < gEspNowDeviceCount; i++) {
+    if (!gEspNowDevices[i].name.equalsIgnoreCase(gSettings.espnowTelemetryPeer)) continue;
+    uint8_t frame[sizeof(EspNowFrameHdr) + sizeof(EspNowTelemetry)];
+    EspNowFrameHdr* h = (EspNowFrameHdr*)frame;
+    memset(h, 0, sizeof(*h));
+    h->type = ESPNOW_FRAME_TELEMETRY;
+    h->seq = gEspNowTelemSeq++;
+    h->count = 1;
+    EspNowTelemetry t;
+    espNowTelemetrySample(t);
+    memcpy(frame + sizeof(*h), &t, sizeof(t));
+    if (espNowFrameSend(gEspNowDevices[i].mac, frame, sizeof(frame), 0xFF, 0, h->seq) == ESP_OK) ++gEspNowTelemSent;
+    break;
+  }
+  return gSettings.espnowTelemetryMs;
+}
+
+// Cached peer telemetry as JSON (collector side)
+static String espNowPeerTelemetryJson() {
+  String json = "{\"peers\":[";
+  if (!lockSensorCache(pdMS_TO_TICKS(100))) return "{\"error\":\"Sensor data temporarily unavailable\"}";
+  uint32_t now = millis();
+  bool first = true;
+  for (uint8_t i = 0; i < kEspNowTelemPeers; ++i) {
+    const EspNowPeerTelemetry& e = gEspNowPeerTelem[i];
+    if (!e.used) continue;
+    if (!first) json += ",";
+    first = false;
+    json += "{\"name\":\"" + getEspNowDeviceName(e.mac) + "\",\"mac\":\"" + formatMacAddress(e.mac) + "\"";
+    json += ",\"age\":" + String(now - e.rxMs) + ",\"seq\":" + String(e.seq) + ",\"received\":" + String(e.received) + ",\"lost\":" + String(e.lost);
+    if (e.t.valid & kTelemThermal) {
+      json += ",\"thermal\":{\"mn\":" + String(e.t.thermMin / 100.0f, 2) + ",\"mx\":" + String(e.t.thermMax / 100.0f, 2) + ",\"avg\":" + String(e.t.thermAvg / 100.0f, 2);
+      if (e.t.hotX != 0xFF) json += ",\"hot\":[" + String(e.t.hotX) + "," + String(e.t.hotY) + "]";
+      json += "}";
+    }
+    if (e.t.valid & kTelemToF) {
+      json += ",\"tof\":[";
+      for (int j = 0; j < e.t.tofCount && j < 4; j++) {
+        if (j) json += ",";
+        json += String(e.t.tofMm[j]);
+      }
+      json += "]";
+    }
+    if (e.t.valid & kTelemImu) {
+      json += ",\"ori\":{\"yaw\":" + String(e.t.yaw / 100.0f, 2) + ",\"pitch\":" + String(e.t.pitch / 100.0f, 2) + ",\"roll\":" + String(e.t.roll / 100.0f, 2) + "}";
+    }
+    json += "}";
+  }
+  unlockSensorCache();
+  json += "]}";
+  return json;
 }
 
-// Send chunked ESP-NOW response
+// Send a command result back to the requesting peer as a framed transfer
 static void sendChunkedResponse(const uint8_t* targetMac, bool success, const String& result, const String& senderName) {
-  // For short results, send single message (backwards compatibility)
-  if (result.length() <= CHUNK_SIZE) {
-    String responseMessage = String("RESULT:") + (success ? "SUCCESS" : "FAILED") + ":" + result;
-    if (responseMessage.length() > 240) {
-      responseMessage = responseMessage.substring(0, 237) + "...";
-    }
-    
-    esp_err_t sendResult = esp_now_send(targetMac, (uint8_t*)responseMessage.c_str(), responseMessage.length());
-    if (sendResult == ESP_OK) {
-      broadcastOutput("[ESP-NOW] Response sent to " + senderName);
-    } else {
-      broadcastOutput("[ESP-NOW] Failed to send response to " + senderName + ": " + String(sendResult));
-    }
-    return;
+  if (espNowSendMessage(targetMac, ESPNOW_MSG_RESULT, success ? kEspNowFrameOk : 0, (const uint8_t*)result.c_str(), result.length())) {
+    broadcastOutput("[ESP-NOW] Sending response to " + senderName + " (" + String(result.length()) + " bytes)");
+  } else {
+    broadcastOutput("[ESP-NOW] Failed to queue response to " + senderName);
   }
-  
-  // Multi-chunk transmission for long results
-  String hash = String(millis() % 10000); // Simple hash for message identification
-  int totalChunks = (result.length() + CHUNK_SIZE - 1) / CHUNK_SIZE;
-  if (totalChunks > MAX_CHUNKS) totalChunks = MAX_CHUNKS; // Limit to max chunks
-  
-  broadcastOutput("[ESP-NOW] Sending chunked response to " + senderName + " (" + String(totalChunks) + " chunks)");
-  
-  // Send START message
-  String startMsg = String("RESULT_START:") + (success ? "SUCCESS" : "FAILED") + 
-                   ":" + String(totalChunks) + ":" + String(result.length()) + ":" + hash;
-  esp_now_send(targetMac, (uint8_t*)startMsg.c_str(), startMsg.length());
-  delay(50); // Small delay between messages
-  
-  // Send chunks
-  for (int i = 0; i < totalChunks; i++) {
-    int start = i * CHUNK_SIZE;
-    int end = min(start + CHUNK_SIZE, (int)result.length());
-    String chunk = result.substring(start, end);
-    
-    String chunkMsg = String("RESULT_CHUNK:") + String(i + 1) + ":" + chunk;
-    esp_now_send(targetMac, (uint8_t*)chunkMsg.c_str(), chunkMsg.length());
-    delay(50); // Prevent message flooding
+}
+
+// Joins the chunks received so far, in order
+static String chunkedAssemble(const ChunkedMessage& m) {
+  String out;
+  for (int i = 0; i < m.totalChunks && i < MAX_CHUNKS; i++) {
+    if (m.chunkMask & (1u << i)) out.concat((const char*)m.data + i * CHUNK_SIZE, m.chunkLen[i]);
   }
-  
-  // Send END message
-  String endMsg = String("RESULT_END:") + hash;
-  esp_now_send(targetMac, (uint8_t*)endMsg.c_str(), endMsg.length());
-  
-  broadcastOutput("[ESP-NOW] Chunked response transmission complete");
+  return out;
 }
 
-// Cleanup expired chunked messages (5 second timeout)
+// Frees the entry at position pos of the active list
+static void chunkedRelease(uint8_t pos) {
+  gChunked[gChunkedActive[pos]].active = false;
+  gChunkedActive[pos] = gChunkedActive[--gChunkedActiveCount];
+}
+
+// Reports a partial result and frees the entry
+static void chunkedAbandon(uint8_t pos, const char* why) {
+  ChunkedMessage& m = gChunked[gChunkedActive[pos]];
+  String deviceName = getEspNowDeviceName(m.mac);
+  if (deviceName.length() == 0) deviceName = formatMacAddress(m.mac);
+  broadcastOutput("[ESP-NOW] Chunked message " + String(why) + " from " + deviceName + " - showing partial result:");
+  String partialResult = chunkedAssemble(m);
+  if (partialResult.length() > 0) {
+    broadcastOutput(partialResult);
+  }
+  broadcastOutput("[ESP-NOW] Error: Incomplete message (" + String(m.receivedChunks) + "/" + String(m.totalChunks) + " chunks received)");
+  chunkedRelease(pos);
+}
+
+// Cleanup expired chunked messages (5 second timeout); visits active entries only
 static void cleanupExpiredChunkedMessage() {
-  if (gActiveMessage.active && (millis() - gActiveMessage.startTime > 5000)) {
-    broadcastOutput("[ESP-NOW] Chunked message timeout from " + gActiveMessage.deviceName + " - showing partial result:");
-    
-    // Show partial result
-    String partialResult = "";
-    for (int i = 0; i < gActiveMessage.receivedChunks && i < MAX_CHUNKS; i++) {
-      if (gActiveMessage.chunks[i].length() > 0) {
-        partialResult += gActiveMessage.chunks[i];
-      }
-    }
-    
-    if (partialResult.length() > 0) {
-      broadcastOutput(partialResult);
-    }
-    broadcastOutput("[ESP-NOW] Error: Incomplete message (" + String(gActiveMessage.receivedChunks) + "/" + String(gActiveMessage.totalChunks) + " chunks received)");
-    
-    // Reset state
-    gActiveMessage.active = false;
-    for (int i = 0; i < MAX_CHUNKS; i++) {
-      gActiveMessage.chunks[i] = "";
-    }
+  unsigned long now = millis();
+  for (int pos = (int)gChunkedActiveCount - 1; pos >= 0; --pos) {
+    if (now - gChunked[gChunkedActive[pos]].startTime > 5000) chunkedAbandon(pos, "timeout");
+  }
+}
+
+// Position in the active list of the newest entry from mac (matching hash when
+// given), or -1. RESULT_CHUNK carries no hash, so chunks go to the newest entry.
+static int chunkedFind(const uint8_t* mac, const char* hash) {
+  int best = -1;
+  for (uint8_t pos = 0; pos < gChunkedActiveCount; ++pos) {
+    const ChunkedMessage& m = gChunked[gChunkedActive[pos]];
+    if (memcmp(m.mac, mac, 6) != 0 || (hash && strcmp(m.hash, hash) != 0)) continue;
+    if (best < 0 || (long)(m.startTime - gChunked[gChunkedActive[best]].startTime) >= 0) best = pos;
   }
+  return best;
 }
 
 // Handle chunked message assembly
-static void handleChunkedMessage(const String& message, const String& deviceName) {
+static void handleChunkedMessage(const String& message, const String& deviceName, const uint8_t* mac) {
+  if (!gChunkedArena) return;
   if (message.startsWith("RESULT_START:")) {
     // Parse: RESULT_START:SUCCESS:4:800:ABC123
-    cleanupExpiredChunkedMessage(); // Clean up any previous incomplete message
-    
     int colon1 = message.indexOf(':', 13); // After "RESULT_START:"
     int colon2 = message.indexOf(':', colon1 + 1);
     int colon3 = message.indexOf(':', colon2 + 1);
-    int colon4 = message.indexOf(':', colon3 + 1);
     
-    if (colon1 > 0 && colon2 > 0 && colon3 > 0 && colon4 > 0) {
-      gActiveMessage.status = message.substring(13, colon1);
-      gActiveMessage.totalChunks = message.substring(colon1 + 1, colon2).toInt();
-      // Skip total length (colon2 to colon3)
-      gActiveMessage.hash = message.substring(colon4 + 1);
-      gActiveMessage.deviceName = deviceName;
-      gActiveMessage.receivedChunks = 0;
-      gActiveMessage.startTime = millis();
-      gActiveMessage.active = true;
-      
-      // Clear chunk array
-      for (int i = 0; i < MAX_CHUNKS; i++) {
-        gActiveMessage.chunks[i] = "";
+    if (colon1 > 0 && colon2 > 0 && colon3 > 0) {
+      String hash = message.substring(colon3 + 1);
+      int pos = chunkedFind(mac, hash.c_str());
+      if (pos >= 0) chunkedRelease(pos);  // restarted by the sender
+      if (gChunkedActiveCount == kChunkedSlots) {
+        int oldest = 0;
+        for (uint8_t p = 1; p < gChunkedActiveCount; ++p) {
+          if ((long)(gChunked[gChunkedActive[p]].startTime - gChunked[gChunkedActive[oldest]].startTime) < 0) oldest = p;
+        }
+        chunkedAbandon(oldest, "evicted");
       }
+      uint8_t idx = 0;
+      while (gChunked[idx].active) idx++;
+      ChunkedMessage& m = gChunked[idx];
+      memcpy(m.mac, mac, 6);
+      strlcpy(m.hash, hash.c_str(), sizeof(m.hash));
+      strlcpy(m.status, message.substring(13, colon1).c_str(), sizeof(m.status));
+      long total = message.substring(colon1 + 1, colon2).toInt();
+      // Skip total length (colon2 to colon3)
+      m.totalChunks = (uint8_t)(total < 0 ? 0 : (total > MAX_CHUNKS ? MAX_CHUNKS : total));
+      m.receivedChunks = 0;
+      m.chunkMask = 0;
+      m.data = gChunkedArena + (size_t)idx * MAX_CHUNKS * CHUNK_SIZE;
+      m.startTime = millis();
+      m.active = true;
+      gChunkedActive[gChunkedActiveCount++] = idx;
       
-      broadcastOutput("[ESP-NOW] Starting chunked message from " + deviceName + " (" + String(gActiveMessage.totalChunks) + " chunks expected)");
+      broadcastOutput("[ESP-NOW] Starting chunked message from " + deviceName + " (" + String(m.totalChunks) + " chunks expected)");
     }
     
-  } else if (message.startsWith("RESULT_CHUNK:") && gActiveMessage.active) {
+  } else if (message.startsWith("RESULT_CHUNK:")) {
     // Parse: RESULT_CHUNK:1:chunk_data
+    int pos = chunkedFind(mac, nullptr);
     int colon1 = message.indexOf(':', 13); // After "RESULT_CHUNK:"
-    int colon2 = message.indexOf(':', colon1 + 1);
     
-    if (colon1 > 0 && colon2 > 0) {
+    if (pos >= 0 && colon1 > 0) {
+      ChunkedMessage& m = gChunked[gChunkedActive[pos]];
       int chunkNum = message.substring(13, colon1).toInt();
-      String chunkData = message.substring(colon2 + 1);
+      unsigned dataLen = message.length() - (colon1 + 1);
+      if (dataLen > CHUNK_SIZE) dataLen = CHUNK_SIZE;
       
       if (chunkNum >= 1 && chunkNum <= MAX_CHUNKS) {
-        gActiveMessage.chunks[chunkNum - 1] = chunkData; // Convert to 0-based index
-        gActiveMessage.receivedChunks++;
+        int i = chunkNum - 1; // Convert to 0-based index
+        memcpy(m.data + i * CHUNK_SIZE, message.c_str() + colon1 + 1, dataLen);
+        m.chunkLen[i] = (uint8_t)dataLen;
+        if (!(m.chunkMask & (1u << i))) {
+          m.chunkMask |= 1u << i;
+          m.receivedChunks++;
+        }
         
-        broadcastOutput("[ESP-NOW] Received chunk " + String(chunkNum) + "/" + String(gActiveMessage.totalChunks) + " from " + deviceName);
+        broadcastOutput("[ESP-NOW] Received chunk " + String(chunkNum) + "/" + String(m.totalChunks) + " from " + deviceName);
       }
     }
     
-  } else if (message.startsWith("RESULT_END:") && gActiveMessage.active) {
+  } else if (message.startsWith("RESULT_END:")) {
     // Parse: RESULT_END:ABC123
-    String endHash = message.substring(11);
+    int pos = chunkedFind(mac, message.c_str() + 11);
     
-    if (endHash == gActiveMessage.hash) {
-      // Assemble all chunks and display
-      String fullResult = "";
-      for (int i = 0; i < gActiveMessage.totalChunks && i < MAX_CHUNKS; i++) {
-        fullResult += gActiveMessage.chunks[i];
-      }
-      
-      broadcastOutput("[ESP-NOW] Remote result from " + gActiveMessage.deviceName + " (" + gActiveMessage.status + "):");
-      broadcastOutput(fullResult);
+    if (pos >= 0) {
+      ChunkedMessage& m = gChunked[gChunkedActive[pos]];
+      String text = chunkedAssemble(m);
+      broadcastOutput("[ESP-NOW] Remote result from " + deviceName + " (" + String(m.status) + "):");
+      broadcastOutput(text);
+      espNowFanoutRecord(mac, strcmp(m.status, "SUCCESS") == 0, text);
       
-      if (gActiveMessage.receivedChunks < gActiveMessage.totalChunks) {
-        broadcastOutput("[ESP-NOW] Warning: Missing " + String(gActiveMessage.totalChunks - gActiveMessage.receivedChunks) + " chunks");
+      if (m.receivedChunks < m.totalChunks) {
+        broadcastOutput("[ESP-NOW] Warning: Missing " + String(m.totalChunks - m.receivedChunks) + " chunks");
       }
       
-      // Cleanup
-      gActiveMessage.active = false;
-      for (int i = 0; i < MAX_CHUNKS; i++) {
-        gActiveMessage.chunks[i] = "";
-      }
-    }
+      chunkedRelease(pos);
+    }
+  }
+}
+
+// HMAC-SHA256 over the concatenation of up to three parts
+static bool espNowHmac(const uint8_t* key, size_t keyLen, const void* a, size_t aLen, const void* b, size_t bLen, const void* c, size_t cLen, uint8_t* out) {
+  const mbedtls_md_info_t* info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+  if (!info) return false;
+  mbedtls_md_context_t md;
+  mbedtls_md_init(&md);
+  int rc = mbedtls_md_setup(&md, info, 1);
+  if (rc == 0) rc = mbedtls_md_hmac_starts(&md, key, keyLen);
+  if (rc == 0 && aLen) rc = mbedtls_md_hmac_update(&md, (const uint8_t*)a, aLen);
+  if (rc == 0 && bLen) rc = mbedtls_md_hmac_update(&md, (const uint8_t*)b, bLen);
+  if (rc == 0 && cLen) rc = mbedtls_md_hmac_update(&md, (const uint8_t*)c, cLen);
+  if (rc == 0) rc = mbedtls_md_hmac_finish(&md, out);
+  mbedtls_md_free(&md);
+  return rc == 0;
+}
+
+static bool espNowTagEqual(const uint8_t* a, const uint8_t* b, size_t n) {
+  uint8_t diff = 0;  // constant-time compare
+  for (size_t i = 0; i < n; ++i) diff |= a[i] ^ b[i];
+  return diff == 0;
+}
+
+// HMAC over a label, both nonces and the user: "proof" keyed by StoredKey gives
+// the signature the proof is masked with, "session" keyed by ClientKey the
+// session key
+static bool espNowAuthMac(const uint8_t* key, const char* label, const uint8_t* nonceA, const uint8_t* nonceB, const char* user, uint8_t* out) {
+  uint8_t nonces[2 * kEspNowNonceBytes];
+  memcpy(nonces, nonceA, kEspNowNonceBytes);
+  memcpy(nonces + kEspNowNonceBytes, nonceB, kEspNowNonceBytes);
+  return espNowHmac(key, 32, label, strlen(label), nonces, sizeof(nonces), user, strlen(user), out);
+}
+
+// Slot for a peer: its current one, else a free one, else the one expiring first
+static EspNowSession* espNowSessionSlot(EspNowSession* table, uint8_t slots, const uint8_t* mac) {
+  EspNowSession* victim = &table[0];
+  for (uint8_t i = 0; i < slots; ++i) {
+    EspNowSession& s = table[i];
+    if (s.state != SESSION_FREE && memcmp(s.mac, mac, 6) == 0) return &s;
+  }
+  for (uint8_t i = 0; i < slots; ++i) {
+    EspNowSession& s = table[i];
+    if (s.state == SESSION_FREE) return &s;
+    if ((int32_t)(s.expiresMs - victim->expiresMs) < 0) victim = &s;
+  }
+  return victim;
+}
+
+// Live session with a peer, or nullptr; expired entries are freed on the way
+static EspNowSession* espNowSessionFind(EspNowSession* table, uint8_t slots, const uint8_t* mac, uint8_t state) {
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < slots; ++i) {
+    EspNowSession& s = table[i];
+    if (s.state == SESSION_FREE || memcmp(s.mac, mac, 6) != 0) continue;
+    if ((int32_t)(s.expiresMs - now) <= 0) {
+      memset(&s, 0, sizeof(s));
+      return nullptr;
+    }
+    return s.state == state ? &s : nullptr;
+  }
+  return nullptr;
+}
+
+static uint8_t espNowSessionCount(const EspNowSession* table) {
+  uint32_t now = millis();
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < kEspNowSessionSlots; ++i) {
+    if (table[i].state == SESSION_ESTABLISHED && (int32_t)(table[i].expiresMs - now) > 0) n++;
+  }
+  return n;
+}
+
+// Server side of "espnow login": answer with a nonce and the user's KDF salt.
+// Unknown users and credentials not yet migrated to SCRAM$ (until the account
+// logs in locally once) get a random key and fail at the proof exactly like a
+// wrong password. Their salt is HMAC(decoy secret, user) with a fixed iteration
+// count, so it is as stable across HELLOs as a real account's.
+static void espNowAuthOnHello(const uint8_t* mac, const uint8_t* buf, size_t len) {
+  if (len != sizeof(EspNowAuthHello)) return;
+  EspNowAuthHello h;
+  memcpy(&h, buf, sizeof(h));
+  h.user[sizeof(h.user) - 1] = '\0';
+
+  EspNowAuthChallenge c;
+  uint8_t storedKey[kPasswordKeyBytes];
+  static_assert(sizeof(c.salt) == kPasswordSaltBytes, "challenge carries the stored salt");
+  uint32_t iterations = 0;
+  bool known = false;
+  if (filesystemReady && userDirAcquire()) {
+    int idx = userDirFind(h.user, strlen(h.user));
+    String stored = (idx >= 0) ? String(userDirStr(gUserDir[idx].credOff)) : String("");
+    userDirRelease();
+    known = parsePasswordKdf(stored, kPasswordScramPrefix, iterations, c.salt, storedKey);
+  }
+  if (!known) {
+    uint8_t decoy[32];
+    espNowHmac(gEspNowDecoySecret, sizeof(gEspNowDecoySecret), "salt", 4, h.user, strlen(h.user), nullptr, 0, decoy);
+    memcpy(c.salt, decoy, sizeof(c.salt));
+    iterations = kEspNowDecoyIterations;
+    esp_fill_random(storedKey, sizeof(storedKey));
+  }
+  c.iterations = iterations;
+  memcpy(c.nonceA, h.nonceA, kEspNowNonceBytes);
+  esp_fill_random(c.nonceB, kEspNowNonceBytes);
+
+  // A repeated HELLO restarts the peer's pending login; a flood of spoofed ones
+  // only churns the pending slots
+  EspNowSession* s = espNowSessionSlot(gEspNowSessPending, kEspNowPendingSlots, mac);
+  memset(s, 0, sizeof(*s));
+  s->state = SESSION_CHALLENGED;
+  memcpy(s->mac, mac, 6);
+  strlcpy(s->user, h.user, sizeof(s->user));
+  memcpy(s->nonceA, c.nonceA, kEspNowNonceBytes);
+  memcpy(s->nonceB, c.nonceB, kEspNowNonceBytes);
+  memcpy(s->key, storedKey, sizeof(s->key));
+  s->expiresMs = millis() + kEspNowHandshakeMs;
+  memset(storedKey, 0, sizeof(storedKey));
+  espNowSendMessage(mac, ESPNOW_MSG_AUTH_CHALLENGE, 0, (const uint8_t*)&c, sizeof(c));
+}
+
+static void espNowAuthOnProof(const uint8_t* mac, const uint8_t* buf, size_t len) {
+  if (len != sizeof(EspNowAuthProof)) return;
+  EspNowAuthProof p;
+  memcpy(&p, buf, sizeof(p));
+  EspNowSession* s = espNowSessionFind(gEspNowSessPending, kEspNowPendingSlots, mac, SESSION_CHALLENGED);
+  if (!s || !espNowTagEqual(s->nonceB, p.nonceB, kEspNowNonceBytes)) return;
+
+  String peer = getEspNowDeviceName(mac);
+  if (peer.length() == 0) peer = formatMacAddress(mac);
+  EspNowAuthOk ok;
+  memset(&ok, 0, sizeof(ok));
+  memcpy(ok.nonceB, s->nonceB, kEspNowNonceBytes);
+  // ClientKey = proof xor HMAC(StoredKey, ...); it is genuine if it hashes to StoredKey
+  uint8_t clientKey[32];
+  uint8_t expect[32];
+  uint8_t sessionKey[32];
+  bool valid = espNowAuthMac(s->key, "proof", s->nonceA, s->nonceB, s->user, clientKey);
+  for (int i = 0; i < 32; ++i) clientKey[i] ^= p.proof[i];
+  valid = valid && mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), clientKey, sizeof(clientKey), expect) == 0
+          && espNowTagEqual(expect, s->key, sizeof(expect))
+          && espNowAuthMac(clientKey, "session", s->nonceA, s->nonceB, s->user, sessionKey);
+  memset(clientKey, 0, sizeof(clientKey));
+  if (valid) {
+    // Only a verified login takes a session slot: the peer's previous one,
+    // else a free one, else the one expiring first
+    EspNowSession* e = espNowSessionSlot(gEspNowSessIn, kEspNowSessionSlots, mac);
+    memcpy(e, s, sizeof(*e));
+    memset(s, 0, sizeof(*s));
+    s = e;
+    memcpy(s->key, sessionKey, sizeof(s->key));
+    s->sessionId = esp_random() | 1;  // never 0
+    s->ctr = 0;
+    s->seen = 0;
+    s->expiresMs = millis() + kEspNowSessionTtlMs;
+    s->state = SESSION_ESTABLISHED;
+    ok.sessionId = s->sessionId;
+    ok.ttlMs = kEspNowSessionTtlMs;
+    uint8_t tag[32];
+    espNowHmac(s->key, sizeof(s->key), "ok", 2, &ok, offsetof(EspNowAuthOk, tag), nullptr, 0, tag);
+    memcpy(ok.tag, tag, kEspNowTagBytes);
+    broadcastOutput("[ESP-NOW] Session established for user '" + String(s->user) + "' from " + peer + " (" + String(kEspNowSessionTtlMs / 60000UL) + " min)");
+  } else {
+    broadcastOutput("[ESP-NOW] Session login failed for user '" + String(s->user) + "' from " + peer);
+    memset(s, 0, sizeof(*s));
+  }
+  memset(sessionKey, 0, sizeof(sessionKey));
+  espNowSendMessage(mac, ESPNOW_MSG_AUTH_OK, 0, (const uint8_t*)&ok, sizeof(ok));
+}
+
+// Client side: hand the awaited reply to the waiting "espnow login"
+static void espNowAuthOnReply(const uint8_t* mac, uint8_t kind, const uint8_t* buf, size_t len) {
+  if (!gEspNowSessMutex) return;
+  xSemaphoreTake(gEspNowSessMutex, portMAX_DELAY);
+  EspNowLogin& l = gEspNowLogin;
+  if (l.active && !l.got && l.stage == kind && memcmp(l.mac, mac, 6) == 0) {
+    if (kind == ESPNOW_MSG_AUTH_CHALLENGE && len == sizeof(l.challenge)) {
+      memcpy(&l.challenge, buf, len);
+      l.got = true;
+    } else if (kind == ESPNOW_MSG_AUTH_OK && len == sizeof(l.ok)) {
+      memcpy(&l.ok, buf, len);
+      l.got = true;
+    }
+    if (l.got) xSemaphoreGive(gEspNowLoginSignal);
+  }
+  xSemaphoreGive(gEspNowSessMutex);
+}
+
+// Session-tagged command: session lookup, counter and one HMAC, no user file or KDF
+static void espNowAuthOnCommand(const uint8_t* mac, const uint8_t* buf, size_t len) {
+  if (len <= sizeof(EspNowCmdHdr)) return;
+  EspNowCmdHdr h;
+  memcpy(&h, buf, sizeof(h));
+  String peer = getEspNowDeviceName(mac);
+  if (peer.length() == 0) peer = formatMacAddress(mac);
+
+  EspNowSession* s = espNowSessionFind(gEspNowSessIn, kEspNowSessionSlots, mac, SESSION_ESTABLISHED);
+  if (!s || s->sessionId != h.sessionId) {
+    broadcastOutput("[ESP-NOW] Session command from " + peer + " rejected: no session");
+    sendChunkedResponse(mac, false, "No valid session; run 'espnow login' again", peer);
+    return;
+  }
+  uint32_t back = s->ctr - h.ctr;  // how far below the highest accepted counter
+  if (h.ctr == 0 || (h.ctr <= s->ctr && (back >= 32 || (s->seen & (1u << back))))) {
+    broadcastOutput("[ESP-NOW] Session command from " + peer + " dropped: replayed counter " + String(h.ctr));
+    return;
+  }
+  uint8_t tag[32];
+  if (!espNowHmac(s->key, sizeof(s->key), &h, offsetof(EspNowCmdHdr, tag), buf + sizeof(h), len - sizeof(h), nullptr, 0, tag)
+      || !espNowTagEqual(tag, h.tag, kEspNowTagBytes)) {
+    broadcastOutput("[ESP-NOW] Session command from " + peer + " rejected: bad tag");
+    sendChunkedResponse(mac, false, "Authentication failed", peer);
+    return;
+  }
+  if (h.ctr > s->ctr) {
+    uint32_t shift = h.ctr - s->ctr;
+    s->seen = (shift >= 32) ? 1u : ((s->seen << shift) | 1u);
+    s->ctr = h.ctr;
+  } else {
+    s->seen |= 1u << back;
+  }
+
+  String username = s->user;
+  String command;
+  command.concat((const char*)buf + sizeof(h), len - sizeof(h));
+  broadcastOutput("[ESP-NOW] Session command from " + peer + ": user='" + username + "' cmd='" + command + "'");
+  espNowRunRemoteCommand(mac, peer, username, command);
+}
+
+// Sends a command under the established session with a peer (any task)
+static bool espNowSessionSend(const uint8_t* mac, const String& command, String& err) {
+  EspNowCmdHdr h;
+  uint8_t key[32];
+  xSemaphoreTake(gEspNowSessMutex, portMAX_DELAY);
+  EspNowSession* s = espNowSessionFind(gEspNowSessOut, kEspNowSessionSlots, mac, SESSION_ESTABLISHED);
+  if (s) {
+    h.sessionId = s->sessionId;
+    h.ctr = ++s->ctr;
+    memcpy(key, s->key, sizeof(key));
+  }
+  xSemaphoreGive(gEspNowSessMutex);
+  if (!s) {
+    err = "no session (run 'espnow login')";
+    return false;
+  }
+
+  size_t len = sizeof(h) + command.length();
+  uint8_t* msg = (uint8_t*)ps_alloc(len, AllocPref::PreferPSRAM, "espnow.cmd");
+  if (!msg) {
+    err = "out of memory";
+    return false;
   }
+  uint8_t tag[32];
+  espNowHmac(key, sizeof(key), &h, offsetof(EspNowCmdHdr, tag), command.c_str(), command.length(), nullptr, 0, tag);
+  memcpy(h.tag, tag, kEspNowTagBytes);
+  memcpy(msg, &h, sizeof(h));
+  memcpy(msg + sizeof(h), command.c_str(), command.length());
+  // exec-all sends to more peers than there are transfer slots; wait for one to free up
+  bool queued = espNowSendMessage(mac, ESPNOW_MSG_COMMAND, 0, msg, len);
+  for (int tries = 0; !queued && tries < 100; tries++) {
+    vTaskDelay(pdMS_TO_TICKS(10));
+    queued = espNowSendMessage(mac, ESPNOW_MSG_COMMAND, 0, msg, len);
+  }
+  free(msg);
+  memset(key, 0, sizeof(key));
+  if (!queued) err = "transfer slots busy";
+  return queued;
 }
 
 // Handle ESP-NOW remote command execution
@@ -12145,57 +15759,86 @@ static void handleEspNowRemoteCommand(const String& message, const uint8_t* send
   // Authenticate user with existing system
   if (!isValidUser(username, password)) {
     broadcastOutput("[ESP-NOW] Remote command: Authentication failed for user '" + username + "'");
-    // TODO: Send failure response back to sender
+    sendChunkedResponse(senderMac, false, "Authentication failed", senderName);
     return;
   }
   
   broadcastOutput("[ESP-NOW] Remote command: Authentication successful for user '" + username + "'");
-  
-  // Execute the command and capture result
-  AuthContext authCtx;
-  authCtx.transport = AUTH_SYSTEM;
-  authCtx.user = username;  // Use the authenticated user
-  authCtx.ip = String();
-  authCtx.path = "/espnow-remote";
-  authCtx.opaque = nullptr;
-  
-  String result;
-  bool success = executeCommand(authCtx, command, result);
-  
-  // Log the execution result
-  if (success) {
+  espNowRunRemoteCommand(senderMac, senderName, username, command);
+}
+
+// Where a remote command's result goes; carried in its ExecReq's ctx.replyHandle
+struct EspNowRemoteReply {
+  uint8_t mac[6];
+  String peer;
+};
+
+// Executor-side completion of a remote command: log it and send the result back
+static void espNowRemoteDone(ExecReq* r) {
+  EspNowRemoteReply* reply = (EspNowRemoteReply*)r->ctx.replyHandle;
+  r->ctx.replyHandle = nullptr;
+  const String& result = r->out;
+  if (r->ok) {
     broadcastOutput("[ESP-NOW] Remote command executed: " + (result.length() > 100 ? result.substring(0, 100) + "..." : result));
   } else {
     broadcastOutput("[ESP-NOW] Remote command failed: " + (result.length() > 100 ? result.substring(0, 100) + "..." : result));
   }
-  
-  // Send result back to sender device using chunked transmission
-  sendChunkedResponse(senderMac, success, result, senderName);
+  sendChunkedResponse(reply->mac, r->ok, result, reply->peer);
+  delete reply;
 }
 
-// ESP-NOW callback for receiving data
-static void onEspNowDataReceived(const esp_now_recv_info *recv_info, const uint8_t *incomingData, int len) {
-  String macStr = "";
-  for (int i = 0; i < 6; i++) {
-    if (i > 0) macStr += ":";
-    if (recv_info->src_addr[i] < 16) macStr += "0";
-    macStr += String(recv_info->src_addr[i], HEX);
+// Queues an authenticated remote command on the executor (its class worker).
+// espnow_rx does all ESP-NOW transport work, so it must not wait for the command:
+// espNowRemoteDone() sends the result back when it finishes.
+static void espNowRunRemoteCommand(const uint8_t* senderMac, const String& senderName, const String& username, const String& command) {
+  QueueHandle_t q = cmdExecQueueFor(command);
+  if (!q) {
+    sendChunkedResponse(senderMac, false, "Command executor not ready", senderName);
+    return;
   }
+  EspNowRemoteReply* reply = new EspNowRemoteReply();
+  memcpy(reply->mac, senderMac, 6);
+  reply->peer = senderName;
+
+  ExecReq* r = execReqAcquire();
+  r->line = command;
+  r->ctx.origin = ORIGIN_SYSTEM;
+  r->ctx.auth.transport = AUTH_SYSTEM;
+  r->ctx.auth.user = username;  // Use the authenticated user
+  r->ctx.auth.ip = String();
+  r->ctx.auth.sid = String();  // pooled requests keep their previous context
+  r->ctx.auth.path = "/espnow-remote";
+  r->ctx.auth.opaque = nullptr;
+  r->ctx.id = (uint32_t)millis();
+  r->ctx.timestampMs = (uint32_t)millis();
+  r->ctx.outputMask = CMD_OUT_LOG;
+  r->ctx.validateOnly = false;
+  r->ctx.replyHandle = reply;
+  r->ctx.httpReq = nullptr;
+  r->onDone = espNowRemoteDone;
+  r->detached = true;
+  if (xQueueSend(q, &r, 0) != pdTRUE) {
+    execReqRelease(r);
+    delete reply;
+    broadcastOutput("[ESP-NOW] Remote command from " + senderName + " dropped: command queue full");
+    sendChunkedResponse(senderMac, false, "Busy: command queue full, try again", senderName);
+  }
+}
+
+// Handle one received packet (espnow_rx worker)
+static void processEspNowPacket(const EspNowRxPacket& pkt) {
+  const uint8_t* srcMac = pkt.mac;
+  char macBuf[18];
+  snprintf(macBuf, sizeof(macBuf), "%02x:%02x:%02x:%02x:%02x:%02x", srcMac[0], srcMac[1], srcMac[2], srcMac[3], srcMac[4], srcMac[5]);
+  String macStr = macBuf;
   
   // Check if this device is encrypted
   bool isEncrypted = false;
   String deviceName = "";
-  String expectedKey = "";
   for (int i = 0; i < gEspNowDeviceCount; i++) {
-    if (memcmp(gEspNowDevices[i].mac, recv_info->src_addr, 6) == 0) {
+    if (memcmp(gEspNowDevices[i].mac, srcMac, 6) == 0) {
       isEncrypted = gEspNowDevices[i].encrypted;
       deviceName = gEspNowDevices[i].name;
-      
-      // Show expected key for this device
-      for (int j = 0; j < 16; j++) {
-        if (gEspNowDevices[i].key[j] < 16) expectedKey += "0";
-        expectedKey += String(gEspNowDevices[i].key[j], HEX);
-      }
       break;
     }
   }
@@ -12203,25 +15846,22 @@ static void onEspNowDataReceived(const esp_now_recv_info *recv_info, const uint8
   // Check encryption status for display
   String encStatus = isEncrypted ? " [ENCRYPTED]" : " [UNENCRYPTED]";
   
-  String message = "";
-  for (int i = 0; i < len && i < 250; i++) {
-    message += (char)incomingData[i];
+  // Binary frames (framed transfers) never start with a printable byte
+  if (pkt.len >= sizeof(EspNowFrameHdr) && pkt.data[0] == ESPNOW_FRAME_MAGIC) {
+    espNowHandleFrame(pkt);
+    return;
   }
   
-  // DEBUG: Show comprehensive receive info
-  broadcastOutput("[ESP-NOW] DEBUG MESSAGE RECEIVED:");
-  broadcastOutput("  From MAC: " + macStr);
-  broadcastOutput("  Device Name: " + (deviceName.length() > 0 ? deviceName : "UNKNOWN"));
-  broadcastOutput("  Expected Encrypted: " + String(isEncrypted ? "YES" : "NO"));
-  if (isEncrypted) {
-    broadcastOutput("  Expected Key: " + expectedKey);
-  }
-  broadcastOutput("  Message Length: " + String(len));
-  broadcastOutput("  Raw Message: '" + message + "'");
+  String message;
+  message.reserve(pkt.len);
+  message.concat((const char*)pkt.data, pkt.len);
+  
+  DEBUG_WIFIF("[ESP-NOW] rx from=%s name=%s enc=%d len=%u age=%lums msg='%s'", macBuf, deviceName.length() ? deviceName.c_str() : "UNKNOWN",
+              isEncrypted ? 1 : 0, (unsigned)pkt.len, (unsigned long)(millis() - pkt.rxMs), message.c_str());
   
   // Check if this is a remote command
   if (message.startsWith("REMOTE:")) {
-    handleEspNowRemoteCommand(message, recv_info->src_addr);
+    handleEspNowRemoteCommand(message, srcMac);
     return; // Don't show remote commands as regular messages
   }
   
@@ -12229,14 +15869,14 @@ static void onEspNowDataReceived(const esp_now_recv_info *recv_info, const uint8
   if (message.startsWith("RESULT:") || message.startsWith("RESULT_START:") || 
       message.startsWith("RESULT_CHUNK:") || message.startsWith("RESULT_END:")) {
     
-    String deviceName = getEspNowDeviceName(recv_info->src_addr);
+    String deviceName = getEspNowDeviceName(srcMac);
     if (deviceName.length() == 0) {
-      deviceName = formatMacAddress(recv_info->src_addr);
+      deviceName = formatMacAddress(srcMac);
     }
     
     // Handle chunked messages
     if (message.startsWith("RESULT_START:") || message.startsWith("RESULT_CHUNK:") || message.startsWith("RESULT_END:")) {
-      handleChunkedMessage(message, deviceName);
+      handleChunkedMessage(message, deviceName, srcMac);
       return;
     }
     
@@ -12250,8 +15890,10 @@ static void onEspNowDataReceived(const esp_now_recv_info *recv_info, const uint8
         
         broadcastOutput("[ESP-NOW] Remote result from " + deviceName + " (" + status + "):");
         broadcastOutput(output);
+        espNowFanoutRecord(srcMac, status == "SUCCESS", output);
       } else {
         broadcastOutput("[ESP-NOW] Remote result from " + deviceName + ": " + message.substring(7));
+        espNowFanoutRecord(srcMac, false, message.substring(7));
       }
       return;
     }
@@ -12265,25 +15907,56 @@ static void onEspNowDataReceived(const esp_now_recv_info *recv_info, const uint8
   }
 }
 
-// ESP-NOW callback for send status
-static void onEspNowDataSent(const uint8_t *mac_addr, esp_now_send_status_t status) {
-  String macStr = "";
-  for (int i = 0; i < 6; i++) {
-    if (i > 0) macStr += ":";
-    macStr += String(mac_addr[i], HEX);
+// ESP-NOW callback for receiving data (WiFi driver task): copy into the ring and
+// wake the worker; nothing here may block, allocate or log
+static void onEspNowDataReceived(const esp_now_recv_info *recv_info, const uint8_t *incomingData, int len) {
+  if (!gEspNowRxRing || len <= 0) return;
+  uint32_t head = gEspNowRxHead.load(std::memory_order_relaxed);
+  if (head - gEspNowRxTail.load(std::memory_order_acquire) >= kEspNowRxSlots) {
+    gEspNowRxDropped.fetch_add(1, std::memory_order_relaxed);
+    return;
   }
-  
-  String statusStr = (status == ESP_NOW_SEND_SUCCESS) ? "Success" : "Failed";
-  
-  // Check if we have a friendly name for this device
-  String deviceName = getEspNowDeviceName(mac_addr);
-  if (deviceName.length() > 0) {
-    broadcastOutput("[ESP-NOW] Send to " + deviceName + ": " + statusStr);
-  } else {
-    broadcastOutput("[ESP-NOW] Send to " + macStr + ": " + statusStr);
+  EspNowRxPacket& pkt = gEspNowRxRing[head & (kEspNowRxSlots - 1)];
+  memcpy(pkt.mac, recv_info->src_addr, 6);
+  pkt.len = (uint8_t)(len > ESP_NOW_MAX_DATA_LEN ? ESP_NOW_MAX_DATA_LEN : len);
+  pkt.rxMs = millis();
+  memcpy(pkt.data, incomingData, pkt.len);
+  gEspNowRxHead.store(head + 1, std::memory_order_release);
+  if (gEspNowRxTask) xTaskNotifyGive(gEspNowRxTask);
+}
+
+// Drains the receive ring and runs framed transfers; woken by both ESP-NOW
+// callbacks, or by the next transfer deadline
+static void espNowRxTask(void* pv) {
+  uint32_t waitMs = UINT32_MAX;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, waitMs == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(waitMs ? waitMs : 1));
+    uint32_t tail = gEspNowRxTail.load(std::memory_order_relaxed);
+    while (tail != gEspNowRxHead.load(std::memory_order_acquire)) {
+      processEspNowPacket(gEspNowRxRing[tail & (kEspNowRxSlots - 1)]);
+      ++gEspNowRxProcessed;
+      gEspNowRxTail.store(++tail, std::memory_order_release);
+    }
+    waitMs = espNowFramesService();
+    uint32_t telemMs = espNowTelemetryService();
+    if (telemMs < waitMs) waitMs = telemMs;
+    cleanupExpiredChunkedMessage();
+    if (gChunkedActiveCount && waitMs > 250) waitMs = 250;
   }
 }
 
+// ESP-NOW callback for send status (WiFi driver task): hand the completion to
+// espnow_rx, which paces framed transfers on it and logs plain sends
+static void onEspNowDataSent(const uint8_t *mac_addr, esp_now_send_status_t status) {
+  uint32_t head = gEspNowTxDoneHead.load(std::memory_order_relaxed);
+  if (head - gEspNowTxDoneTail.load(std::memory_order_acquire) >= kEspNowTxDoneSlots) return;
+  EspNowTxDone& d = gEspNowTxDone[head & (kEspNowTxDoneSlots - 1)];
+  memcpy(d.mac, mac_addr, 6);
+  d.ok = (status == ESP_NOW_SEND_SUCCESS) ? 1 : 0;
+  gEspNowTxDoneHead.store(head + 1, std::memory_order_release);
+  if (gEspNowRxTask) xTaskNotifyGive(gEspNowRxTask);
+}
+
 // Initialize ESP-NOW
 static bool initEspNow() {
   if (gEspNowInitialized) return true;
@@ -12303,6 +15976,64 @@ static bool initEspNow() {
     gEspNowChannel = 1; // Final fallback
   }
   
+  // Receive ring + worker (kept across deinit/init)
+  if (!gEspNowRxRing) {
+    gEspNowRxRing = (EspNowRxPacket*)ps_alloc(kEspNowRxSlots * sizeof(EspNowRxPacket), AllocPref::PreferInternal, "espnow.rx");
+    if (!gEspNowRxRing) {
+      broadcastOutput("[ESP-NOW] Failed to allocate receive ring");
+      return false;
+    }
+  }
+  if (!gChunkedArena) {
+    gChunkedArena = (uint8_t*)ps_alloc((size_t)kChunkedSlots * MAX_CHUNKS * CHUNK_SIZE, AllocPref::PreferPSRAM, "espnow.chunks");
+    if (!gChunkedArena) {
+      broadcastOutput("[ESP-NOW] Failed to allocate chunk reassembly buffer");
+      return false;
+    }
+  }
+  if (!gEspNowTxMutex || !gEspNowSendMutex) {
+    if (!gEspNowTxMutex) gEspNowTxMutex = xSemaphoreCreateMutex();
+    if (!gEspNowSendMutex) gEspNowSendMutex = xSemaphoreCreateMutex();
+    if (!gEspNowTxMutex || !gEspNowSendMutex) {
+      broadcastOutput("[ESP-NOW] Failed to create transfer mutex");
+      return false;
+    }
+    gEspNowNextMsgId = (uint16_t)esp_random();  // stale peer state from before a reboot won't match
+  }
+  if (!gEspNowFanoutMutex || !gEspNowFanoutDone) {
+    if (!gEspNowFanoutMutex) gEspNowFanoutMutex = xSemaphoreCreateMutex();
+    if (!gEspNowFanoutDone) gEspNowFanoutDone = xSemaphoreCreateBinary();
+    if (!gEspNowFanoutMutex || !gEspNowFanoutDone) {
+      broadcastOutput("[ESP-NOW] Failed to create exec-all semaphores");
+      return false;
+    }
+  }
+  if (!gEspNowSessMutex || !gEspNowLoginSignal) {
+    if (!gEspNowSessMutex) gEspNowSessMutex = xSemaphoreCreateMutex();
+    if (!gEspNowLoginSignal) gEspNowLoginSignal = xSemaphoreCreateBinary();
+    if (!gEspNowSessMutex || !gEspNowLoginSignal) {
+      broadcastOutput("[ESP-NOW] Failed to create session semaphores");
+      return false;
+    }
+  }
+  if (!gEspNowDecoyReady) {
+    // Kept across reboots like a real user's salt; if NVS fails it still holds for this boot
+    Preferences p;
+    bool stored = p.begin("espnow", false);
+    if (!stored || p.getBytes("decoy", gEspNowDecoySecret, sizeof(gEspNowDecoySecret)) != sizeof(gEspNowDecoySecret)) {
+      esp_fill_random(gEspNowDecoySecret, sizeof(gEspNowDecoySecret));
+      if (stored) p.putBytes("decoy", gEspNowDecoySecret, sizeof(gEspNowDecoySecret));
+    }
+    if (stored) p.end();
+    gEspNowDecoyReady = true;
+  }
+  if (!gEspNowRxTask) {
+    if (xTaskCreate(espNowRxTask, "espnow_rx", 8192, nullptr, 1, &gEspNowRxTask) != pdPASS) {
+      broadcastOutput("[ESP-NOW] Failed to create receive task");
+      return false;
+    }
+  }
+
   // Initialize ESP-NOW
   if (esp_now_init() != ESP_OK) {
     broadcastOutput("[ESP-NOW] Failed to initialize ESP-NOW");
@@ -12517,7 +16248,7 @@ static String cmd_espnow_send_core(const String& originalCmd) {
   broadcastOutput("  Message Content: '" + message + "'");
   
   // Send message
-  esp_err_t result = esp_now_send(mac, (uint8_t*)message.c_str(), message.length());
+  esp_err_t result = espNowSendPlain(mac, (const uint8_t*)message.c_str(), message.length());
   if (result != ESP_OK) {
     return "Failed to send message: " + String(result);
   }
@@ -12664,7 +16395,7 @@ static String cmd_espnow_broadcast_core(const String& originalCmd) {
   // Get first peer
   esp_err_t ret = esp_now_fetch_peer(true, &peer);
   while (ret == ESP_OK) {
-    esp_err_t sendResult = esp_now_send(peer.peer_addr, (uint8_t*)message.c_str(), message.length());
+    esp_err_t sendResult = espNowSendPlain(peer.peer_addr, (const uint8_t*)message.c_str(), message.length());
     if (sendResult == ESP_OK) {
       sent++;
     } else {
@@ -12860,88 +16591,426 @@ static String cmd_espnow_setpassphrase_modern(const String& cmd) {
   return cmd_espnow_setpassphrase_core(cmd);
 }
 
-static String cmd_espnow_encstatus_modern(const String& cmd) {
-  RETURN_VALID_IF_VALIDATE();
-  return cmd_espnow_encstatus_core();
+static String cmd_espnow_encstatus_modern(const String& cmd) {
+  RETURN_VALID_IF_VALIDATE();
+  return cmd_espnow_encstatus_core();
+}
+
+static String cmd_espnow_pairsecure_modern(const String& cmd) {
+  RETURN_VALID_IF_VALIDATE();
+  return cmd_espnow_pairsecure_core(cmd);
+}
+
+// Paired device name (case-insensitive) or MAC address
+static bool espNowResolveTarget(const String& target, uint8_t* mac) {
+  for (int i = 0; i < gEspNowDeviceCount; i++) {
+    if (gEspNowDevices[i].name.equalsIgnoreCase(target)) {
+      memcpy(mac, gEspNowDevices[i].mac, 6);
+      return true;
+    }
+  }
+  return parseMacAddress(target, mac);
+}
+
+static String cmd_espnow_remote_core(const String& originalCmd) {
+  if (!gEspNowInitialized) {
+    return "ESP-NOW not initialized. Run 'espnow init' first.";
+  }
+  
+  // Parse: espnow remote <target> <username> <password> <command>
+  String cmd = originalCmd;
+  cmd.trim();
+  
+  int firstSpace = cmd.indexOf(' ', 13); // after "espnow remote"
+  if (firstSpace < 0) return "Usage: espnow remote <target> <username> <password> <command>";
+  
+  int secondSpace = cmd.indexOf(' ', firstSpace + 1);
+  if (secondSpace < 0) return "Usage: espnow remote <target> <username> <password> <command>";
+  
+  int thirdSpace = cmd.indexOf(' ', secondSpace + 1);
+  if (thirdSpace < 0) return "Usage: espnow remote <target> <username> <password> <command>";
+  
+  int fourthSpace = cmd.indexOf(' ', thirdSpace + 1);
+  if (fourthSpace < 0) return "Usage: espnow remote <target> <username> <password> <command>";
+  
+  String target = cmd.substring(firstSpace + 1, secondSpace);
+  String username = cmd.substring(secondSpace + 1, thirdSpace);
+  String password = cmd.substring(thirdSpace + 1, fourthSpace);
+  String command = cmd.substring(fourthSpace + 1);
+  
+  target.trim();
+  username.trim();
+  password.trim();
+  command.trim();
+  
+  if (target.length() == 0 || username.length() == 0 || password.length() == 0 || command.length() == 0) {
+    return "Usage: espnow remote <target> <username> <password> <command>";
+  }
+  
+  // Format remote command message
+  String remoteMessage = "REMOTE:" + username + ":" + password + ":" + command;
+  
+  // Find target device by name or MAC
+  uint8_t targetMac[6];
+  if (!espNowResolveTarget(target, targetMac)) {
+    return "Target device '" + target + "' not found. Use device name or MAC address.";
+  }
+  
+  // Send remote command
+  esp_err_t result = espNowSendPlain(targetMac, (const uint8_t*)remoteMessage.c_str(), remoteMessage.length());
+  if (result != ESP_OK) {
+    return "Failed to send remote command: " + String(result);
+  }
+  
+  return "Remote command sent to " + target + ": " + command;
+}
+
+static String cmd_espnow_remote_modern(const String& cmd) {
+  RETURN_VALID_IF_VALIDATE();
+  return cmd_espnow_remote_core(cmd);
+}
+
+// Sends one remote command to every paired device and collects the replies
+// (delivered by the espnow_rx worker) until all have answered or the deadline
+static String cmd_espnow_execall_core(const String& originalCmd) {
+  if (!gEspNowInitialized) {
+    return "ESP-NOW not initialized. Run 'espnow init' first.";
+  }
+
+  // Parse: espnow exec-all [--timeout <ms>] (--session <command> | <username> <password> <command>)
+  const char* usage = "Usage: espnow exec-all [--timeout <ms>] (--session <command> | <username> <password> <command>)";
+  String args = originalCmd;
+  args.trim();
+  args = args.substring(15); // after "espnow exec-all"
+  args.trim();
+
+  uint32_t timeoutMs = kEspNowFanoutDefaultMs;
+  bool useSession = false;
+  for (;;) {
+    if (args.startsWith("--timeout ")) {
+      int sp = args.indexOf(' ', 10);
+      if (sp < 0) return usage;
+      long t = args.substring(10, sp).toInt();
+      if (t < 100 || t > 60000) return "Error: --timeout must be 100..60000 ms";
+      timeoutMs = (uint32_t)t;
+      args = args.substring(sp + 1);
+    } else if (args.startsWith("--session ")) {
+      useSession = true;
+      args = args.substring(10);
+    } else {
+      break;
+    }
+    args.trim();
+  }
+
+  String username, password, command;
+  if (useSession) {
+    command = args;
+  } else {
+    int firstSpace = args.indexOf(' ');
+    if (firstSpace < 0) return usage;
+    int secondSpace = args.indexOf(' ', firstSpace + 1);
+    if (secondSpace < 0) return usage;
+    username = args.substring(0, firstSpace);
+    password = args.substring(firstSpace + 1, secondSpace);
+    command = args.substring(secondSpace + 1);
+    password.trim();
+    command.trim();
+    if (username.length() == 0 || password.length() == 0) return usage;
+  }
+  if (command.length() == 0) return usage;
+
+  if (gEspNowDeviceCount == 0) {
+    return "No paired devices. Use 'espnow pair <mac> <name>' first.";
+  }
+
+  uint8_t macs[16][6];
+  uint8_t n = 0;
+  xSemaphoreTake(gEspNowFanoutMutex, portMAX_DELAY);
+  if (gEspNowFanout.active) {
+    xSemaphoreGive(gEspNowFanoutMutex);
+    return "Error: another 'espnow exec-all' is still collecting results";
+  }
+  xSemaphoreTake(gEspNowFanoutDone, 0);  // drop a give left over from the last fan-out
+  for (int i = 0; i < gEspNowDeviceCount && n < 16; i++, n++) {
+    EspNowFanoutRow& row = gEspNowFanout.row[n];
+    memcpy(row.mac, gEspNowDevices[i].mac, 6);
+    memcpy(macs[n], gEspNowDevices[i].mac, 6);
+    row.state = FANOUT_PENDING;
+    row.ms = 0;
+    row.lines = 0;
+    row.name = gEspNowDevices[i].name.length() ? gEspNowDevices[i].name : formatMacAddress(gEspNowDevices[i].mac);
+    row.firstLine = String();
+  }
+  gEspNowFanout.rows = n;
+  gEspNowFanout.pending = n;
+  gEspNowFanout.startMs = millis();
+  gEspNowFanout.active = true;
+  xSemaphoreGive(gEspNowFanoutMutex);
+
+  // Send to everyone before waiting on anyone; the driver only queues a few
+  // frames, so back off briefly while it reports ESP_ERR_ESPNOW_NO_MEM
+  String remoteMessage = useSession ? String() : "REMOTE:" + username + ":" + password + ":" + command;
+  for (uint8_t i = 0; i < n; i++) {
+    String why;
+    if (useSession) {
+      espNowSessionSend(macs[i], command, why);
+    } else {
+      esp_err_t err = espNowSendPlain(macs[i], (const uint8_t*)remoteMessage.c_str(), remoteMessage.length());
+      for (int tries = 0; err == ESP_ERR_ESPNOW_NO_MEM && tries < 20; tries++) {
+        vTaskDelay(pdMS_TO_TICKS(5));
+        err = espNowSendPlain(macs[i], (const uint8_t*)remoteMessage.c_str(), remoteMessage.length());
+      }
+      if (err != ESP_OK) why = "esp_now_send error " + String(err);
+    }
+    if (why.length()) {
+      xSemaphoreTake(gEspNowFanoutMutex, portMAX_DELAY);
+      EspNowFanoutRow& row = gEspNowFanout.row[i];
+      row.state = FANOUT_SEND_ERROR;
+      row.firstLine = why;
+      if (--gEspNowFanout.pending == 0) xSemaphoreGive(gEspNowFanoutDone);
+      xSemaphoreGive(gEspNowFanoutMutex);
+    }
+  }
+
+  xSemaphoreTake(gEspNowFanoutDone, pdMS_TO_TICKS(timeoutMs));
+
+  xSemaphoreTake(gEspNowFanoutMutex, portMAX_DELAY);
+  gEspNowFanout.active = false;
+  uint32_t elapsed = millis() - gEspNowFanout.startMs;
+  int okCount = 0, failCount = 0, noReply = 0;
+  String table;
+  char line[64];
+  for (uint8_t i = 0; i < n; i++) {
+    EspNowFanoutRow& row = gEspNowFanout.row[i];
+    const char* status = "NO REPLY";
+    if (row.state == FANOUT_OK) { status = "SUCCESS"; okCount++; }
+    else if (row.state == FANOUT_FAILED) { status = "FAILED"; failCount++; }
+    else if (row.state == FANOUT_SEND_ERROR) { status = "SEND ERR"; failCount++; }
+    else noReply++;
+    if (row.state == FANOUT_OK || row.state == FANOUT_FAILED) {
+      snprintf(line, sizeof(line), "  %-16.16s %-9s %6lums  ", row.name.c_str(), status, (unsigned long)row.ms);
+    } else {
+      snprintf(line, sizeof(line), "  %-16.16s %-9s %8s  ", row.name.c_str(), status, "-");
+    }
+    table += line;
+    table += row.firstLine;
+    if (row.lines > 1) table += " (+" + String(row.lines - 1) + " lines)";
+    table += "\n";
+  }
+  xSemaphoreGive(gEspNowFanoutMutex);
+
+  String result = "exec-all '" + command + "' on " + String(n) + " device(s): " + String(okCount) + " ok, " + String(failCount) + " failed, " + String(noReply) + " no reply (" + String(elapsed) + " ms)\n";
+  snprintf(line, sizeof(line), "  %-16s %-9s %8s  %s\n", "Device", "Status", "Time", "Result");
+  result += line;
+  result += table;
+  return result;
+}
+
+static String cmd_espnow_execall_modern(const String& cmd) {
+  RETURN_VALID_IF_VALIDATE();
+  return cmd_espnow_execall_core(cmd);
+}
+
+// Client half of the session login. Runs in the command worker, not espnow_rx:
+// deriving the key costs as much as one password login.
+static void espNowLoginArm(uint8_t stage) {
+  xSemaphoreTake(gEspNowLoginSignal, 0);  // drop a give from an abandoned step
+  xSemaphoreTake(gEspNowSessMutex, portMAX_DELAY);
+  gEspNowLogin.stage = stage;
+  gEspNowLogin.got = false;
+  xSemaphoreGive(gEspNowSessMutex);
+}
+
+static bool espNowLoginWait(void* reply, size_t len) {
+  if (xSemaphoreTake(gEspNowLoginSignal, pdMS_TO_TICKS(kEspNowHandshakeMs)) != pdTRUE) return false;
+  xSemaphoreTake(gEspNowSessMutex, portMAX_DELAY);
+  bool got = gEspNowLogin.got;
+  if (got) memcpy(reply, gEspNowLogin.stage == ESPNOW_MSG_AUTH_OK ? (const void*)&gEspNowLogin.ok : (const void*)&gEspNowLogin.challenge, len);
+  xSemaphoreGive(gEspNowSessMutex);
+  return got;
+}
+
+static bool espNowLoginExchange(const uint8_t* mac, const String& username, const String& password, uint32_t& ttlMs, String& err) {
+  EspNowAuthHello h;
+  memset(&h, 0, sizeof(h));
+  esp_fill_random(h.nonceA, kEspNowNonceBytes);
+  strlcpy(h.user, username.c_str(), sizeof(h.user));
+  espNowLoginArm(ESPNOW_MSG_AUTH_CHALLENGE);
+  if (!espNowSendMessage(mac, ESPNOW_MSG_AUTH_HELLO, 0, (const uint8_t*)&h, sizeof(h))) {
+    err = "transfer slots busy";
+    return false;
+  }
+  EspNowAuthChallenge c;
+  if (!espNowLoginWait(&c, sizeof(c)) || !espNowTagEqual(c.nonceA, h.nonceA, kEspNowNonceBytes)) {
+    err = "no challenge (peer offline or without session support)";
+    return false;
+  }
+  if (c.iterations < 1 || c.iterations > (uint32_t)kPasswordKdfMaxIterations) {
+    err = "bad challenge";
+    return false;
+  }
+
+  uint8_t kdfKey[kPasswordKeyBytes];
+  uint8_t clientKey[kPasswordKeyBytes];
+  uint8_t storedKey[kPasswordKeyBytes];
+  uint8_t sessionKey[32];
+  EspNowAuthProof p;
+  memcpy(p.nonceB, c.nonceB, kEspNowNonceBytes);
+  bool ok = passwordKdf(password, c.salt, sizeof(c.salt), c.iterations, kdfKey)
+            && passwordScramKeys(kdfKey, clientKey, storedKey)
+            && espNowAuthMac(storedKey, "proof", h.nonceA, c.nonceB, h.user, p.proof)
+            && espNowAuthMac(clientKey, "session", h.nonceA, c.nonceB, h.user, sessionKey);
+  for (int i = 0; i < kPasswordKeyBytes; ++i) p.proof[i] ^= clientKey[i];
+  memset(kdfKey, 0, sizeof(kdfKey));
+  memset(clientKey, 0, sizeof(clientKey));
+  memset(storedKey, 0, sizeof(storedKey));
+  espNowLoginArm(ESPNOW_MSG_AUTH_OK);
+  if (!ok || !espNowSendMessage(mac, ESPNOW_MSG_AUTH_PROOF, 0, (const uint8_t*)&p, sizeof(p))) {
+    memset(sessionKey, 0, sizeof(sessionKey));
+    err = "could not send proof";
+    return false;
+  }
+  EspNowAuthOk a;
+  uint8_t tag[32];
+  if (!espNowLoginWait(&a, sizeof(a))) {
+    err = "no answer to proof";
+    ok = false;
+  } else if (a.sessionId == 0 || !espNowTagEqual(a.nonceB, c.nonceB, kEspNowNonceBytes)
+             || !espNowHmac(sessionKey, sizeof(sessionKey), "ok", 2, &a, offsetof(EspNowAuthOk, tag), nullptr, 0, tag)
+             || !espNowTagEqual(tag, a.tag, kEspNowTagBytes)) {
+    err = "authentication failed";
+    ok = false;
+  }
+  if (ok) {
+    ttlMs = (a.ttlMs < kEspNowSessionTtlMs) ? a.ttlMs : kEspNowSessionTtlMs;
+    xSemaphoreTake(gEspNowSessMutex, portMAX_DELAY);
+    EspNowSession* s = espNowSessionSlot(gEspNowSessOut, kEspNowSessionSlots, mac);
+    memset(s, 0, sizeof(*s));
+    memcpy(s->mac, mac, 6);
+    strlcpy(s->user, h.user, sizeof(s->user));
+    memcpy(s->key, sessionKey, sizeof(s->key));
+    s->sessionId = a.sessionId;
+    s->expiresMs = millis() + ttlMs;
+    s->state = SESSION_ESTABLISHED;
+    xSemaphoreGive(gEspNowSessMutex);
+  }
+  memset(sessionKey, 0, sizeof(sessionKey));
+  return ok;
+}
+
+static String cmd_espnow_login_core(const String& originalCmd) {
+  if (!gEspNowInitialized) {
+    return "ESP-NOW not initialized. Run 'espnow init' first.";
+  }
+
+  // Parse: espnow login <target> <username> <password>
+  const char* usage = "Usage: espnow login <target> <username> <password>";
+  String args = originalCmd;
+  args.trim();
+  args = args.substring(12); // after "espnow login"
+  args.trim();
+  int firstSpace = args.indexOf(' ');
+  if (firstSpace < 0) return usage;
+  int secondSpace = args.indexOf(' ', firstSpace + 1);
+  if (secondSpace < 0) return usage;
+  String target = args.substring(0, firstSpace);
+  String username = args.substring(firstSpace + 1, secondSpace);
+  String password = args.substring(secondSpace + 1);
+  username.trim();
+  password.trim();
+  if (username.length() == 0 || password.length() == 0) return usage;
+  if (username.length() >= sizeof(EspNowAuthHello::user)) return "Error: username too long";
+
+  uint8_t mac[6];
+  if (!espNowResolveTarget(target, mac)) {
+    return "Target device '" + target + "' not found. Use device name or MAC address.";
+  }
+
+  xSemaphoreTake(gEspNowSessMutex, portMAX_DELAY);
+  bool busy = gEspNowLogin.active;
+  if (!busy) {
+    memset(&gEspNowLogin, 0, sizeof(gEspNowLogin));
+    memcpy(gEspNowLogin.mac, mac, 6);
+    gEspNowLogin.active = true;
+  }
+  xSemaphoreGive(gEspNowSessMutex);
+  if (busy) return "Error: another 'espnow login' is in progress";
+
+  uint32_t ttlMs = 0;
+  String err;
+  bool ok = espNowLoginExchange(mac, username, password, ttlMs, err);
+
+  xSemaphoreTake(gEspNowSessMutex, portMAX_DELAY);
+  gEspNowLogin.active = false;
+  xSemaphoreGive(gEspNowSessMutex);
+
+  if (!ok) return "Login to " + target + " failed: " + err;
+  return "Session with " + target + " established for '" + username + "' (expires in " + String(ttlMs / 60000UL) + " min)";
 }
 
-static String cmd_espnow_pairsecure_modern(const String& cmd) {
+static String cmd_espnow_login_modern(const String& cmd) {
   RETURN_VALID_IF_VALIDATE();
-  return cmd_espnow_pairsecure_core(cmd);
+  return cmd_espnow_login_core(cmd);
 }
 
-static String cmd_espnow_remote_core(const String& originalCmd) {
+static String cmd_espnow_logout_core(const String& originalCmd) {
   if (!gEspNowInitialized) {
     return "ESP-NOW not initialized. Run 'espnow init' first.";
   }
-  
-  // Parse: espnow remote <target> <username> <password> <command>
-  String cmd = originalCmd;
-  cmd.trim();
-  
-  int firstSpace = cmd.indexOf(' ', 13); // after "espnow remote"
-  if (firstSpace < 0) return "Usage: espnow remote <target> <username> <password> <command>";
-  
-  int secondSpace = cmd.indexOf(' ', firstSpace + 1);
-  if (secondSpace < 0) return "Usage: espnow remote <target> <username> <password> <command>";
-  
-  int thirdSpace = cmd.indexOf(' ', secondSpace + 1);
-  if (thirdSpace < 0) return "Usage: espnow remote <target> <username> <password> <command>";
-  
-  int fourthSpace = cmd.indexOf(' ', thirdSpace + 1);
-  if (fourthSpace < 0) return "Usage: espnow remote <target> <username> <password> <command>";
-  
-  String target = cmd.substring(firstSpace + 1, secondSpace);
-  String username = cmd.substring(secondSpace + 1, thirdSpace);
-  String password = cmd.substring(thirdSpace + 1, fourthSpace);
-  String command = cmd.substring(fourthSpace + 1);
-  
+  String target = originalCmd;
   target.trim();
-  username.trim();
-  password.trim();
-  command.trim();
-  
-  if (target.length() == 0 || username.length() == 0 || password.length() == 0 || command.length() == 0) {
-    return "Usage: espnow remote <target> <username> <password> <command>";
-  }
-  
-  // Format remote command message
-  String remoteMessage = "REMOTE:" + username + ":" + password + ":" + command;
-  
-  // Find target device by name or MAC
-  uint8_t targetMac[6];
-  bool found = false;
-  
-  // First try to find by device name
-  for (int i = 0; i < gEspNowDeviceCount; i++) {
-    if (gEspNowDevices[i].name.equalsIgnoreCase(target)) {
-      memcpy(targetMac, gEspNowDevices[i].mac, 6);
-      found = true;
-      break;
-    }
+  target = target.substring(13); // after "espnow logout"
+  target.trim();
+  if (target.length() == 0) return "Usage: espnow logout <target>";
+  uint8_t mac[6];
+  if (!espNowResolveTarget(target, mac)) {
+    return "Target device '" + target + "' not found. Use device name or MAC address.";
   }
-  
-  // If not found by name, try to parse as MAC address
-  if (!found && parseMacAddress(target, targetMac)) {
-    found = true;
+  xSemaphoreTake(gEspNowSessMutex, portMAX_DELAY);
+  EspNowSession* s = espNowSessionFind(gEspNowSessOut, kEspNowSessionSlots, mac, SESSION_ESTABLISHED);
+  if (s) memset(s, 0, sizeof(*s));
+  xSemaphoreGive(gEspNowSessMutex);
+  return s ? "Session with " + target + " closed" : "No session with " + target;
+}
+
+static String cmd_espnow_logout_modern(const String& cmd) {
+  RETURN_VALID_IF_VALIDATE();
+  return cmd_espnow_logout_core(cmd);
+}
+
+// Remote command under an established session: no credentials on the air
+static String cmd_espnow_exec_core(const String& originalCmd) {
+  if (!gEspNowInitialized) {
+    return "ESP-NOW not initialized. Run 'espnow init' first.";
   }
-  
-  if (!found) {
+
+  // Parse: espnow exec <target> <command>
+  String args = originalCmd;
+  args.trim();
+  args = args.substring(11); // after "espnow exec"
+  args.trim();
+  int firstSpace = args.indexOf(' ');
+  if (firstSpace < 0) return "Usage: espnow exec <target> <command>";
+  String target = args.substring(0, firstSpace);
+  String command = args.substring(firstSpace + 1);
+  command.trim();
+  if (command.length() == 0) return "Usage: espnow exec <target> <command>";
+
+  uint8_t mac[6];
+  if (!espNowResolveTarget(target, mac)) {
     return "Target device '" + target + "' not found. Use device name or MAC address.";
   }
-  
-  // Send remote command
-  esp_err_t result = esp_now_send(targetMac, (uint8_t*)remoteMessage.c_str(), remoteMessage.length());
-  if (result != ESP_OK) {
-    return "Failed to send remote command: " + String(result);
+  String err;
+  if (!espNowSessionSend(mac, command, err)) {
+    return "Failed to send remote command to " + target + ": " + err;
   }
-  
   return "Remote command sent to " + target + ": " + command;
 }
 
-static String cmd_espnow_remote_modern(const String& cmd) {
+static String cmd_espnow_exec_modern(const String& cmd) {
   RETURN_VALID_IF_VALIDATE();
-  return cmd_espnow_remote_core(cmd);
+  return cmd_espnow_exec_core(cmd);
 }
 
 static String cmd_memory_core() {
@@ -13387,7 +17456,7 @@ static String cmd_validate_conditions_modern(const String& cmd) {
   String validationResult = validateConditionalHierarchy(conditions);
   // If we're in validation mode and validation passes, return "VALID"
   // Otherwise return the actual validation result (which could be an error)
-  if (gCLIValidateOnly && validationResult == "VALID") {
+  if (execState().validateOnly && validationResult == "VALID") {
     return "VALID";
   }
   return validationResult;
@@ -13419,6 +17488,11 @@ static String cmd_stack_modern(const String& cmd) {
   result += "Thermal Task: current=" + String((unsigned)gThermalWatermarkNow) + 
             ", minimum=" + String((unsigned)gThermalWatermarkMin) + "\n";
   
+  // I2C bus owner (the kernel tracks its minimum; no per-loop bookkeeping)
+  if (gI2CBusTask) {
+    result += "I2C Bus Task: minimum=" + String((unsigned)uxTaskGetStackHighWaterMark(gI2CBusTask)) + "\n";
+  }
+
   // Main task watermark
   UBaseType_t mainWatermark = uxTaskGetStackHighWaterMark(NULL);
   result += "Main Task: current=" + String((unsigned)mainWatermark) + "\n";
@@ -13761,6 +17835,7 @@ static String cmd_tofstart() {
     tofEnabled = true;
     if (tofEnabled != prev) sensorStatusBumpWith("tofstart@CLI");
   }
+  sensorTaskNotify(I2C_DEV_TOF);
   DEBUG_CLIF("tofstart: now=%d, seq=%d", tofEnabled ? 1 : 0, gSensorStatusSeq);
   return "SUCCESS: ToF sensor started successfully";
 }
@@ -13790,10 +17865,10 @@ static String cmd_tofstop() {
     if (tofEnabled != prev) sensorStatusBumpWith("tofstop@CLI");
   }
   // Serialize with the ToF task: take I2C mutex to ensure the task isn't inside a read
-  if (i2cMutex) xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(500));
+  bool gate = i2cGateTake(I2C_DEV_TOF, 500);
   VL53L4CX_Error stop_status = tofSensor->VL53L4CX_StopMeasurement();
   if (stop_status != VL53L4CX_ERROR_NONE) {
-    if (i2cMutex) xSemaphoreGive(i2cMutex);
+    i2cGateGive(I2C_DEV_TOF, gate);
     return "ERROR: Failed to stop ToF measurement";
   } else {
     DEBUG_CLIF("tofstop: prev=%d", tofEnabled ? 1 : 0);
@@ -13818,11 +17893,12 @@ static String cmd_tofstop() {
         unlockSensorCache();
       }
     }
-    if (i2cMutex) xSemaphoreGive(i2cMutex);
+    i2cGateGive(I2C_DEV_TOF, gate);
     // Reclaim task stack by deleting the task; it will be recreated on next start
     if (tofTaskHandle) {
       vTaskDelete(tofTaskHandle);
       tofTaskHandle = nullptr;
+      i2cBusCancel(I2C_DEV_TOF);
     }
     // Restore I2C default: prefer thermal clock if thermal still enabled; otherwise 100k safe default
     if (thermalEnabled) {
@@ -13896,6 +17972,7 @@ static String cmd_thermalstart() {
     thermalPendingFirstFrame = true;
     thermalArmAtMs = millis() + 150;  // small arming delay to let system settle
   }
+  sensorTaskNotify(I2C_DEV_THERMAL);
   // If init was requested above, block briefly for result so caller gets success/fail
   if (thermalInitRequested || !thermalConnected || thermalSensor == nullptr) {
     unsigned long start = millis();
@@ -13917,6 +17994,7 @@ static String cmd_thermalstart() {
           thermalInitDone = false;
           thermalInitResult = false;
           thermalInitRequested = true;
+          sensorTaskNotify(I2C_DEV_THERMAL);
           
           // Wait for retry result
           unsigned long retryStart = millis();
@@ -13964,7 +18042,7 @@ static String cmd_thermalstop() {
   thermalEnabled = false;
   if (was) sensorStatusBumpWith("thermalstop@CLI");
   // Serialize with thermal task and safely delete sensor object
-  if (i2cMutex) xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(500));
+  bool gate = i2cGateTake(I2C_DEV_THERMAL, 500);
   thermalConnected = false;
   if (thermalSensor != nullptr) {
     DEBUG_CLIF("thermalstop: deleting thermalSensor object");
@@ -13972,7 +18050,7 @@ static String cmd_thermalstop() {
     thermalSensor = nullptr;
   }
   // Clear any thermal cache validity if applicable (handled inside read function/UI elsewhere)
-  if (i2cMutex) xSemaphoreGive(i2cMutex);
+  i2cGateGive(I2C_DEV_THERMAL, gate);
   // Restore to safe mixed-sensor default when thermal stops
   gWire1DefaultHz = 100000;
   i2cSetDefaultWire1Clock();
@@ -13980,6 +18058,7 @@ static String cmd_thermalstop() {
   if (thermalTaskHandle) {
     vTaskDelete(thermalTaskHandle);
     thermalTaskHandle = nullptr;
+    i2cBusCancel(I2C_DEV_THERMAL);
   }
   DEBUG_CLIF("thermalstop: now=%d, seq=%d", thermalEnabled ? 1 : 0, gSensorStatusSeq);
   return "Thermal sensor stopped";
@@ -14028,6 +18107,7 @@ static String cmd_imustart() {
   bool prev = imuEnabled;
   imuEnabled = true;  // task will run and perform init
   if (imuEnabled != prev) sensorStatusBumpWith("imustart@CLI");
+  sensorTaskNotify(I2C_DEV_IMU);
 
   // If init was requested, block up to 3s for a result so CLI returns accurate status
   if (imuInitRequested || bno == nullptr || !imuConnected) {
@@ -14055,18 +18135,19 @@ static String cmd_imustop() {
   imuEnabled = false;
   if (wasRunning) sensorStatusBumpWith("imustop@CLI");
   // Serialize with IMU task and safely delete sensor object if present
-  if (i2cMutex) xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(300));
+  bool gate = i2cGateTake(I2C_DEV_IMU, 300);
   imuConnected = false;
   if (bno != nullptr) {
     DEBUG_CLIF("imustop: deleting IMU object");
     delete bno;
     bno = nullptr;
   }
-  if (i2cMutex) xSemaphoreGive(i2cMutex);
+  i2cGateGive(I2C_DEV_IMU, gate);
   // Reclaim task stack by deleting the task; it will be recreated on next start
   if (imuTaskHandle) {
     vTaskDelete(imuTaskHandle);
     imuTaskHandle = nullptr;
+    i2cBusCancel(I2C_DEV_IMU);
   }
   return "IMU sensor stopped";
 }
@@ -14327,6 +18408,7 @@ static String cmd_filecreate(const String& originalCmd) {
   File f = LittleFS.open(path, "w");
   if (!f) return String("Error: Failed to create file: ") + path;
   f.close();
+  if (path == USERS_FILE) gUserDirStale = true;
   return String("Created file: ") + path;
 }
 
@@ -14364,6 +18446,11 @@ static String cmd_filedelete(const String& originalCmd) {
   if (!path.startsWith("/")) path = String("/") + path;
   if (!LittleFS.exists(path)) return "Error: File does not exist";
   if (!LittleFS.remove(path)) return "Error: Failed to delete file";
+  if (path == AUTOMATIONS_JSON_FILE) {
+    gAutoTableStale = true;
+    gAutosDirty = true;
+  }
+  if (path == USERS_JSON_FILE || path == USERS_FILE) gUserDirStale = true;
   return String("Deleted file: ") + path;
 }
 
@@ -14656,10 +18743,25 @@ static String cmd_taskstats_modern(const String& originalCmd) {
   }
   
   // Get detailed task information
-  UBaseType_t actualCount = uxTaskGetSystemState(taskArray, taskCount, nullptr);
-  
+  uint32_t totalRunTime = 0;
+  UBaseType_t actualCount = uxTaskGetSystemState(taskArray, taskCount, &totalRunTime);
+
+#if configGENERATE_RUN_TIME_STATS
+  // CPU is each task's share of one core since the previous taskstats (or boot),
+  // so two calls bracket a measurement; IDLE0/IDLE1 show the idle CPU
+  static const int kMaxPrevTasks = 32;
+  static TaskHandle_t prevHandle[kMaxPrevTasks];
+  static uint32_t prevRunTime[kMaxPrevTasks];
+  static uint32_t prevTotalRunTime = 0;
+  static int prevCount = 0;
+  uint32_t windowRunTime = totalRunTime - prevTotalRunTime;
+  result += "CPU window: " + String(windowRunTime / 1000000.0f, 1) + " s\n\n";
+  result += "Task Name          State  Prio  Stack  Core   CPU%\n";
+  result += "================== ===== ===== ====== ==== ======\n";
+#else
   result += "Task Name          State  Prio  Stack  Core\n";
   result += "================== ===== ===== ====== ====\n";
+#endif
   
   for (UBaseType_t i = 0; i < actualCount; i++) {
     String taskName = String(taskArray[i].pcTaskName);
@@ -14686,8 +18788,31 @@ static String cmd_taskstats_modern(const String& originalCmd) {
     
     String core = String(taskArray[i].xCoreID);
     
+#if configGENERATE_RUN_TIME_STATS
+    uint32_t ran = taskArray[i].ulRunTimeCounter;
+    for (int p = 0; p < prevCount; ++p) {
+      if (prevHandle[p] == taskArray[i].xHandle) {
+        ran -= prevRunTime[p];
+        break;
+      }
+    }
+    char cpu[12];
+    snprintf(cpu, sizeof(cpu), "%6.1f", windowRunTime ? (100.0f * ran) / windowRunTime : 0.0f);
+    while (core.length() < 4) core += " ";
+    result += taskName + " " + state + " " + prio + " " + stack + "   " + core + " " + cpu + "\n";
+#else
     result += taskName + " " + state + " " + prio + " " + stack + "   " + core + "\n";
+#endif
   }
+
+#if configGENERATE_RUN_TIME_STATS
+  prevCount = 0;
+  for (UBaseType_t i = 0; i < actualCount && prevCount < kMaxPrevTasks; i++) {
+    prevHandle[prevCount] = taskArray[i].xHandle;
+    prevRunTime[prevCount++] = taskArray[i].ulRunTimeCounter;
+  }
+  prevTotalRunTime = totalRunTime;
+#endif
   
   free(taskArray);
   return result;
@@ -14741,6 +18866,466 @@ static String cmd_heapfrag_modern(const String& originalCmd) {
   return result;
 }
 
+// ---- Memory telemetry (time series + per-tag allocation stats) ----
+// Background sampler records heap/PSRAM free, min-free and largest block into a
+// PSRAM ring; the ps_* allocators report per-tag counts and latency through the
+// weak memPerfRecordAlloc hook declared in mem_util.h.
+struct MemPerfSample {
+  uint32_t uptimeSec;
+  uint32_t epoch;  // 0 until NTP time is valid
+  uint32_t heapFree;
+  uint32_t heapMinFree;
+  uint32_t heapLargest;
+  uint32_t psFree;
+  uint32_t psMinFree;
+  uint32_t psLargest;
+  uint16_t sensorMask;  // bit0 thermal, bit1 tof, bit2 imu, bit3 apdsColor, bit4 apdsProx, bit5 apdsGesture, bit6 espnow
+  uint16_t sessions;    // active web sessions at sample time
+};
+
+static const int kMemPerfLatBuckets = 16;  // log2(us) buckets: [0], [1], [2-3], [4-7] ... [16384+]
+static const int kMemPerfTagCap = 32;      // last slot collects overflow tags
+
+struct MemPerfTagStat {
+  const char* tag;
+  uint32_t count;
+  uint32_t failures;
+  uint32_t psCount;
+  uint32_t maxUs;
+  uint64_t bytes;
+  uint32_t hist[kMemPerfLatBuckets];
+};
+
+static MemPerfSample* gMemPerfRing = nullptr;
+static int gMemPerfCap = 0;
+static int gMemPerfHead = 0;   // next write slot
+static int gMemPerfCount = 0;  // valid samples in ring
+static MemPerfTagStat* gMemPerfTags = nullptr;
+static volatile int gMemPerfTagCount = 0;  // entries are only appended, or wiped by reset
+static const int kMemPerfTagHashSlots = 64;
+static volatile uint8_t gMemPerfTagHash[kMemPerfTagHashSlots];  // tag pointer hash -> index + 1, 0 = empty
+static uint32_t gMemPerfAllHist[kMemPerfLatBuckets] = { 0 };
+static uint32_t gMemPerfAllCount = 0;
+static uint32_t gMemPerfAllMaxUs = 0;
+static volatile uint32_t gMemPerfIntervalMs = 60000;  // 24h at 1440 samples
+static TaskHandle_t gMemPerfTaskHandle = nullptr;
+static portMUX_TYPE gMemPerfMux = portMUX_INITIALIZER_UNLOCKED;
+
+static inline int memPerfBucket(uint32_t us) {
+  int b = 0;
+  while (us && b < kMemPerfLatBuckets - 1) {
+    us >>= 1;
+    b++;
+  }
+  return b;
+}
+
+// Upper bound (us) of the bucket holding the requested percentile
+static uint32_t memPerfPercentile(const uint32_t* hist, uint32_t total, uint32_t pct) {
+  if (total == 0) return 0;
+  uint32_t want = (uint32_t)(((uint64_t)total * pct + 99) / 100);
+  uint32_t seen = 0;
+  for (int b = 0; b < kMemPerfLatBuckets; ++b) {
+    seen += hist[b];
+    if (seen >= want) return (b == 0) ? 0 : ((1UL << b) - 1);
+  }
+  return (1UL << (kMemPerfLatBuckets - 1));
+}
+
+static inline int memPerfTagHashSlot(const char* key) {
+  uintptr_t p = (uintptr_t)key;
+  return (int)((p ^ (p >> 6) ^ (p >> 12)) % kMemPerfTagHashSlots);
+}
+
+// Tag index found without the lock: tags are literals, so the pointer hash
+// almost always hits; otherwise the first 'scanned' entries are searched by
+// pointer, then by content. Returns -1 if absent; 'matched' is the entry's tag,
+// which the caller re-checks under the lock in case a reset wiped it meanwhile.
+static int memPerfTagLookup(const char* key, const char*& matched, int& scanned) {
+  int h = memPerfTagHashSlot(key);
+  int i = (int)gMemPerfTagHash[h] - 1;
+  if (i >= 0 && gMemPerfTags[i].tag == key) {
+    matched = key;
+    return i;
+  }
+  int n = gMemPerfTagCount;
+  scanned = n;
+  for (i = 0; i < n; ++i) {
+    if (gMemPerfTags[i].tag == key) {
+      gMemPerfTagHash[h] = (uint8_t)(i + 1);
+      matched = key;
+      return i;
+    }
+  }
+  for (i = 0; i < n; ++i) {
+    const char* t = gMemPerfTags[i].tag;
+    if (t && strcmp(t, key) == 0) {
+      matched = t;
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Adds a tag, or returns one another task added after our scan (gMemPerfMux held;
+// runs at most once per distinct tag until the table fills)
+static int memPerfTagInsertLocked(const char* key, int scanned) {
+  if (scanned > gMemPerfTagCount) scanned = 0;  // reset since the scan
+  for (int i = scanned; i < gMemPerfTagCount; ++i) {
+    const char* t = gMemPerfTags[i].tag;
+    if (t == key || (t && strcmp(t, key) == 0)) return i;
+  }
+  if (gMemPerfTagCount < kMemPerfTagCap - 1) {
+    int idx = gMemPerfTagCount;
+    gMemPerfTags[idx].tag = key;
+    gMemPerfTagCount = idx + 1;  // publish after the tag is set
+    return idx;
+  }
+  gMemPerfTags[kMemPerfTagCap - 1].tag = "(other)";
+  gMemPerfTagCount = kMemPerfTagCap;
+  return kMemPerfTagCap - 1;
+}
+
+// Called from every ps_* allocation; must not allocate or log. The tag is
+// resolved before the critical section, which only bumps counters.
+extern "C" void __attribute__((weak)) memPerfRecordAlloc(const char* tag, size_t size, bool usedPS,
+                                                         bool ok, uint32_t elapsedUs) {
+  if (!gMemPerfTags) return;
+  const char* key = (tag && tag[0]) ? tag : "(untagged)";
+  int bucket = memPerfBucket(elapsedUs);
+  const char* matched = nullptr;
+  int scanned = 0;
+  int idx = memPerfTagLookup(key, matched, scanned);
+  portENTER_CRITICAL(&gMemPerfMux);
+  if (idx < 0 || gMemPerfTags[idx].tag != matched) idx = memPerfTagInsertLocked(key, scanned);
+  MemPerfTagStat& st = gMemPerfTags[idx];
+  st.count++;
+  if (!ok) st.failures++;
+  if (ok && usedPS) st.psCount++;
+  st.bytes += size;
+  st.hist[bucket]++;
+  if (elapsedUs > st.maxUs) st.maxUs = elapsedUs;
+  gMemPerfAllHist[bucket]++;
+  gMemPerfAllCount++;
+  if (elapsedUs > gMemPerfAllMaxUs) gMemPerfAllMaxUs = elapsedUs;
+  portEXIT_CRITICAL(&gMemPerfMux);
+}
+
+static void memPerfTakeSample(MemPerfSample& s) {
+  s.uptimeSec = (uint32_t)(millis() / 1000UL);
+  time_t now = time(nullptr);
+  s.epoch = (now > 1609459200) ? (uint32_t)now : 0;  // treat pre-2021 as unsynced
+  s.heapFree = ESP.getFreeHeap();
+  s.heapMinFree = ESP.getMinFreeHeap();
+  s.heapLargest = ESP.getMaxAllocHeap();
+  if (ESP.getPsramSize() > 0) {
+    s.psFree = ESP.getFreePsram();
+    s.psMinFree = ESP.getMinFreePsram();
+    s.psLargest = ESP.getMaxAllocPsram();
+  } else {
+    s.psFree = s.psMinFree = s.psLargest = 0;
+  }
+  uint16_t mask = 0;
+  if (thermalEnabled) mask |= 0x01;
+  if (tofEnabled) mask |= 0x02;
+  if (imuEnabled) mask |= 0x04;
+  if (apdsColorEnabled) mask |= 0x08;
+  if (apdsProximityEnabled) mask |= 0x10;
+  if (apdsGestureEnabled) mask |= 0x20;
+  if (gEspNowInitialized) mask |= 0x40;
+  s.sensorMask = mask;
+  uint16_t sess = 0;
+  if (gSessions) {
+    for (int i = 0; i < MAX_SESSIONS; ++i) {
+      if (gSessions[i].sid.length()) sess++;
+    }
+  }
+  s.sessions = sess;
+}
+
+static void memPerfTask(void* parameter) {
+  while (true) {
+    MemPerfSample s;
+    memPerfTakeSample(s);
+    portENTER_CRITICAL(&gMemPerfMux);
+    gMemPerfRing[gMemPerfHead] = s;
+    gMemPerfHead = (gMemPerfHead + 1) % gMemPerfCap;
+    if (gMemPerfCount < gMemPerfCap) gMemPerfCount++;
+    portEXIT_CRITICAL(&gMemPerfMux);
+    // Short sleeps so interval changes take effect without waiting a full period
+    uint32_t waited = 0;
+    while (waited < gMemPerfIntervalMs) {
+      vTaskDelay(pdMS_TO_TICKS(1000));
+      waited += 1000;
+    }
+  }
+}
+
+static bool memPerfInit() {
+  if (gMemPerfTaskHandle) return true;
+  int cap = (ESP.getPsramSize() > 0) ? 1440 : 120;
+  MemPerfSample* ring = (MemPerfSample*)ps_calloc(cap, sizeof(MemPerfSample), AllocPref::PreferPSRAM, "memperf.ring");
+  MemPerfTagStat* tags = (MemPerfTagStat*)ps_calloc(kMemPerfTagCap, sizeof(MemPerfTagStat), AllocPref::PreferPSRAM, "memperf.tags");
+  if (!ring || !tags) {
+    free(ring);
+    free(tags);
+    return false;
+  }
+  gMemPerfRing = ring;
+  gMemPerfCap = cap;
+  gMemPerfTags = tags;  // hook starts recording from here on
+  if (xTaskCreate(memPerfTask, "mem_perf", 3072, nullptr, 1, &gMemPerfTaskHandle) != pdPASS) {
+    gMemPerfTaskHandle = nullptr;
+    return false;
+  }
+  return true;
+}
+
+static void memPerfReset() {
+  portENTER_CRITICAL(&gMemPerfMux);
+  gMemPerfHead = 0;
+  gMemPerfCount = 0;
+  if (gMemPerfTags) memset(gMemPerfTags, 0, kMemPerfTagCap * sizeof(MemPerfTagStat));
+  gMemPerfTagCount = 0;
+  memset((void*)gMemPerfTagHash, 0, sizeof(gMemPerfTagHash));
+  memset(gMemPerfAllHist, 0, sizeof(gMemPerfAllHist));
+  gMemPerfAllCount = 0;
+  gMemPerfAllMaxUs = 0;
+  portEXIT_CRITICAL(&gMemPerfMux);
+}
+
+// Copy samples oldest first: the newest maxOut, or with haveSince the first
+// maxOut with uptimeSec > sinceSec, so a poller that fell behind pages forward
+// without gaps. 'more' is set when newer samples remain after the last copied.
+static int memPerfCopySamples(MemPerfSample* out, int maxOut, bool haveSince, uint32_t sinceSec, bool& more) {
+  int n = 0;
+  more = false;
+  portENTER_CRITICAL(&gMemPerfMux);
+  int avail = gMemPerfCount;
+  int start = (gMemPerfHead - avail + gMemPerfCap) % (gMemPerfCap ? gMemPerfCap : 1);
+  int first = (avail > maxOut) ? (avail - maxOut) : 0;
+  if (haveSince) {
+    first = 0;
+    while (first < avail && gMemPerfRing[(start + first) % gMemPerfCap].uptimeSec <= sinceSec) first++;
+  }
+  for (int i = first; i < avail && n < maxOut; ++i) out[n++] = gMemPerfRing[(start + i) % gMemPerfCap];
+  more = first + n < avail;
+  portEXIT_CRITICAL(&gMemPerfMux);
+  return n;
+}
+
+// Snapshot of the tag table so String building happens outside the critical section
+static int memPerfCopyTags(MemPerfTagStat* out, uint32_t* allHist, uint32_t& allCount, uint32_t& allMax) {
+  portENTER_CRITICAL(&gMemPerfMux);
+  int n = gMemPerfTagCount;
+  if (gMemPerfTags && n > 0) memcpy(out, gMemPerfTags, n * sizeof(MemPerfTagStat));
+  memcpy(allHist, gMemPerfAllHist, sizeof(gMemPerfAllHist));
+  allCount = gMemPerfAllCount;
+  allMax = gMemPerfAllMaxUs;
+  portEXIT_CRITICAL(&gMemPerfMux);
+  // Sort by count descending (small n; insertion sort)
+  for (int i = 1; i < n; ++i) {
+    MemPerfTagStat t = out[i];
+    int j = i - 1;
+    while (j >= 0 && out[j].count < t.count) {
+      out[j + 1] = out[j];
+      j--;
+    }
+    out[j + 1] = t;
+  }
+  return n;
+}
+
+static String memPerfSampleJson(const MemPerfSample& s) {
+  return String("[") + String(s.uptimeSec) + "," + String(s.epoch) + "," + String(s.heapFree) + "," + String(s.heapMinFree) + "," + String(s.heapLargest) + "," + String(s.psFree) + "," + String(s.psMinFree) + "," + String(s.psLargest) + "," + String(s.sensorMask) + "," + String(s.sessions) + "]";
+}
+
+static String cmd_memperf_modern(const String& originalCmd) {
+  RETURN_VALID_IF_VALIDATE();
+  if (!gMemPerfRing) return "Error: memory telemetry not running";
+
+  String args = originalCmd.substring(7);  // "memperf"
+  args.trim();
+  String sub = args;
+  String rest = "";
+  int sp = args.indexOf(' ');
+  if (sp > 0) {
+    sub = args.substring(0, sp);
+    rest = args.substring(sp + 1);
+    rest.trim();
+  }
+  sub.toLowerCase();
+
+  if (sub == "reset") {
+    memPerfReset();
+    return "Memory telemetry reset";
+  }
+  if (sub == "interval") {
+    int sec = rest.toInt();
+    if (sec < 1 || sec > 3600) return "Usage: memperf interval <1..3600 seconds>";
+    gMemPerfIntervalMs = (uint32_t)sec * 1000UL;
+    return "Memory telemetry interval set to " + String(sec) + "s (window " + String((uint32_t)sec * gMemPerfCap / 3600UL) + "h)";
+  }
+
+  if (sub == "samples") {
+    int n = rest.length() ? rest.toInt() : 20;
+    if (n < 1) n = 1;
+    if (n > 120) n = 120;
+    MemPerfSample* buf = (MemPerfSample*)ps_alloc(n * sizeof(MemPerfSample), AllocPref::PreferPSRAM, "memperf.cli");
+    if (!buf) return "Error: out of memory";
+    bool more;
+    int got = memPerfCopySamples(buf, n, false, 0, more);
+    String out = "Uptime(s)  HeapFree  HeapMin  HeapBlk   PsFree    PsMin    PsBlk  Sens Sess\n";
+    for (int i = 0; i < got; ++i) {
+      const MemPerfSample& s = buf[i];
+      char line[112];
+      snprintf(line, sizeof(line), "%9lu %9lu %8lu %8lu %8lu %8lu %8lu  0x%02x %4u\n",
+               (unsigned long)s.uptimeSec, (unsigned long)s.heapFree, (unsigned long)s.heapMinFree,
+               (unsigned long)s.heapLargest, (unsigned long)s.psFree, (unsigned long)s.psMinFree,
+               (unsigned long)s.psLargest, (unsigned)s.sensorMask, (unsigned)s.sessions);
+      out += line;
+    }
+    free(buf);
+    if (got == 0) out += "(no samples yet)";
+    return out;
+  }
+
+  if (sub.length() && sub != "tags") {
+    return "Usage: memperf [tags|samples [n]|interval <sec>|reset]";
+  }
+
+  MemPerfTagStat* tags = (MemPerfTagStat*)ps_alloc(kMemPerfTagCap * sizeof(MemPerfTagStat), AllocPref::PreferPSRAM, "memperf.cli");
+  if (!tags) return "Error: out of memory";
+  uint32_t allHist[kMemPerfLatBuckets];
+  uint32_t allCount = 0, allMax = 0;
+  int nTags = memPerfCopyTags(tags, allHist, allCount, allMax);
+
+  String out;
+  if (sub != "tags") {
+    MemPerfSample now;
+    memPerfTakeSample(now);
+    out += "Memory Telemetry:\n";
+    out += "  Samples: " + String(gMemPerfCount) + "/" + String(gMemPerfCap) + " every " + String(gMemPerfIntervalMs / 1000UL) + "s\n";
+    out += "  Heap:  free=" + String(now.heapFree) + " min=" + String(now.heapMinFree) + " largest=" + String(now.heapLargest) + "\n";
+    if (ESP.getPsramSize() > 0) {
+      out += "  PSRAM: free=" + String(now.psFree) + " min=" + String(now.psMinFree) + " largest=" + String(now.psLargest) + "\n";
+    }
+    out += "  Alloc latency: n=" + String(allCount) + " p50<=" + String(memPerfPercentile(allHist, allCount, 50)) + "us p99<=" + String(memPerfPercentile(allHist, allCount, 99)) + "us max=" + String(allMax) + "us\n\n";
+  }
+  out += "Tag                      Count  Fail   PSRAM      Bytes  p50us  p99us  maxus\n";
+  for (int i = 0; i < nTags; ++i) {
+    const MemPerfTagStat& t = tags[i];
+    char line[128];
+    snprintf(line, sizeof(line), "%-22.22s %7lu %5lu %7lu %10llu %6lu %6lu %6lu\n",
+             t.tag, (unsigned long)t.count, (unsigned long)t.failures, (unsigned long)t.psCount,
+             (unsigned long long)t.bytes, (unsigned long)memPerfPercentile(t.hist, t.count, 50),
+             (unsigned long)memPerfPercentile(t.hist, t.count, 99), (unsigned long)t.maxUs);
+    out += line;
+  }
+  free(tags);
+  return out;
+}
+
+// GET /api/perf/memory[?n=<samples>][&since=<uptimeSec>] -> telemetry JSON.
+// Without since: the newest n samples. With since: the n oldest after it; poll
+// again with since=<next> while "more" is true.
+esp_err_t handlePerfMemory(httpd_req_t* req) {
+  AuthContext ctx;
+  ctx.transport = AUTH_HTTP;
+  ctx.opaque = req;
+  ctx.path = "/api/perf/memory";
+  getClientIP(req, ctx.ip);
+  if (!tgRequireAuth(ctx)) return ESP_OK;
+
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+  if (!gMemPerfRing) {
+    httpd_resp_send(req, "{\"success\":false,\"error\":\"telemetry not running\"}", HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+  }
+
+  String v;
+  int n = 60;
+  uint32_t since = 0;
+  if (getQueryParam(req, "n", v)) n = v.toInt();
+  bool haveSince = getQueryParam(req, "since", v);
+  if (haveSince) since = (uint32_t)v.toInt();
+  if (n < 1) n = 1;
+  if (n > 240) n = 240;  // keep the response bounded; page with since=
+
+  MemPerfSample* samples = (MemPerfSample*)ps_alloc(n * sizeof(MemPerfSample), AllocPref::PreferPSRAM, "memperf.http");
+  MemPerfTagStat* tags = (MemPerfTagStat*)ps_alloc(kMemPerfTagCap * sizeof(MemPerfTagStat), AllocPref::PreferPSRAM, "memperf.http");
+  if (!samples || !tags) {
+    free(samples);
+    free(tags);
+    httpd_resp_send(req, "{\"success\":false,\"error\":\"out of memory\"}", HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+  }
+  bool more = false;
+  int got = memPerfCopySamples(samples, n, haveSince, since, more);
+  uint32_t next = got ? samples[got - 1].uptimeSec : since;  // since= for the next page
+  uint32_t allHist[kMemPerfLatBuckets];
+  uint32_t allCount = 0, allMax = 0;
+  int nTags = memPerfCopyTags(tags, allHist, allCount, allMax);
+  MemPerfSample now;
+  memPerfTakeSample(now);
+
+  String json;
+  json.reserve(256 + got * 72 + nTags * 120);
+  json += "{\"success\":true,\"intervalMs\":" + String(gMemPerfIntervalMs) + ",\"capacity\":" + String(gMemPerfCap) + ",\"count\":" + String(gMemPerfCount);
+  json += ",\"columns\":[\"uptimeSec\",\"epoch\",\"heapFree\",\"heapMinFree\",\"heapLargest\",\"psFree\",\"psMinFree\",\"psLargest\",\"sensorMask\",\"sessions\"]";
+  json += ",\"now\":" + memPerfSampleJson(now);
+  json += ",\"next\":" + String(next) + ",\"more\":" + String(more ? "true" : "false");
+  json += ",\"samples\":[";
+  for (int i = 0; i < got; ++i) {
+    if (i) json += ",";
+    json += memPerfSampleJson(samples[i]);
+  }
+  json += "],\"latency\":{\"count\":" + String(allCount) + ",\"p50Us\":" + String(memPerfPercentile(allHist, allCount, 50)) + ",\"p99Us\":" + String(memPerfPercentile(allHist, allCount, 99)) + ",\"maxUs\":" + String(allMax) + "}";
+  json += ",\"tags\":[";
+  for (int i = 0; i < nTags; ++i) {
+    const MemPerfTagStat& t = tags[i];
+    if (i) json += ",";
+    json += "{\"tag\":\"" + jsonEscape(String(t.tag)) + "\",\"count\":" + String(t.count) + ",\"failures\":" + String(t.failures) + ",\"psram\":" + String(t.psCount) + ",\"bytes\":" + String((unsigned long)t.bytes) + ",\"p50Us\":" + String(memPerfPercentile(t.hist, t.count, 50)) + ",\"p99Us\":" + String(memPerfPercentile(t.hist, t.count, 99)) + ",\"maxUs\":" + String(t.maxUs) + "}";
+  }
+  json += "]}";
+  free(samples);
+  free(tags);
+
+  httpd_resp_send(req, json.c_str(), json.length());
+  return ESP_OK;
+}
+
+static String i2cPerfHistJson(const uint32_t* hist, uint32_t n, uint32_t maxUs) {
+  return "{\"count\":" + String(n) + ",\"p50Us\":" + String(i2cPerfPercentile(hist, n, maxUs, 50)) + ",\"p95Us\":" + String(i2cPerfPercentile(hist, n, maxUs, 95)) + ",\"p99Us\":" + String(i2cPerfPercentile(hist, n, maxUs, 99)) + ",\"maxUs\":" + String(maxUs) + "}";
+}
+
+// GET /api/perf/i2c -> per-device bus wait/hold percentiles and counters
+esp_err_t handlePerfI2C(httpd_req_t* req) {
+  AuthContext ctx;
+  ctx.transport = AUTH_HTTP;
+  ctx.opaque = req;
+  ctx.path = "/api/perf/i2c";
+  getClientIP(req, ctx.ip);
+  if (!tgRequireAuth(ctx)) return ESP_OK;
+
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+  String json;
+  json.reserve(64 + I2C_DEV_COUNT * 320);
+  json += "{\"success\":true,\"windowMs\":" + String(millis() - gI2CPerfSinceMs) + ",\"devices\":[";
+  for (uint8_t d = 0; d < I2C_DEV_COUNT; ++d) {
+    I2CPerfSnap ps;
+    i2cPerfSnapshot(d, ps);
+    if (d) json += ",";
+    json += "{\"device\":\"" + String(kI2CBusDevNames[d]) + "\",\"addr\":" + String(gI2CPerfAddr[d]) + ",\"tx\":" + String(ps.tx) + ",\"errors\":" + String(ps.errors) + ",\"clockSwitches\":" + String(ps.switches);
+    json += ",\"wait\":" + i2cPerfHistJson(ps.wait, ps.waitN, ps.waitMaxUs) + ",\"hold\":" + i2cPerfHistJson(ps.hold, ps.holdN, ps.holdMaxUs) + "}";
+  }
+  json += "]}";
+  httpd_resp_send(req, json.c_str(), json.length());
+  return ESP_OK;
+}
+
 // I2C Sensor Registry Structure (moved before usage)
 struct I2CSensorEntry {
   uint8_t address;           // I2C address (7-bit)
@@ -15161,6 +19746,27 @@ static String cmd_i2cstats_modern(const String& originalCmd) {
   result += "  SCL Pin: 22\n";
   result += "  Clock: " + String(gWire1CurrentHz) + " Hz\n";
   result += "  Default Clock: " + String(gWire1DefaultHz) + " Hz\n\n";
+
+  // Per-device occupancy from the i2c_bus owner
+  I2CBusDevStats st[I2C_DEV_COUNT];
+  portENTER_CRITICAL(&gI2CBusMux);
+  memcpy(st, gI2CBusStats, sizeof(st));
+  uint32_t switches = gI2CBusSwitches;
+  portEXIT_CRITICAL(&gI2CBusMux);
+  uint32_t windowMs = millis() - gI2CBusStatsSinceMs;
+  if (windowMs == 0) windowMs = 1;
+  result += "Wire1 Bus Owner (" + String(windowMs / 1000) + " s, " + String(switches) + " clock switches):\n";
+  result += "  Device   Leases  Busy%  AvgBusy  AvgWait  MaxWait  Late\n";
+  char line[96];
+  for (uint8_t d = 0; d < I2C_DEV_COUNT; ++d) {
+    const I2CBusDevStats& ds = st[d];
+    uint32_t n = ds.leases ? ds.leases : 1;
+    snprintf(line, sizeof(line), "  %-8s %6lu %5.1f%% %6.1fms %6.1fms %6.1fms %5lu\n", kI2CBusDevNames[d],
+             (unsigned long)ds.leases, (double)ds.busyUs / 10.0 / windowMs, (double)ds.busyUs / 1000.0 / n,
+             (double)ds.waitUs / 1000.0 / n, ds.maxWaitUs / 1000.0, (unsigned long)ds.late);
+    result += line;
+  }
+  result += "\n";
   
   // Sensor connection status
   result += "Connected Sensors:\n";
@@ -15177,6 +19783,57 @@ static String cmd_i2cstats_modern(const String& originalCmd) {
   return result;
 }
 
+static String cmd_i2cperf_modern(const String& originalCmd) {
+  RETURN_VALID_IF_VALIDATE();
+  String args = originalCmd.substring(7);  // "i2cperf"
+  args.trim();
+  args.toLowerCase();
+  if (args == "reset") {
+    i2cPerfReset();
+    return "I2C bus accounting reset";
+  }
+  if (args.length()) return "Usage: i2cperf [reset]";
+
+  String out = "I2C Bus Time (" + String((millis() - gI2CPerfSinceMs) / 1000UL) + " s; percentiles are bucket upper bounds in us):\n";
+  out += "Device   Addr       Tx   Err  Clk | Wait p50    p95    p99     max | Hold p50    p95    p99     max\n";
+  for (uint8_t d = 0; d < I2C_DEV_COUNT; ++d) {
+    I2CPerfSnap ps;
+    i2cPerfSnapshot(d, ps);
+    char line[160];
+    snprintf(line, sizeof(line), "%-8s 0x%02X %8lu %5lu %4lu | %8lu %6lu %6lu %7lu | %8lu %6lu %6lu %7lu\n",
+             kI2CBusDevNames[d], (unsigned)gI2CPerfAddr[d], (unsigned long)ps.tx, (unsigned long)ps.errors,
+             (unsigned long)ps.switches, (unsigned long)i2cPerfPercentile(ps.wait, ps.waitN, ps.waitMaxUs, 50),
+             (unsigned long)i2cPerfPercentile(ps.wait, ps.waitN, ps.waitMaxUs, 95), (unsigned long)i2cPerfPercentile(ps.wait, ps.waitN, ps.waitMaxUs, 99),
+             (unsigned long)ps.waitMaxUs, (unsigned long)i2cPerfPercentile(ps.hold, ps.holdN, ps.holdMaxUs, 50),
+             (unsigned long)i2cPerfPercentile(ps.hold, ps.holdN, ps.holdMaxUs, 95), (unsigned long)i2cPerfPercentile(ps.hold, ps.holdN, ps.holdMaxUs, 99),
+             (unsigned long)ps.holdMaxUs);
+    out += line;
+  }
+  return out;
+}
+
+static String cmd_sensorgov_modern(const String& originalCmd) {
+  RETURN_VALID_IF_VALIDATE();
+  const int configured[I2C_DEV_COUNT] = {
+    (gSettings.thermalDevicePollMs > 0) ? gSettings.thermalDevicePollMs : 100,
+    (gSettings.tofDevicePollMs > 0) ? gSettings.tofDevicePollMs : 100,
+    (gSettings.imuDevicePollMs > 0) ? gSettings.imuDevicePollMs : 200
+  };
+  const bool running[I2C_DEV_COUNT] = { thermalEnabled && thermalConnected, tofEnabled && tofConnected, imuEnabled && imuConnected };
+  String out = "Sensor Polling Governor (idle period " + (gSettings.sensorIdlePollMs ? String(gSettings.sensorIdlePollMs) + " ms" : String("sleep")) + ", bus " + (gSensorGovBusBusy ? "busy" : "ok") + "):\n";
+  out += "Sensor   State   Config ms  Actual ms  Reason      Viewers\n";
+  uint32_t now = millis();
+  for (uint8_t d = 0; d < I2C_DEV_COUNT; ++d) {
+    uint8_t reason;
+    uint32_t ms = sensorGovPollMs(d, configured[d], &reason);
+    char line[96];
+    snprintf(line, sizeof(line), "%-8s %-7s %9d  %9s  %-10s  %7u\n", kI2CBusDevNames[d], running[d] ? "on" : "off", configured[d],
+             ms ? String(ms).c_str() : "sleep", kSensorGovReasonNames[reason], (unsigned)sensorGovViewerCount(d, now));
+    out += line;
+  }
+  return out;
+}
+
 static String cmd_sensors_modern(const String& originalCmd) {
   RETURN_VALID_IF_VALIDATE();
   
@@ -15342,42 +19999,48 @@ struct CommandEntry {
   const char* help;    // short help text
   bool requiresAdmin;  // whether admin is required (UI will still gate via features)
   String (*handler)(const String& cmd);  // function pointer to command handler (nullptr = use legacy routing)
+  CmdClass cls;        // executor worker the command runs on (see CmdClass)
 };
 
 // Static command registry (moved outside function to avoid stack allocation)
 static const CommandEntry kCommands[] = {
     // ---- Core / General ----
-    { "help", "Show available commands and usage. Use 'help all' to see all commands.", false, cmd_help_modern },
-    { "stack", "Show task stack watermarks and memory usage.", false, cmd_stack_modern },
-    { "clear", "Clear CLI/web output history.", false, cmd_clear_modern },
-    { "status", "Show system status (WiFi, FS, memory).", false, cmd_status_modern },
-    { "uptime", "Show device uptime.", false, cmd_uptime_modern },
-    { "memory", "Show heap/PSRAM usage.", false, cmd_memory_modern },
-    { "psram", "Show PSRAM stats.", false, cmd_psram_modern },
-    { "fsusage", "Show filesystem usage.", false, cmd_fsusage_modern },
-    { "espnow status", "Show ESP-NOW status and configuration.", false, cmd_espnow_status_modern },
-    { "espnow init", "Initialize ESP-NOW communication.", false, cmd_espnow_init_modern },
-    { "espnow pair", "Pair ESP-NOW device: 'espnow pair <mac> <name>'.", false, cmd_espnow_pair_modern },
-    { "espnow unpair", "Unpair ESP-NOW device: 'espnow unpair <mac>'.", false, cmd_espnow_unpair_modern },
-    { "espnow list", "List all paired ESP-NOW devices.", false, cmd_espnow_list_modern },
-    { "espnow send", "Send message: 'espnow send <mac> <message>'.", false, cmd_espnow_send_modern },
-    { "espnow broadcast", "Broadcast message: 'espnow broadcast <message>'.", false, cmd_espnow_broadcast_modern },
-    { "espnow remote", "Execute remote command: 'espnow remote <target> <user> <pass> <cmd>'.", false, cmd_espnow_remote_modern },
-    { "espnow setpassphrase", "Set encryption passphrase: 'espnow setpassphrase \"phrase\"'.", false, cmd_espnow_setpassphrase_modern },
-    { "espnow encstatus", "Show ESP-NOW encryption status and key fingerprint.", false, cmd_espnow_encstatus_modern },
-    { "espnow pairsecure", "Pair device with encryption: 'espnow pairsecure <mac> <name>'.", false, cmd_espnow_pairsecure_modern },
-    { "testencryption", "Test WiFi password encryption (admin only).", true, cmd_testencryption },
-    { "testpassword", "Test user password hashing (admin only).", true, cmd_testpassword },
+    { "help", "Show available commands and usage. Use 'help all' to see all commands.", false, cmd_help_modern, CMD_CLASS_STATUS },
+    { "stack", "Show task stack watermarks and memory usage.", false, cmd_stack_modern, CMD_CLASS_STATUS },
+    { "clear", "Clear CLI/web output history.", false, cmd_clear_modern, CMD_CLASS_STATUS },
+    { "status", "Show system status (WiFi, FS, memory).", false, cmd_status_modern, CMD_CLASS_STATUS },
+    { "uptime", "Show device uptime.", false, cmd_uptime_modern, CMD_CLASS_STATUS },
+    { "memory", "Show heap/PSRAM usage.", false, cmd_memory_modern, CMD_CLASS_STATUS },
+    { "psram", "Show PSRAM stats.", false, cmd_psram_modern, CMD_CLASS_STATUS },
+    { "fsusage", "Show filesystem usage.", false, cmd_fsusage_modern, CMD_CLASS_STATUS },
+    { "espnow status", "Show ESP-NOW status and configuration.", false, cmd_espnow_status_modern, CMD_CLASS_STATUS },
+    { "espnow init", "Initialize ESP-NOW communication.", false, cmd_espnow_init_modern, CMD_CLASS_BLOCKING },
+    { "espnow pair", "Pair ESP-NOW device: 'espnow pair <mac> <name>'.", false, cmd_espnow_pair_modern, CMD_CLASS_FS },
+    { "espnow unpair", "Unpair ESP-NOW device: 'espnow unpair <mac>'.", false, cmd_espnow_unpair_modern, CMD_CLASS_FS },
+    { "espnow list", "List all paired ESP-NOW devices.", false, cmd_espnow_list_modern, CMD_CLASS_STATUS },
+    { "espnow telemetry", "Show sensor telemetry received from peers (accepted only from 'espnow pairsecure' peers; used by IF PEER:<name>.<SENSOR>).", false, cmd_espnow_telemetry_modern, CMD_CLASS_STATUS },
+    { "espnow send", "Send message: 'espnow send <mac> <message>'.", false, cmd_espnow_send_modern, CMD_CLASS_BLOCKING },
+    { "espnow broadcast", "Broadcast message: 'espnow broadcast <message>'.", false, cmd_espnow_broadcast_modern, CMD_CLASS_BLOCKING },
+    { "espnow remote", "Execute remote command: 'espnow remote <target> <user> <pass> <cmd>'.", false, cmd_espnow_remote_modern, CMD_CLASS_BLOCKING },
+    { "espnow exec-all", "Run a command on all paired devices: 'espnow exec-all [--timeout <ms>] (--session <cmd> | <user> <pass> <cmd>)'.", false, cmd_espnow_execall_modern, CMD_CLASS_BLOCKING },
+    { "espnow login", "Open a command session with a device: 'espnow login <target> <user> <pass>' (the account must have logged in locally on the target since the SCRAM$ upgrade).", false, cmd_espnow_login_modern, CMD_CLASS_BLOCKING },
+    { "espnow exec", "Execute remote command in a session: 'espnow exec <target> <cmd>'.", false, cmd_espnow_exec_modern, CMD_CLASS_BLOCKING },
+    { "espnow logout", "Close the command session with a device: 'espnow logout <target>'.", false, cmd_espnow_logout_modern, CMD_CLASS_STATUS },
+    { "espnow setpassphrase", "Set encryption passphrase: 'espnow setpassphrase \"phrase\"'.", false, cmd_espnow_setpassphrase_modern, CMD_CLASS_FS },
+    { "espnow encstatus", "Show ESP-NOW encryption status and key fingerprint.", false, cmd_espnow_encstatus_modern, CMD_CLASS_STATUS },
+    { "espnow pairsecure", "Pair device with encryption: 'espnow pairsecure <mac> <name>'.", false, cmd_espnow_pairsecure_modern, CMD_CLASS_FS },
+    { "testencryption", "Test WiFi password encryption (admin only).", true, cmd_testencryption, CMD_CLASS_STATUS },
+    { "testpassword", "Test user password hashing (admin only).", true, cmd_testpassword, CMD_CLASS_BLOCKING },
 
     // ---- Settings: WiFi Network (matches Settings page WiFi section) ----
-    { "wifiinfo", "Show WiFi details.", false, cmd_wifiinfo_modern },
-    { "wifilist", "List saved WiFi networks.", false, cmd_wifilist_modern },
-    { "wifiadd", "Add/overwrite a WiFi network.", true, cmd_wifiadd_modern },
-    { "wifirm", "Remove a saved WiFi network.", true, cmd_wifirm_modern },
-    { "wifipromote", "Change priority of a saved WiFi network.", true, cmd_wifipromote_modern },
-    { "wificonnect", "Connect to WiFi (best/index).", false, cmd_wificonnect_modern },
-    { "wifidisconnect", "Disconnect WiFi and stop HTTP server.", true, cmd_wifidisconnect_modern },
-    { "wifiscan", "Scan WiFi networks (plain/json).", false, cmd_wifiscan_modern },
+    { "wifiinfo", "Show WiFi details.", false, cmd_wifiinfo_modern, CMD_CLASS_STATUS },
+    { "wifilist", "List saved WiFi networks.", false, cmd_wifilist_modern, CMD_CLASS_STATUS },
+    { "wifiadd", "Add/overwrite a WiFi network.", true, cmd_wifiadd_modern, CMD_CLASS_FS },
+    { "wifirm", "Remove a saved WiFi network.", true, cmd_wifirm_modern, CMD_CLASS_FS },
+    { "wifipromote", "Change priority of a saved WiFi network.", true, cmd_wifipromote_modern, CMD_CLASS_FS },
+    { "wificonnect", "Connect to WiFi (best/index).", false, cmd_wificonnect_modern, CMD_CLASS_BLOCKING },
+    { "wifidisconnect", "Disconnect WiFi and stop HTTP server.", true, cmd_wifidisconnect_modern, CMD_CLASS_BLOCKING },
+    { "wifiscan", "Scan WiFi networks (plain/json).", false, cmd_wifiscan_modern, CMD_CLASS_BLOCKING },
 
     // ---- Settings: System Time (timezone/NTP via 'set' command) ----
     // Use: set tzoffsetminutes <mins>, set ntpserver <host>
@@ -15389,11 +20052,11 @@ static const CommandEntry kCommands[] = {
     // (Moved to Settings section below)
 
     // ---- Settings: Sensors UI (client-side visualization) ----
-    { "thermalpalettedefault", "Set thermal default palette.", true, cmd_thermalpalettedefault_modern },
-    { "thermalewmafactor", "Set thermal EWMA factor.", true, cmd_thermalewmafactor_modern },
-    { "thermaltransitionms", "Set thermal transition time.", true, cmd_thermaltransitionms_modern },
-    { "toftransitionms", "Set ToF transition time.", true, cmd_toftransitionms_modern },
-    { "tofuimaxdistancemm", "Set ToF UI max distance.", true, cmd_tofuimaxdistancemm_modern },
+    { "thermalpalettedefault", "Set thermal default palette.", true, cmd_thermalpalettedefault_modern, CMD_CLASS_FS },
+    { "thermalewmafactor", "Set thermal EWMA factor.", true, cmd_thermalewmafactor_modern, CMD_CLASS_FS },
+    { "thermaltransitionms", "Set thermal transition time.", true, cmd_thermaltransitionms_modern, CMD_CLASS_FS },
+    { "toftransitionms", "Set ToF transition time.", true, cmd_toftransitionms_modern, CMD_CLASS_FS },
+    { "tofuimaxdistancemm", "Set ToF UI max distance.", true, cmd_tofuimaxdistancemm_modern, CMD_CLASS_FS },
     // Note: thermalpollingms, tofpollingms, tofstabilitythreshold, thermalwebmaxfps moved to Thermal/Sensor Polling Settings section
 
     // ---- Settings: Device-side Sensor Settings ----
@@ -15403,128 +20066,197 @@ static const CommandEntry kCommands[] = {
     // (Moved to Debug Commands section below)
 
     // ---- Sensors / Peripherals (start/stop and single reads) ----
-    { "thermalstart", "Start MLX90640 thermal sensor.", false, cmd_thermalstart_modern },
-    { "thermalstop", "Stop MLX90640 thermal sensor.", false, cmd_thermalstop_modern },
-    { "tofstart", "Start VL53L4CX ToF sensor.", false, cmd_tofstart_modern },
-    { "tofstop", "Stop VL53L4CX ToF sensor.", false, cmd_tofstop_modern },
-    { "tof", "Read a single ToF distance.", false, cmd_tof_modern },
-    { "imustart", "Start IMU sensor.", false, cmd_imustart_modern },
-    { "imustop", "Stop IMU sensor.", false, cmd_imustop_modern },
-    { "imu", "Read IMU data once.", false, cmd_imu_modern },
-    { "apdscolor", "Read APDS9960 color values.", false, cmd_apdscolor_modern },
-    { "apdsproximity", "Read APDS9960 proximity value.", false, cmd_apdsproximity_modern },
-    { "apdsgesture", "Read APDS9960 gesture.", false, cmd_apdsgesture_modern },
-    { "apdscolorstart", "Start APDS9960 color sensing.", false, cmd_apdscolorstart_modern },
-    { "apdscolorstop", "Stop APDS9960 color sensing.", false, cmd_apdscolorstop_modern },
-    { "apdsproximitystart", "Start APDS9960 proximity sensing.", false, cmd_apdsproximitystart_modern },
-    { "apdsproximitystop", "Stop APDS9960 proximity sensing.", false, cmd_apdsproximitystop_modern },
-    { "apdsgesturestart", "Start APDS9960 gesture sensing.", false, cmd_apdsgesturestart_modern },
-    { "apdsgesturestop", "Stop APDS9960 gesture sensing.", false, cmd_apdsgesturestop_modern },
+    { "thermalstart", "Start MLX90640 thermal sensor.", false, cmd_thermalstart_modern, CMD_CLASS_SENSOR },
+    { "thermalstop", "Stop MLX90640 thermal sensor.", false, cmd_thermalstop_modern, CMD_CLASS_SENSOR },
+    { "tofstart", "Start VL53L4CX ToF sensor.", false, cmd_tofstart_modern, CMD_CLASS_SENSOR },
+    { "tofstop", "Stop VL53L4CX ToF sensor.", false, cmd_tofstop_modern, CMD_CLASS_SENSOR },
+    { "tof", "Read a single ToF distance.", false, cmd_tof_modern, CMD_CLASS_SENSOR },
+    { "imustart", "Start IMU sensor.", false, cmd_imustart_modern, CMD_CLASS_SENSOR },
+    { "imustop", "Stop IMU sensor.", false, cmd_imustop_modern, CMD_CLASS_SENSOR },
+    { "imu", "Read IMU data once.", false, cmd_imu_modern, CMD_CLASS_SENSOR },
+    { "apdscolor", "Read APDS9960 color values.", false, cmd_apdscolor_modern, CMD_CLASS_SENSOR },
+    { "apdsproximity", "Read APDS9960 proximity value.", false, cmd_apdsproximity_modern, CMD_CLASS_SENSOR },
+    { "apdsgesture", "Read APDS9960 gesture.", false, cmd_apdsgesture_modern, CMD_CLASS_SENSOR },
+    { "apdscolorstart", "Start APDS9960 color sensing.", false, cmd_apdscolorstart_modern, CMD_CLASS_SENSOR },
+    { "apdscolorstop", "Stop APDS9960 color sensing.", false, cmd_apdscolorstop_modern, CMD_CLASS_SENSOR },
+    { "apdsproximitystart", "Start APDS9960 proximity sensing.", false, cmd_apdsproximitystart_modern, CMD_CLASS_SENSOR },
+    { "apdsproximitystop", "Stop APDS9960 proximity sensing.", false, cmd_apdsproximitystop_modern, CMD_CLASS_SENSOR },
+    { "apdsgesturestart", "Start APDS9960 gesture sensing.", false, cmd_apdsgesturestart_modern, CMD_CLASS_SENSOR },
+    { "apdsgesturestop", "Stop APDS9960 gesture sensing.", false, cmd_apdsgesturestop_modern, CMD_CLASS_SENSOR },
 
     // ---- LED Controls ----
-    { "ledcolor", "Set LED color by name.", false, cmd_ledcolor_modern },
-    { "ledclear", "Turn off LED.", false, cmd_ledclear_modern },
-    { "ledeffect", "Run a predefined LED effect.", false, cmd_ledeffect_modern },
+    { "ledcolor", "Set LED color by name.", false, cmd_ledcolor_modern, CMD_CLASS_SENSOR },
+    { "ledclear", "Turn off LED.", false, cmd_ledclear_modern, CMD_CLASS_SENSOR },
+    { "ledeffect", "Run a predefined LED effect.", false, cmd_ledeffect_modern, CMD_CLASS_BLOCKING },
 
     // ---- Files / FS ----
-    { "files", "List/inspect files.", false, cmd_files_modern },
-    { "mkdir", "Create directory in LittleFS.", true, cmd_mkdir_modern },
-    { "rmdir", "Remove directory in LittleFS.", true, cmd_rmdir_modern },
-    { "filecreate", "Create a file (optionally with content).", true, cmd_filecreate_modern },
-    { "fileview", "View a file (supports offsets).", false, cmd_fileview_modern },
-    { "filedelete", "Delete a file.", true, cmd_filedelete_modern },
-    { "autolog", "Automation logging: autolog start <file> | autolog stop | autolog status.", true, cmd_autolog_modern },
+    { "files", "List/inspect files.", false, cmd_files_modern, CMD_CLASS_FS },
+    { "mkdir", "Create directory in LittleFS.", true, cmd_mkdir_modern, CMD_CLASS_FS },
+    { "rmdir", "Remove directory in LittleFS.", true, cmd_rmdir_modern, CMD_CLASS_FS },
+    { "filecreate", "Create a file (optionally with content).", true, cmd_filecreate_modern, CMD_CLASS_FS },
+    { "fileview", "View a file (supports offsets).", false, cmd_fileview_modern, CMD_CLASS_FS },
+    { "filedelete", "Delete a file.", true, cmd_filedelete_modern, CMD_CLASS_FS },
+    { "autolog", "Automation logging: autolog start <file> | autolog stop | autolog status.", true, cmd_autolog_modern, CMD_CLASS_FS },
 
     // ---- Automations ----
-    { "automation", "Automation list/add/enable/disable/delete/run.", true, cmd_automation_modern },
-    { "downloadautomation", "Download automation from GitHub: downloadautomation url=<github-raw-url> [name=<custom-name>].", true, cmd_downloadautomation_modern },
-    { "validate-conditions", "Validate conditional automation syntax: validate-conditions IF temp>75 THEN ledcolor red.", false, cmd_validate_conditions_modern },
+    { "automation", "Automation list/add/enable/disable/delete/run.", true, cmd_automation_modern, CMD_CLASS_FS },
+    { "downloadautomation", "Download automation from GitHub: downloadautomation url=<github-raw-url> [name=<custom-name>].", true, cmd_downloadautomation_modern, CMD_CLASS_BLOCKING },
+    { "validate-conditions", "Validate conditional automation syntax: validate-conditions IF temp>75 THEN ledcolor red.", false, cmd_validate_conditions_modern, CMD_CLASS_STATUS },
 
     // ---- Users / Admin (Admin Controls section on Settings page) ----
-    { "user approve", "Approve pending user.", true, cmd_user_approve_modern },
-    { "user deny", "Deny pending user.", true, cmd_user_deny_modern },
-    { "user promote", "Promote an existing user to admin.", true, cmd_user_promote_modern },
-    { "user demote", "Demote an admin user to regular user.", true, cmd_user_demote_modern },
-    { "user delete", "Delete an existing user.", true, cmd_user_delete_modern },
-    { "user list", "List all users.", true, cmd_user_list_modern },
-    { "user request", "List/submit access request.", false, cmd_user_request_modern },
-    { "session list", "List all active sessions.", true, cmd_session_list_modern },
-    { "session revoke", "Revoke sessions: 'session revoke sid <sid> [reason]' | 'session revoke user <username> [reason]' | 'session revoke all [reason]'.", true, cmd_session_revoke_modern },
+    { "user approve", "Approve pending user.", true, cmd_user_approve_modern, CMD_CLASS_FS },
+    { "user deny", "Deny pending user.", true, cmd_user_deny_modern, CMD_CLASS_FS },
+    { "user promote", "Promote an existing user to admin.", true, cmd_user_promote_modern, CMD_CLASS_FS },
+    { "user demote", "Demote an admin user to regular user.", true, cmd_user_demote_modern, CMD_CLASS_FS },
+    { "user delete", "Delete an existing user.", true, cmd_user_delete_modern, CMD_CLASS_FS },
+    { "user list", "List all users.", true, cmd_user_list_modern, CMD_CLASS_STATUS },
+    { "user request", "List/submit access request.", false, cmd_user_request_modern, CMD_CLASS_FS },
+    { "session list", "List all active sessions.", true, cmd_session_list_modern, CMD_CLASS_STATUS },
+    { "session revoke", "Revoke sessions: 'session revoke sid <sid> [reason]' | 'session revoke user <username> [reason]' | 'session revoke all [reason]'.", true, cmd_session_revoke_modern, CMD_CLASS_STATUS },
     // Note: pending list and broadcast moved to Misc section below
 
     // ---- Output Routing ----
-    { "outserial", "Enable/disable serial output.", true, cmd_outserial_modern },
-    { "outweb", "Enable/disable web output.", true, cmd_outweb_modern },
-    { "outtft", "Enable/disable TFT output.", true, cmd_outtft_modern },
+    { "outserial", "Enable/disable serial output.", true, cmd_outserial_modern, CMD_CLASS_FS },
+    { "outweb", "Enable/disable web output.", true, cmd_outweb_modern, CMD_CLASS_FS },
+    { "outtft", "Enable/disable TFT output.", true, cmd_outtft_modern, CMD_CLASS_FS },
 
     // ---- Settings ----
-    { "wifiautoreconnect", "Enable/disable WiFi auto-reconnect.", true, cmd_wifiautoreconnect_modern },
-    { "clihistorysize", "Set CLI history size.", true, cmd_clihistorysize_modern },
+    { "wifiautoreconnect", "Enable/disable WiFi auto-reconnect.", true, cmd_wifiautoreconnect_modern, CMD_CLASS_FS },
+    { "clihistorysize", "Set CLI history size.", true, cmd_clihistorysize_modern, CMD_CLASS_FS },
 
     // ---- Debug Commands ----
-    { "debugauthcookies", "Debug authentication cookies.", true, cmd_debugauthcookies_modern },
-    { "debughttp", "Debug HTTP requests.", true, cmd_debughttp_modern },
-    { "debugsse", "Debug Server-Sent Events.", true, cmd_debugsse_modern },
-    { "debugcli", "Debug CLI processing.", true, cmd_debugcli_modern },
-    { "debugsensorsframe", "Debug sensor frame processing.", true, cmd_debugsensorsframe_modern },
-    { "debugsensorsdata", "Debug sensor data.", true, cmd_debugsensorsdata_modern },
-    { "debugsensorsgeneral", "Debug general sensor operations.", true, cmd_debugsensorsgeneral_modern },
-    { "debugwifi", "Debug WiFi operations.", true, cmd_debugwifi_modern },
-    { "debugstorage", "Debug storage operations.", true, cmd_debugstorage_modern },
-    { "debugperformance", "Debug performance metrics.", true, cmd_debugperformance_modern },
-    { "debugdatetime", "Debug date/time operations.", true, cmd_debugdatetime_modern },
-    { "debugcommandflow", "Debug command flow.", true, cmd_debugcommandflow_modern },
-    { "debugusers", "Debug user management.", true, cmd_debugusers_modern },
+    { "debugauthcookies", "Debug authentication cookies.", true, cmd_debugauthcookies_modern, CMD_CLASS_FS },
+    { "debughttp", "Debug HTTP requests.", true, cmd_debughttp_modern, CMD_CLASS_FS },
+    { "debugsse", "Debug Server-Sent Events.", true, cmd_debugsse_modern, CMD_CLASS_FS },
+    { "debugcli", "Debug CLI processing.", true, cmd_debugcli_modern, CMD_CLASS_FS },
+    { "debugsensorsframe", "Debug sensor frame processing.", true, cmd_debugsensorsframe_modern, CMD_CLASS_FS },
+    { "debugsensorsdata", "Debug sensor data.", true, cmd_debugsensorsdata_modern, CMD_CLASS_FS },
+    { "debugsensorsgeneral", "Debug general sensor operations.", true, cmd_debugsensorsgeneral_modern, CMD_CLASS_FS },
+    { "debugwifi", "Debug WiFi operations.", true, cmd_debugwifi_modern, CMD_CLASS_FS },
+    { "debugstorage", "Debug storage operations.", true, cmd_debugstorage_modern, CMD_CLASS_FS },
+    { "debugperformance", "Debug performance metrics.", true, cmd_debugperformance_modern, CMD_CLASS_FS },
+    { "debugdatetime", "Debug date/time operations.", true, cmd_debugdatetime_modern, CMD_CLASS_FS },
+    { "debugcommandflow", "Debug command flow.", true, cmd_debugcommandflow_modern, CMD_CLASS_FS },
+    { "debugusers", "Debug user management.", true, cmd_debugusers_modern, CMD_CLASS_FS },
 
     // ---- Thermal/Sensor Polling Settings ----
-    { "thermaltargetfps", "Set thermal sensor target FPS.", true, cmd_thermaltargetfps_modern },
-    { "thermalwebmaxfps", "Set thermal web max FPS.", true, cmd_thermalwebmaxfps_modern },
-    { "thermalinterpolationenabled", "Enable/disable thermal interpolation.", true, cmd_thermalinterpolationenabled_modern },
-    { "thermalinterpolationsteps", "Set thermal interpolation steps.", true, cmd_thermalinterpolationsteps_modern },
-    { "thermalinterpolationbuffersize", "Set thermal interpolation buffer size.", true, cmd_thermalinterpolationbuffersize_modern },
-    { "thermaldevicepollms", "Set thermal device polling interval.", true, cmd_thermaldevicepollms_modern },
-    { "tofdevicepollms", "Set ToF device polling interval.", true, cmd_tofdevicepollms_modern },
-    { "imudevicepollms", "Set IMU device polling interval.", true, cmd_imudevicepollms_modern },
-    { "thermalpollingms", "Set thermal polling interval.", true, cmd_thermalpollingms_modern },
-    { "tofpollingms", "Set ToF polling interval.", true, cmd_tofpollingms_modern },
-    { "tofstabilitythreshold", "Set ToF stability threshold.", true, cmd_tofstabilitythreshold_modern },
-    { "i2cclockthermalhz", "Set I2C clock for thermal sensor.", true, cmd_i2cclockthermalhz_modern },
-    { "i2cclocktofhz", "Set I2C clock for ToF sensor.", true, cmd_i2cclocktofhz_modern },
+    { "thermaltargetfps", "Set thermal sensor target FPS.", true, cmd_thermaltargetfps_modern, CMD_CLASS_FS },
+    { "thermalwebmaxfps", "Set thermal web max FPS.", true, cmd_thermalwebmaxfps_modern, CMD_CLASS_FS },
+    { "thermalinterpolationenabled", "Enable/disable thermal interpolation.", true, cmd_thermalinterpolationenabled_modern, CMD_CLASS_FS },
+    { "thermalinterpolationsteps", "Set thermal interpolation steps.", true, cmd_thermalinterpolationsteps_modern, CMD_CLASS_FS },
+    { "thermalinterpolationbuffersize", "Set thermal interpolation buffer size.", true, cmd_thermalinterpolationbuffersize_modern, CMD_CLASS_FS },
+    { "thermaldevicepollms", "Set thermal device polling interval.", true, cmd_thermaldevicepollms_modern, CMD_CLASS_FS },
+    { "tofdevicepollms", "Set ToF device polling interval.", true, cmd_tofdevicepollms_modern, CMD_CLASS_FS },
+    { "imudevicepollms", "Set IMU device polling interval.", true, cmd_imudevicepollms_modern, CMD_CLASS_FS },
+    { "thermalpollingms", "Set thermal polling interval.", true, cmd_thermalpollingms_modern, CMD_CLASS_FS },
+    { "tofpollingms", "Set ToF polling interval.", true, cmd_tofpollingms_modern, CMD_CLASS_FS },
+    { "tofstabilitythreshold", "Set ToF stability threshold.", true, cmd_tofstabilitythreshold_modern, CMD_CLASS_FS },
+    { "i2cclockthermalhz", "Set I2C clock for thermal sensor.", true, cmd_i2cclockthermalhz_modern, CMD_CLASS_FS },
+    { "i2cclocktofhz", "Set I2C clock for ToF sensor.", true, cmd_i2cclocktofhz_modern, CMD_CLASS_FS },
 
     // ---- System Diagnostics ----
-    { "temperature", "Read ESP32 internal temperature.", false, cmd_temperature_modern },
-    { "voltage", "Read supply voltage.", false, cmd_voltage_modern },
-    { "cpufreq", "Get/set CPU frequency.", false, cmd_cpufreq_modern },
-    { "taskstats", "Detailed task statistics.", false, cmd_taskstats_modern },
-    { "heapfrag", "Analyze heap fragmentation.", false, cmd_heapfrag_modern },
-    { "i2cscan", "Scan I2C bus for devices.", false, cmd_i2cscan_modern },
-    { "i2cstats", "I2C bus statistics and errors.", false, cmd_i2cstats_modern },
-    { "sensors", "List known I2C sensor database.", false, cmd_sensors_modern },
-    { "sensorinfo", "Get detailed info about a specific sensor.", false, cmd_sensorinfo_modern },
-    { "devices", "Show discovered I2C device registry.", false, cmd_devices_modern },
-    { "discover", "Discover and register I2C devices.", false, cmd_discover_modern },
-    { "devicefile", "Show device registry JSON file.", false, cmd_devicefile_modern },
+    { "temperature", "Read ESP32 internal temperature.", false, cmd_temperature_modern, CMD_CLASS_STATUS },
+    { "voltage", "Read supply voltage.", false, cmd_voltage_modern, CMD_CLASS_STATUS },
+    { "cpufreq", "Get/set CPU frequency.", false, cmd_cpufreq_modern, CMD_CLASS_STATUS },
+    { "taskstats", "Detailed task statistics.", false, cmd_taskstats_modern, CMD_CLASS_STATUS },
+    { "heapfrag", "Analyze heap fragmentation.", false, cmd_heapfrag_modern, CMD_CLASS_STATUS },
+    { "memperf", "Heap telemetry over time: memperf [tags|samples [n]|interval <sec>|reset].", false, cmd_memperf_modern, CMD_CLASS_STATUS },
+    { "i2cscan", "Scan I2C bus for devices.", false, cmd_i2cscan_modern, CMD_CLASS_SENSOR },
+    { "i2cstats", "I2C bus statistics and errors.", false, cmd_i2cstats_modern, CMD_CLASS_STATUS },
+    { "i2cperf", "Per-device I2C wait/hold percentiles: i2cperf [reset].", false, cmd_i2cperf_modern, CMD_CLASS_STATUS },
+    { "sensorgov", "Sensor poll rates chosen by the demand governor.", false, cmd_sensorgov_modern, CMD_CLASS_STATUS },
+    { "sensors", "List known I2C sensor database.", false, cmd_sensors_modern, CMD_CLASS_STATUS },
+    { "sensorinfo", "Get detailed info about a specific sensor.", false, cmd_sensorinfo_modern, CMD_CLASS_STATUS },
+    { "devices", "Show discovered I2C device registry.", false, cmd_devices_modern, CMD_CLASS_STATUS },
+    { "discover", "Discover and register I2C devices.", false, cmd_discover_modern, CMD_CLASS_SENSOR },
+    { "devicefile", "Show device registry JSON file.", false, cmd_devicefile_modern, CMD_CLASS_STATUS },
 
     // ---- Misc ----
-    { "set", "Set a named setting (key value).", false, cmd_set_modern },
-    { "reboot", "Reboot the device.", true, cmd_reboot_modern },
-    { "broadcast", "Send message to all or specific user.", true, cmd_broadcast_modern },
-    { "pending list", "List pending user approvals.", true, cmd_pending_list_modern },
-    { "wait", "Delay execution for N milliseconds: wait <ms>.", false, cmd_wait_modern },
-    { "sleep", "Alias for wait: sleep <ms>.", false, cmd_wait_modern },
+    { "set", "Set a named setting (key value).", false, cmd_set_modern, CMD_CLASS_FS },
+    { "reboot", "Reboot the device.", true, cmd_reboot_modern, CMD_CLASS_STATUS },
+    { "broadcast", "Send message to all or specific user.", true, cmd_broadcast_modern, CMD_CLASS_STATUS },
+    { "pending list", "List pending user approvals.", true, cmd_pending_list_modern, CMD_CLASS_STATUS },
+    { "wait", "Delay execution for N milliseconds: wait <ms>.", false, cmd_wait_modern, CMD_CLASS_BLOCKING },
+    { "sleep", "Alias for wait: sleep <ms>.", false, cmd_wait_modern, CMD_CLASS_BLOCKING },
   };
 
+// ---- Command lookup ----
+// Open-addressed hash over the kCommands names (case-insensitive, full name incl.
+// multi-word verbs like "espnow status"). A line is matched by hashing its first
+// one or two words in place, longest first, so lookups never copy the input.
+static const size_t kCmdHashSlots = 256;  // power of two, > 2x the command count
+static const int kCmdMaxWords = 2;        // longest names are "<group> <verb>"
+static uint8_t gCmdHash[kCmdHashSlots];   // kCommands index + 1; 0 = empty slot
+
+static uint32_t cmdHashName(const char* s, size_t n) {
+  uint32_t h = 2166136261u;  // FNV-1a over lowercased bytes
+  for (size_t i = 0; i < n; ++i) {
+    h ^= (uint8_t)tolower((unsigned char)s[i]);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static bool cmdHashBuild() {
+  static_assert(sizeof(kCommands) / sizeof(kCommands[0]) < 255, "gCmdHash stores indices in uint8_t");
+  for (size_t i = 0; i < (sizeof(kCommands) / sizeof(kCommands[0])); ++i) {
+    const char* nm = kCommands[i].name;
+    size_t slot = cmdHashName(nm, strlen(nm)) & (kCmdHashSlots - 1);
+    while (gCmdHash[slot]) slot = (slot + 1) & (kCmdHashSlots - 1);
+    gCmdHash[slot] = (uint8_t)(i + 1);  // earlier entries sit first in the probe chain
+  }
+  return true;
+}
+
+// Registry entry for line, or nullptr. *nameEnd receives the offset just past the
+// matched name (leading blanks included) so callers can take the arguments from there.
+static const CommandEntry* findCommandEntry(const char* line, size_t* nameEnd) {
+  static const bool built = cmdHashBuild();  // once, on first lookup
+  (void)built;
+  const char* p = line;
+  while (*p == ' ' || *p == '\t') ++p;
+
+  size_t ends[kCmdMaxWords];
+  int words = 0;
+  size_t i = 0;
+  while (words < kCmdMaxWords && p[i] && p[i] != ' ') {
+    while (p[i] && p[i] != ' ') ++i;
+    ends[words++] = i;
+    if (p[i] != ' ') break;
+    ++i;
+  }
+  for (int w = words - 1; w >= 0; --w) {
+    size_t n = ends[w];
+    for (size_t slot = cmdHashName(p, n) & (kCmdHashSlots - 1); gCmdHash[slot]; slot = (slot + 1) & (kCmdHashSlots - 1)) {
+      const CommandEntry& e = kCommands[gCmdHash[slot] - 1];
+      if (strncasecmp(e.name, p, n) == 0 && e.name[n] == '\0') {
+        if (nameEnd) *nameEnd = (size_t)(p - line) + n;
+        return &e;
+      }
+    }
+  }
+  return nullptr;
+}
+
+// Conditionals may run anything, so they go to the blocking worker;
+// unknown commands just produce an error
+static CmdClass commandClassOf(const String& line) {
+  const char* p = line.c_str();
+  while (*p == ' ' || *p == '\t') ++p;
+  if (strncasecmp(p, "if ", 3) == 0) return CMD_CLASS_BLOCKING;
+  const CommandEntry* e = findCommandEntry(p, nullptr);
+  return e ? e->cls : CMD_CLASS_STATUS;
+}
+
 // Minimal CLI processor used by Serial loop
 static String processCommand(const String& cmd) {
   String command = cmd;
   command.trim();
   
-  // Check for conditional commands first (before lowercasing to preserve case in commands)
-  String upperCommand = command;
-  upperCommand.toUpperCase();
-  if (upperCommand.startsWith("IF ")) {
+  // Check for conditional commands first (case preserved for the command parts)
+  if (strncasecmp(command.c_str(), "IF ", 3) == 0) {
     // Validate conditional command syntax if in validation mode
-    if (gCLIValidateOnly) {
+    if (execState().validateOnly) {
       String validationResult = validateConditionalCommand(command);
       if (validationResult.length() > 0) {
         return validationResult;
@@ -15534,65 +20266,7 @@ static String processCommand(const String& cmd) {
     // Execute conditional command
     return executeConditionalCommand(command);
   }
-  
-  // Preserve original for argument casing; use a lowercased copy for matching
-  String originalForArgs = command;
-  String lc = command; lc.toLowerCase();
-  // TEMP DEBUG (gated by DEBUG_CMD_FLOW): show raw command and ASCII codes for first 40 chars
-  {
-    String dbg = "";
-    for (unsigned i = 0; i < lc.length() && i < 40; ++i) {
-      char c = lc[i];
-      dbg += String((int)c) + " ";
-    }
-    DEBUG_CMD_FLOWF("[router] raw='%s', ascii=[%s]", lc.c_str(), dbg.c_str());
-    DEBUG_CMD_FLOWF("[router] startsWith(\"user request \")=%s", lc.startsWith("user request ") ? "YES" : "NO");
-    DEBUG_CMD_FLOWF("[router] indexOf(\"user request\")==%d", lc.indexOf("user request"));
-  }
-
-  auto splitFirstToken = [](const String& s, String& head, String& tail) {
-    int sp = s.indexOf(' ');
-    if (sp < 0) {
-      head = s;
-      tail = String();
-    } else {
-      head = s.substring(0, sp);
-      tail = s.substring(sp + 1);
-      tail.trim();
-    }
-  };
-
-  auto isMatch = [](const String& a, const char* b) {
-    return a.equalsIgnoreCase(String(b));
-  };
-
-  auto findCanonical = [&](const String& verb, const CommandEntry*& out) -> bool {
-    for (size_t i = 0; i < (sizeof(kCommands) / sizeof(kCommands[0])); ++i) {
-      const CommandEntry& e = kCommands[i];
-      if (isMatch(verb, e.name)) {
-        out = &e;
-        return true;
-      }
-    }
-    out = nullptr;
-    return false;
-  };
-
-  auto buildHelp = [&]() {
-    String h;
-    h.reserve(512);
-    h += "Available commands:\n";
-    for (size_t i = 0; i < (sizeof(kCommands) / sizeof(kCommands[0])); ++i) {
-      const CommandEntry& e = kCommands[i];
-      h += "  ";
-      h += e.name;
-      h += "  - ";
-      h += e.help;
-      h += "\n";
-    }
-    h += "\nTip: many commands also accept arguments. Use the Settings page for convenience.";
-    return h;
-  };
+  DEBUG_CMD_FLOWF("[router] raw='%s'", command.c_str());
 
   // Handle CLI state transitions and help navigation BEFORE command registry
   if (gCLIState == CLI_HELP_MAIN) {
@@ -15632,34 +20306,31 @@ static String processCommand(const String& cmd) {
     }
   }
 
-  // Option A: prefix-based registry matching to support multi-word commands
-  const CommandEntry* found = nullptr;
+  // Registry lookup (hashed, multi-word commands included; see findCommandEntry)
   size_t foundLen = 0;
-  for (size_t i = 0; i < (sizeof(kCommands) / sizeof(kCommands[0])); ++i) {
-    const char* nm = kCommands[i].name;
-    size_t nlen = strlen(nm);
-    if (lc.length() >= nlen && lc.substring(0, nlen).equalsIgnoreCase(String(nm)) &&
-        (lc.length() == nlen || lc.charAt(nlen) == ' ')) {
-      found = &kCommands[i];
-      foundLen = nlen;
-      break;
-    }
-  }
+  const CommandEntry* found = findCommandEntry(command.c_str(), &foundLen);
 
   if (found) {
     // Admin gating now handled by executeCommand pipeline
     // (Legacy requiresAdmin flag no longer needed)
-    // Normalize: rebuild input using the canonical name + trailing args (preserve original arg casing)
-    String args = originalForArgs.substring(foundLen);
-    args.trim();
-    command = String(found->name);
-    if (args.length()) {
-      command += " ";
-      command += args;
+    // Normalize: canonical name + trailing args (preserve original arg casing)
+    // (command is trimmed, so the name starts at 0; the common case is already canonical)
+    const char* args = command.c_str() + foundLen;
+    while (*args == ' ') ++args;
+    bool canonical = strncmp(command.c_str(), found->name, foundLen) == 0 && (size_t)(args - command.c_str()) <= foundLen + 1;
+    if (!canonical) {
+      String normalized;
+      normalized.reserve(foundLen + 1 + strlen(args));
+      normalized = found->name;
+      if (*args) {
+        normalized += ' ';
+        normalized += args;
+      }
+      command = std::move(normalized);
     }
 
     // During validation, do not execute handlers; just report VALID if recognized
-    if (gCLIValidateOnly) {
+    if (execState().validateOnly) {
       return "VALID";
     }
     // Check if command has a modern function pointer handler
@@ -15670,7 +20341,7 @@ static String processCommand(const String& cmd) {
     // No legacy commands remaining - all commands now use modern routing!
   } else {
     // Command not found in registry - handle validation properly
-    if (gCLIValidateOnly) {
+    if (execState().validateOnly) {
       return "Error: Unknown command '" + cmd + "'. Type 'help' for available commands.";
     }
     // Avoid Serial-only debug; return result for unified broadcast by caller
@@ -16006,7 +20677,7 @@ REPROCESS_NORMAL_COMMANDS:
     return "";
   } else {
     // This should never be reached for commands found in registry
-    if (gCLIValidateOnly) {
+    if (execState().validateOnly) {
       return "Error: Unknown command '" + cmd + "'. Type 'help' for available commands.";
     }
     String result = "Unknown command: " + cmd + "\nType 'help' for available commands";
@@ -16190,6 +20861,7 @@ bool initIMUSensor() {
         delay(20);
         if (bno->begin()) {
           begun = true;
+          gI2CPerfAddr[I2C_DEV_IMU] = addr;
           break;
         }
         // Failed begin on this addr
@@ -16699,7 +21371,7 @@ bool readThermalPixels() {
   uint32_t captureTime = afterCapture - startTime;
 
   if (result != 0) {
-    if (!gExecFromWeb) {
+    if (!execState().fromWeb) {
       broadcastOutput(String("MLX90640 frame capture failed: error=") + String(result) + ", time=" + String(captureTime) + "ms, heap=" + String(ESP.getFreeHeap()));
       // Check I2C bus status
       Wire1.beginTransmission(MLX90640_I2CADDR_DEFAULT);
@@ -16921,7 +21593,7 @@ bool readThermalPixels() {
                  gSettings.i2cClockThermalHz, gSettings.thermalTargetFps, effFps, ESP.getFreeHeap());
   }
 
-  if (!gExecFromWeb && (gDebugFlags & DEBUG_SENSORS_FRAME) && ((dbgCounter++ % 10) == 0)) {
+  if (!execState().fromWeb && (gDebugFlags & DEBUG_SENSORS_FRAME) && ((dbgCounter++ % 10) == 0)) {
     String msg = String("THERM frame: cap=") + captureTime + "ms, proc=" + processingTime + "ms, total=" + totalTime + "ms, fps_i=" + String(instFps, 2) + ", fps_ema=" + String(emaFps, 2) + ", i2cHz=" + String(gSettings.i2cClockThermalHz) + ", tgtFps=" + String(gSettings.thermalTargetFps) + "(eff=" + String(effFps) + ")" + ", heap=" + String(ESP.getFreeHeap());
     broadcastOutput(msg);
 
@@ -16991,14 +21663,108 @@ void setupWiFi() {
   }
 }
 
+// ==========================
+// HTTP async workers
+// ==========================
+// esp_http_server runs every handler on its single task, so a CLI command that
+// blocks (e.g. "wait 600") or an SSE hold stalls every other request behind it.
+// Long-running endpoints are registered through handleHttpAsync: the request is
+// detached with httpd_req_async_handler_begin() and finished on a small worker
+// pool, so the server task keeps answering short requests such as /api/sensors.
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+#define HTTP_ASYNC_SUPPORTED 1
+#else
+#define HTTP_ASYNC_SUPPORTED 0
+#endif
+
+typedef esp_err_t (*HttpHandlerFn)(httpd_req_t*);
+
+struct HttpAsyncJob {
+  httpd_req_t* req;  // detached copy, owned by the worker until completed
+  HttpHandlerFn handler;
+};
+
+static const int kHttpAsyncQueueLen = 4;
+static QueueHandle_t gHttpAsyncQueue = nullptr;
+static int gHttpAsyncWorkers = 0;
+
+#if HTTP_ASYNC_SUPPORTED
+static void httpAsyncWorkerTask(void* arg) {
+  HttpAsyncJob job;
+  for (;;) {
+    if (xQueueReceive(gHttpAsyncQueue, &job, portMAX_DELAY) != pdTRUE) continue;
+    job.handler(job.req);
+    httpd_req_async_handler_complete(job.req);
+  }
+}
+#endif
+
+// Workers are created once; a lower count only takes effect after reboot
+static void httpAsyncStart(int workers) {
+#if HTTP_ASYNC_SUPPORTED
+  if (workers > kHttpMaxWorkers) workers = kHttpMaxWorkers;
+  if (workers <= gHttpAsyncWorkers) return;
+  if (!gHttpAsyncQueue) {
+    gHttpAsyncQueue = xQueueCreate(kHttpAsyncQueueLen, sizeof(HttpAsyncJob));
+    if (!gHttpAsyncQueue) {
+      broadcastOutput("ERROR: Failed to create HTTP worker queue");
+      return;
+    }
+  }
+  while (gHttpAsyncWorkers < workers) {
+    char name[16];
+    snprintf(name, sizeof(name), "http_w%d", gHttpAsyncWorkers);
+    if (xTaskCreate(httpAsyncWorkerTask, name, 6144, nullptr, 5, nullptr) != pdPASS) {
+      broadcastOutput("ERROR: Failed to create HTTP worker task");
+      break;
+    }
+    gHttpAsyncWorkers++;
+  }
+#else
+  (void)workers;
+#endif
+}
+
+// URI handler for long-running endpoints; user_ctx holds the real handler
+static esp_err_t handleHttpAsync(httpd_req_t* req) {
+  HttpHandlerFn handler = (HttpHandlerFn)req->user_ctx;
+#if HTTP_ASYNC_SUPPORTED
+  if (gHttpAsyncWorkers > 0) {
+    httpd_req_t* copy = nullptr;
+    if (httpd_req_async_handler_begin(req, &copy) != ESP_OK) {
+      return handler(req);
+    }
+    HttpAsyncJob job = { copy, handler };
+    if (xQueueSend(gHttpAsyncQueue, &job, 0) == pdTRUE) return ESP_OK;
+    // Every worker busy and the backlog full: tell the client to retry
+    // instead of parking the server task behind them
+    DEBUG_HTTPF("http async: queue full, 503 for %s", copy->uri);
+    httpd_resp_set_status(copy, "503 Service Unavailable");
+    httpd_resp_set_hdr(copy, "Retry-After", "1");
+    httpd_resp_send(copy, "Busy", HTTPD_RESP_USE_STRLEN);
+    httpd_req_async_handler_complete(copy);
+    return ESP_OK;
+  }
+#endif
+  return handler(req);
+}
+
 void startHttpServer() {
   httpd_config_t config = HTTPD_DEFAULT_CONFIG();
   config.max_uri_handlers = 100;
-  config.lru_purge_enable = true;
+  int sockets = gSettings.httpMaxSockets;
+  if (sockets < 2) sockets = 2;
+  if (sockets > kHttpMaxSocketsLimit) sockets = kHttpMaxSocketsLimit;
+  config.max_open_sockets = sockets;
+  config.lru_purge_enable = gSettings.httpLruPurge;
+  config.uri_match_fn = httpd_uri_match_wildcard;  // for /api/cli/job/<id>
+  httpAsyncStart(gSettings.httpWorkers);
   if (httpd_start(&server, &config) != ESP_OK) {
     broadcastOutput("ERROR: Failed to start HTTP server");
     return;
   }
+  DEBUG_HTTPF("HTTP server: sockets=%d lru=%d workers=%d", sockets, config.lru_purge_enable ? 1 : 0, gHttpAsyncWorkers);
 
   // Define URIs
   static httpd_uri_t root = { .uri = "/", .method = HTTP_GET, .handler = handleRoot, .user_ctx = NULL };
@@ -17013,7 +21779,7 @@ void startHttpServer() {
   static httpd_uri_t settingsGet = { .uri = "/api/settings", .method = HTTP_GET, .handler = handleSettingsGet, .user_ctx = NULL };
   static httpd_uri_t devicesGet = { .uri = "/api/devices", .method = HTTP_GET, .handler = handleDeviceRegistryGet, .user_ctx = NULL };
   static httpd_uri_t apiNotice = { .uri = "/api/notice", .method = HTTP_GET, .handler = handleNotice, .user_ctx = NULL };
-  static httpd_uri_t apiEvents = { .uri = "/api/events", .method = HTTP_GET, .handler = handleEvents, .user_ctx = NULL };
+  static httpd_uri_t apiEvents = { .uri = "/api/events", .method = HTTP_GET, .handler = handleHttpAsync, .user_ctx = (void*)handleEvents };
   static httpd_uri_t filesPage = { .uri = "/files", .method = HTTP_GET, .handler = handleFilesPage, .user_ctx = NULL };
   static httpd_uri_t filesList = { .uri = "/api/files/list", .method = HTTP_GET, .handler = handleFilesList, .user_ctx = NULL };
   static httpd_uri_t filesCreate = { .uri = "/api/files/create", .method = HTTP_POST, .handler = handleFilesCreate, .user_ctx = NULL };
@@ -17022,7 +21788,8 @@ void startHttpServer() {
   static httpd_uri_t filesRead = { .uri = "/api/files/read", .method = HTTP_GET, .handler = handleFileRead, .user_ctx = NULL };
   static httpd_uri_t filesWrite = { .uri = "/api/files/write", .method = HTTP_POST, .handler = handleFileWrite, .user_ctx = NULL };
   static httpd_uri_t cliPage = { .uri = "/cli", .method = HTTP_GET, .handler = handleCLIPage, .user_ctx = NULL };
-  static httpd_uri_t cliCmd = { .uri = "/api/cli", .method = HTTP_POST, .handler = handleCLICommand, .user_ctx = NULL };
+  static httpd_uri_t cliCmd = { .uri = "/api/cli", .method = HTTP_POST, .handler = handleHttpAsync, .user_ctx = (void*)handleCLICommand };
+  static httpd_uri_t cliJob = { .uri = "/api/cli/job/*", .method = HTTP_GET, .handler = handleCLIJob, .user_ctx = NULL };
   static httpd_uri_t logsGet = { .uri = "/api/cli/logs", .method = HTTP_GET, .handler = handleLogs, .user_ctx = NULL };
   static httpd_uri_t sensorsPage = { .uri = "/sensors", .method = HTTP_GET, .handler = handleSensorsPage, .user_ctx = NULL };
   static httpd_uri_t espnowPage = { .uri = "/espnow", .method = HTTP_GET, .handler = handleEspNowPage, .user_ctx = NULL };
@@ -17030,6 +21797,8 @@ void startHttpServer() {
   static httpd_uri_t sensorData = { .uri = "/api/sensors", .method = HTTP_GET, .handler = handleSensorData, .user_ctx = NULL };
   static httpd_uri_t sensorsStatus = { .uri = "/api/sensors/status", .method = HTTP_GET, .handler = handleSensorsStatusWithUpdates, .user_ctx = NULL };
   static httpd_uri_t systemStatus = { .uri = "/api/system", .method = HTTP_GET, .handler = handleSystemStatus, .user_ctx = NULL };
+  static httpd_uri_t perfMemory = { .uri = "/api/perf/memory", .method = HTTP_GET, .handler = handlePerfMemory, .user_ctx = NULL };
+  static httpd_uri_t perfI2C = { .uri = "/api/perf/i2c", .method = HTTP_GET, .handler = handlePerfI2C, .user_ctx = NULL };
   static httpd_uri_t automationsGet = { .uri = "/api/automations", .method = HTTP_GET, .handler = handleAutomationsGet, .user_ctx = NULL };
   static httpd_uri_t automationsExport = { .uri = "/api/automations/export", .method = HTTP_GET, .handler = handleAutomationsExport, .user_ctx = NULL };
   static httpd_uri_t outputGet = { .uri = "/api/output", .method = HTTP_GET, .handler = handleOutputGet, .user_ctx = NULL };
@@ -17062,6 +21831,7 @@ void startHttpServer() {
   httpd_register_uri_handler(server, &filesWrite);
   httpd_register_uri_handler(server, &cliPage);
   httpd_register_uri_handler(server, &cliCmd);
+  httpd_register_uri_handler(server, &cliJob);
   httpd_register_uri_handler(server, &logsGet);
   httpd_register_uri_handler(server, &sensorsPage);
   httpd_register_uri_handler(server, &espnowPage);
@@ -17070,6 +21840,8 @@ void startHttpServer() {
   // SSE events endpoint for server-driven notices
   httpd_register_uri_handler(server, &apiEvents);
   httpd_register_uri_handler(server, &systemStatus);
+  httpd_register_uri_handler(server, &perfMemory);
+  httpd_register_uri_handler(server, &perfI2C);
   httpd_register_uri_handler(server, &automationsPage);
   httpd_register_uri_handler(server, &automationsGet);
   httpd_register_uri_handler(server, &automationsExport);
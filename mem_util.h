@@ -21,6 +21,17 @@ inline void __capture_mem_before() {
 extern "C" void memAllocDebug(const char* op, void* ptr, size_t size,
                               bool requestedPS, bool usedPS, const char* tag);
 
+// Optional allocation telemetry hook (defined weakly elsewhere). Receives the time
+// spent inside the ps_* allocator itself; memAllocDebug logging is excluded.
+extern "C" void memPerfRecordAlloc(const char* tag, size_t size, bool usedPS,
+                                   bool ok, uint32_t elapsedUs);
+
+inline void __mem_perf_record(const char* tag, size_t size, bool usedPS, void* p,
+                              uint32_t startUs) {
+  if (&memPerfRecordAlloc) memPerfRecordAlloc(tag, size, usedPS, p != nullptr,
+                                              (uint32_t)micros() - startUs);
+}
+
 inline bool hasPSRAMAvail() {
 #if defined(BOARD_HAS_PSRAM) || defined(CONFIG_SPIRAM)
   return true;
@@ -113,10 +124,12 @@ inline bool psramAvailableRuntime() {
 
 inline void* ps_alloc(size_t size, AllocPref pref = AllocPref::PreferPSRAM) {
   const bool wantPS = (pref == AllocPref::PreferPSRAM) && !psramBypassGlobal() && psramAvailableRuntime();
+  const uint32_t t0 = (uint32_t)micros();
   if (wantPS) {
     __capture_mem_before();
     void* p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
     if (p) {
+      __mem_perf_record(nullptr, size, /*usedPS=*/true, p, t0);
       // Determine whether the returned pointer is actually in PSRAM (paranoia)
       bool usedPS = true; // we requested SPIRAM and got non-null
       if (&memAllocDebug) memAllocDebug("malloc", p, size, /*requestedPS=*/true, usedPS, nullptr);
@@ -125,6 +138,7 @@ inline void* ps_alloc(size_t size, AllocPref pref = AllocPref::PreferPSRAM) {
   }
   __capture_mem_before();
   void* p2 = malloc(size);
+  __mem_perf_record(nullptr, size, /*usedPS=*/false, p2, t0);
   if (&memAllocDebug) memAllocDebug("malloc", p2, size, /*requestedPS=*/wantPS,
                                    /*usedPS=*/false, nullptr);
   return p2;
@@ -133,10 +147,12 @@ inline void* ps_alloc(size_t size, AllocPref pref = AllocPref::PreferPSRAM) {
 // Tagged overload: record a human-readable name for this allocation
 inline void* ps_alloc(size_t size, AllocPref pref, const char* tag) {
   const bool wantPS = (pref == AllocPref::PreferPSRAM) && !psramBypassGlobal() && psramAvailableRuntime();
+  const uint32_t t0 = (uint32_t)micros();
   if (wantPS) {
     __capture_mem_before();
     void* p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
     if (p) {
+      __mem_perf_record(tag, size, /*usedPS=*/true, p, t0);
       bool usedPS = true;
       if (&memAllocDebug) memAllocDebug("malloc", p, size, /*requestedPS=*/true, usedPS, tag);
       return p;
@@ -144,16 +160,19 @@ inline void* ps_alloc(size_t size, AllocPref pref, const char* tag) {
   }
   __capture_mem_before();
   void* p2 = malloc(size);
+  __mem_perf_record(tag, size, /*usedPS=*/false, p2, t0);
   if (&memAllocDebug) memAllocDebug("malloc", p2, size, /*requestedPS=*/wantPS, /*usedPS=*/false, tag);
   return p2;
 }
 
 inline void* ps_calloc(size_t n, size_t size, AllocPref pref = AllocPref::PreferPSRAM) {
   const bool wantPS = (pref == AllocPref::PreferPSRAM) && !psramBypassGlobal() && psramAvailableRuntime();
+  const uint32_t t0 = (uint32_t)micros();
   if (wantPS) {
     __capture_mem_before();
     void* p = heap_caps_calloc(n, size, MALLOC_CAP_SPIRAM);
     if (p) {
+      __mem_perf_record(nullptr, n * size, /*usedPS=*/true, p, t0);
       bool usedPS = true;
       if (&memAllocDebug) memAllocDebug("calloc", p, n * size, /*requestedPS=*/true, usedPS, nullptr);
       return p;
@@ -161,6 +180,7 @@ inline void* ps_calloc(size_t n, size_t size, AllocPref pref = AllocPref::Prefer
   }
   __capture_mem_before();
   void* p2 = calloc(n, size);
+  __mem_perf_record(nullptr, n * size, /*usedPS=*/false, p2, t0);
   if (&memAllocDebug) memAllocDebug("calloc", p2, n * size, /*requestedPS=*/wantPS,
                                    /*usedPS=*/false, nullptr);
   return p2;
@@ -169,10 +189,12 @@ inline void* ps_calloc(size_t n, size_t size, AllocPref pref = AllocPref::Prefer
 // Tagged overload
 inline void* ps_calloc(size_t n, size_t size, AllocPref pref, const char* tag) {
   const bool wantPS = (pref == AllocPref::PreferPSRAM) && !psramBypassGlobal() && psramAvailableRuntime();
+  const uint32_t t0 = (uint32_t)micros();
   if (wantPS) {
     __capture_mem_before();
     void* p = heap_caps_calloc(n, size, MALLOC_CAP_SPIRAM);
     if (p) {
+      __mem_perf_record(tag, n * size, /*usedPS=*/true, p, t0);
       bool usedPS = true;
       if (&memAllocDebug) memAllocDebug("calloc", p, n * size, /*requestedPS=*/true, usedPS, tag);
       return p;
@@ -180,16 +202,19 @@ inline void* ps_calloc(size_t n, size_t size, AllocPref pref, const char* tag) {
   }
   __capture_mem_before();
   void* p2 = calloc(n, size);
+  __mem_perf_record(tag, n * size, /*usedPS=*/false, p2, t0);
   if (&memAllocDebug) memAllocDebug("calloc", p2, n * size, /*requestedPS=*/wantPS, /*usedPS=*/false, tag);
   return p2;
 }
 
 inline void* ps_realloc(void* ptr, size_t size, AllocPref pref = AllocPref::PreferPSRAM) {
   const bool wantPS = (pref == AllocPref::PreferPSRAM) && !psramBypassGlobal() && psramAvailableRuntime();
+  const uint32_t t0 = (uint32_t)micros();
   if (wantPS) {
     __capture_mem_before();
     void* p = heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM);
     if (p) {
+      __mem_perf_record(nullptr, size, /*usedPS=*/true, p, t0);
       bool usedPS = true;
       if (&memAllocDebug) memAllocDebug("realloc", p, size, /*requestedPS=*/true, usedPS, nullptr);
       return p;
@@ -198,6 +223,7 @@ inline void* ps_realloc(void* ptr, size_t size, AllocPref pref = AllocPref::Pref
   }
   __capture_mem_before();
   void* p2 = realloc(ptr, size);
+  __mem_perf_record(nullptr, size, /*usedPS=*/false, p2, t0);
   if (&memAllocDebug) memAllocDebug("realloc", p2, size, /*requestedPS=*/wantPS,
                                    /*usedPS=*/false, nullptr);
   return p2;
@@ -206,10 +232,12 @@ inline void* ps_realloc(void* ptr, size_t size, AllocPref pref = AllocPref::Pref
 // Tagged overload
 inline void* ps_realloc(void* ptr, size_t size, AllocPref pref, const char* tag) {
   const bool wantPS = (pref == AllocPref::PreferPSRAM) && !psramBypassGlobal() && psramAvailableRuntime();
+  const uint32_t t0 = (uint32_t)micros();
   if (wantPS) {
     __capture_mem_before();
     void* p = heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM);
     if (p) {
+      __mem_perf_record(tag, size, /*usedPS=*/true, p, t0);
       bool usedPS = true;
       if (&memAllocDebug) memAllocDebug("realloc", p, size, /*requestedPS=*/true, usedPS, tag);
       return p;
@@ -217,6 +245,7 @@ inline void* ps_realloc(void* ptr, size_t size, AllocPref pref, const char* tag)
   }
   __capture_mem_before();
   void* p2 = realloc(ptr, size);
+  __mem_perf_record(tag, size, /*usedPS=*/false, p2, t0);
   if (&memAllocDebug) memAllocDebug("realloc", p2, size, /*requestedPS=*/wantPS, /*usedPS=*/false, tag);
   return p2;
 }
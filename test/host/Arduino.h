@@ -0,0 +1,85 @@
+#pragma once
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <cctype>
+#include <algorithm>
+#include <utility>
+#define HEX 16
+class String {
+ public:
+  std::string s;
+  String() {}
+  String(const char* c) : s(c ? c : "") {}
+  String(const std::string& x) : s(x) {}
+  String(char c) : s(1, c) {}
+  String(int v, int base = 10) { char b[40]; snprintf(b, sizeof b, base == 16 ? "%x" : "%d", v); s = b; }
+  String(unsigned v, int base = 10) { char b[40]; snprintf(b, sizeof b, base == 16 ? "%x" : "%u", v); s = b; }
+  String(long v, int base = 10) { char b[40]; snprintf(b, sizeof b, base == 16 ? "%lx" : "%ld", v); s = b; }
+  String(unsigned long v, int base = 10) { char b[40]; snprintf(b, sizeof b, base == 16 ? "%lx" : "%lu", v); s = b; }
+  String(long long v) { s = std::to_string(v); }
+  String(unsigned long long v) { s = std::to_string(v); }
+  String(float v, int d = 2) { char b[40]; snprintf(b, sizeof b, "%.*f", d, v); s = b; }
+  String(double v, int d = 2) { char b[40]; snprintf(b, sizeof b, "%.*f", d, v); s = b; }
+  unsigned length() const { return s.size(); }
+  const char* c_str() const { return s.c_str(); }
+  char operator[](unsigned i) const { return i < s.size() ? s[i] : 0; }
+  char& operator[](unsigned i) { return s[i]; }
+  char charAt(unsigned i) const { return (*this)[i]; }
+  void setCharAt(unsigned i, char c) { if (i < s.size()) s[i] = c; }
+  int indexOf(char c, unsigned from = 0) const { auto p = s.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const String& x, unsigned from = 0) const { auto p = s.find(x.s, from); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const char* x, unsigned from = 0) const { return indexOf(String(x), from); }
+  int lastIndexOf(char c) const { auto p = s.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+  int lastIndexOf(char c, int from) const { if (from < 0) return -1; auto p = s.rfind(c, from); return p == std::string::npos ? -1 : (int)p; }
+  int lastIndexOf(const String& x) const { auto p = s.rfind(x.s); return p == std::string::npos ? -1 : (int)p; }
+  String substring(unsigned a) const { return a >= s.size() ? String() : String(s.substr(a)); }
+  String substring(unsigned a, unsigned b) const { if (b > s.size()) b = s.size(); if (a >= b) return String(); return String(s.substr(a, b - a)); }
+  long toInt() const { return strtol(s.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(s.c_str(), nullptr); }
+  void trim() { size_t a = 0; while (a < s.size() && isspace((unsigned char)s[a])) a++; size_t b = s.size(); while (b > a && isspace((unsigned char)s[b - 1])) b--; s = s.substr(a, b - a); }
+  void toLowerCase() { for (auto& c : s) c = tolower(c); }
+  void toUpperCase() { for (auto& c : s) c = toupper(c); }
+  bool startsWith(const String& x) const { return s.compare(0, x.s.size(), x.s) == 0; }
+  bool startsWith(const String& x, unsigned off) const { return off <= s.size() && s.compare(off, x.s.size(), x.s) == 0; }
+  bool endsWith(const String& x) const { return s.size() >= x.s.size() && s.compare(s.size() - x.s.size(), x.s.size(), x.s) == 0; }
+  bool equalsIgnoreCase(const String& x) const { if (x.s.size() != s.size()) return false; for (size_t i = 0; i < s.size(); ++i) if (tolower(s[i]) != tolower(x.s[i])) return false; return true; }
+  bool equals(const String& x) const { return s == x.s; }
+  void replace(const String& a, const String& b) { if (a.s.empty()) return; size_t p = 0; while ((p = s.find(a.s, p)) != std::string::npos) { s.replace(p, a.s.size(), b.s); p += b.s.size(); } }
+  void remove(unsigned i) { if (i < s.size()) s.erase(i); }
+  void remove(unsigned i, unsigned n) { if (i < s.size()) s.erase(i, n); }
+  bool reserve(unsigned n) { s.reserve(n); return true; }
+  void toCharArray(char* b, unsigned n) const { strncpy(b, s.c_str(), n); if (n) b[n - 1] = 0; }
+  String& operator+=(const String& x) { s += x.s; return *this; }
+  String& operator+=(const char* x) { s += x; return *this; }
+  String& operator+=(char c) { s += c; return *this; }
+  String& operator+=(int v) { s += std::to_string(v); return *this; }
+  String& operator+=(unsigned v) { s += std::to_string(v); return *this; }
+  String& operator+=(long v) { s += std::to_string(v); return *this; }
+  String& operator+=(unsigned long v) { s += std::to_string(v); return *this; }
+  bool concat(const char* x) { s += x; return true; }
+  bool concat(const char* x, unsigned n) { s.append(x, n); return true; }
+  bool concat(char c) { s += c; return true; }
+  bool concat(const String& x) { s += x.s; return true; }
+  bool operator==(const String& x) const { return s == x.s; }
+  bool operator==(const char* x) const { return s == (x ? x : ""); }
+  bool operator!=(const String& x) const { return s != x.s; }
+  bool operator!=(const char* x) const { return s != (x ? x : ""); }
+  bool operator<(const String& x) const { return s < x.s; }
+  explicit operator bool() const { return true; }
+};
+inline String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+inline String operator+(const String& a, const char* b) { return String(a.s + b); }
+inline String operator+(const char* a, const String& b) { return String(std::string(a) + b.s); }
+inline String operator+(const String& a, char b) { return String(a.s + b); }
+inline String operator+(const String& a, int b) { return String(a.s + std::to_string(b)); }
+inline String operator+(const String& a, long b) { return String(a.s + std::to_string(b)); }
+inline String operator+(const String& a, unsigned long b) { return String(a.s + std::to_string(b)); }
+inline String operator+(const String& a, unsigned b) { return String(a.s + std::to_string(b)); }
+#include <chrono>
+inline unsigned long millis() { static auto t0 = std::chrono::steady_clock::now(); return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count(); }
+inline unsigned long micros() { static auto t0 = std::chrono::steady_clock::now(); return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count(); }
+inline void delay(unsigned long) {}
@@ -0,0 +1,58 @@
+#pragma once
+// In-memory stand-in for the LittleFS calls the extracted sketch code makes.
+#include <map>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+class File {
+ public:
+  File() {}
+  File(std::vector<uint8_t>* data, bool write) : data_(data), write_(write) {}
+  explicit operator bool() const { return data_ != nullptr; }
+  size_t read(uint8_t* buf, size_t n) {
+    if (!data_ || write_) return 0;
+    size_t left = data_->size() - pos_;
+    if (n > left) n = left;
+    memcpy(buf, data_->data() + pos_, n);
+    pos_ += n;
+    return n;
+  }
+  size_t write(const uint8_t* buf, size_t n) {
+    if (!data_ || !write_) return 0;
+    data_->insert(data_->end(), buf, buf + n);
+    return n;
+  }
+  size_t size() const { return data_ ? data_->size() : 0; }
+  void close() { data_ = nullptr; }
+
+ private:
+  std::vector<uint8_t>* data_ = nullptr;
+  bool write_ = false;
+  size_t pos_ = 0;
+};
+
+class HostFS {
+ public:
+  std::map<std::string, std::vector<uint8_t>> files;
+  File open(const char* path, const char* mode) {
+    if (mode[0] == 'w') {
+      files[path].clear();
+      return File(&files[path], true);
+    }
+    auto it = files.find(path);
+    return it == files.end() ? File() : File(&it->second, false);
+  }
+  bool exists(const char* path) const { return files.count(path) != 0; }
+  bool remove(const char* path) { return files.erase(path) != 0; }
+  bool rename(const char* from, const char* to) {
+    auto it = files.find(from);
+    if (it == files.end()) return false;
+    files[to] = std::move(it->second);
+    files.erase(from);
+    return true;
+  }
+};
+
+static HostFS LittleFS;
+static bool filesystemReady = true;
@@ -0,0 +1,181 @@
+// Automation scheduler on a virtual clock.
+//
+// Runs the sketch's table loader, state journal and deadline heap against a
+// simulated wall clock: a fast interval, a daily atTime across both US DST
+// transitions, a reload that must keep progress from the state file, and a
+// 2000-entry table to watch per-pass cost.
+#include <sys/time.h>
+#include <vector>
+#include "Arduino.h"
+#include "FS.h"
+
+enum class AllocPref : uint8_t { PreferPSRAM, PreferInternal };
+inline void* ps_realloc(void* p, size_t n, AllocPref, const char*) { return realloc(p, n); }
+inline void* ps_alloc(size_t n, AllocPref, const char*) { return malloc(n); }
+#define DEBUGF(f, fmt, ...) do { if (getenv("DBG")) printf(fmt "\n", ##__VA_ARGS__); } while (0)
+#define DEBUG_AUTOMATIONS 1
+typedef void* TaskHandle_t;
+static long random(long a, long b) { return a + rand() % (b - a); }
+
+// Virtual wall clock (epoch ms) behind gettimeofday()/time()
+static int64_t gNowMs = 0;
+static int hostGettimeofday(struct timeval* tv, void*) {
+  tv->tv_sec = gNowMs / 1000;
+  tv->tv_usec = (gNowMs % 1000) * 1000;
+  return 0;
+}
+static time_t hostTime(time_t*) { return (time_t)(gNowMs / 1000); }
+#define gettimeofday hostGettimeofday
+#define time(x) hostTime(x)
+
+static bool gAutosDirty = false;
+static bool gAutoLogActive = false;
+static String gAutoLogAutomationName;
+static String gJson;  // automations.json
+static bool readText(const char*, String& out) {
+  out = gJson;
+  return true;
+}
+static bool writeAutomationsJsonAtomic(const String& j) {
+  gJson = j;
+  return true;
+}
+static bool appendAutoLogEntry(const String&, const String&) { return true; }
+
+// Every command is "run <id>"; record when each automation fired
+struct Run {
+  long id;
+  int64_t ms;
+};
+static std::vector<Run> gRuns;
+static String executeConditionalCommand(const String& c) {
+  gRuns.push_back({ c.substring(4).toInt(), gNowMs });
+  return "ok";
+}
+
+// Conditions are covered by condition_parity; these entries have none
+struct AutoEntry;
+static void autoCompileConditions() {}
+static int autoCondSelect(const AutoEntry&) { return 0; }
+static const char* autoCondAction(const AutoEntry&, int) { return ""; }
+
+#include "extract.inc"
+
+static int gFailures = 0;
+#define CHECK(cond, ...) \
+  do { \
+    if (!(cond)) { \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__); \
+      printf("\n"); \
+      gFailures++; \
+    } \
+  } while (0)
+
+static String entry(long id, const String& sched) {
+  return "{\"id\": " + String(id) + ", \"enabled\": true, " + sched + ", \"commands\": [\"run " + String(id) + "\"]}";
+}
+
+static void load(const std::vector<String>& objs) {
+  gJson = "{\"version\": 1, \"automations\": [";
+  for (size_t i = 0; i < objs.size(); ++i) {
+    if (i) gJson += ",";
+    gJson += objs[i];
+  }
+  gJson += "]}";
+  LittleFS.files.clear();
+  gAutoTableStale = true;
+  gRuns.clear();
+}
+
+// Sleeps exactly as long as the scheduler task would
+static int runUntil(int64_t untilMs) {
+  int passes = 0;
+  while (gNowMs < untilMs) {
+    gNowMs += autoSchedulerRunDue();
+    passes++;
+  }
+  return passes;
+}
+
+static String localTime(int64_t ms) {
+  time_t t = ms / 1000;
+  struct tm tm;
+  localtime_r(&t, &tm);
+  char b[32];
+  strftime(b, sizeof b, "%Y-%m-%d %H:%M %Z", &tm);
+  return b;
+}
+
+static void testInterval() {
+  gNowMs = 1767225600000LL;  // 2026-01-01 00:00Z
+  load({ entry(1, "\"type\": \"interval\", \"intervalMs\": 1500") });
+  runUntil(gNowMs + 60000);
+  // First run one period in; the 40th lands exactly on the end of the window
+  CHECK(gRuns.size() == 39, "interval 1500ms over 60s ran %zu times, want 39", gRuns.size());
+  for (size_t i = 1; i < gRuns.size(); ++i) {
+    CHECK(gRuns[i].ms - gRuns[i - 1].ms == 1500, "interval run %zu drifted: %lld ms after the previous",
+          i, (long long)(gRuns[i].ms - gRuns[i - 1].ms));
+  }
+}
+
+// Daily 02:30 over four local days starting at startMs
+static void testDst(int64_t startMs, const std::vector<const char*>& want) {
+  gNowMs = startMs;
+  load({ entry(2, "\"type\": \"atTime\", \"time\": \"02:30\"") });
+  runUntil(startMs + 4LL * 86400000);
+  CHECK(gRuns.size() == want.size(), "atTime across DST ran %zu times, want %zu", gRuns.size(), want.size());
+  for (size_t i = 0; i < gRuns.size() && i < want.size(); ++i) {
+    String got = localTime(gRuns[i].ms);
+    CHECK(got == want[i], "atTime run %zu at %s, want %s", i, got.c_str(), want[i]);
+  }
+}
+
+// A reload (any automations.json write) resumes from the journalled state
+static void testReloadKeepsState() {
+  gNowMs = 1767225600000LL;
+  load({ entry(3, "\"type\": \"interval\", \"intervalMs\": 10000") });
+  runUntil(gNowMs + 35000);
+  size_t before = gRuns.size();
+  CHECK(LittleFS.exists(AUTOMATIONS_STATE_FILE), "state file not written");
+  gAutoTableStale = true;
+  runUntil(gNowMs + 30000);
+  CHECK(gRuns.size() == before + 3, "reload: %zu runs after reload, want 3", gRuns.size() - before);
+  CHECK(gAutoTableCount == 1 && gAutoTable[0].runCount == gRuns.size(), "reload: runCount %u, want %zu",
+        gAutoTableCount ? gAutoTable[0].runCount : 0, gRuns.size());
+}
+
+static void testBulk() {
+  std::vector<String> objs;
+  long expect = 0;
+  for (int i = 0; i < 2000; ++i) {
+    int period = 1000 + (i % 50) * 997;
+    objs.push_back(entry(100 + i, "\"type\": \"interval\", \"intervalMs\": " + String(period)));
+    expect += 600000 / period;
+  }
+  gNowMs = 1767225600000LL;
+  load(objs);
+  auto t0 = std::chrono::steady_clock::now();
+  int passes = runUntil(gNowMs + 600000);
+  double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+  long fires = (long)gRuns.size();
+  CHECK(fires >= expect - 2000 && fires <= expect + 2000, "bulk: %ld runs, want about %ld", fires, expect);
+  CHECK(gAutoHeapCount == 2000, "bulk: %d entries scheduled, want 2000", gAutoHeapCount);
+  printf("bulk: 2000 entries, %ld runs in 10 min, %d passes, %.2f us/pass\n", fires, passes, us / passes);
+}
+
+int main() {
+  setenv("TZ", "America/New_York", 1);
+  tzset();
+  testInterval();
+  // Spring forward 2026-03-08: 02:30 doesn't exist that day
+  testDst(1772798400000LL /* 2026-03-06 12:00Z */,
+          { "2026-03-07 02:30 EST", "2026-03-08 03:30 EDT", "2026-03-09 02:30 EDT", "2026-03-10 02:30 EDT" });
+  // Fall back 2026-11-01: 01:00-02:00 repeats, 02:30 happens once
+  testDst(1793361600000LL /* 2026-10-30 12:00Z */,
+          { "2026-10-31 02:30 EDT", "2026-11-01 02:30 EST", "2026-11-02 02:30 EST", "2026-11-03 02:30 EST" });
+  testReloadKeepsState();
+  testBulk();
+  printf("automation_dst: %s\n", gFailures ? "FAILED" : "ok");
+  return gFailures ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+// Compiled conditions vs. the old string evaluator.
+//
+// Feeds random IF/THEN conditions and IF/ELSE IF/ELSE chains, over random
+// sensor readings, to both the sketch's compiled evaluator and the frozen
+// reference in reference.inc, and fails on any disagreement. Also pins down
+// AND/OR precedence and PEER: parsing, and reports evaluation throughput.
+#include <cmath>
+#include "Arduino.h"
+
+#define DEBUGF(f, fmt, ...) do {} while (0)
+#define DEBUG_CLI 1
+#define DEBUG_AUTOMATIONS 2
+
+struct TofObj {
+  bool valid;
+  float distance_cm;
+};
+struct {
+  float thermalAvgTemp;
+  uint16_t apdsClear;
+  uint8_t apdsProximity;
+  int tofTotalObjects;
+  TofObj tofObjects[4];
+} gSensorCache;
+
+static bool old_evaluateCondition(const String& condition);
+#define abs(x) ((x) > 0 ? (x) : -(x))
+#include "reference.inc"
+#undef abs
+
+// Peer telemetry isn't modelled: record which peer a term asked for
+struct CondTerm;
+static uint32_t gPeerAsked = 0;
+static bool gPeerResult = false;
+static bool condEvalPeerTerm(const CondTerm& t);
+
+#include "extract.inc"
+
+static bool condEvalPeerTerm(const CondTerm& t) {
+  gPeerAsked = t.peer;
+  return gPeerResult;
+}
+
+static int gFailures = 0;
+#define CHECK(cond, ...) \
+  do { \
+    if (!(cond)) { \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__); \
+      printf("\n"); \
+      gFailures++; \
+    } \
+  } while (0)
+
+static const char* kSensors[] = { "temp", "TEMP", "light", "distance", "motion", "time", "humidity", "foo", " temp " };
+static const char* kOps[] = { ">", "<", "=", ">=", "<=", "!=" };
+static const char* kValues[] = { "70", "75.5", "0", "-3", "detected", "none", "morning", "night", "evening", "afternoon", "abc", "100" };
+
+static String randomTerm() {
+  return String(kSensors[rand() % 9]) + (rand() % 2 ? " " : "") + kOps[rand() % 6] + (rand() % 2 ? " " : "") + kValues[rand() % 12];
+}
+
+static void randomSensors() {
+  gSensorCache.thermalAvgTemp = (rand() % 1000) / 10.0f;
+  gSensorCache.apdsClear = rand() % 200;
+  gSensorCache.apdsProximity = rand() % 100;
+  gSensorCache.tofTotalObjects = rand() % 5;
+  for (int j = 0; j < 4; ++j) gSensorCache.tofObjects[j] = { (bool)(rand() % 2), (float)(rand() % 300) };
+}
+
+// The reference evaluator only knew single-term conditions
+static void testParity() {
+  srand(1);
+  int mismatches = 0, total = 0;
+  for (int it = 0; it < 200000; ++it) {
+    randomSensors();
+    String simple = "IF " + randomTerm() + " THEN led on";
+    bool a = old_evaluateCondition(simple), b = evaluateCondition(simple);
+    total++;
+    if (a != b && mismatches++ < 5) printf("simple mismatch: %s old=%d new=%d\n", simple.c_str(), a, b);
+
+    String chain = "IF " + randomTerm() + " THEN cmd a";
+    int k = rand() % 3;
+    for (int i = 0; i < k; ++i) chain += " ELSE IF " + randomTerm() + " THEN cmd " + String(i);
+    if (rand() % 2) chain += " ELSE fallback x";
+    String oa = old_evaluateConditionalChain(chain), nb = evaluateConditionalChain(chain);
+    total++;
+    if (oa != nb && mismatches++ < 10) printf("chain mismatch: %s old=[%s] new=[%s]\n", chain.c_str(), oa.c_str(), nb.c_str());
+  }
+  CHECK(mismatches == 0, "parity: %d of %d cases disagree with the reference", mismatches, total);
+}
+
+static void testAndOr() {
+  gSensorCache.thermalAvgTemp = 80;
+  gSensorCache.apdsClear = 10;
+  gSensorCache.apdsProximity = 0;
+  CHECK(!evaluateCondition("IF temp>75 AND light>50 THEN x"), "AND of true and false was true");
+  CHECK(evaluateCondition("IF temp>75 OR light>50 THEN x"), "OR of true and false was false");
+  // AND binds tighter: (light>50 AND motion=detected) OR temp>75
+  CHECK(evaluateCondition("IF light>50 AND motion=detected OR temp>75 THEN x"), "AND/OR precedence");
+  CHECK(!evaluateCondition("IF temp>75 AND light>50 OR motion=detected THEN x"), "AND/OR precedence (false)");
+  CHECK(evaluateConditionalChain("IF temp<50 THEN a ELSE IF temp>75 AND light<50 THEN b ELSE idle") == "B",
+        "chain picked the wrong AND branch");
+}
+
+static void testPeer() {
+  gPeerAsked = 0;
+  gPeerResult = true;
+  CHECK(evaluateCondition("IF peer:Kitchen.temp>20 THEN x"), "peer term result not used");
+  CHECK(gPeerAsked == cmdHashName("kitchen", 7), "peer name hash %08x, want hash of 'kitchen'", gPeerAsked);
+  gPeerResult = false;
+  CHECK(!evaluateCondition("IF peer:kitchen.temp>20 THEN x"), "false peer term evaluated true");
+  gPeerAsked = 0;
+  CHECK(!evaluateCondition("IF peer:.temp>20 THEN x") && gPeerAsked == 0, "peer term without a name was accepted");
+}
+
+static void bench() {
+  String c = "IF temp>75 AND light<50 OR motion=detected THEN x";
+  c.toUpperCase();
+  CondTerm terms[kCondMaxTerms];
+  CondBranch br;
+  int tc = 0;
+  condCompile(c.c_str(), c.length(), false, terms, kCondMaxTerms, tc, &br, 1);
+  const int N = 5000000;
+  volatile int acc = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) {
+    gSensorCache.thermalAvgTemp = (float)(i % 100);
+    acc += condEvalBranch(br, terms);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int i = 0; i < N / 50; ++i) {
+    gSensorCache.thermalAvgTemp = (float)(i % 100);
+    acc += old_evaluateCondition("IF temp>75 THEN x");
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  printf("compiled (3 terms): %.1fM evals/s, reference (1 term): %.2fM evals/s\n",
+         N / std::chrono::duration<double>(t1 - t0).count() / 1e6,
+         (N / 50) / std::chrono::duration<double>(t2 - t1).count() / 1e6);
+}
+
+int main() {
+  testParity();
+  testAndOr();
+  testPeer();
+  bench();
+  printf("condition_parity: %s\n", gFailures ? "FAILED" : "ok");
+  return gFailures ? 1 : 0;
+}
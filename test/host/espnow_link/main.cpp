@@ -0,0 +1,260 @@
+// ESP-NOW framed transfers over a simulated lossy link.
+//
+// Two nodes run the sketch's receive ring, espnow_rx worker and framed
+// transfer code on real threads. The link is half duplex at about 1 Mbit/s
+// with a per-frame overhead, an 8-frame driver queue per sender and random
+// frame loss; send callbacks report each loss like the radio's MAC ACK would.
+// Checks that messages arrive intact at 0/5/20% loss, that transfers in both
+// directions can overlap, that plain sends don't disturb the credit
+// accounting, and that corrupted frames are rejected.
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "Arduino.h"
+
+#define ESP_NOW_MAX_DATA_LEN 250
+#define portMAX_DELAY 0xffffffffu
+#define pdMS_TO_TICKS(x) (x)
+#define DEBUG_WIFIF(...) do {} while (0)
+typedef int BaseType_t;
+enum { pdTRUE = 1 };
+typedef int esp_err_t;
+enum { ESP_OK = 0, ESP_ERR_ESPNOW_NO_MEM = 0x3067, ESP_ERR_ESPNOW_NOT_FOUND = 0x3069 };
+static const char* esp_err_to_name(esp_err_t e) { return e == ESP_ERR_ESPNOW_NOT_FOUND ? "ESP_ERR_ESPNOW_NOT_FOUND" : "ERR"; }
+typedef enum { ESP_NOW_SEND_SUCCESS = 0, ESP_NOW_SEND_FAIL } esp_now_send_status_t;
+struct esp_now_recv_info {
+  const uint8_t* src_addr;
+};
+enum class AllocPref { PreferPSRAM, PreferInternal };
+static void* ps_alloc(size_t n, AllocPref, const char*) { return malloc(n); }
+static uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* p, size_t n) {
+  crc = ~crc;
+  while (n--) {
+    crc ^= *p++;
+    for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+  }
+  return ~crc;
+}
+typedef std::mutex* SemaphoreHandle_t;
+static SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::mutex; }
+static void xSemaphoreTake(SemaphoreHandle_t m, uint32_t) { m->lock(); }
+static void xSemaphoreGive(SemaphoreHandle_t m) { m->unlock(); }
+
+// ---- Lossy half-duplex link ----
+struct Frame {
+  int src, dst;
+  std::vector<uint8_t> b;
+};
+typedef void (*RecvFn)(const esp_now_recv_info*, const uint8_t*, int);
+typedef void (*SentFn)(const uint8_t*, esp_now_send_status_t);
+static std::mutex gLinkMx;
+static std::condition_variable gLinkCv;
+static std::deque<Frame> gLinkQ;
+static double gLoss = 0.0;
+static std::mt19937 gRng(1);
+static std::atomic<uint32_t> gAir{ 0 }, gLost{ 0 };
+static RecvFn gRecv[2];
+static SentFn gSent[2];
+
+static esp_err_t linkSend(int src, int dst, const uint8_t* d, size_t n) {
+  std::lock_guard<std::mutex> l(gLinkMx);
+  int queued = 0;
+  for (auto& f : gLinkQ) queued += f.src == src;
+  if (queued >= 8) return ESP_ERR_ESPNOW_NO_MEM;
+  gLinkQ.push_back({ src, dst, std::vector<uint8_t>(d, d + n) });
+  gLinkCv.notify_one();
+  return ESP_OK;
+}
+
+static void linkThread() {
+  for (;;) {
+    Frame f;
+    {
+      std::unique_lock<std::mutex> l(gLinkMx);
+      gLinkCv.wait(l, [] { return !gLinkQ.empty(); });
+      f = std::move(gLinkQ.front());
+      gLinkQ.pop_front();
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(60 + f.b.size() * 8));
+    gAir++;
+    bool lost = std::uniform_real_distribution<double>(0, 1)(gRng) < gLoss;
+    uint8_t srcMac[6] = { 2, 0, 0, 0, 0, (uint8_t)f.src }, dstMac[6] = { 2, 0, 0, 0, 0, (uint8_t)f.dst };
+    if (lost) {
+      gLost++;
+    } else {
+      esp_now_recv_info ri{ srcMac };
+      gRecv[f.dst](&ri, f.b.data(), (int)f.b.size());
+    }
+    gSent[f.src](dstMac, lost ? ESP_NOW_SEND_FAIL : ESP_NOW_SEND_SUCCESS);
+  }
+}
+
+namespace dev0 {
+static const int kSelf = 0;
+#include "device.inc"
+}
+namespace dev1 {
+static const int kSelf = 1;
+#include "device.inc"
+}
+
+static int gFailures = 0;
+#define CHECK(cond, ...) \
+  do { \
+    if (!(cond)) { \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__); \
+      printf("\n"); \
+      gFailures++; \
+    } \
+  } while (0)
+
+static uint8_t kMac0[6] = { 2, 0, 0, 0, 0, 0 };
+static uint8_t kMac1[6] = { 2, 0, 0, 0, 0, 1 };
+
+static std::string payload(int id, size_t n) {
+  std::string s = "M" + std::to_string(id) + ":";
+  while (s.size() < n) s += (char)('a' + (s.size() * 7 + id) % 26);
+  s.resize(n);
+  return s;
+}
+
+// Delivered RESULT bodies on one device, scanned incrementally from its output
+struct Inbox {
+  std::map<std::string, uint32_t> got;  // body -> delivery time (us)
+  size_t cursor = 0;
+};
+template <class Out>
+static void collect(Out& out, std::mutex& mx, Inbox& in) {
+  std::lock_guard<std::mutex> l(mx);
+  for (; in.cursor < out.size(); ++in.cursor) {
+    if (out[in.cursor].second.rfind("[ESP-NOW] Remote result from", 0) != 0) continue;
+    if (in.cursor + 1 >= out.size()) break;  // body line not logged yet
+    ++in.cursor;
+    in.got[out[in.cursor].second] = out[in.cursor].first;
+  }
+}
+template <class Out>
+static int countLines(Out& out, std::mutex& mx, const char* needle) {
+  std::lock_guard<std::mutex> l(mx);
+  int n = 0;
+  for (auto& e : out) n += e.second.find(needle) != std::string::npos;
+  return n;
+}
+
+static Inbox gIn0, gIn1;
+static int gNextPayload = 0;  // every message body is unique
+
+// n messages of one size from dev0 to dev1, one at a time
+static int runSequential(size_t size, double loss, int n) {
+  gLoss = loss;
+  std::vector<double> lat;
+  uint64_t bytes = 0;
+  uint32_t air0 = gAir, retx0 = dev0::gEspNowFrameStats.txRetx;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; ++i) {
+    std::string p = payload(gNextPayload++, size);
+    uint32_t s = micros();
+    int fail0 = countLines(dev0::gOut, dev0::gOutMx, "failed");
+    while (!dev0::espNowSendMessage(kMac1, dev0::ESPNOW_MSG_RESULT, dev0::kEspNowFrameOk, (const uint8_t*)p.data(), p.size())) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (int w = 0; w < 50000; ++w) {
+      collect(dev1::gOut, dev1::gOutMx, gIn1);
+      if (gIn1.got.count(p) || countLines(dev0::gOut, dev0::gOutMx, "failed") > fail0) break;
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    if (gIn1.got.count(p)) {
+      lat.push_back((gIn1.got[p] - s) / 1000.0);
+      bytes += size;
+    }
+  }
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  std::sort(lat.begin(), lat.end());
+  auto pct = [&](double q) { return lat.empty() ? 0.0 : lat[std::min(lat.size() - 1, (size_t)(q * lat.size()))]; };
+  printf("size=%6zu loss=%3.0f%%  delivered=%2d/%2d  goodput=%6.1f KB/s  p50=%7.1f ms  p95=%7.1f ms  air=%u retx=%u\n",
+         size, loss * 100, (int)lat.size(), n, bytes / 1024.0 / secs, pct(0.5), pct(0.95),
+         (unsigned)(gAir - air0), (unsigned)(dev0::gEspNowFrameStats.txRetx - retx0));
+  return (int)lat.size();
+}
+
+static void testSequential() {
+  for (double loss : { 0.0, 0.05, 0.20 }) {
+    for (size_t size : { 100, 2000, 16000, 60000 }) {
+      int n = size > 20000 ? 5 : 20;
+      int ok = runSequential(size, loss, n);
+      CHECK(ok == n, "%zu-byte messages at %.0f%% loss: %d of %d delivered", size, loss * 100, ok, n);
+    }
+  }
+}
+
+// Six transfers 0->1 and four 1->0 at once, with plain sends mixed in
+static void testConcurrent() {
+  gLoss = 0.10;
+  std::vector<std::string> to1, to0;
+  int plain0 = countLines(dev0::gOut, dev0::gOutMx, "[ESP-NOW] Send to dev1:");
+  for (int i = 0; i < 6; ++i) {
+    to1.push_back(payload(gNextPayload++, 8000 + i * 333));
+    CHECK(dev0::espNowSendMessage(kMac1, dev0::ESPNOW_MSG_RESULT, 0, (const uint8_t*)to1.back().data(), to1.back().size()),
+          "dev0 transfer %d not queued", i);
+  }
+  for (int i = 0; i < 4; ++i) {
+    to0.push_back(payload(gNextPayload++, 5000 + i * 777));
+    CHECK(dev1::espNowSendMessage(kMac0, dev1::ESPNOW_MSG_RESULT, 0, (const uint8_t*)to0.back().data(), to0.back().size()),
+          "dev1 transfer %d not queued", i);
+  }
+  const char text[] = "hello";
+  for (int i = 0; i < 3; ++i) dev0::espNowSendPlain(kMac1, (const uint8_t*)text, sizeof(text) - 1);
+
+  auto t0 = std::chrono::steady_clock::now();
+  int ok1 = 0, ok0 = 0;
+  for (int w = 0; w < 10000 && ok1 + ok0 < 10; ++w) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    collect(dev1::gOut, dev1::gOutMx, gIn1);
+    collect(dev0::gOut, dev0::gOutMx, gIn0);
+    ok1 = ok0 = 0;
+    for (auto& p : to1) ok1 += (int)gIn1.got.count(p);
+    for (auto& p : to0) ok0 += (int)gIn0.got.count(p);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  int plain = countLines(dev0::gOut, dev0::gOutMx, "[ESP-NOW] Send to dev1:") - plain0;
+  printf("concurrent (10%% loss): 0->1 %d/6, 1->0 %d/4 in %.0f ms; rx dup=%u/%u; plain send reports=%d\n", ok1, ok0,
+         std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count(),
+         dev1::gEspNowFrameStats.rxDup, dev0::gEspNowFrameStats.rxDup, plain);
+  CHECK(ok1 == 6 && ok0 == 4, "concurrent transfers: 0->1 %d/6, 1->0 %d/4", ok1, ok0);
+  CHECK(plain == 3, "plain sends: %d send reports, want 3", plain);
+  CHECK(dev0::gEspNowTxCreditsUsed == 0 && dev1::gEspNowTxCreditsUsed == 0, "idle link still holds credits: %u/%u",
+        dev0::gEspNowTxCreditsUsed, dev1::gEspNowTxCreditsUsed);
+}
+
+static void testCorruptFrame() {
+  uint32_t bad0 = dev1::gEspNowFrameStats.rxBad;
+  uint8_t junk[40] = { 0xA7, 1 };
+  esp_now_recv_info ri{ kMac0 };
+  dev1::onEspNowDataReceived(&ri, junk, sizeof junk);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  CHECK(dev1::gEspNowFrameStats.rxBad == bad0 + 1, "corrupted frame not rejected by CRC");
+}
+
+int main() {
+  gRecv[0] = dev0::onEspNowDataReceived;
+  gSent[0] = dev0::onEspNowDataSent;
+  gRecv[1] = dev1::onEspNowDataReceived;
+  gSent[1] = dev1::onEspNowDataSent;
+  std::thread(linkThread).detach();
+  dev0::start();
+  dev1::start();
+  printf("frame payload=%zu bytes, window=%u, credits=%u\n", dev0::kEspNowFramePayload, dev0::kEspNowTxWindow, dev0::kEspNowTxCredits);
+  testSequential();
+  testConcurrent();
+  testCorruptFrame();
+  printf("espnow_link: %s\n", gFailures ? "FAILED" : "ok");
+  fflush(stdout);
+  _exit(gFailures ? 1 : 0);  // worker threads never return
+}
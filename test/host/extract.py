@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""Copy pieces of HardwareOnev2.ino into an include file for a host harness.
+
+Usage: extract.py <sketch.ino> <spec> <out.inc>
+
+Each non-blank, non-# line of the spec names one piece, in output order:
+  def <regex>            top-level definition whose first line matches <regex>
+                         (anchored at column 0), through its closing '}' / '};'
+  range <start> | <end>  lines from the first one starting with <start> up to,
+                         not including, the next one starting with <end>
+  line <prefix>          the single line starting with <prefix>
+
+Pieces are searched in file order from the start of the sketch each time, so
+a spec keeps working as unrelated code moves around. A piece that can't be
+found is an error: the harness no longer matches the sketch.
+"""
+import re
+import sys
+
+
+def find(lines, pred, start=0):
+    for i in range(start, len(lines)):
+        if pred(lines[i]):
+            return i
+    return -1
+
+
+def extract(lines, spec_line):
+    kind, _, arg = spec_line.partition(' ')
+    arg = arg.strip()
+    if kind == 'def':
+        rx = re.compile(arg)
+        a = find(lines, lambda l: rx.match(l) and not l.rstrip().endswith(';'))
+        if a < 0:
+            raise LookupError(spec_line)
+        b = find(lines, lambda l: l.startswith('}'), a)
+        if b < 0:
+            raise LookupError(spec_line)
+        return lines[a:b + 1]
+    if kind == 'range':
+        s, _, e = arg.partition(' | ')
+        a = find(lines, lambda l: l.startswith(s))
+        b = find(lines, lambda l: l.startswith(e), a + 1) if a >= 0 else -1
+        if a < 0 or b < 0:
+            raise LookupError(spec_line)
+        return lines[a:b]
+    if kind == 'line':
+        a = find(lines, lambda l: l.startswith(arg))
+        if a < 0:
+            raise LookupError(spec_line)
+        return lines[a:a + 1]
+    raise ValueError('unknown spec kind: ' + spec_line)
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit(__doc__)
+    with open(sys.argv[1]) as f:
+        lines = f.read().split('\n')
+    out = ['// Generated by test/host/extract.py from ' + sys.argv[1] + '; do not edit']
+    with open(sys.argv[2]) as f:
+        for raw in f:
+            spec = raw.strip()
+            if not spec or spec.startswith('#'):
+                continue
+            try:
+                out.extend(extract(lines, spec))
+            except LookupError:
+                sys.exit('%s: not found in sketch: %s' % (sys.argv[2], spec))
+    with open(sys.argv[3], 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()
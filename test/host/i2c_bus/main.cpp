@@ -0,0 +1,234 @@
+// i2c_bus owner task under contention.
+//
+// Checks i2cBusPick()'s policy directly, then runs the owner task with three
+// sensor "tasks" taking leases at their own clocks plus a CLI path taking the
+// gate directly. Meanwhile the IMU task is killed hundreds of times while
+// waiting for or holding its lease (imustop), and must not wedge the bus.
+// Fails on overlapping bus use, a transaction at the wrong clock, a clock
+// change under someone else's lease, or a device that stops getting the bus.
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "Arduino.h"
+using std::min;
+
+typedef int BaseType_t;
+enum { pdTRUE = 1, pdFALSE = 0, pdPASS = 1 };
+#define portMAX_DELAY 0xffffffffu
+#define pdMS_TO_TICKS(x) (x)
+#define DEBUG_CLIF(...) do {} while (0)
+
+// Binary semaphores (i2cMutex and the per-device grants)
+struct Sem {
+  std::mutex m;
+  std::condition_variable cv;
+  int c = 0;
+};
+typedef Sem* SemaphoreHandle_t;
+static BaseType_t xSemaphoreTake(SemaphoreHandle_t s, uint32_t t) {
+  std::unique_lock<std::mutex> l(s->m);
+  if (t == portMAX_DELAY) s->cv.wait(l, [&] { return s->c > 0; });
+  else if (!s->cv.wait_for(l, std::chrono::milliseconds(t), [&] { return s->c > 0; })) return pdFALSE;
+  s->c--;
+  return pdTRUE;
+}
+static BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+  std::lock_guard<std::mutex> l(s->m);
+  if (s->c) return pdFALSE;
+  s->c = 1;
+  s->cv.notify_all();
+  return pdTRUE;
+}
+struct Tsk {
+  Sem n;
+};
+typedef Tsk* TaskHandle_t;
+static TaskHandle_t gBusTaskObj = nullptr;  // only the owner task waits on notifications
+static uint32_t ulTaskNotifyTake(BaseType_t, uint32_t) {
+  Sem* s = &gBusTaskObj->n;
+  std::unique_lock<std::mutex> l(s->m);
+  s->cv.wait(l, [&] { return s->c > 0; });
+  s->c = 0;
+  return 1;
+}
+static void xTaskNotifyGive(TaskHandle_t t) {
+  std::lock_guard<std::mutex> l(t->n.m);
+  t->n.c++;
+  t->n.cv.notify_all();
+}
+struct portMUX_TYPE {
+  std::mutex m;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(x) (x)->m.lock()
+#define portEXIT_CRITICAL(x) (x)->m.unlock()
+
+// Bus activity: who is on the wire right now
+static std::atomic<int> gInBus{ 0 }, gOverlap{ 0 }, gWrongClock{ 0 }, gClockUnderLease{ 0 };
+struct {
+  void setClock(uint32_t) {
+    if (gInBus) gClockUnderLease++;
+  }
+} Wire1;
+
+SemaphoreHandle_t i2cMutex;
+#define MLX90640_I2CADDR_DEFAULT 0x33
+#define VL53L4CX_DEFAULT_DEVICE_ADDRESS 0x29
+#define BNO055_ADDRESS_A 0x28
+
+#include "extract.inc"
+
+static int gFailures = 0;
+#define CHECK(cond, ...) \
+  do { \
+    if (!(cond)) { \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__); \
+      printf("\n"); \
+      gFailures++; \
+    } \
+  } while (0)
+
+static void request(uint8_t dev, uint8_t prio, uint32_t hz, uint32_t deadlineMs) {
+  I2CBusReq& r = gI2CBusReq[dev];
+  r.pending = true;
+  r.priority = prio;
+  r.clockHz = hz;
+  r.deadlineMs = deadlineMs;
+}
+
+static void testPick() {
+  const uint32_t now = 1000;
+  gWire1CurrentHz = 100000;
+  for (auto& r : gI2CBusReq) r.pending = false;
+  CHECK(i2cBusPick(now) == I2C_DEV_NONE, "picked a device with nothing pending");
+
+  // Priority wins when nothing is overdue and the clocks agree
+  request(I2C_DEV_TOF, kI2CPrioToF, 0, now + 20);
+  request(I2C_DEV_THERMAL, kI2CPrioThermal, 100000, now + 20);
+  CHECK(i2cBusPick(now) == I2C_DEV_THERMAL, "priority: picked %u", i2cBusPick(now));
+
+  // Overdue beats priority, earliest deadline first
+  request(I2C_DEV_IMU, kI2CPrioImu, 0, now - 5);
+  request(I2C_DEV_TOF, kI2CPrioToF, 0, now - 10);
+  CHECK(i2cBusPick(now) == I2C_DEV_TOF, "overdue: picked %u", i2cBusPick(now));
+  gI2CBusReq[I2C_DEV_TOF].pending = gI2CBusReq[I2C_DEV_IMU].pending = false;
+
+  // A short lease at the current clock runs before a clock switch it fits ahead of
+  request(I2C_DEV_THERMAL, kI2CPrioThermal, 800000, now + 20);
+  request(I2C_DEV_TOF, kI2CPrioToF, 0, now + 20);
+  gI2CBusStats[I2C_DEV_TOF].avgBusyUs = 2000;
+  CHECK(i2cBusPick(now) == I2C_DEV_TOF, "batching: picked %u", i2cBusPick(now));
+  // ...but not one that would push the switch past its deadline
+  gI2CBusStats[I2C_DEV_TOF].avgBusyUs = 30000;
+  CHECK(i2cBusPick(now) == I2C_DEV_THERMAL, "batching past deadline: picked %u", i2cBusPick(now));
+
+  for (auto& r : gI2CBusReq) r.pending = false;
+  memset(gI2CBusStats, 0, sizeof(gI2CBusStats));
+}
+
+static std::atomic<int> gOps[I2C_DEV_COUNT];
+static std::atomic<bool> gStop{ false };
+
+static void useBus(uint8_t dev, uint32_t hz, int us) {
+  if (gInBus.fetch_add(1)) gOverlap++;
+  if (hz && gWire1CurrentHz != hz) gWrongClock++;
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+  gInBus--;
+  gOps[dev]++;
+}
+
+static const uint32_t kClock[I2C_DEV_COUNT] = { 800000, 0, 100000 };
+static const int kHoldUs[I2C_DEV_COUNT] = { 3000, 400, 300 };
+static const uint8_t kPrio[I2C_DEV_COUNT] = { kI2CPrioThermal, kI2CPrioToF, kI2CPrioImu };
+
+static void sensorTask(uint8_t d) {
+  while (!gStop) {
+    {
+      I2CBusLease lease(d, kPrio[d], kClock[d], 20);
+      useBus(d, kClock[d], kHoldUs[d]);
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(200 + d * 150));
+  }
+}
+
+// imustop: the IMU task is deleted while waiting for or holding a lease
+static void testCancel(int rounds) {
+  int heldAtCancel = 0;
+  for (int i = 0; i < rounds; ++i) {
+    auto* killed = new std::atomic<bool>(false);
+    auto* running = new std::atomic<bool>(false);
+    std::thread victim([=] {
+      i2cBusAcquire(I2C_DEV_IMU, kI2CPrioImu, 100000, 20);
+      if (*killed) return;
+      *running = true;
+      for (int k = 0; k < 100 && !*killed; ++k) std::this_thread::sleep_for(std::chrono::microseconds(100));
+    });
+    while (!gI2CBusReq[I2C_DEV_IMU].pending && gI2CBusHolder != I2C_DEV_IMU && !*running) std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::microseconds(50 + (i % 11) * 2500));
+    *killed = true;
+    bool held = gI2CBusHolder == I2C_DEV_IMU;
+    i2cBusCancel(I2C_DEV_IMU);
+    heldAtCancel += held;
+    // A deleted task waits on nothing: leave a still-blocked thread its own semaphore
+    std::this_thread::sleep_for(std::chrono::microseconds(300));
+    if (!held && !*running) gI2CBusReq[I2C_DEV_IMU].grant = new Sem;
+    victim.detach();
+    if (gI2CBusHolder == I2C_DEV_IMU) {
+      CHECK(false, "round %d: cancelled imu still holds the bus", i);
+      break;
+    }
+  }
+  printf("cancel: %d rounds, %d while holding the bus\n", rounds, heldAtCancel);
+  CHECK(heldAtCancel > 0, "no cancel hit a held lease; the test lost its timing");
+}
+
+int main() {
+  testPick();
+
+  i2cMutex = new Sem;
+  i2cMutex->c = 1;
+  for (auto& r : gI2CBusReq) r.grant = new Sem;
+  gBusTaskObj = new Tsk;
+  gI2CBusTask = gBusTaskObj;
+  std::thread([] { i2cBusTask(nullptr); }).detach();
+
+  std::thread thermal(sensorTask, I2C_DEV_THERMAL), tof(sensorTask, I2C_DEV_TOF);
+  std::thread cli([] {
+    while (!gStop) {
+      bool took = i2cGateTake(I2C_DEV_TOF, 500);
+      if (took) useBus(I2C_DEV_TOF, 0, 100);
+      i2cGateGive(I2C_DEV_TOF, took);
+      std::this_thread::sleep_for(std::chrono::milliseconds(7));
+    }
+  });
+  testCancel(300);
+
+  // imustart: a new IMU task, with stale grants from the cancels still around
+  int before[I2C_DEV_COUNT];
+  for (int d = 0; d < I2C_DEV_COUNT; ++d) before[d] = gOps[d];
+  std::thread imu(sensorTask, I2C_DEV_IMU);
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  gStop = true;
+  thermal.join();
+  tof.join();
+  imu.join();
+  cli.join();
+
+  printf("leases after restart: thermal %d tof %d imu %d; switches %u\n", gOps[0] - before[0], gOps[1] - before[1],
+         gOps[2] - before[2], gI2CBusSwitches);
+  for (int d = 0; d < I2C_DEV_COUNT; ++d) {
+    printf("  %-7s leases %u late %u avgBusy %u us maxWait %u us\n", kI2CBusDevNames[d], gI2CBusStats[d].leases,
+           gI2CBusStats[d].late, gI2CBusStats[d].avgBusyUs, gI2CBusStats[d].maxWaitUs);
+    CHECK(gOps[d] - before[d] > 50, "%s got only %d leases in 2 s", kI2CBusDevNames[d], gOps[d] - before[d]);
+  }
+  CHECK(gOverlap == 0, "%d overlapping bus uses", gOverlap.load());
+  CHECK(gWrongClock == 0, "%d transactions at the wrong clock", gWrongClock.load());
+  CHECK(gClockUnderLease == 0, "%d clock changes while the bus was in use", gClockUnderLease.load());
+  printf("i2c_bus: %s\n", gFailures ? "FAILED" : "ok");
+  fflush(stdout);
+  _exit(gFailures ? 1 : 0);  // the owner task never returns
+}
@@ -4,8 +4,7 @@
 #include <Arduino.h>
 #include "web_shared.h"
 
-String getEspNowContent() {
-  String inner = 
+static const char kEspNowContent[] PROGMEM =
     "<style>"
     ".espnow-container { max-width: 1200px; margin: 0 auto; padding: 20px; }"
     ".espnow-grid { display: grid; grid-template-columns: repeat(auto-fit, minmax(400px, 1fr)); gap: 20px; margin-bottom: 30px; }"
@@ -143,575 +142,568 @@ String getEspNowContent() {
     "</div>"
     
     "</div>" // End container
-    ;
+    
 
   // JavaScript - Chunk 1: Global Variables
-  inner += "<script>";
-  inner += "(function() {";
-  inner += "  try {";
-  inner += "    console.log('[ESP-NOW] Chunk 1: Global variables start');";
-  inner += "    window.messageCount = 0;";
-  inner += "    window.maxMessages = 50;";
-  inner += "    window.__espnowLogPoll = null;";
-  inner += "    window.__espnowSeen = new Set();";
-  inner += "    window.DEBUG_ESPNOW_RX = false;";
-  inner += "    console.log('[ESP-NOW] Chunk 1: Global variables ready');";
-  inner += "  } catch(e) { console.error('[ESP-NOW] Chunk 1 error:', e); }";
-  inner += "})();";
-  inner += "</script>";
+    "<script>"
+    "(function() {"
+    "  try {"
+    "    console.log('[ESP-NOW] Chunk 1: Global variables start');"
+    "    window.messageCount = 0;"
+    "    window.maxMessages = 50;"
+    "    window.__espnowLogPoll = null;"
+    "    window.__espnowSeen = new Set();"
+    "    window.DEBUG_ESPNOW_RX = false;"
+    "    console.log('[ESP-NOW] Chunk 1: Global variables ready');"
+    "  } catch(e) { console.error('[ESP-NOW] Chunk 1 error:', e); }"
+    "})();"
+    "</script>"
 
   // JavaScript - Chunk 1b: RX Watcher Functions
-  inner += "<script>";
-  inner += "(function() {";
-  inner += "  try {";
-  inner += "    console.log('[ESP-NOW] Chunk 1b: RX functions start');";
-  inner += "    window.parseAndAppendReceives = function(text) {";
-  inner += "      try {";
-  inner += "        const lines = (text || '').split('\\n');";
-  inner += "        let found = 0;";
-  inner += "        for (let i = 0; i < lines.length; i++) {";
-  inner += "          const line = lines[i];";
-  inner += "          if (!line || line.indexOf('[ESP-NOW] Received from ') < 0) continue;";
-  inner += "          if (window.__espnowSeen.has(line)) continue;";
-  inner += "          window.__espnowSeen.add(line);";
-  inner += "          const fromIdx = line.indexOf('Received from ') + 'Received from '.length;";
-  inner += "          let mac = line.substring(fromIdx).trim();";
-  inner += "          const colonIdx = mac.indexOf(':');";
-  inner += "          if (colonIdx >= 0) {";
-  inner += "            const rest = mac.substring(colonIdx + 1).trim();";
-  inner += "            mac = mac.substring(0, colonIdx).trim();";
-  inner += "            const msg = rest.replace(/^:\\s*/, '');";
-  inner += "            if (typeof addMessageToLog === 'function') {";
-  inner += "              addMessageToLog('RECEIVED', 'From ' + mac + ': ' + msg);";
-  inner += "              found++;";
-  inner += "            }";
-  inner += "          }";
-  inner += "        }";
-  inner += "        if (window.DEBUG_ESPNOW_RX && found > 0) {";
-  inner += "          console.log('[ESP-NOW][RX] Found', found, 'new messages');";
-  inner += "        }";
-  inner += "      } catch(e) { console.warn('[ESP-NOW][RX] Parse error:', e); }";
-  inner += "    };";
-  inner += "    window.startEspNowReceiveWatcher = function() {";
-  inner += "      try {";
-  inner += "        if (window.__espnowLogPoll) return;";
-  inner += "        console.log('[ESP-NOW] Starting RX watcher...');";
-  inner += "        window.__espnowLogPoll = setInterval(function() {";
-  inner += "          fetch('/logs.txt', { cache: 'no-store', credentials: 'same-origin' })";
-  inner += "            .then(r => r.text())";
-  inner += "            .then(t => window.parseAndAppendReceives(t))";
-  inner += "            .catch(e => { if (window.DEBUG_ESPNOW_RX) console.warn('[ESP-NOW][RX] Fetch error:', e); });";
-  inner += "        }, 2000);";
-  inner += "      } catch(e) { console.warn('[ESP-NOW] RX watcher start error:', e); }";
-  inner += "    };";
-  inner += "    window.stopEspNowReceiveWatcher = function() {";
-  inner += "      if (window.__espnowLogPoll) {";
-  inner += "        clearInterval(window.__espnowLogPoll);";
-  inner += "        window.__espnowLogPoll = null;";
-  inner += "        console.log('[ESP-NOW] RX watcher stopped');";
-  inner += "      }";
-  inner += "    };";
-  inner += "    console.log('[ESP-NOW] Chunk 1b: RX functions ready');";
-  inner += "  } catch(e) { console.error('[ESP-NOW] Chunk 1b error:', e); }";
-  inner += "})();";
-  inner += "</script>";
+    "<script>"
+    "(function() {"
+    "  try {"
+    "    console.log('[ESP-NOW] Chunk 1b: RX functions start');"
+    "    window.parseAndAppendReceives = function(text) {"
+    "      try {"
+    "        const lines = (text || '').split('\\n');"
+    "        let found = 0;"
+    "        for (let i = 0; i < lines.length; i++) {"
+    "          const line = lines[i];"
+    "          if (!line || line.indexOf('[ESP-NOW] Received from ') < 0) continue;"
+    "          if (window.__espnowSeen.has(line)) continue;"
+    "          window.__espnowSeen.add(line);"
+    "          const fromIdx = line.indexOf('Received from ') + 'Received from '.length;"
+    "          let mac = line.substring(fromIdx).trim();"
+    "          const colonIdx = mac.indexOf(':');"
+    "          if (colonIdx >= 0) {"
+    "            const rest = mac.substring(colonIdx + 1).trim();"
+    "            mac = mac.substring(0, colonIdx).trim();"
+    "            const msg = rest.replace(/^:\\s*/, '');"
+    "            if (typeof addMessageToLog === 'function') {"
+    "              addMessageToLog('RECEIVED', 'From ' + mac + ': ' + msg);"
+    "              found++;"
+    "            }"
+    "          }"
+    "        }"
+    "        if (window.DEBUG_ESPNOW_RX && found > 0) {"
+    "          console.log('[ESP-NOW][RX] Found', found, 'new messages');"
+    "        }"
+    "      } catch(e) { console.warn('[ESP-NOW][RX] Parse error:', e); }"
+    "    };"
+    "    window.startEspNowReceiveWatcher = function() {"
+    "      try {"
+    "        if (window.__espnowLogPoll) return;"
+    "        console.log('[ESP-NOW] Starting RX watcher...');"
+    "        window.__espnowLogPoll = setInterval(function() {"
+    "          fetch('/logs.txt', { cache: 'no-store', credentials: 'same-origin' })"
+    "            .then(r => r.text())"
+    "            .then(t => window.parseAndAppendReceives(t))"
+    "            .catch(e => { if (window.DEBUG_ESPNOW_RX) console.warn('[ESP-NOW][RX] Fetch error:', e); });"
+    "        }, 2000);"
+    "      } catch(e) { console.warn('[ESP-NOW] RX watcher start error:', e); }"
+    "    };"
+    "    window.stopEspNowReceiveWatcher = function() {"
+    "      if (window.__espnowLogPoll) {"
+    "        clearInterval(window.__espnowLogPoll);"
+    "        window.__espnowLogPoll = null;"
+    "        console.log('[ESP-NOW] RX watcher stopped');"
+    "      }"
+    "    };"
+    "    console.log('[ESP-NOW] Chunk 1b: RX functions ready');"
+    "  } catch(e) { console.error('[ESP-NOW] Chunk 1b error:', e); }"
+    "})();"
+    "</script>"
 
   // JavaScript - Chunk 2: Status Management Functions
-  inner += "<script>";
-  inner += "(function() {";
-  inner += "  try {";
-  inner += "    console.log('[ESP-NOW] Chunk 2: Status functions start');";
-  inner += "    window.refreshStatus = function() {";
-  inner += "      fetch('/api/cli', {";
-  inner += "        method: 'POST',";
-  inner += "        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },";
-  inner += "        body: 'cmd=' + encodeURIComponent('espnow status')";
-  inner += "      })";
-  inner += "      .then(response => response.text())";
-  inner += "      .then(output => {";
-  inner += "        document.getElementById('espnow-status-data').textContent = output;";
-  inner += "        const indicator = document.getElementById('espnow-status-indicator');";
-  inner += "        if (output.includes('Initialized: Yes')) {";
-  inner += "          indicator.className = 'status-indicator status-enabled';";
-  inner += "        } else {";
-  inner += "          indicator.className = 'status-indicator status-disabled';";
-  inner += "        }";
-  inner += "      })";
-  inner += "      .catch(error => {";
-  inner += "        document.getElementById('espnow-status-data').textContent = 'Error: ' + error;";
-  inner += "      });";
-  inner += "    };";
-  inner += "    console.log('[ESP-NOW] Chunk 2: Status functions ready');";
-  inner += "  } catch(e) { console.error('[ESP-NOW] Chunk 2 error:', e); }";
-  inner += "})();";
-  inner += "</script>";
+    "<script>"
+    "(function() {"
+    "  try {"
+    "    console.log('[ESP-NOW] Chunk 2: Status functions start');"
+    "    window.refreshStatus = function() {"
+    "      fetch('/api/cli', {"
+    "        method: 'POST',"
+    "        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },"
+    "        body: 'cmd=' + encodeURIComponent('espnow status')"
+    "      })"
+    "      .then(response => response.text())"
+    "      .then(output => {"
+    "        document.getElementById('espnow-status-data').textContent = output;"
+    "        const indicator = document.getElementById('espnow-status-indicator');"
+    "        if (output.includes('Initialized: Yes')) {"
+    "          indicator.className = 'status-indicator status-enabled';"
+    "        } else {"
+    "          indicator.className = 'status-indicator status-disabled';"
+    "        }"
+    "      })"
+    "      .catch(error => {"
+    "        document.getElementById('espnow-status-data').textContent = 'Error: ' + error;"
+    "      });"
+    "    };"
+    "    console.log('[ESP-NOW] Chunk 2: Status functions ready');"
+    "  } catch(e) { console.error('[ESP-NOW] Chunk 2 error:', e); }"
+    "})();"
+    "</script>"
 
   // JavaScript - Chunk 3: Device Management Functions
-  inner += "<script>";
-  inner += "(function() {";
-  inner += "  try {";
-  inner += "    console.log('[ESP-NOW] Chunk 3: Device functions start');";
-  inner += "    window.listDevices = function() {";
-  inner += "      fetch('/api/cli', {";
-  inner += "        method: 'POST',";
-  inner += "        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },";
-  inner += "        body: 'cmd=' + encodeURIComponent('espnow list')";
-  inner += "      })";
-  inner += "      .then(response => response.text())";
-  inner += "      .then(output => {";
-  inner += "        const deviceList = document.getElementById('device-list');";
-  inner += "        if (output.includes('No devices paired')) {";
-  inner += "          deviceList.innerHTML = '<div style=\"color: #666; text-align: center;\">No devices paired yet</div>';";
-  inner += "        } else {";
-  inner += "          const lines = output.split('\\n');";
-  inner += "          let html = '';";
-  inner += "          for (const line of lines) {";
-  inner += "            if (line.includes('Channel:')) {";
-  inner += "              const trimmed = line.trim();";
-  inner += "              let deviceName = '';";
-  inner += "              let mac = '';";
-  inner += "              let channel = '?';";
-  inner += "              ";
-  inner += "              /* Parse format: 'left (E8:6B:EA:30:04:D4) Channel: 11' or 'E8:6B:EA:30:04:D4 (Channel: 11)' */";
-  inner += "              const channelMatch = trimmed.match(/Channel:\\s*(\\d+)/);";
-  inner += "              if (channelMatch) channel = channelMatch[1];";
-  inner += "              ";
-  inner += "              /* Check for encryption status */";
-  inner += "              const isEncrypted = trimmed.includes('[ENCRYPTED]');";
-  inner += "              const encryptionClass = isEncrypted ? 'device-encrypted' : 'device-unencrypted';";
-  inner += "              const encryptionIndicator = isEncrypted ? 'encryption-enabled' : 'encryption-disabled';";
-  inner += "              const encryptionText = isEncrypted ? 'Encrypted' : 'Unencrypted';";
-  inner += "              ";
-  inner += "              const macMatch = trimmed.match(/([A-Fa-f0-9:]{17})/);";
-  inner += "              if (macMatch) {";
-  inner += "                mac = macMatch[1].toUpperCase();";
-  inner += "                ";
-  inner += "                /* Check if format has device name: 'name (MAC) Channel: X' */";
-  inner += "                const nameMatch = trimmed.match(/^\\s*(.+?)\\s*\\([A-Fa-f0-9:]{17}\\)/);";
-  inner += "                if (nameMatch) {";
-  inner += "                  deviceName = nameMatch[1].trim();";
-  inner += "                }";
-  inner += "                ";
-  inner += "                html += '<div class=\"device-item\">';";
-  inner += "                html += '<div>';";
-  inner += "                if (deviceName) {";
-  inner += "                  html += '<div class=\"device-mac\"><strong>' + deviceName + '</strong><span class=\"encryption-indicator ' + encryptionIndicator + '\" title=\"' + encryptionText + '\"></span></div>';";
-  inner += "                  html += '<div class=\"device-channel ' + encryptionClass + '\">' + mac + ' • Channel: ' + channel + ' • ' + encryptionText + '</div>';";
-  inner += "                } else {";
-  inner += "                  html += '<div class=\"device-mac\">' + mac + '<span class=\"encryption-indicator ' + encryptionIndicator + '\" title=\"' + encryptionText + '\"></span></div>';";
-  inner += "                  html += '<div class=\"device-channel ' + encryptionClass + '\">Channel: ' + channel + ' • ' + encryptionText + '</div>';";
-  inner += "                }";
-  inner += "                html += '</div>';";
-  inner += "                html += '<div class=\"device-actions\">';";
-  inner += "                html += '<button class=\"btn btn-small\" onclick=\"sendToDevice(\\'' + mac + '\\')\">Send</button>';";
-  inner += "                html += '<button class=\"btn btn-small\" onclick=\"unpairDevice(\\'' + mac + '\\')\">Unpair</button>';";
-  inner += "                html += '</div>';";
-  inner += "                html += '</div>';";
-  inner += "              }";
-  inner += "            }";
-  inner += "          }";
-  inner += "          deviceList.innerHTML = html || '<div style=\"color: #666; text-align: center;\">No devices found</div>';";
-  inner += "        }";
-  inner += "      })";
-  inner += "      .catch(error => {";
-  inner += "        document.getElementById('device-list').innerHTML = '<div style=\"color: #dc3545;\">Error loading devices: ' + error + '</div>';";
-  inner += "      });";
-  inner += "    };";
-  inner += "    window.sendToDevice = function(mac) {";
-  inner += "      document.getElementById('send-mac').value = mac;";
-  inner += "      document.getElementById('send-message').focus();";
-  inner += "    };";
-  inner += "    window.unpairDevice = function(mac) {";
-  inner += "      if (confirm('Unpair device ' + mac + '?')) {";
-  inner += "        fetch('/api/cli', {";
-  inner += "          method: 'POST',";
-  inner += "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },";
-  inner += "          body: 'cmd=' + encodeURIComponent('espnow unpair ' + mac)";
-  inner += "        })";
-  inner += "        .then(response => response.text())";
-  inner += "        .then(text => {";
-  inner += "          addMessageToLog('UNPAIR', text);";
-  inner += "          listDevices();";
-  inner += "        })";
-  inner += "        .catch(error => {";
-  inner += "          addMessageToLog('ERROR', 'Unpair error: ' + error);";
-  inner += "        });";
-  inner += "      }";
-  inner += "    };";
-  inner += "    console.log('[ESP-NOW] Chunk 3: Device functions ready');";
-  inner += "  } catch(e) { console.error('[ESP-NOW] Chunk 3 error:', e); }";
-  inner += "})();";
-  inner += "</script>";
+    "<script>"
+    "(function() {"
+    "  try {"
+    "    console.log('[ESP-NOW] Chunk 3: Device functions start');"
+    "    window.listDevices = function() {"
+    "      fetch('/api/cli', {"
+    "        method: 'POST',"
+    "        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },"
+    "        body: 'cmd=' + encodeURIComponent('espnow list')"
+    "      })"
+    "      .then(response => response.text())"
+    "      .then(output => {"
+    "        const deviceList = document.getElementById('device-list');"
+    "        if (output.includes('No devices paired')) {"
+    "          deviceList.innerHTML = '<div style=\"color: #666; text-align: center;\">No devices paired yet</div>';"
+    "        } else {"
+    "          const lines = output.split('\\n');"
+    "          let html = '';"
+    "          for (const line of lines) {"
+    "            if (line.includes('Channel:')) {"
+    "              const trimmed = line.trim();"
+    "              let deviceName = '';"
+    "              let mac = '';"
+    "              let channel = '?';"
+    "              "
+    "              /* Parse format: 'left (E8:6B:EA:30:04:D4) Channel: 11' or 'E8:6B:EA:30:04:D4 (Channel: 11)' */"
+    "              const channelMatch = trimmed.match(/Channel:\\s*(\\d+)/);"
+    "              if (channelMatch) channel = channelMatch[1];"
+    "              "
+    "              /* Check for encryption status */"
+    "              const isEncrypted = trimmed.includes('[ENCRYPTED]');"
+    "              const encryptionClass = isEncrypted ? 'device-encrypted' : 'device-unencrypted';"
+    "              const encryptionIndicator = isEncrypted ? 'encryption-enabled' : 'encryption-disabled';"
+    "              const encryptionText = isEncrypted ? 'Encrypted' : 'Unencrypted';"
+    "              "
+    "              const macMatch = trimmed.match(/([A-Fa-f0-9:]{17})/);"
+    "              if (macMatch) {"
+    "                mac = macMatch[1].toUpperCase();"
+    "                "
+    "                /* Check if format has device name: 'name (MAC) Channel: X' */"
+    "                const nameMatch = trimmed.match(/^\\s*(.+?)\\s*\\([A-Fa-f0-9:]{17}\\)/);"
+    "                if (nameMatch) {"
+    "                  deviceName = nameMatch[1].trim();"
+    "                }"
+    "                "
+    "                html += '<div class=\"device-item\">';"
+    "                html += '<div>';"
+    "                if (deviceName) {"
+    "                  html += '<div class=\"device-mac\"><strong>' + deviceName + '</strong><span class=\"encryption-indicator ' + encryptionIndicator + '\" title=\"' + encryptionText + '\"></span></div>';"
+    "                  html += '<div class=\"device-channel ' + encryptionClass + '\">' + mac + ' • Channel: ' + channel + ' • ' + encryptionText + '</div>';"
+    "                } else {"
+    "                  html += '<div class=\"device-mac\">' + mac + '<span class=\"encryption-indicator ' + encryptionIndicator + '\" title=\"' + encryptionText + '\"></span></div>';"
+    "                  html += '<div class=\"device-channel ' + encryptionClass + '\">Channel: ' + channel + ' • ' + encryptionText + '</div>';"
+    "                }"
+    "                html += '</div>';"
+    "                html += '<div class=\"device-actions\">';"
+    "                html += '<button class=\"btn btn-small\" onclick=\"sendToDevice(\\'' + mac + '\\')\">Send</button>';"
+    "                html += '<button class=\"btn btn-small\" onclick=\"unpairDevice(\\'' + mac + '\\')\">Unpair</button>';"
+    "                html += '</div>';"
+    "                html += '</div>';"
+    "              }"
+    "            }"
+    "          }"
+    "          deviceList.innerHTML = html || '<div style=\"color: #666; text-align: center;\">No devices found</div>';"
+    "        }"
+    "      })"
+    "      .catch(error => {"
+    "        document.getElementById('device-list').innerHTML = '<div style=\"color: #dc3545;\">Error loading devices: ' + error + '</div>';"
+    "      });"
+    "    };"
+    "    window.sendToDevice = function(mac) {"
+    "      document.getElementById('send-mac').value = mac;"
+    "      document.getElementById('send-message').focus();"
+    "    };"
+    "    window.unpairDevice = function(mac) {"
+    "      if (confirm('Unpair device ' + mac + '?')) {"
+    "        fetch('/api/cli', {"
+    "          method: 'POST',"
+    "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },"
+    "          body: 'cmd=' + encodeURIComponent('espnow unpair ' + mac)"
+    "        })"
+    "        .then(response => response.text())"
+    "        .then(text => {"
+    "          addMessageToLog('UNPAIR', text);"
+    "          listDevices();"
+    "        })"
+    "        .catch(error => {"
+    "          addMessageToLog('ERROR', 'Unpair error: ' + error);"
+    "        });"
+    "      }"
+    "    };"
+    "    console.log('[ESP-NOW] Chunk 3: Device functions ready');"
+    "  } catch(e) { console.error('[ESP-NOW] Chunk 3 error:', e); }"
+    "})();"
+    "</script>"
 
   // JavaScript - Chunk 4: Messaging Functions
-  inner += "<script>";
-  inner += "(function() {";
-  inner += "  try {";
-  inner += "    console.log('[ESP-NOW] Chunk 4: Messaging functions start');";
-  inner += "    window.sendMessage = function(mac, message) {";
-  inner += "      fetch('/api/cli', {";
-  inner += "        method: 'POST',";
-  inner += "        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },";
-  inner += "        body: 'cmd=' + encodeURIComponent('espnow send ' + mac + ' ' + message)";
-  inner += "      })";
-  inner += "      .then(response => response.text())";
-  inner += "      .then(text => {";
-  inner += "        addMessageToLog('SENT', 'To ' + mac + ': ' + message);";
-  inner += "        addMessageToLog('RESULT', text);";
-  inner += "        if (text && text.indexOf('Message sent') >= 0) {";
-  inner += "          document.getElementById('send-message').value = '';";
-  inner += "        }";
-  inner += "      })";
-  inner += "      .catch(error => {";
-  inner += "        addMessageToLog('ERROR', 'Send error: ' + error);";
-  inner += "      });";
-  inner += "    };";
-  inner += "    window.addMessageToLog = function(type, message) {";
-  inner += "      const log = document.getElementById('message-log');";
-  inner += "      const timestamp = new Date().toLocaleTimeString();";
-  inner += "      let className = 'message-item';";
-  inner += "      if (type === 'SENT' || type === 'BROADCAST') className += ' message-sent';";
-  inner += "      else if (type === 'RECEIVED') className += ' message-received';";
-  inner += "      else if (type === 'ERROR') className += ' message-error';";
-  inner += "      const messageDiv = document.createElement('div');";
-  inner += "      messageDiv.className = className;";
-  inner += "      messageDiv.textContent = '[' + timestamp + '] ' + type + ': ' + message;";
-  inner += "      if (log.children.length === 1 && log.children[0].textContent.includes('Message log will appear')) {";
-  inner += "        log.innerHTML = '';";
-  inner += "      }";
-  inner += "      log.appendChild(messageDiv);";
-  inner += "      window.messageCount++;";
-  inner += "      if (window.messageCount > window.maxMessages) {";
-  inner += "        log.removeChild(log.firstChild);";
-  inner += "        window.messageCount--;";
-  inner += "      }";
-  inner += "      log.scrollTop = log.scrollHeight;";
-  inner += "    };";
-  inner += "    console.log('[ESP-NOW] Chunk 4: Messaging functions ready');";
-  inner += "  } catch(e) { console.error('[ESP-NOW] Chunk 4 error:', e); }";
-  inner += "})();";
-  inner += "</script>";
+    "<script>"
+    "(function() {"
+    "  try {"
+    "    console.log('[ESP-NOW] Chunk 4: Messaging functions start');"
+    "    window.sendMessage = function(mac, message) {"
+    "      fetch('/api/cli', {"
+    "        method: 'POST',"
+    "        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },"
+    "        body: 'cmd=' + encodeURIComponent('espnow send ' + mac + ' ' + message)"
+    "      })"
+    "      .then(response => response.text())"
+    "      .then(text => {"
+    "        addMessageToLog('SENT', 'To ' + mac + ': ' + message);"
+    "        addMessageToLog('RESULT', text);"
+    "        if (text && text.indexOf('Message sent') >= 0) {"
+    "          document.getElementById('send-message').value = '';"
+    "        }"
+    "      })"
+    "      .catch(error => {"
+    "        addMessageToLog('ERROR', 'Send error: ' + error);"
+    "      });"
+    "    };"
+    "    window.addMessageToLog = function(type, message) {"
+    "      const log = document.getElementById('message-log');"
+    "      const timestamp = new Date().toLocaleTimeString();"
+    "      let className = 'message-item';"
+    "      if (type === 'SENT' || type === 'BROADCAST') className += ' message-sent';"
+    "      else if (type === 'RECEIVED') className += ' message-received';"
+    "      else if (type === 'ERROR') className += ' message-error';"
+    "      const messageDiv = document.createElement('div');"
+    "      messageDiv.className = className;"
+    "      messageDiv.textContent = '[' + timestamp + '] ' + type + ': ' + message;"
+    "      if (log.children.length === 1 && log.children[0].textContent.includes('Message log will appear')) {"
+    "        log.innerHTML = '';"
+    "      }"
+    "      log.appendChild(messageDiv);"
+    "      window.messageCount++;"
+    "      if (window.messageCount > window.maxMessages) {"
+    "        log.removeChild(log.firstChild);"
+    "        window.messageCount--;"
+    "      }"
+    "      log.scrollTop = log.scrollHeight;"
+    "    };"
+    "    console.log('[ESP-NOW] Chunk 4: Messaging functions ready');"
+    "  } catch(e) { console.error('[ESP-NOW] Chunk 4 error:', e); }"
+    "})();"
+    "</script>"
 
   // JavaScript - Chunk 5: Button Event Handlers
-  inner += "<script>";
-  inner += "(function() {";
-  inner += "  try {";
-  inner += "    console.log('[ESP-NOW] Chunk 5: Button handlers start');";
-  inner += "    window.setupButtonHandlers = function() {";
-  inner += "      document.getElementById('btn-espnow-init').addEventListener('click', function() {";
-  inner += "        fetch('/api/cli', {";
-  inner += "          method: 'POST',";
-  inner += "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },";
-  inner += "          body: 'cmd=' + encodeURIComponent('espnow init')";
-  inner += "        })";
-  inner += "        .then(response => response.text())";
-  inner += "        .then(text => {";
-  inner += "          document.getElementById('espnow-status-data').textContent = text;";
-  inner += "          refreshStatus();";
-  inner += "        })";
-  inner += "        .catch(error => {";
-  inner += "          document.getElementById('espnow-status-data').textContent = 'Error: ' + error;";
-  inner += "        });";
-  inner += "      });";
-  inner += "      document.getElementById('btn-espnow-refresh').addEventListener('click', refreshStatus);";
-  inner += "      document.getElementById('btn-pair-device').addEventListener('click', function() {";
-  inner += "        const mac = document.getElementById('pair-mac').value.trim();";
-  inner += "        const name = document.getElementById('pair-name').value.trim();";
-  inner += "        if (!mac || !name) {";
-  inner += "          alert('Please enter both MAC address and device name');";
-  inner += "          return;";
-  inner += "        }";
-  inner += "        fetch('/api/cli', {";
-  inner += "          method: 'POST',";
-  inner += "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },";
-  inner += "          body: 'cmd=' + encodeURIComponent('espnow pair ' + mac + ' ' + name)";
-  inner += "        })";
-  inner += "        .then(response => response.text())";
-  inner += "        .then(text => {";
-  inner += "          addMessageToLog('PAIR', text);";
-  inner += "          if (text && text.indexOf('Paired device') >= 0) {";
-  inner += "            document.getElementById('pair-mac').value = '';";
-  inner += "            document.getElementById('pair-name').value = '';";
-  inner += "            listDevices();";
-  inner += "          }";
-  inner += "        })";
-  inner += "        .catch(error => {";
-  inner += "          addMessageToLog('ERROR', 'Pair error: ' + error);";
-  inner += "        });";
-  inner += "      });";
-  inner += "      document.getElementById('btn-pair-secure').addEventListener('click', function() {";
-  inner += "        const mac = document.getElementById('pair-mac').value.trim();";
-  inner += "        const name = document.getElementById('pair-name').value.trim();";
-  inner += "        if (!mac || !name) {";
-  inner += "          alert('Please enter both MAC address and device name');";
-  inner += "          return;";
-  inner += "        }";
-  inner += "        fetch('/api/cli', {";
-  inner += "          method: 'POST',";
-  inner += "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },";
-  inner += "          body: 'cmd=' + encodeURIComponent('espnow pairsecure ' + mac + ' ' + name)";
-  inner += "        })";
-  inner += "        .then(response => response.text())";
-  inner += "        .then(text => {";
-  inner += "          addMessageToLog('PAIR_SECURE', text);";
-  inner += "          if (text && text.indexOf('paired successfully') >= 0) {";
-  inner += "            document.getElementById('pair-mac').value = '';";
-  inner += "            document.getElementById('pair-name').value = '';";
-  inner += "            listDevices();";
-  inner += "          }";
-  inner += "        })";
-  inner += "        .catch(error => {";
-  inner += "          addMessageToLog('ERROR', 'Secure pair error: ' + error);";
-  inner += "        });";
-  inner += "      });";
-  inner += "      document.getElementById('btn-set-passphrase').addEventListener('click', function() {";
-  inner += "        const passphrase = document.getElementById('encryption-passphrase').value.trim();";
-  inner += "        if (!passphrase) {";
-  inner += "          alert('Please enter a passphrase');";
-  inner += "          return;";
-  inner += "        }";
-  inner += "        fetch('/api/cli', {";
-  inner += "          method: 'POST',";
-  inner += "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },";
-  inner += "          body: 'cmd=' + encodeURIComponent('espnow setpassphrase \"' + passphrase + '\"')";
-  inner += "        })";
-  inner += "        .then(response => response.text())";
-  inner += "        .then(text => {";
-  inner += "          document.getElementById('encryption-status').textContent = 'Passphrase set successfully';";
-  inner += "          document.getElementById('encryption-passphrase').value = '';";
-  inner += "          addMessageToLog('ENCRYPTION', text);";
-  inner += "        })";
-  inner += "        .catch(error => {";
-  inner += "          document.getElementById('encryption-status').textContent = 'Error setting passphrase';";
-  inner += "          addMessageToLog('ERROR', 'Passphrase error: ' + error);";
-  inner += "        });";
-  inner += "      });";
-  inner += "      document.getElementById('btn-clear-passphrase').addEventListener('click', function() {";
-  inner += "        fetch('/api/cli', {";
-  inner += "          method: 'POST',";
-  inner += "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },";
-  inner += "          body: 'cmd=' + encodeURIComponent('espnow clearpassphrase')";
-  inner += "        })";
-  inner += "        .then(response => response.text())";
-  inner += "        .then(text => {";
-  inner += "          document.getElementById('encryption-status').textContent = 'Passphrase cleared';";
-  inner += "          addMessageToLog('ENCRYPTION', text);";
-  inner += "        })";
-  inner += "        .catch(error => {";
-  inner += "          document.getElementById('encryption-status').textContent = 'Error clearing passphrase';";
-  inner += "          addMessageToLog('ERROR', 'Clear passphrase error: ' + error);";
-  inner += "        });";
-  inner += "      });";
-  inner += "      document.getElementById('btn-list-devices').addEventListener('click', listDevices);";
-  inner += "      document.getElementById('btn-send-message').addEventListener('click', function() {";
-  inner += "        const mac = document.getElementById('send-mac').value.trim();";
-  inner += "        const message = document.getElementById('send-message').value.trim();";
-  inner += "        if (!message) {";
-  inner += "          alert('Please enter a message to send');";
-  inner += "          return;";
-  inner += "        }";
-  inner += "        if (!mac) {";
-  inner += "          alert('Please enter a MAC address or use Broadcast button');";
-  inner += "          return;";
-  inner += "        }";
-  inner += "        sendMessage(mac, message);";
-  inner += "      });";
-  inner += "      document.getElementById('btn-broadcast-message').addEventListener('click', function() {";
-  inner += "        const message = document.getElementById('send-message').value.trim();";
-  inner += "        if (!message) {";
-  inner += "          alert('Please enter a message to broadcast');";
-  inner += "          return;";
-  inner += "        }";
-  inner += "        fetch('/api/cli', {";
-  inner += "          method: 'POST',";
-  inner += "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },";
-  inner += "          body: 'cmd=' + encodeURIComponent('espnow broadcast ' + message)";
-  inner += "        })";
-  inner += "        .then(response => response.text())";
-  inner += "        .then(text => {";
-  inner += "          addMessageToLog('BROADCAST', text);";
-  inner += "          if (text && text.indexOf('Broadcast sent') >= 0) {";
-  inner += "            document.getElementById('send-message').value = '';";
-  inner += "          }";
-  inner += "        })";
-  inner += "        .catch(error => {";
-  inner += "          addMessageToLog('ERROR', 'Broadcast error: ' + error);";
-  inner += "        });";
-  inner += "      });";
-  inner += "      document.getElementById('btn-clear-log').addEventListener('click', function() {";
-  inner += "        document.getElementById('message-log').innerHTML = '<div style=\"color: #666; text-align: center;\">Message log cleared</div>';";
-  inner += "        window.messageCount = 0;";
-  inner += "      });";
-  inner += "      /* Remote command button handlers */";
-  inner += "      document.getElementById('btn-send-remote').addEventListener('click', executeRemoteCommand);";
-  inner += "      document.getElementById('btn-clear-remote-log').addEventListener('click', function() {";
-  inner += "        document.getElementById('remote-results-log').innerHTML = '<div style=\"color: #666; text-align: center;\">Remote command results cleared</div>';";
-  inner += "      });";
-  inner += "      /* Enter key support for remote command */";
-  inner += "      document.getElementById('remote-command').addEventListener('keypress', function(e) {";
-  inner += "        if (e.key === 'Enter') {";
-  inner += "          executeRemoteCommand();";
-  inner += "        }";
-  inner += "      });";
-  inner += "    };";
-  inner += "    console.log('[ESP-NOW] Chunk 5: Button handlers ready');";
-  inner += "  } catch(e) { console.error('[ESP-NOW] Chunk 5 error:', e); }";
-  inner += "})();";
-  inner += "</script>";
+    "<script>"
+    "(function() {"
+    "  try {"
+    "    console.log('[ESP-NOW] Chunk 5: Button handlers start');"
+    "    window.setupButtonHandlers = function() {"
+    "      document.getElementById('btn-espnow-init').addEventListener('click', function() {"
+    "        fetch('/api/cli', {"
+    "          method: 'POST',"
+    "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },"
+    "          body: 'cmd=' + encodeURIComponent('espnow init')"
+    "        })"
+    "        .then(response => response.text())"
+    "        .then(text => {"
+    "          document.getElementById('espnow-status-data').textContent = text;"
+    "          refreshStatus();"
+    "        })"
+    "        .catch(error => {"
+    "          document.getElementById('espnow-status-data').textContent = 'Error: ' + error;"
+    "        });"
+    "      });"
+    "      document.getElementById('btn-espnow-refresh').addEventListener('click', refreshStatus);"
+    "      document.getElementById('btn-pair-device').addEventListener('click', function() {"
+    "        const mac = document.getElementById('pair-mac').value.trim();"
+    "        const name = document.getElementById('pair-name').value.trim();"
+    "        if (!mac || !name) {"
+    "          alert('Please enter both MAC address and device name');"
+    "          return;"
+    "        }"
+    "        fetch('/api/cli', {"
+    "          method: 'POST',"
+    "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },"
+    "          body: 'cmd=' + encodeURIComponent('espnow pair ' + mac + ' ' + name)"
+    "        })"
+    "        .then(response => response.text())"
+    "        .then(text => {"
+    "          addMessageToLog('PAIR', text);"
+    "          if (text && text.indexOf('Paired device') >= 0) {"
+    "            document.getElementById('pair-mac').value = '';"
+    "            document.getElementById('pair-name').value = '';"
+    "            listDevices();"
+    "          }"
+    "        })"
+    "        .catch(error => {"
+    "          addMessageToLog('ERROR', 'Pair error: ' + error);"
+    "        });"
+    "      });"
+    "      document.getElementById('btn-pair-secure').addEventListener('click', function() {"
+    "        const mac = document.getElementById('pair-mac').value.trim();"
+    "        const name = document.getElementById('pair-name').value.trim();"
+    "        if (!mac || !name) {"
+    "          alert('Please enter both MAC address and device name');"
+    "          return;"
+    "        }"
+    "        fetch('/api/cli', {"
+    "          method: 'POST',"
+    "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },"
+    "          body: 'cmd=' + encodeURIComponent('espnow pairsecure ' + mac + ' ' + name)"
+    "        })"
+    "        .then(response => response.text())"
+    "        .then(text => {"
+    "          addMessageToLog('PAIR_SECURE', text);"
+    "          if (text && text.indexOf('paired successfully') >= 0) {"
+    "            document.getElementById('pair-mac').value = '';"
+    "            document.getElementById('pair-name').value = '';"
+    "            listDevices();"
+    "          }"
+    "        })"
+    "        .catch(error => {"
+    "          addMessageToLog('ERROR', 'Secure pair error: ' + error);"
+    "        });"
+    "      });"
+    "      document.getElementById('btn-set-passphrase').addEventListener('click', function() {"
+    "        const passphrase = document.getElementById('encryption-passphrase').value.trim();"
+    "        if (!passphrase) {"
+    "          alert('Please enter a passphrase');"
+    "          return;"
+    "        }"
+    "        fetch('/api/cli', {"
+    "          method: 'POST',"
+    "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },"
+    "          body: 'cmd=' + encodeURIComponent('espnow setpassphrase \"' + passphrase + '\"')"
+    "        })"
+    "        .then(response => response.text())"
+    "        .then(text => {"
+    "          document.getElementById('encryption-status').textContent = 'Passphrase set successfully';"
+    "          document.getElementById('encryption-passphrase').value = '';"
+    "          addMessageToLog('ENCRYPTION', text);"
+    "        })"
+    "        .catch(error => {"
+    "          document.getElementById('encryption-status').textContent = 'Error setting passphrase';"
+    "          addMessageToLog('ERROR', 'Passphrase error: ' + error);"
+    "        });"
+    "      });"
+    "      document.getElementById('btn-clear-passphrase').addEventListener('click', function() {"
+    "        fetch('/api/cli', {"
+    "          method: 'POST',"
+    "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },"
+    "          body: 'cmd=' + encodeURIComponent('espnow clearpassphrase')"
+    "        })"
+    "        .then(response => response.text())"
+    "        .then(text => {"
+    "          document.getElementById('encryption-status').textContent = 'Passphrase cleared';"
+    "          addMessageToLog('ENCRYPTION', text);"
+    "        })"
+    "        .catch(error => {"
+    "          document.getElementById('encryption-status').textContent = 'Error clearing passphrase';"
+    "          addMessageToLog('ERROR', 'Clear passphrase error: ' + error);"
+    "        });"
+    "      });"
+    "      document.getElementById('btn-list-devices').addEventListener('click', listDevices);"
+    "      document.getElementById('btn-send-message').addEventListener('click', function() {"
+    "        const mac = document.getElementById('send-mac').value.trim();"
+    "        const message = document.getElementById('send-message').value.trim();"
+    "        if (!message) {"
+    "          alert('Please enter a message to send');"
+    "          return;"
+    "        }"
+    "        if (!mac) {"
+    "          alert('Please enter a MAC address or use Broadcast button');"
+    "          return;"
+    "        }"
+    "        sendMessage(mac, message);"
+    "      });"
+    "      document.getElementById('btn-broadcast-message').addEventListener('click', function() {"
+    "        const message = document.getElementById('send-message').value.trim();"
+    "        if (!message) {"
+    "          alert('Please enter a message to broadcast');"
+    "          return;"
+    "        }"
+    "        fetch('/api/cli', {"
+    "          method: 'POST',"
+    "          headers: { 'Content-Type': 'application/x-www-form-urlencoded' },"
+    "          body: 'cmd=' + encodeURIComponent('espnow broadcast ' + message)"
+    "        })"
+    "        .then(response => response.text())"
+    "        .then(text => {"
+    "          addMessageToLog('BROADCAST', text);"
+    "          if (text && text.indexOf('Broadcast sent') >= 0) {"
+    "            document.getElementById('send-message').value = '';"
+    "          }"
+    "        })"
+    "        .catch(error => {"
+    "          addMessageToLog('ERROR', 'Broadcast error: ' + error);"
+    "        });"
+    "      });"
+    "      document.getElementById('btn-clear-log').addEventListener('click', function() {"
+    "        document.getElementById('message-log').innerHTML = '<div style=\"color: #666; text-align: center;\">Message log cleared</div>';"
+    "        window.messageCount = 0;"
+    "      });"
+    "      /* Remote command button handlers */"
+    "      document.getElementById('btn-send-remote').addEventListener('click', executeRemoteCommand);"
+    "      document.getElementById('btn-clear-remote-log').addEventListener('click', function() {"
+    "        document.getElementById('remote-results-log').innerHTML = '<div style=\"color: #666; text-align: center;\">Remote command results cleared</div>';"
+    "      });"
+    "      /* Enter key support for remote command */"
+    "      document.getElementById('remote-command').addEventListener('keypress', function(e) {"
+    "        if (e.key === 'Enter') {"
+    "          executeRemoteCommand();"
+    "        }"
+    "      });"
+    "    };"
+    "    console.log('[ESP-NOW] Chunk 5: Button handlers ready');"
+    "  } catch(e) { console.error('[ESP-NOW] Chunk 5 error:', e); }"
+    "})();"
+    "</script>"
 
   // JavaScript - Chunk 5b: Remote Command Functions
-  inner += "<script>";
-  inner += "(function() {";
-  inner += "  try {";
-  inner += "    console.log('[ESP-NOW] Chunk 5b: Remote command functions start');";
-  inner += "    window.setRemoteCommand = function(command) {";
-  inner += "      document.getElementById('remote-command').value = command;";
-  inner += "    };";
-  inner += "    window.addRemoteResultToLog = function(type, message) {";
-  inner += "      const log = document.getElementById('remote-results-log');";
-  inner += "      const timestamp = new Date().toLocaleTimeString();";
-  inner += "      let className = 'message-item';";
-  inner += "      if (type === 'SUCCESS') className += ' message-received';";
-  inner += "      else if (type === 'ERROR' || type === 'FAILED') className += ' message-error';";
-  inner += "      else if (type === 'SENT') className += ' message-sent';";
-  inner += "      const messageDiv = document.createElement('div');";
-  inner += "      messageDiv.className = className;";
-  inner += "      if (type === 'RESULT') {";
-  inner += "        /* Multi-line result formatting */";
-  inner += "        messageDiv.innerHTML = '<pre style=\"margin: 0; white-space: pre-wrap; font-family: inherit;\">' + message + '</pre>';";
-  inner += "      } else {";
-  inner += "        messageDiv.textContent = '[' + timestamp + '] ' + type + ': ' + message;";
-  inner += "      }";
-  inner += "      if (log.children.length === 1 && log.children[0].textContent.includes('Remote command results will appear')) {";
-  inner += "        log.innerHTML = '';";
-  inner += "      }";
-  inner += "      log.appendChild(messageDiv);";
-  inner += "      /* Limit log size */";
-  inner += "      if (log.children.length > 20) {";
-  inner += "        log.removeChild(log.firstChild);";
-  inner += "      }";
-  inner += "      log.scrollTop = log.scrollHeight;";
-  inner += "    };";
-  inner += "    window.executeRemoteCommand = function() {";
-  inner += "      const device = document.getElementById('remote-device').value.trim();";
-  inner += "      const username = document.getElementById('remote-username').value.trim();";
-  inner += "      const password = document.getElementById('remote-password').value.trim();";
-  inner += "      const command = document.getElementById('remote-command').value.trim();";
-  inner += "      ";
-  inner += "      if (!device || !username || !password || !command) {";
-  inner += "        alert('Please fill in all fields: device, username, password, and command');";
-  inner += "        return;";
-  inner += "      }";
-  inner += "      ";
-  inner += "      const remoteCmd = 'espnow remote ' + device + ' ' + username + ' ' + password + ' ' + command;";
-  inner += "      addRemoteResultToLog('SENT', 'Executing on ' + device + ': ' + command);";
-  inner += "      ";
-  inner += "      fetch('/api/cli', {";
-  inner += "        method: 'POST',";
-  inner += "        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },";
-  inner += "        body: 'cmd=' + encodeURIComponent(remoteCmd)";
-  inner += "      })";
-  inner += "      .then(response => response.text())";
-  inner += "      .then(text => {";
-  inner += "        if (text.includes('Remote command sent')) {";
-  inner += "          addRemoteResultToLog('SUCCESS', 'Command sent successfully - waiting for response...');";
-  inner += "          /* Start polling for remote results */";
-  inner += "          setTimeout(function() { pollForRemoteResults(device); }, 1000);";
-  inner += "        } else {";
-  inner += "          addRemoteResultToLog('ERROR', text);";
-  inner += "        }";
-  inner += "      })";
-  inner += "      .catch(error => {";
-  inner += "        addRemoteResultToLog('ERROR', 'Send error: ' + error);";
-  inner += "      });";
-  inner += "    };";
-  inner += "    window.pollForRemoteResults = function(device) {";
-  inner += "      /* Poll logs for remote results - look for chunked or single results */";
-  inner += "      let pollCount = 0;";
-  inner += "      const maxPolls = 10; /* 10 seconds max wait */";
-  inner += "      ";
-  inner += "      const pollInterval = setInterval(function() {";
-  inner += "        pollCount++;";
-  inner += "        ";
-  inner += "        fetch('/logs.txt', { cache: 'no-store', credentials: 'same-origin' })";
-  inner += "          .then(r => r.text())";
-  inner += "          .then(logText => {";
-  inner += "            /* Look for remote results from the target device */";
-  inner += "            const lines = logText.split('\\n');";
-  inner += "            let foundResult = false;";
-  inner += "            let resultText = '';";
-  inner += "            ";
-  inner += "            for (let i = lines.length - 1; i >= 0 && i >= lines.length - 50; i--) {";
-  inner += "              const line = lines[i];";
-  inner += "              if (line.includes('[ESP-NOW] Remote result from ' + device)) {";
-  inner += "                foundResult = true;";
-  inner += "                /* Extract the result status */";
-  inner += "                if (line.includes('(SUCCESS)')) {";
-  inner += "                  addRemoteResultToLog('SUCCESS', 'Command completed successfully');";
-  inner += "                } else if (line.includes('(FAILED)')) {";
-  inner += "                  addRemoteResultToLog('FAILED', 'Command failed');";
-  inner += "                }";
-  inner += "                break;";
-  inner += "              }";
-  inner += "              /* Look for the actual result content (next line after result header) */";
-  inner += "              if (foundResult && line.trim().length > 0 && !line.includes('[ESP-NOW]')) {";
-  inner += "                resultText = line + '\\n' + resultText;";
-  inner += "              }";
-  inner += "            }";
-  inner += "            ";
-  inner += "            if (foundResult) {";
-  inner += "              clearInterval(pollInterval);";
-  inner += "              if (resultText.trim().length > 0) {";
-  inner += "                addRemoteResultToLog('RESULT', resultText.trim());";
-  inner += "              }";
-  inner += "            } else if (pollCount >= maxPolls) {";
-  inner += "              clearInterval(pollInterval);";
-  inner += "              addRemoteResultToLog('ERROR', 'Timeout waiting for response from ' + device);";
-  inner += "            }";
-  inner += "          })";
-  inner += "          .catch(e => {";
-  inner += "            if (pollCount >= maxPolls) {";
-  inner += "              clearInterval(pollInterval);";
-  inner += "              addRemoteResultToLog('ERROR', 'Error polling for results: ' + e);";
-  inner += "            }";
-  inner += "          });";
-  inner += "      }, 1000);";
-  inner += "    };";
-  inner += "    console.log('[ESP-NOW] Chunk 5b: Remote command functions ready');";
-  inner += "  } catch(e) { console.error('[ESP-NOW] Chunk 5b error:', e); }";
-  inner += "})();";
-  inner += "</script>";
+    "<script>"
+    "(function() {"
+    "  try {"
+    "    console.log('[ESP-NOW] Chunk 5b: Remote command functions start');"
+    "    window.setRemoteCommand = function(command) {"
+    "      document.getElementById('remote-command').value = command;"
+    "    };"
+    "    window.addRemoteResultToLog = function(type, message) {"
+    "      const log = document.getElementById('remote-results-log');"
+    "      const timestamp = new Date().toLocaleTimeString();"
+    "      let className = 'message-item';"
+    "      if (type === 'SUCCESS') className += ' message-received';"
+    "      else if (type === 'ERROR' || type === 'FAILED') className += ' message-error';"
+    "      else if (type === 'SENT') className += ' message-sent';"
+    "      const messageDiv = document.createElement('div');"
+    "      messageDiv.className = className;"
+    "      if (type === 'RESULT') {"
+    "        /* Multi-line result formatting */"
+    "        messageDiv.innerHTML = '<pre style=\"margin: 0; white-space: pre-wrap; font-family: inherit;\">' + message + '</pre>';"
+    "      } else {"
+    "        messageDiv.textContent = '[' + timestamp + '] ' + type + ': ' + message;"
+    "      }"
+    "      if (log.children.length === 1 && log.children[0].textContent.includes('Remote command results will appear')) {"
+    "        log.innerHTML = '';"
+    "      }"
+    "      log.appendChild(messageDiv);"
+    "      /* Limit log size */"
+    "      if (log.children.length > 20) {"
+    "        log.removeChild(log.firstChild);"
+    "      }"
+    "      log.scrollTop = log.scrollHeight;"
+    "    };"
+    "    window.executeRemoteCommand = function() {"
+    "      const device = document.getElementById('remote-device').value.trim();"
+    "      const username = document.getElementById('remote-username').value.trim();"
+    "      const password = document.getElementById('remote-password').value.trim();"
+    "      const command = document.getElementById('remote-command').value.trim();"
+    "      "
+    "      if (!device || !username || !password || !command) {"
+    "        alert('Please fill in all fields: device, username, password, and command');"
+    "        return;"
+    "      }"
+    "      "
+    "      const remoteCmd = 'espnow remote ' + device + ' ' + username + ' ' + password + ' ' + command;"
+    "      addRemoteResultToLog('SENT', 'Executing on ' + device + ': ' + command);"
+    "      "
+    "      fetch('/api/cli', {"
+    "        method: 'POST',"
+    "        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },"
+    "        body: 'cmd=' + encodeURIComponent(remoteCmd)"
+    "      })"
+    "      .then(response => response.text())"
+    "      .then(text => {"
+    "        if (text.includes('Remote command sent')) {"
+    "          addRemoteResultToLog('SUCCESS', 'Command sent successfully - waiting for response...');"
+    "          /* Start polling for remote results */"
+    "          setTimeout(function() { pollForRemoteResults(device); }, 1000);"
+    "        } else {"
+    "          addRemoteResultToLog('ERROR', text);"
+    "        }"
+    "      })"
+    "      .catch(error => {"
+    "        addRemoteResultToLog('ERROR', 'Send error: ' + error);"
+    "      });"
+    "    };"
+    "    window.pollForRemoteResults = function(device) {"
+    "      /* Poll logs for remote results - look for chunked or single results */"
+    "      let pollCount = 0;"
+    "      const maxPolls = 10; /* 10 seconds max wait */"
+    "      "
+    "      const pollInterval = setInterval(function() {"
+    "        pollCount++;"
+    "        "
+    "        fetch('/logs.txt', { cache: 'no-store', credentials: 'same-origin' })"
+    "          .then(r => r.text())"
+    "          .then(logText => {"
+    "            /* Look for remote results from the target device */"
+    "            const lines = logText.split('\\n');"
+    "            let foundResult = false;"
+    "            let resultText = '';"
+    "            "
+    "            for (let i = lines.length - 1; i >= 0 && i >= lines.length - 50; i--) {"
+    "              const line = lines[i];"
+    "              if (line.includes('[ESP-NOW] Remote result from ' + device)) {"
+    "                foundResult = true;"
+    "                /* Extract the result status */"
+    "                if (line.includes('(SUCCESS)')) {"
+    "                  addRemoteResultToLog('SUCCESS', 'Command completed successfully');"
+    "                } else if (line.includes('(FAILED)')) {"
+    "                  addRemoteResultToLog('FAILED', 'Command failed');"
+    "                }"
+    "                break;"
+    "              }"
+    "              /* Look for the actual result content (next line after result header) */"
+    "              if (foundResult && line.trim().length > 0 && !line.includes('[ESP-NOW]')) {"
+    "                resultText = line + '\\n' + resultText;"
+    "              }"
+    "            }"
+    "            "
+    "            if (foundResult) {"
+    "              clearInterval(pollInterval);"
+    "              if (resultText.trim().length > 0) {"
+    "                addRemoteResultToLog('RESULT', resultText.trim());"
+    "              }"
+    "            } else if (pollCount >= maxPolls) {"
+    "              clearInterval(pollInterval);"
+    "              addRemoteResultToLog('ERROR', 'Timeout waiting for response from ' + device);"
+    "            }"
+    "          })"
+    "          .catch(e => {"
+    "            if (pollCount >= maxPolls) {"
+    "              clearInterval(pollInterval);"
+    "              addRemoteResultToLog('ERROR', 'Error polling for results: ' + e);"
+    "            }"
+    "          });"
+    "      }, 1000);"
+    "    };"
+    "    console.log('[ESP-NOW] Chunk 5b: Remote command functions ready');"
+    "  } catch(e) { console.error('[ESP-NOW] Chunk 5b error:', e); }"
+    "})();"
+    "</script>"
 
   // JavaScript - Chunk 6: Main Initialization
-  inner += "<script>";
-  inner += "(function() {";
-  inner += "  try {";
-  inner += "    console.log('[ESP-NOW] Chunk 6: Main init start');";
-  inner += "    document.addEventListener('DOMContentLoaded', function() {";
-  inner += "      console.log('[ESP-NOW] DOMContentLoaded');";
-  inner += "      setupButtonHandlers();";
-  inner += "      refreshStatus();";
-  inner += "      listDevices();";
-  inner += "      /* Start RX watcher - functions should be available by now */";
-  inner += "      try {";
-  inner += "        if (typeof window.startEspNowReceiveWatcher === 'function') {";
-  inner += "          console.log('[ESP-NOW] Starting RX watcher...');";
-  inner += "          window.startEspNowReceiveWatcher();";
-  inner += "        } else {";
-  inner += "          console.warn('[ESP-NOW] RX watcher function not available');";
-  inner += "        }";
-  inner += "      } catch (e) { console.warn('[ESP-NOW] Error starting RX watcher:', e); }";
-  inner += "    });";
-  inner += "    console.log('[ESP-NOW] Chunk 6: Main init ready');";
-  inner += "  } catch(e) { console.error('[ESP-NOW] Chunk 6 error:', e); }";
-  inner += "})();";
-  inner += "</script>";
-
-  return inner;
-}
-
-String getEspNowPage(const String& username) {
-  return htmlShellWithNav(username, "espnow", getEspNowContent());
-}
+    "<script>"
+    "(function() {"
+    "  try {"
+    "    console.log('[ESP-NOW] Chunk 6: Main init start');"
+    "    document.addEventListener('DOMContentLoaded', function() {"
+    "      console.log('[ESP-NOW] DOMContentLoaded');"
+    "      setupButtonHandlers();"
+    "      refreshStatus();"
+    "      listDevices();"
+    "      /* Start RX watcher - functions should be available by now */"
+    "      try {"
+    "        if (typeof window.startEspNowReceiveWatcher === 'function') {"
+    "          console.log('[ESP-NOW] Starting RX watcher...');"
+    "          window.startEspNowReceiveWatcher();"
+    "        } else {"
+    "          console.warn('[ESP-NOW] RX watcher function not available');"
+    "        }"
+    "      } catch (e) { console.warn('[ESP-NOW] Error starting RX watcher:', e); }"
+    "    });"
+    "    console.log('[ESP-NOW] Chunk 6: Main init ready');"
+    "  } catch(e) { console.error('[ESP-NOW] Chunk 6 error:', e); }"
+    "})();"
+    "</script>";
 
 #endif
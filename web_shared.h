@@ -7,6 +7,12 @@ String generateNavigation(const String& activePage, const String& username);
 String generatePublicNavigation();
 String htmlPublicShellWithNav(const String& inner);
 
+// Per-request values inside otherwise static pages (marker byte + slot id).
+// The gzip page cache splits pages at these; see webSlotValue().
+#define WEB_SLOT_USER "\x1e" "U"
+#define WEB_SLOT_IP "\x1e" "I"
+#define WEB_SLOT_NAV "\x1e" "N"
+
 String htmlPage(const String& body) {
   return String(
     "<!DOCTYPE html><html><head><meta charset='utf-8'>"
@@ -15,8 +21,7 @@ String htmlPage(const String& body) {
     "</style></head><body>" + body + "</body></html>";
 }
 
-String getCommonCSS() {
-  return
+static const char kWebCommonCss[] PROGMEM =
     "*{margin:0;padding:0;box-sizing:border-box}"
     "body{font-family:'Segoe UI',Tahoma,Geneva,Verdana,sans-serif;"
     "background:linear-gradient(135deg,#667eea 0%,#764ba2 100%);"
@@ -125,6 +130,9 @@ String getCommonCSS() {
     ".table th,.table td{padding:.5rem;text-align:left;border-bottom:1px solid #ddd;color:#333}"
     ".table-striped tr:nth-child(odd){background:#fafafa}"
     ;
+
+String getCommonCSS() {
+  return String(kWebCommonCss);
 }
 
 // Public page shell - minimal navigation with only login
@@ -138,22 +146,25 @@ String htmlPublicShellWithNav(const String& inner) {
   return h;
 }
 
-// Authenticated page shell - full navigation
-String htmlShellWithNav(const String& username, const String& activePage, const String& inner) {
-  String h;
-  h += "<!DOCTYPE html><html><head><meta charset='utf-8'><meta name='viewport' content='width=device-width,initial-scale=1'>";
-  h += "<title>HardwareOne - Minimal</title><style>"; h += getCommonCSS(); h += "</style></head><body>";
-  h += generateNavigation(activePage, username);
-  h += "<div class='content'><div class='card'>"; h += inner; h += "</div></div>";
+// Authenticated page shell - full navigation. Kept in flash as spans around the
+// page content: kWebShellHead, kWebCommonCss, kWebShellBody, content, kWebShellTail
+static const char kWebShellHead[] PROGMEM =
+  "<!DOCTYPE html><html><head><meta charset='utf-8'><meta name='viewport' content='width=device-width,initial-scale=1'>"
+  "<title>HardwareOne - Minimal</title><style>";
+
+static const char kWebShellBody[] PROGMEM =
+  "</style></head><body>" WEB_SLOT_NAV
+  "<div class='content'><div class='card'>";
+
+static const char kWebShellTail[] PROGMEM =
+  "</div></div>"
   // Unified SSE + Session Management System
-  h += "<script>(function(){try{ if(typeof window.ENABLE_SSE==='undefined'){ window.ENABLE_SSE=true; } var pollInterval=null; var checkRevoke=function(){ try{ fetch('/api/notice',{cache:'no-store',credentials:'same-origin'}).then(function(r){ if(r.status===401){ fetch('/login',{cache:'no-store',credentials:'same-origin'}).then(function(lr){return lr.text();}).then(function(loginHtml){ var startMarker='alert alert-warning'; var alertStart=loginHtml.indexOf(startMarker); var reason=''; if(alertStart>=0){ var strongStart=loginHtml.indexOf('<strong>Session Terminated:</strong>',alertStart); if(strongStart>=0){ var reasonStart=strongStart+37; var reasonEnd=loginHtml.indexOf('<',reasonStart); if(reasonEnd<0) reasonEnd=loginHtml.length; reason=loginHtml.substring(reasonStart,reasonEnd).trim(); } } if(reason.length>0){ sessionStorage.setItem('revokeMsg','[revoke] '+reason); }else{ sessionStorage.setItem('revokeMsg','[revoke] Your session has expired. Please log in again.'); } document.body.innerHTML='<div style=\"text-align:center;padding:50px;font-family:Arial,sans-serif\"><h2>Session Expired</h2><p>Redirecting to login...</p></div>'; setTimeout(function(){ window.location.replace('/login'); }, 1000); }).catch(function(){ sessionStorage.setItem('revokeMsg','[revoke] Your session has expired. Please log in again.'); document.body.innerHTML='<div style=\"text-align:center;padding:50px;font-family:Arial,sans-serif\"><h2>Session Expired</h2><p>Redirecting to login...</p></div>'; setTimeout(function(){ window.location.replace('/login'); }, 1000); }); return; } return r.json(); }).then(function(d){ if(d&&d.notice&&d.notice.indexOf('[revoke]')===0){ try{ if(window.__es){ window.__es.close(); window.__es=null; } sessionStorage.setItem('revokeMsg', d.notice); document.body.innerHTML='<div style=\"text-align:center;padding:50px;font-family:Arial,sans-serif\"><h2>Session Revoked</h2><p>Redirecting to login...</p></div>'; setTimeout(function(){ window.location.replace('/login'); }, 1000); }catch(_){ window.location.href='/login'; } } }).catch(function(){}); }catch(_){} }; var startPolling=function(){ if(!pollInterval){ pollInterval=setInterval(checkRevoke, 8000); } }; var stopPolling=function(){ if(pollInterval){ clearInterval(pollInterval); pollInterval=null; } }; if(!window.ENABLE_SSE||!window.EventSource){ startPolling(); }else{ var attachNotice=function(es){ try{ es.addEventListener('notice', function(e){ try{ var d=null; try{ d=JSON.parse(e.data||'{}'); }catch(_){ d=null; } if(d&&d.msg){ if(d.msg.indexOf('[revoke]')===0){ try{ if(window.__es){ window.__es.close(); window.__es=null; } sessionStorage.setItem('revokeMsg', d.msg); document.body.innerHTML='<div style=\"text-align:center;padding:50px;font-family:Arial,sans-serif\"><h2>Session Revoked</h2><p>Redirecting to login...</p></div>'; setTimeout(function(){ window.location.replace('/login'); }, 1000); }catch(_){ window.location.href='/login'; } } else { try{ alert(d.msg); }catch(_){ console.log('[NOTICE]', d.msg); } } } } catch(_){ } }); }catch(_){ } }; window.ensureES=function(){ try{ var es=window.__es; if(es && es.readyState===1){ stopPolling(); attachNotice(es); return; } if(es){ try{ es.close(); }catch(_){ } } es = new EventSource('/api/events', { withCredentials: true }); window.__es = es; attachNotice(es); es.onopen=function(){ stopPolling(); if(window.DEBUG_SSE){ console.log('[SSE] connected'); } }; es.onerror=function(){ if(window.DEBUG_SSE){ console.log('[SSE] error (auto-reconnect)'); } startPolling(); }; }catch(_){ startPolling(); } }; window.ensureES(); setInterval(window.ensureES, 10000); } }catch(_){ startPolling(); } })();</script>";
+  "<script>(function(){try{ if(typeof window.ENABLE_SSE==='undefined'){ window.ENABLE_SSE=true; } var pollInterval=null; var checkRevoke=function(){ try{ fetch('/api/notice',{cache:'no-store',credentials:'same-origin'}).then(function(r){ if(r.status===401){ fetch('/login',{cache:'no-store',credentials:'same-origin'}).then(function(lr){return lr.text();}).then(function(loginHtml){ var startMarker='alert alert-warning'; var alertStart=loginHtml.indexOf(startMarker); var reason=''; if(alertStart>=0){ var strongStart=loginHtml.indexOf('<strong>Session Terminated:</strong>',alertStart); if(strongStart>=0){ var reasonStart=strongStart+37; var reasonEnd=loginHtml.indexOf('<',reasonStart); if(reasonEnd<0) reasonEnd=loginHtml.length; reason=loginHtml.substring(reasonStart,reasonEnd).trim(); } } if(reason.length>0){ sessionStorage.setItem('revokeMsg','[revoke] '+reason); }else{ sessionStorage.setItem('revokeMsg','[revoke] Your session has expired. Please log in again.'); } document.body.innerHTML='<div style=\"text-align:center;padding:50px;font-family:Arial,sans-serif\"><h2>Session Expired</h2><p>Redirecting to login...</p></div>'; setTimeout(function(){ window.location.replace('/login'); }, 1000); }).catch(function(){ sessionStorage.setItem('revokeMsg','[revoke] Your session has expired. Please log in again.'); document.body.innerHTML='<div style=\"text-align:center;padding:50px;font-family:Arial,sans-serif\"><h2>Session Expired</h2><p>Redirecting to login...</p></div>'; setTimeout(function(){ window.location.replace('/login'); }, 1000); }); return; } return r.json(); }).then(function(d){ if(d&&d.notice&&d.notice.indexOf('[revoke]')===0){ try{ if(window.__es){ window.__es.close(); window.__es=null; } sessionStorage.setItem('revokeMsg', d.notice); document.body.innerHTML='<div style=\"text-align:center;padding:50px;font-family:Arial,sans-serif\"><h2>Session Revoked</h2><p>Redirecting to login...</p></div>'; setTimeout(function(){ window.location.replace('/login'); }, 1000); }catch(_){ window.location.href='/login'; } } }).catch(function(){}); }catch(_){} }; var startPolling=function(){ if(!pollInterval){ pollInterval=setInterval(checkRevoke, 8000); } }; var stopPolling=function(){ if(pollInterval){ clearInterval(pollInterval); pollInterval=null; } }; if(!window.ENABLE_SSE||!window.EventSource){ startPolling(); }else{ var attachNotice=function(es){ try{ es.addEventListener('notice', function(e){ try{ var d=null; try{ d=JSON.parse(e.data||'{}'); }catch(_){ d=null; } if(d&&d.msg){ if(d.msg.indexOf('[revoke]')===0){ try{ if(window.__es){ window.__es.close(); window.__es=null; } sessionStorage.setItem('revokeMsg', d.msg); document.body.innerHTML='<div style=\"text-align:center;padding:50px;font-family:Arial,sans-serif\"><h2>Session Revoked</h2><p>Redirecting to login...</p></div>'; setTimeout(function(){ window.location.replace('/login'); }, 1000); }catch(_){ window.location.href='/login'; } } else { try{ alert(d.msg); }catch(_){ console.log('[NOTICE]', d.msg); } } } } catch(_){ } }); }catch(_){ } }; window.ensureES=function(){ try{ var es=window.__es; if(es && es.readyState===1){ stopPolling(); attachNotice(es); return; } if(es){ try{ es.close(); }catch(_){ } } es = new EventSource('/api/events', { withCredentials: true }); window.__es = es; attachNotice(es); es.onopen=function(){ stopPolling(); if(window.DEBUG_SSE){ console.log('[SSE] connected'); } }; es.onerror=function(){ if(window.DEBUG_SSE){ console.log('[SSE] error (auto-reconnect)'); } startPolling(); }; }catch(_){ startPolling(); } }; window.ensureES(); setInterval(window.ensureES, 10000); } }catch(_){ startPolling(); } })();</script>"
   // Proactively close SSE on navigation/unload to free server resources quickly
-  h += "<script>(function(){ try{ function closeES(){ try{ if(window.__es){ window.__es.close(); window.__es=null; } }catch(_){ } } window.addEventListener('beforeunload', closeES, {capture:true}); window.addEventListener('pagehide', closeES, {capture:true}); document.addEventListener('click', function(ev){ try{ var a=ev.target; while(a && a.tagName!=='A'){ a=a.parentElement; } if(!a) return; var href=a.getAttribute('href'); if(!href) return; if(href.indexOf('#')===0) return; /* ignore in-page anchors */ closeES(); }catch(_){ } }, {capture:true}); }catch(_){ } })();</script>";
+  "<script>(function(){ try{ function closeES(){ try{ if(window.__es){ window.__es.close(); window.__es=null; } }catch(_){ } } window.addEventListener('beforeunload', closeES, {capture:true}); window.addEventListener('pagehide', closeES, {capture:true}); document.addEventListener('click', function(ev){ try{ var a=ev.target; while(a && a.tagName!=='A'){ a=a.parentElement; } if(!a) return; var href=a.getAttribute('href'); if(!href) return; if(href.indexOf('#')===0) return; /* ignore in-page anchors */ closeES(); }catch(_){ } }, {capture:true}); }catch(_){ } })();</script>"
   // One-shot status hydration on page load (no persistent SSE needed)
-  h += "<script>(function(){ try{ fetch('/api/sensors/status',{cache:'no-store', credentials:'same-origin'}).then(function(r){return r.json();}).then(function(j){ if(j && typeof window.applySensorStatus==='function'){ try{ window.applySensorStatus(j); }catch(_){ } } }).catch(function(_){ }); }catch(_){ } })();</script>";
-  h += "</body></html>";
-  return h;
-}
+  "<script>(function(){ try{ fetch('/api/sensors/status',{cache:'no-store', credentials:'same-origin'}).then(function(r){return r.json();}).then(function(j){ if(j && typeof window.applySensorStatus==='function'){ try{ window.applySensorStatus(j); }catch(_){ } } }).catch(function(_){ }); }catch(_){ } })();</script>"
+  "</body></html>";
 
 // Render a generic two-field form with two buttons using shared classes
 // title: heading for the form